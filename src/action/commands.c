@@ -75,11 +75,16 @@ cmd_pop(
 int
 ws_action_commands_init(void) {
     // list of commands to add. These _must_ be sorted!
+    // They only affect the processor, hence they are all pure.
     struct ws_command cmds[] = {
-        {.name = "jump",  .command_type = special, .func.special = cmd_jump  },
-        {.name = "store", .command_type = special, .func.special = cmd_store },
-        {.name = "push",  .command_type = special, .func.special = cmd_push  },
-        {.name = "pop",   .command_type = special, .func.special = cmd_pop   },
+        {.name = "jump",  .command_type = special, .pure = true,
+         .func.special = cmd_jump  },
+        {.name = "pop",   .command_type = special, .pure = true,
+         .func.special = cmd_pop   },
+        {.name = "push",  .command_type = special, .pure = true,
+         .func.special = cmd_push  },
+        {.name = "store", .command_type = special, .pure = true,
+         .func.special = cmd_store },
     };
 
     return ws_command_add(cmds, ARYLEN(cmds));
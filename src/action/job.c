@@ -0,0 +1,352 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "action/job.h"
+#include "objects/message/error_reply.h"
+#include "objects/message/transaction.h"
+#include "objects/message/value_reply.h"
+#include "trace/module.h"
+#include "util/error.h"
+#include "values/object_id.h"
+#include "values/union.h"
+#include "values/value_type.h"
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Finish a job with an error reply
+ */
+static void
+job_fail(
+    struct ws_action_job* self, //!< the job
+    int error, //!< positive error number
+    char const* msg //!< error message
+);
+
+/**
+ * Store the result of the current part of a batch
+ *
+ * @return 0 on success, a negative error number otherwise
+ */
+static int
+job_store_result(
+    struct ws_action_job* self //!< the job
+);
+
+/**
+ * Store the result of the current part of a batch and set up the next one
+ *
+ * The statements run by the finished part are deducted from the budget.
+ *
+ * @return 0 on success, a negative error number otherwise
+ */
+static int
+job_next_part(
+    struct ws_action_job* self, //!< the job
+    size_t* budget //!< remaining budget
+);
+
+/**
+ * Tear down the processor and stack of a running job
+ */
+static void
+job_stop(
+    struct ws_action_job* self //!< the job
+);
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+void
+ws_action_job_init(
+    struct ws_action_job* self,
+    struct ws_transaction* transaction,
+    struct ws_object* global_ctx,
+    struct ws_value* context,
+    struct ws_value* connection_ctx
+) {
+    memset(self, 0, sizeof(*self));
+    self->transaction = (struct ws_transaction*)
+                        ws_object_getref(&transaction->m.obj);
+    ws_object_read_log_init(&self->reads);
+    ws_value_table_init(&self->results);
+
+    // get the commands from the transaction. For batches, these are the
+    // commands of the last part, which keep the stack hint for the batch.
+    struct ws_transaction_command_list* commands;
+    commands = ws_transaction_commands(transaction);
+    if (!commands) {
+        job_fail(self, EINVAL, "Command list malformed");
+        return;
+    }
+    size_t hint = commands->stack_hint + 1;
+
+    size_t parts_num = ws_transaction_parts_num(transaction);
+    if (parts_num) {
+        int res = ws_value_table_resize(&self->results, parts_num, 1);
+        if (res < 0) {
+            job_fail(self, -res, "Could not allocate batch results");
+            return;
+        }
+        commands = ws_transaction_part(transaction, 0);
+    }
+
+    // prepare the stack, large enough for what previous runs needed
+    int res = ws_processor_stack_acquire(&self->stack, hint);
+    if (res < 0) {
+        job_fail(self, -res, "Could not init stack");
+        return;
+    }
+
+    // push environment on the stack
+    res = ws_processor_stack_push(&self->stack, 3);
+    if (res < 0) {
+        ws_processor_stack_release(&self->stack);
+        job_fail(self, -res, "Could not init stack");
+        return;
+    }
+
+    {
+        union ws_value_union* bottom = ws_processor_stack_bottom(&self->stack);
+
+        // initialize the global context
+        ws_value_union_reinit(bottom, WS_VALUE_TYPE_OBJECT_ID);
+        ws_value_object_id_set(&bottom->object_id, global_ctx);
+
+        // initialize the event context
+        ++bottom;
+        if (context) {
+            ws_value_union_init_from_val(bottom, context);
+        } else {
+            ws_value_union_reinit(bottom, WS_VALUE_TYPE_NIL);
+        }
+
+        // initialize the connection context
+        ++bottom;
+        if (connection_ctx) {
+            ws_value_union_init_from_val(bottom, connection_ctx);
+        } else {
+            ws_value_union_reinit(bottom, WS_VALUE_TYPE_NIL);
+        }
+    }
+
+    // we start a new frame, but we will never restore the default frame
+    (void) ws_processor_stack_start_frame(&self->stack);
+
+    // prepare the processor
+    res = ws_processor_init(&self->proc, &self->stack, commands);
+    if (res < 0) {
+        ws_processor_stack_release(&self->stack);
+        job_fail(self, -res, "Could not init processor");
+        return;
+    }
+
+    self->running = true;
+    ws_trace_async_begin(WS_TRACE_EVENT_TRANSACTION, (uintptr_t) self,
+                         ws_object_uuid(&transaction->m.obj));
+}
+
+bool
+ws_action_job_step(
+    struct ws_action_job* self,
+    size_t budget
+) {
+    if (!self->running) {
+        return true;
+    }
+
+    size_t parts_num = ws_transaction_parts_num(self->transaction);
+
+    if (self->log_reads) {
+        ws_object_read_log_start(&self->reads);
+    }
+    ssize_t res;
+    while (1) {
+        res = ws_processor_exec_budget(&self->proc, budget);
+        if ((res < 0) || (self->part + 1 >= parts_num)) {
+            break;
+        }
+
+        // run the next part of the batch, as far as the budget allows
+        res = job_next_part(self, &budget);
+        if (res < 0) {
+            break;
+        }
+    }
+    if (self->log_reads) {
+        ws_object_read_log_stop();
+    }
+
+    if (res == -EINPROGRESS) {
+        return false;
+    }
+
+    if ((res >= 0) && parts_num) {
+        res = job_store_result(self);
+    }
+
+    if (res < 0) {
+        job_stop(self);
+        if (!parts_num) {
+            job_fail(self, -res, ws_errno_tostr(res));
+            return true;
+        }
+
+        char msg[64];
+        snprintf(msg, sizeof(msg), "Part %zu of batch failed: %s",
+                 self->part, ws_errno_tostr(res));
+        job_fail(self, -res, msg);
+        return true;
+    }
+
+    // create the return message from the transaction and the value
+    struct ws_value* value = &self->results.value;
+    if (!parts_num) {
+        value = ws_processor_stack_value_at(&self->stack, -1, NULL);
+    }
+    self->reply = (struct ws_reply*)
+                  ws_value_reply_new(self->transaction, value);
+
+    job_stop(self);
+    return true;
+}
+
+struct ws_reply*
+ws_action_job_take_reply(
+    struct ws_action_job* self
+) {
+    struct ws_reply* reply = self->reply;
+    self->reply = NULL;
+    return reply;
+}
+
+void
+ws_action_job_deinit(
+    struct ws_action_job* self
+) {
+    job_stop(self);
+
+    if (self->reply) {
+        ws_object_unref(&self->reply->m.obj);
+        self->reply = NULL;
+    }
+
+    ws_object_read_log_deinit(&self->reads);
+    ws_value_deinit(&self->results.value);
+    ws_object_unref(self->etc);
+    ws_object_unref(&self->transaction->m.obj);
+}
+
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static void
+job_fail(
+    struct ws_action_job* self,
+    int error,
+    char const* msg
+) {
+    self->reply = (struct ws_reply*)
+                  ws_error_reply_new(self->transaction, error, msg, NULL);
+}
+
+static int
+job_store_result(
+    struct ws_action_job* self
+) {
+    union ws_value_union* cell;
+    cell = ws_value_table_cell(&self->results, self->part, 0);
+
+    struct ws_value* value;
+    value = ws_processor_stack_value_at(&self->stack, -1, NULL);
+    if (!value) {
+        return 0;
+    }
+
+    return ws_value_union_init_from_val(cell, value);
+}
+
+static int
+job_next_part(
+    struct ws_action_job* self,
+    size_t* budget
+) {
+    int res = job_store_result(self);
+    if (res < 0) {
+        return res;
+    }
+
+    // roughly account for the statements run by the part
+    struct ws_transaction_command_list* commands;
+    commands = ws_transaction_part(self->transaction, self->part);
+    *budget -= *budget < commands->num ? *budget : commands->num;
+
+    // deinitializing the processor clears its frame, so the next part starts
+    // with a clean stack
+    ws_processor_deinit(&self->proc);
+    ++self->part;
+    commands = ws_transaction_part(self->transaction, self->part);
+    return ws_processor_init(&self->proc, &self->stack, commands);
+}
+
+static void
+job_stop(
+    struct ws_action_job* self
+) {
+    if (!self->running) {
+        return;
+    }
+
+    ws_trace_async_end(WS_TRACE_EVENT_TRANSACTION, (uintptr_t) self,
+                       ws_object_uuid(&self->transaction->m.obj));
+    ws_processor_deinit(&self->proc);
+
+    struct ws_transaction_command_list* commands;
+    commands = ws_transaction_commands(self->transaction);
+    size_t high = ws_processor_stack_high_water(&self->stack);
+    if (high > commands->stack_hint) {
+        commands->stack_hint = high;
+    }
+    ws_processor_stack_release(&self->stack);
+
+    self->running = false;
+}
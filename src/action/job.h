@@ -0,0 +1,171 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup action "Action manager"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup action_job "Action manager jobs"
+ *
+ * A job is a single run of a transaction, which may be suspended and resumed
+ * at statement boundaries.
+ *
+ * @{
+ */
+
+#ifndef __WS_ACTION_JOB_H__
+#define __WS_ACTION_JOB_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "action/processor.h"
+#include "action/processor_stack.h"
+#include "objects/object.h"
+#include "util/attributes.h"
+#include "values/table.h"
+
+// forward declarations
+struct ws_action_job;
+struct ws_reply;
+struct ws_transaction;
+struct ws_value;
+
+/**
+ * Callback invoked by the scheduler once a job is finished
+ *
+ * The callback is responsible for deinitializing and freeing the job.
+ */
+typedef void (*ws_action_job_done_callback)(struct ws_action_job*);
+
+/**
+ * Callback for delivering the reply of a deferred job
+ *
+ * The callback takes over the reference on the reply, which may be `NULL`.
+ */
+typedef void (*ws_action_reply_callback)(struct ws_reply*, struct ws_object*);
+
+/**
+ * Job, a (resumable) run of a transaction
+ */
+struct ws_action_job {
+    struct ws_transaction* transaction; //!< @private transaction being run
+    struct ws_processor_stack stack; //!< @private stack of the processor
+    struct ws_processor proc; //!< @private the processor
+    struct ws_reply* reply; //!< @private reply, once the job is finished
+    bool running; //!< @private whether the processor is set up
+    size_t part; //!< @private part of a batch currently run
+    struct ws_value_table results; //!< @private results of batch parts
+
+    bool log_reads; //!< @public whether to log the attribute reads
+    struct ws_object_read_log reads; //!< @public attribute reads of the job
+
+    ws_action_job_done_callback done; //!< @public called when finished
+    ws_action_reply_callback callback; //!< @public reply delivery callback
+    struct ws_object* etc; //!< @public argument for the callback (ref held)
+    bool discard_reply; //!< @public whether to drop the reply
+    struct ws_action_job* next; //!< @private next job in the queue
+};
+
+/**
+ * Initialize a job
+ *
+ * This function prepares the stack and processor for running the transaction.
+ * If something goes wrong, the job is finished right away, holding an error
+ * reply.
+ */
+void
+ws_action_job_init(
+    struct ws_action_job* self, //!< job to initialize
+    struct ws_transaction* transaction, //!< transaction to run
+    struct ws_object* global_ctx, //!< global context to push on the stack
+    struct ws_value* context, //!< context to push on the stack (or NULL)
+    struct ws_value* connection_ctx //!< connection ctx to push on the stack
+)
+__ws_nonnull__(1, 2)
+;
+
+/**
+ * Run a job for a limited number of statements
+ *
+ * The parts of a batch are run one after another on the same stack, which is
+ * cleared between the parts. The whole batch fails if one part fails.
+ *
+ * @return true if the job is finished, false if it has to be resumed
+ */
+bool
+ws_action_job_step(
+    struct ws_action_job* self, //!< job to run
+    size_t budget //!< maximum number of statements to run
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Take the reply from a finished job
+ *
+ * The reply is either an error reply or a value reply transporting the topmost
+ * element of the stack. If the transaction didn't leave a value, a nil value is
+ * embedded in the reply.
+ * For a batch, the value is a table with one row per part, holding the topmost
+ * element left by that part.
+ *
+ * @return the reply, the caller takes over the reference
+ */
+struct ws_reply*
+ws_action_job_take_reply(
+    struct ws_action_job* self //!< the job
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Deinitialize a job
+ *
+ * Releases everything held by the job, including a reply not taken and the
+ * callback argument.
+ */
+void
+ws_action_job_deinit(
+    struct ws_action_job* self //!< job to deinitialize
+)
+__ws_nonnull__(1)
+;
+
+#endif // __WS_ACTION_JOB_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
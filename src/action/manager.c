@@ -27,17 +27,21 @@
 
 #include <errno.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "action/commands.h"
+#include "action/job.h"
 #include "action/manager.h"
-#include "action/processor.h"
-#include "action/processor_stack.h"
+#include "action/memo.h"
+#include "action/scheduler.h"
 #include "objects/message/error_reply.h"
 #include "objects/message/event.h"
 #include "objects/message/transaction.h"
 #include "objects/message/value_reply.h"
 #include "objects/named.h"
+#include "objects/object.h"
 #include "objects/set.h"
 #include "util/cleaner.h"
 #include "util/error.h"
@@ -60,21 +64,76 @@ struct {
  */
 
 /**
- * Run a transaction
+ * Process a message
  *
- * This function will run a transaction and generate a reply by returning either
- * an error reply message or a value reply message transporting the topmost
- * element from the processor stack, if the transaction left anything, tat is.
- * If the transaction didn't leave a value, a nil value will be embedded in the
- * reply.
+ * Registrations are always handled right away. Transactions to run are run
+ * right away if `sync` is set or if the scheduler is idle and the transaction
+ * completes within one slice. Otherwise, a job is queued and the callback is
+ * invoked with the reply once the job is finished.
  *
- * @return reply generated by running the transaction
+ * Events never have a reply. If an event is deferred, the callback is not
+ * invoked and 0 is returned.
+ *
+ * @return 0 if the message was processed, 1 if the processing was deferred
+ */
+static int
+process_message(
+    struct ws_message* message, //!< message to process
+    struct ws_object* opt_ctx, //!< optional additional context object
+    enum ws_action_priority priority, //!< priority to use for deferred jobs
+    ws_action_reply_callback callback, //!< callback for deferred replies
+    bool sync, //!< whether to run the transaction to completion right away
+    struct ws_reply** reply //!< reply, if the message was processed
+);
+
+/**
+ * Find the transaction to run for an event
+ *
+ * @return the transaction (with a reference held) or NULL, if there is none
+ */
+static struct ws_transaction*
+event_transaction(
+    struct ws_event* event //!< event to get the transaction for
+);
+
+/**
+ * Key comparison callback for looking up registrations by event name
+ *
+ * @return 0 if the registration is for the event named `key`
+ */
+static int
+cmp_registration_name(
+    struct ws_object const* elem, //!< registration (a `struct ws_named`)
+    void const* key //!< event name (a `struct ws_string`)
+);
+
+/**
+ * Key comparison callback for looking up transactions by name
+ *
+ * @return 0 if the transaction is named `key`
+ */
+static int
+cmp_transaction_name(
+    struct ws_object const* elem, //!< transaction
+    void const* key //!< transaction name (a `struct ws_string`)
+);
+
+/**
+ * Finish a job, either run right away or by the scheduler
+ *
+ * @return the reply of the job, if it is to be delivered
  */
 static struct ws_reply*
-run_transaction(
-    struct ws_transaction* transaction, //!< Transaction to run
-    struct ws_value* context, //!< context to push on the stack
-    struct ws_value* connection_context //!< connection ctx to push on stack
+job_finish(
+    struct ws_action_job* job //!< finished job
+);
+
+/**
+ * Done callback for jobs run by the scheduler
+ */
+static void
+job_done(
+    struct ws_action_job* job //!< finished job
 );
 
 /**
@@ -123,6 +182,8 @@ ws_action_manager_init(
         goto cleanup_registrations;
     }
 
+    ws_action_scheduler_init();
+
     ws_cleaner_add(action_manager_deinit, NULL);
 
     is_init = true;
@@ -141,105 +202,23 @@ ws_action_manager_process(
     struct ws_message* message,
     struct ws_object* opt_ctx
 ) {
-    struct ws_value* vctx = NULL;
-    struct ws_value_object_id ctx;
-    memset(&ctx, 0, sizeof(ctx));
-
-    if (opt_ctx) {
-        ws_value_object_id_init(&ctx);
-        ws_value_object_id_set(&ctx, opt_ctx);
-        vctx = &ctx.val;
-    }
-
-    // check whether the message is a transaction
-    if (message->obj.id == &WS_OBJECT_TYPE_ID_TRANSACTION) {
-        struct ws_transaction* transaction;
-        transaction = (struct ws_transaction*) message;
-
-        // get the flags
-        enum ws_transaction_flags flags = ws_transaction_flags(transaction);
-
-        if (flags & WS_TRANSACTION_FLAGS_REGISTER) {
-            // register the transaction for later invokation
-            int res = ws_set_insert(&actman_ctx.transactions,
-                                    &transaction->m.obj);
-            if (res < 0) {
-                struct ws_error_reply* rep;
-                rep = ws_error_reply_new(transaction, -res,
-                                         "Could not register transaction",
-                                         NULL);
-                return &rep->reply;
-            }
-        }
-
-        if (flags & WS_TRANSACTION_FLAGS_EXEC) {
-            // execute the transaction
-            return run_transaction(transaction, NULL, vctx);
-        }
-
-        return NULL;
-    }
-
-    // check whether the message is an event
-    if (message->obj.id == &WS_OBJECT_TYPE_ID_EVENT) {
-        struct ws_event* event = (struct ws_event*) message;
-        struct ws_transaction* transaction = NULL;
-
-        // extract the name of the event
-        struct ws_string* name = ws_event_get_name(event);
-        if (!name) {
-            return NULL;
-        }
-
-        { // contain transaction retrieval in a scope to save stack
-            // get the named object containing the event
-            struct ws_named comparable;
-            memset(&comparable, 0, sizeof(comparable));
-            ws_named_init(&comparable, name, NULL);
-
-            struct ws_named* named;
-            named = set_get(&actman_ctx.registrations, &comparable);
-
-            ws_object_deinit(&comparable.str.obj);
-
-            // extract the transaction to run
-            if (named) {
-                transaction = (struct ws_transaction*) ws_named_get_obj(named);
-            }
-        }
-
-        if (!transaction) {
-            // get the transaction directly
-            struct ws_transaction comparable;
-            memset(&comparable, 0, sizeof(comparable));
-            if (ws_transaction_init(&comparable, 0, name) < 0) {
-                goto cleanup_name;
-            }
-
-            transaction = set_get(&actman_ctx.transactions, &comparable);
-            ws_object_deinit(&comparable.m.obj);
-        }
-
-        // check whether we _have_ a transaction
-        if (!transaction) {
-            goto cleanup_name;
-        }
-
-        // now, finally, run the transaction
-        struct ws_reply* reply;
-        reply = run_transaction(transaction,
-                                &ws_event_get_context(event)->value,
-                                vctx);
-        if (reply) {
-            ws_object_unref(&reply->m.obj);
-        }
-
-cleanup_name:
-        ws_object_unref(&name->obj);
-        return NULL;
-    }
+    struct ws_reply* reply = NULL;
+    (void) process_message(message, opt_ctx, WS_ACTION_PRIORITY_IPC, NULL,
+                           true, &reply);
+    return reply;
+}
 
-    return NULL;
+int
+ws_action_manager_submit(
+    struct ws_message* message,
+    struct ws_object* opt_ctx,
+    enum ws_action_priority priority,
+    ws_action_reply_callback callback,
+    struct ws_reply** reply
+) {
+    *reply = NULL;
+    return process_message(message, opt_ctx, priority, callback, false,
+                           reply);
 }
 
 int
@@ -250,17 +229,11 @@ ws_action_manager_register(
     int res;
 
     // get the transaction
-    struct ws_transaction comparable;
-    memset(&comparable, 0, sizeof(comparable));
-
-    res = ws_transaction_init(&comparable, 0, transaction_name);
-    if (res < 0) {
-        return res;
-    }
-
     struct ws_transaction* transaction;
-    transaction = set_get(&actman_ctx.transactions, &comparable);
-    ws_object_deinit(&comparable.m.obj);
+    transaction = (struct ws_transaction*)
+                  ws_set_get_by_key(&actman_ctx.transactions,
+                                    ws_string_hash(transaction_name),
+                                    transaction_name, cmp_transaction_name);
     if (!transaction) {
         return -ENOENT;
     }
@@ -268,6 +241,7 @@ ws_action_manager_register(
     // construct a named object
     struct ws_named* named = ws_named_new(event_name,
                                           &transaction->m.obj);
+    ws_object_unref(&transaction->m.obj);
     if (!named) {
         return -ENOMEM;
     }
@@ -286,45 +260,18 @@ int
 ws_action_manager_unregister_event(
     struct ws_string* event_name
 ) {
-    int res;
-
-    // construct a comparable for removal
-    struct ws_named comparable;
-    memset(&comparable, 0, sizeof(comparable));
-
-    res = ws_named_init(&comparable, event_name, NULL);
-    if (res < 0) {
-        return res;
-    }
-
-    // perform the removal
-    res = ws_set_remove(&actman_ctx.registrations, &comparable.str.obj);
-
-    // get rid of the comparable before returning
-    ws_object_deinit(&comparable.str.obj);
-    return res;
+    return ws_set_remove_by_key(&actman_ctx.registrations,
+                                ws_string_hash(event_name), event_name,
+                                cmp_registration_name);
 }
 
 int
 ws_action_manager_unregister_transaction(
     struct ws_string* transaction_name
 ) {
-    int res;
-
-    // construct a comparable for removal
-    struct ws_transaction comparable;
-    memset(&comparable, 0, sizeof(comparable));
-    res = ws_transaction_init(&comparable, 0, transaction_name);
-    if (res < 0) {
-        return res;
-    }
-
-    // perform the removal
-    res = ws_set_remove(&actman_ctx.transactions, &comparable.m.obj);
-
-    // get rid of the comparable before returning
-    ws_object_deinit(&comparable.m.obj);
-    return res;
+    return ws_set_remove_by_key(&actman_ctx.transactions,
+                                ws_string_hash(transaction_name),
+                                transaction_name, cmp_transaction_name);
 }
 
 
@@ -334,112 +281,229 @@ ws_action_manager_unregister_transaction(
  *
  */
 
-static struct ws_reply*
-run_transaction(
-    struct ws_transaction* transaction,
-    struct ws_value* context,
-    struct ws_value* connection_ctx
+static int
+process_message(
+    struct ws_message* message,
+    struct ws_object* opt_ctx,
+    enum ws_action_priority priority,
+    ws_action_reply_callback callback,
+    bool sync,
+    struct ws_reply** reply
 ) {
-    struct ws_reply* retval = NULL;
-    int res;
+    struct ws_transaction* transaction = NULL;
+    struct ws_value* event_ctx = NULL;
+    bool is_event = false;
 
-    // prepare the stack
-    struct ws_processor_stack stack;
-    memset(&stack, 0, sizeof(stack));
+    // check whether the message is a transaction
+    if (message->obj.id == &WS_OBJECT_TYPE_ID_TRANSACTION) {
+        transaction = (struct ws_transaction*) message;
 
-    res = ws_processor_stack_init(&stack);
-    if (res < 0) {
-        retval = (struct ws_reply*)
-                 ws_error_reply_new(transaction, -res, "Could not init stack",
-                                    NULL);
-        goto cleanup_stack;
-    }
+        // get the flags
+        enum ws_transaction_flags flags = ws_transaction_flags(transaction);
 
-    // push environment on the stack
-    res = ws_processor_stack_push(&stack, 2);
-    if (res < 0) {
-        retval = (struct ws_reply*)
-                 ws_error_reply_new(transaction, -res, "Could not init stack",
-                                    NULL);
-        goto cleanup_stack;
+        if (flags & WS_TRANSACTION_FLAGS_REGISTER) {
+            // registered transactions are run repeatedly, so we pre-link them.
+            // If that fails, they are simply interpreted.
+            (void) ws_transaction_compile(transaction);
+
+            // register the transaction for later invokation
+            int res = ws_set_insert(&actman_ctx.transactions,
+                                    &transaction->m.obj);
+            if (res < 0) {
+                struct ws_error_reply* rep;
+                rep = ws_error_reply_new(transaction, -res,
+                                         "Could not register transaction",
+                                         NULL);
+                *reply = &rep->reply;
+                return 0;
+            }
+        }
+
+        if (!(flags & WS_TRANSACTION_FLAGS_EXEC)) {
+            return 0;
+        }
+
+        // pure transactions may be answered from the cache, unless there are
+        // jobs queued which may alter the objects read
+        if ((sync || ws_action_scheduler_is_idle()) &&
+                ws_action_memo_cacheable(transaction)) {
+            *reply = ws_action_memo_lookup(transaction, opt_ctx);
+            if (*reply) {
+                return 0;
+            }
+        }
+
+        transaction = (struct ws_transaction*)
+                      ws_object_getref(&transaction->m.obj);
+    } else if (message->obj.id == &WS_OBJECT_TYPE_ID_EVENT) {
+        // nobody waits for the result of an event, except for hotkeys
+        is_event = true;
+        if (priority == WS_ACTION_PRIORITY_IPC) {
+            priority = WS_ACTION_PRIORITY_BACKGROUND;
+        }
+
+        transaction = event_transaction((struct ws_event*) message);
+        if (!transaction) {
+            return 0;
+        }
+        event_ctx = &ws_event_get_context((struct ws_event*) message)->value;
+    } else {
+        return 0;
     }
 
-    {
-        union ws_value_union* bottom = ws_processor_stack_bottom(&stack);
+    struct ws_value* vctx = NULL;
+    struct ws_value_object_id ctx;
+    memset(&ctx, 0, sizeof(ctx));
 
-        // initialize the global context
-        ws_value_union_reinit(bottom, WS_VALUE_TYPE_OBJECT_ID);
-        ws_value_object_id_set(&bottom->object_id, actman_ctx.obj);
+    if (opt_ctx) {
+        ws_value_object_id_init(&ctx);
+        ws_value_object_id_set(&ctx, opt_ctx);
+        vctx = &ctx.val;
+    }
 
-        // initialize the event context
-        ++bottom;
-        if (context) {
-            ws_value_union_init_from_val(bottom, context);
-        } else {
-            ws_value_union_reinit(bottom, WS_VALUE_TYPE_NIL);
+    // prepare the job, on the heap if we might have to defer it
+    struct ws_action_job local;
+    struct ws_action_job* job = &local;
+    if (!sync) {
+        job = malloc(sizeof(*job));
+        if (!job) {
+            // we can still run it right away
+            job = &local;
+            sync = true;
         }
+    }
 
-        // initialize the connection context
-        ++bottom;
-        if (connection_ctx) {
-            ws_value_union_init_from_val(bottom, connection_ctx);
-        } else {
-            ws_value_union_reinit(bottom, WS_VALUE_TYPE_NIL);
+    ws_action_job_init(job, transaction, actman_ctx.obj, event_ctx, vctx);
+    job->log_reads      = !is_event && ws_action_memo_cacheable(transaction);
+    job->discard_reply  = is_event;
+    job->callback       = is_event ? NULL : callback;
+    job->etc            = ws_object_getref(opt_ctx);
+    job->done           = job_done;
+
+    // the job holds its own references
+    ws_object_unref(&transaction->m.obj);
+    if (vctx) {
+        ws_value_deinit(vctx);
+    }
+
+    // keep the order of jobs: if there are jobs queued, we queue this one, too
+    if (sync || ws_action_scheduler_is_idle()) {
+        size_t budget = sync ? SIZE_MAX : WS_ACTION_SCHEDULER_BUDGET;
+        if (ws_action_job_step(job, budget)) {
+            *reply = job_finish(job);
+            ws_action_job_deinit(job);
+            if (job != &local) {
+                free(job);
+            }
+            return 0;
         }
     }
 
-    // we start a new frame, but we will never restore the default frame
-    (void) ws_processor_stack_start_frame(&stack);
-
-    // get the commands from the transaction
-    struct ws_transaction_command_list* commands;
-    commands = ws_transaction_commands(transaction);
-    if (!commands) {
-        retval = (struct ws_reply*)
-                 ws_error_reply_new(transaction, EINVAL,
-                                    "Command list malformed", NULL);
-        goto cleanup_stack;
+    ws_action_scheduler_enqueue(job, priority);
+
+    // events don't have a reply, so there's nothing for the caller to wait for
+    return is_event ? 0 : 1;
+}
+
+static struct ws_transaction*
+event_transaction(
+    struct ws_event* event
+) {
+    struct ws_transaction* transaction = NULL;
+
+    // extract the name of the event
+    struct ws_string* name = ws_event_get_name(event);
+    if (!name) {
+        return NULL;
     }
 
-    // prepare the processor
-    struct ws_processor proc;
-    memset(&proc, 0, sizeof(proc));
+    size_t hash = ws_string_hash(name);
 
-    res = ws_processor_init(&proc, &stack, commands);
-    if (res < 0) {
-        retval = (struct ws_reply*)
-                 ws_error_reply_new(transaction, -res,
-                                    "Could not init processor", NULL);
-        goto cleanup_stack;
+    // get the named object containing the event
+    struct ws_named* named;
+    named = (struct ws_named*)
+            ws_set_get_by_key(&actman_ctx.registrations, hash, name,
+                              cmp_registration_name);
+
+    // extract the transaction to run
+    if (named) {
+        transaction = (struct ws_transaction*) ws_named_get_obj(named);
+        ws_object_unref(&named->str.obj);
     }
 
-    // run processor
-    res = ws_processor_exec(&proc);
-    if (res < 0) {
-        const char* errmsg = ws_errno_tostr(res);
-        retval = (struct ws_reply*)
-                 ws_error_reply_new(transaction, -res, errmsg, NULL);
-        goto cleanup_processor;
+    if (!transaction) {
+        // get the transaction directly
+        transaction = (struct ws_transaction*)
+                      ws_set_get_by_key(&actman_ctx.transactions, hash, name,
+                                        cmp_transaction_name);
     }
 
-    // create the return message from the transaction and the value
-    struct ws_value* value = ws_processor_stack_value_at(&stack, -1, NULL);
-    retval = (struct ws_reply*) ws_value_reply_new(transaction, value);
+    ws_object_unref(&name->obj);
+    return transaction;
+}
+
+static int
+cmp_registration_name(
+    struct ws_object const* elem,
+    void const* key
+) {
+    return !ws_string_equal((struct ws_string*) elem, (struct ws_string*) key);
+}
+
+static int
+cmp_transaction_name(
+    struct ws_object const* elem,
+    void const* key
+) {
+    struct ws_transaction* t = (struct ws_transaction*) elem;
+
+    ws_object_lock_read(&t->m.obj);
+    bool equal = ws_string_equal(t->name, (struct ws_string*) key);
+    ws_object_unlock(&t->m.obj);
 
-    // cleanup
+    return !equal;
+}
 
-cleanup_processor:
-    ws_processor_deinit(&proc);
+static struct ws_reply*
+job_finish(
+    struct ws_action_job* job
+) {
+    struct ws_reply* reply = ws_action_job_take_reply(job);
+
+    if (job->log_reads) {
+        ws_action_memo_store(job->transaction, job->etc, reply, &job->reads);
+    }
+
+    if (job->discard_reply && reply) {
+        ws_object_unref(&reply->m.obj);
+        reply = NULL;
+    }
+
+    return reply;
+}
+
+static void
+job_done(
+    struct ws_action_job* job
+) {
+    struct ws_reply* reply = job_finish(job);
+
+    if (job->callback) {
+        job->callback(reply, job->etc);
+    } else if (reply) {
+        ws_object_unref(&reply->m.obj);
+    }
 
-cleanup_stack:
-    ws_processor_stack_deinit(&stack);
-    return retval;
+    ws_action_job_deinit(job);
+    free(job);
 }
 
 static void
 action_manager_deinit(
     void* dummy
 ) {
+    ws_action_scheduler_deinit();
+    ws_action_memo_flush();
     ws_object_deinit(&actman_ctx.transactions.obj);
     ws_object_deinit(&actman_ctx.registrations.obj);
     ws_object_unref(actman_ctx.obj);
@@ -36,6 +36,8 @@
 #ifndef __WS_ACTION_MANAGER_H__
 #define __WS_ACTION_MANAGER_H__
 
+#include "action/job.h"
+#include "action/scheduler.h"
 #include "util/attributes.h"
 
 // forward declarations
@@ -73,6 +75,37 @@ ws_action_manager_process(
 __ws_nonnull__(1)
 ;
 
+/**
+ * Submit a message for processing
+ *
+ * If the scheduler is idle and the transaction completes within a single
+ * slice, the message is processed right away, just like with
+ * `ws_action_manager_process()`.
+ * Otherwise, the transaction is run by the scheduler with the priority given.
+ * Once it is finished, `callback` is invoked with the reply and `opt_ctx`.
+ *
+ * Events submitted with `WS_ACTION_PRIORITY_IPC` are run in the background,
+ * since nobody waits for their result. Events never have a reply: if one is
+ * deferred, `callback` is not invoked and 0 is returned with `reply` NULL.
+ *
+ * @note Should be called with reference on the message already aquired.
+ *
+ * @warning must only be called from the main thread
+ *
+ * @return 0 if the message was processed right away, in which case `reply`
+ *         holds the reply (or NULL), 1 if the processing was deferred
+ */
+int
+ws_action_manager_submit(
+    struct ws_message* message, //!< message to process
+    struct ws_object* opt_ctx, //!< optional additional context object
+    enum ws_action_priority priority, //!< priority of the transaction
+    ws_action_reply_callback callback, //!< callback for a deferred reply
+    struct ws_reply** reply //!< reply, if processed right away
+)
+__ws_nonnull__(1, 5)
+;
+
 /**
  * Register a transaction to be run on an event
  *
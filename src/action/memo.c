@@ -0,0 +1,427 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdint.h>
+#include <string.h>
+
+#include "action/memo.h"
+#include "command/command.h"
+#include "command/statement.h"
+#include "objects/message/reply.h"
+#include "objects/message/transaction.h"
+#include "objects/message/value_reply.h"
+#include "objects/object.h"
+#include "objects/string.h"
+#include "values/bool.h"
+#include "values/int.h"
+#include "values/object_id.h"
+#include "values/string.h"
+#include "values/value.h"
+
+/**
+ * Number of cache entries, must be a power of two
+ */
+#define MEMO_SIZE (32)
+
+/**
+ * Cached result of a transaction
+ */
+struct memo_entry {
+    struct ws_transaction* transaction; //!< transaction run, the key
+    struct ws_object* ctx; //!< context the transaction was run in, no ref held
+    size_t hash; //!< hash of the transaction
+    struct ws_value_reply* reply; //!< reply generated
+    struct ws_object_read_log reads; //!< objects the result depends on
+};
+
+/**
+ * The cache, entries are addressed by the hash of their transaction
+ */
+static struct memo_entry memo[MEMO_SIZE];
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Compute the hash of a transaction
+ *
+ * @return the hash
+ */
+static size_t
+transaction_hash(
+    struct ws_transaction_command_list const* cmds, //!< commands to hash
+    struct ws_object* ctx //!< context the transaction is run in
+);
+
+/**
+ * Check whether two command lists are identical
+ *
+ * @return true if the command lists are identical, false otherwise
+ */
+static bool
+commands_equal(
+    struct ws_transaction_command_list const* a, //!< first list
+    struct ws_transaction_command_list const* b //!< second list
+);
+
+/**
+ * Compute the hash of a (simple) value
+ *
+ * @return the hash
+ */
+static size_t
+value_hash(
+    struct ws_value* val //!< value to hash
+);
+
+/**
+ * Check whether two (simple) values are equal
+ *
+ * @return true if the values are equal, false otherwise
+ */
+static bool
+value_equal(
+    struct ws_value* a, //!< first value
+    struct ws_value* b //!< second value
+);
+
+/**
+ * Mix a word into a hash
+ *
+ * @return the new hash
+ */
+static size_t
+hash_mix(
+    size_t hash, //!< hash to mix the word into
+    size_t word //!< word to mix in
+);
+
+/**
+ * Release an entry
+ */
+static void
+entry_release(
+    struct memo_entry* entry //!< entry to release
+);
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+bool
+ws_action_memo_cacheable(
+    struct ws_transaction* transaction
+) {
+    // batches are expected to alter things, we don't bother caching them
+    if (ws_transaction_parts_num(transaction)) {
+        return false;
+    }
+
+    struct ws_transaction_command_list* cmds;
+    cmds = ws_transaction_commands(transaction);
+    if (!cmds || !cmds->num) {
+        return false;
+    }
+
+    struct ws_statement const* stmt = cmds->statements;
+    struct ws_statement const* end = stmt + cmds->num;
+    for (; stmt < end; ++stmt) {
+        if (!stmt->command->pure) {
+            return false;
+        }
+
+        size_t i;
+        for (i = 0; i < stmt->args.num; ++i) {
+            struct ws_argument const* arg = stmt->args.vals + i;
+            if (arg->type != direct) {
+                continue;
+            }
+
+            switch (ws_value_get_type(arg->arg.val)) {
+            case WS_VALUE_TYPE_NIL:
+            case WS_VALUE_TYPE_BOOL:
+            case WS_VALUE_TYPE_INT:
+            case WS_VALUE_TYPE_STRING:
+            case WS_VALUE_TYPE_OBJECT_ID:
+                break;
+
+            default:
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+struct ws_reply*
+ws_action_memo_lookup(
+    struct ws_transaction* transaction,
+    struct ws_object* ctx
+) {
+    struct ws_transaction_command_list* cmds;
+    cmds = ws_transaction_commands(transaction);
+    if (!cmds) {
+        return NULL;
+    }
+
+    size_t hash = transaction_hash(cmds, ctx);
+    struct memo_entry* entry = memo + (hash & (MEMO_SIZE - 1));
+    if (!entry->reply || (entry->hash != hash) || (entry->ctx != ctx)) {
+        return NULL;
+    }
+
+    if (!commands_equal(ws_transaction_commands(entry->transaction), cmds)) {
+        return NULL;
+    }
+
+    // the result is stale if any of the objects read changed
+    if (!ws_object_read_log_valid(&entry->reads)) {
+        entry_release(entry);
+        return NULL;
+    }
+
+    struct ws_value* value = ws_value_reply_get_value(entry->reply);
+    return (struct ws_reply*) ws_value_reply_new(transaction, value);
+}
+
+void
+ws_action_memo_store(
+    struct ws_transaction* transaction,
+    struct ws_object* ctx,
+    struct ws_reply* reply,
+    struct ws_object_read_log* reads
+) {
+    struct ws_transaction_command_list* cmds;
+    cmds = ws_transaction_commands(transaction);
+
+    // we only cache successful runs of which we know all the dependencies
+    if (!cmds || !reply || reads->incomplete ||
+            (reply->m.obj.id != &WS_OBJECT_TYPE_ID_VALUE_REPLY)) {
+        ws_object_read_log_deinit(reads);
+        return;
+    }
+
+    size_t hash = transaction_hash(cmds, ctx);
+    struct memo_entry* entry = memo + (hash & (MEMO_SIZE - 1));
+    entry_release(entry);
+
+    entry->transaction  = (struct ws_transaction*)
+                          ws_object_getref(&transaction->m.obj);
+    entry->ctx          = ctx;
+    entry->hash         = hash;
+    entry->reply        = (struct ws_value_reply*)
+                          ws_object_getref(&reply->m.obj);
+
+    // take over the objects logged
+    memcpy(&entry->reads, reads, sizeof(entry->reads));
+    reads->num = 0;
+}
+
+void
+ws_action_memo_forget(
+    struct ws_object* ctx
+) {
+    size_t i;
+    for (i = 0; i < MEMO_SIZE; ++i) {
+        if (memo[i].ctx == ctx) {
+            entry_release(memo + i);
+        }
+    }
+}
+
+void
+ws_action_memo_flush(void)
+{
+    size_t i;
+    for (i = 0; i < MEMO_SIZE; ++i) {
+        entry_release(memo + i);
+    }
+}
+
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static size_t
+transaction_hash(
+    struct ws_transaction_command_list const* cmds,
+    struct ws_object* ctx
+) {
+    size_t hash = hash_mix(0, (uintptr_t) ctx);
+
+    struct ws_statement const* stmt = cmds->statements;
+    struct ws_statement const* end = stmt + cmds->num;
+    for (; stmt < end; ++stmt) {
+        hash = hash_mix(hash, (uintptr_t) stmt->command);
+        hash = hash_mix(hash, stmt->args.num);
+
+        size_t i;
+        for (i = 0; i < stmt->args.num; ++i) {
+            struct ws_argument const* arg = stmt->args.vals + i;
+            if (arg->type == direct) {
+                hash = hash_mix(hash, value_hash(arg->arg.val));
+            } else {
+                hash = hash_mix(hash, (size_t) arg->arg.pos);
+            }
+        }
+    }
+
+    return hash;
+}
+
+static bool
+commands_equal(
+    struct ws_transaction_command_list const* a,
+    struct ws_transaction_command_list const* b
+) {
+    if (a->num != b->num) {
+        return false;
+    }
+
+    size_t s;
+    for (s = 0; s < a->num; ++s) {
+        struct ws_statement const* sa = a->statements + s;
+        struct ws_statement const* sb = b->statements + s;
+        if ((sa->command != sb->command) || (sa->args.num != sb->args.num)) {
+            return false;
+        }
+
+        size_t i;
+        for (i = 0; i < sa->args.num; ++i) {
+            struct ws_argument const* aa = sa->args.vals + i;
+            struct ws_argument const* ab = sb->args.vals + i;
+            if (aa->type != ab->type) {
+                return false;
+            }
+
+            if (aa->type == direct) {
+                if (!value_equal(aa->arg.val, ab->arg.val)) {
+                    return false;
+                }
+            } else if (aa->arg.pos != ab->arg.pos) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static size_t
+value_hash(
+    struct ws_value* val
+) {
+    enum ws_value_type type = ws_value_get_type(val);
+    size_t hash = hash_mix(0, type);
+
+    switch (type) {
+    case WS_VALUE_TYPE_BOOL:
+        return hash_mix(hash, ws_value_bool_get((struct ws_value_bool*) val));
+
+    case WS_VALUE_TYPE_INT:
+        return hash_mix(hash, ws_value_int_get((struct ws_value_int*) val));
+
+    case WS_VALUE_TYPE_STRING:
+        // strings are compared anyway, the length is good enough
+        return hash_mix(hash,
+                        ws_string_len(((struct ws_value_string*) val)->str));
+
+    case WS_VALUE_TYPE_OBJECT_ID:
+        return hash_mix(hash,
+                        (uintptr_t) ((struct ws_value_object_id*) val)->obj);
+
+    default:
+        return hash;
+    }
+}
+
+static bool
+value_equal(
+    struct ws_value* a,
+    struct ws_value* b
+) {
+    enum ws_value_type type = ws_value_get_type(a);
+    if (type != ws_value_get_type(b)) {
+        return false;
+    }
+
+    switch (type) {
+    case WS_VALUE_TYPE_NIL:
+        return true;
+
+    case WS_VALUE_TYPE_BOOL:
+        return ws_value_bool_get((struct ws_value_bool*) a) ==
+               ws_value_bool_get((struct ws_value_bool*) b);
+
+    case WS_VALUE_TYPE_INT:
+        return ws_value_int_get((struct ws_value_int*) a) ==
+               ws_value_int_get((struct ws_value_int*) b);
+
+    case WS_VALUE_TYPE_STRING:
+        return ws_string_equal(((struct ws_value_string*) a)->str,
+                               ((struct ws_value_string*) b)->str);
+
+    case WS_VALUE_TYPE_OBJECT_ID:
+        return ((struct ws_value_object_id*) a)->obj ==
+               ((struct ws_value_object_id*) b)->obj;
+
+    default:
+        return false;
+    }
+}
+
+static size_t
+hash_mix(
+    size_t hash,
+    size_t word
+) {
+    // FNV-1a style, but on whole words
+    return (hash ^ word) * 1099511628211ULL;
+}
+
+static void
+entry_release(
+    struct memo_entry* entry
+) {
+    if (!entry->reply) {
+        return;
+    }
+
+    ws_object_read_log_deinit(&entry->reads);
+    ws_object_unref(&entry->reply->reply.m.obj);
+    ws_object_unref(&entry->transaction->m.obj);
+    memset(entry, 0, sizeof(*entry));
+}
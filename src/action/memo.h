@@ -0,0 +1,141 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup action "Action manager"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup action_memo "Action manager result cache"
+ *
+ * Cache for the results of transactions consisting of pure commands only
+ *
+ * The result of such a transaction only depends on its statements, the context
+ * it is run in and the attributes of the objects read while running it. The
+ * cache keeps the reply of a run along with a log of the objects read (see
+ * ws_object_read_log). As long as none of these objects' attributes change, an
+ * identical transaction is answered from the cache without running the
+ * processor.
+ *
+ * @warning The cache is not thread safe, just like the action manager.
+ *
+ * @{
+ */
+
+#ifndef __WS_ACTION_MEMO_H__
+#define __WS_ACTION_MEMO_H__
+
+#include <stdbool.h>
+
+#include "util/attributes.h"
+
+// forward declarations
+struct ws_object;
+struct ws_object_read_log;
+struct ws_reply;
+struct ws_transaction;
+
+/**
+ * Check whether the result of a transaction may be cached
+ *
+ * A transaction may be cached if all of its commands are pure and all of its
+ * direct arguments are of a simple type (nil, bool, int, string or object id).
+ * Batches are never cached.
+ *
+ * @return true if the transaction may be cached, false otherwise
+ */
+bool
+ws_action_memo_cacheable(
+    struct ws_transaction* transaction //!< transaction to check
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Look up the result of a transaction
+ *
+ * @return a new reply to the transaction or NULL, if there is no valid result
+ *         cached
+ */
+struct ws_reply*
+ws_action_memo_lookup(
+    struct ws_transaction* transaction, //!< transaction to look up
+    struct ws_object* ctx //!< context the transaction is run in (or NULL)
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Store the result of a transaction
+ *
+ * Only value replies are stored. The objects referenced by the read log are
+ * taken over by the cache, the log is deinitialized in any case.
+ *
+ * @note the cache does not hold a reference on `ctx`, see
+ *       `ws_action_memo_forget()`
+ */
+void
+ws_action_memo_store(
+    struct ws_transaction* transaction, //!< transaction run
+    struct ws_object* ctx, //!< context the transaction was run in (or NULL)
+    struct ws_reply* reply, //!< reply generated by running the transaction
+    struct ws_object_read_log* reads //!< log of objects read during the run
+)
+__ws_nonnull__(1, 4)
+;
+
+/**
+ * Drop all the cached results for a context
+ *
+ * Contexts are only used as keys, the cache doesn't keep them alive. Hence
+ * this has to be called once a context goes away, e.g. a connection closes.
+ */
+void
+ws_action_memo_forget(
+    struct ws_object* ctx //!< context to drop the results of
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Drop all the cached results
+ */
+void
+ws_action_memo_flush(void);
+
+#endif // __WS_ACTION_MEMO_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
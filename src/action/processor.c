@@ -26,9 +26,11 @@
  */
 
 #include <errno.h>
+#include <stdint.h>
 
 #include "action/processor.h"
 #include "action/processor_stack.h"
+#include "command/bytecode.h"
 #include "command/command.h"
 #include "command/statement.h"
 #include "logger/module.h"
@@ -80,6 +82,63 @@ exec_regular(
 __ws_nonnull__(1, 2, 3)
 ;
 
+/**
+ * Run a command processor on the bytecode of its command list
+ *
+ * @return see `ws_processor_exec()`
+ */
+static ssize_t
+exec_bytecode(
+    struct ws_processor* self, //!< command processor context
+    struct ws_bytecode const* code, //!< bytecode to run
+    size_t budget //!< maximum number of instructions to run
+)
+__ws_nonnull__(1, 2)
+;
+
+/**
+ * Execute a regular command with its arguments given by operands
+ */
+static int
+op_regular(
+    struct ws_processor* self, //!< command processor context
+    struct ws_bytecode_insn const* insn //!< instruction to execute
+);
+
+/**
+ * Execute a regular command with its arguments already on the stack
+ */
+static int
+op_regular_stack(
+    struct ws_processor* self, //!< command processor context
+    struct ws_bytecode_insn const* insn //!< instruction to execute
+);
+
+/**
+ * Execute a special command
+ */
+static int
+op_special(
+    struct ws_processor* self, //!< command processor context
+    struct ws_bytecode_insn const* insn //!< instruction to execute
+);
+
+/*
+ *
+ * Variables
+ *
+ */
+
+/**
+ * Dispatch table for bytecode instructions
+ */
+static int (* const ops[WS_BYTECODE_OP_NUM])(struct ws_processor*,
+                                             struct ws_bytecode_insn const*) = {
+    [WS_BYTECODE_OP_REGULAR]        = op_regular,
+    [WS_BYTECODE_OP_REGULAR_STACK]  = op_regular_stack,
+    [WS_BYTECODE_OP_SPECIAL]        = op_special,
+};
+
 /*
  *
  * Interface implementation
@@ -113,13 +172,32 @@ ws_processor_deinit(
 ssize_t
 ws_processor_exec(
     struct ws_processor* self
+) {
+    return ws_processor_exec_budget(self, SIZE_MAX);
+}
+
+ssize_t
+ws_processor_exec_budget(
+    struct ws_processor* self,
+    size_t budget
 ) {
     ws_log(&log_ctx, LOG_DEBUG, "Starting processor %p", self);
+
+    // run the pre-linked version of the commands, if there is one
+    if (self->commands->code) {
+        return exec_bytecode(self, self->commands->code, budget);
+    }
+
     // keep a sentinel around for faster comparisons
     struct ws_statement const* aend;
     aend = self->commands->statements + self->commands->num;
 
     while (self->pc < aend) {
+        if (!budget--) {
+            // we'll be resumed at the current pc
+            return -EINPROGRESS;
+        }
+
         // get the current pc and increment it afterwards
         struct ws_statement const* cur = self->pc++;
 
@@ -260,3 +338,130 @@ exec_regular(
     return ws_processor_stack_pop(stack, args->num - 1);
 }
 
+static ssize_t
+exec_bytecode(
+    struct ws_processor* self,
+    struct ws_bytecode const* code,
+    size_t budget
+) {
+    struct ws_statement* base = self->commands->statements;
+    size_t pos = self->pc - base;
+
+    while (pos < code->num) {
+        if (!budget--) {
+            // `pc` still points to the next instruction, we'll resume there
+            return -EINPROGRESS;
+        }
+
+        struct ws_bytecode_insn const* insn = code->insns + pos;
+
+        // special commands expect the pc to point to the next statement
+        self->pc = base + pos + 1;
+
+        int res = ops[insn->op](self, insn);
+        if (res != 0) {
+            return res;
+        }
+
+        pos = self->pc - base;
+    }
+
+    if (pos <= code->num) {
+        return 0;
+    }
+    return pos;
+}
+
+static int
+op_regular(
+    struct ws_processor* self,
+    struct ws_bytecode_insn const* insn
+) {
+    struct ws_processor_stack* stack = self->stack;
+    size_t argc = insn->argc;
+    if (!argc) {
+        return -EINVAL;
+    }
+
+    size_t base = stack->top;
+    int res = ws_processor_stack_push(stack, argc);
+    if (res < 0) {
+        return res;
+    }
+    union ws_value_union* frame = stack->data + base;
+
+    // the operands are decoded already, we only have to copy the values
+    struct ws_bytecode_operand const* operand = insn->operands;
+    for (size_t i = 0; i < argc; ++i, ++operand) {
+        union ws_value_union const* src;
+        switch (operand->kind) {
+        case WS_BYTECODE_OPERAND_CONST:
+            if (operand->trivial) {
+                // the slot holds a nil, there's nothing to deinitialize
+                frame[i] = *operand->arg.val;
+                continue;
+            }
+            src = operand->arg.val;
+            break;
+
+        case WS_BYTECODE_OPERAND_ABSOLUTE:
+            if ((size_t) operand->arg.pos >= base) {
+                return -EINVAL;
+            }
+            src = stack->data + operand->arg.pos;
+            break;
+
+        case WS_BYTECODE_OPERAND_RELATIVE:
+            if ((size_t) -operand->arg.pos > base) {
+                return -EINVAL;
+            }
+            src = stack->data + base + operand->arg.pos;
+            break;
+
+        default:
+            return -EINVAL;
+        }
+
+        res = ws_value_union_init_from_val(frame + i,
+                                           (struct ws_value*) &src->value);
+        if (res < 0) {
+            return res;
+        }
+    }
+
+    res = insn->func.regular(frame);
+    if (res < 0) {
+        return res;
+    }
+
+    // pop the values
+    return ws_processor_stack_pop(stack, argc - 1);
+}
+
+static int
+op_regular_stack(
+    struct ws_processor* self,
+    struct ws_bytecode_insn const* insn
+) {
+    struct ws_processor_stack* stack = self->stack;
+    size_t argc = insn->argc;
+    if (!argc || (argc > stack->top)) {
+        return -EINVAL;
+    }
+
+    int res = insn->func.regular(stack->data + stack->top - argc);
+    if (res < 0) {
+        return res;
+    }
+
+    // pop the values
+    return ws_processor_stack_pop(stack, argc - 1);
+}
+
+static int
+op_special(
+    struct ws_processor* self,
+    struct ws_bytecode_insn const* insn
+) {
+    return insn->func.special(self, &insn->stmt->args);
+}
@@ -98,6 +98,26 @@ ws_processor_exec(
 __ws_nonnull__(1)
 ;
 
+/**
+ * Run a command processor for a limited number of statements
+ *
+ * This function runs at most `budget` statements. If the command list is not
+ * completed by then, the processor may be resumed later by calling this
+ * function again.
+ *
+ * @return 0 on success, -EINPROGRESS if the budget was exhausted before the
+ *         end of the command list was reached, another negative error value on
+ *         failure and a positive value if some command caused a jump outside
+ *         the command list given by the transaction
+ */
+ssize_t
+ws_processor_exec_budget(
+    struct ws_processor* self, //!< command processor context
+    size_t budget //!< maximum number of statements to run
+)
+__ws_nonnull__(1)
+;
+
 /**
  * Perform a jump (by incrementing the program counter)
  *
@@ -27,7 +27,6 @@
 
 #include <errno.h>
 #include <malloc.h>
-#include <string.h>
 
 #include "action/processor_stack.h"
 #include "values/nil.h"
@@ -38,6 +37,54 @@
 
 #define INITIAL_STACK_SIZE (4)
 
+/**
+ * Maximum number of stacks kept in the per-thread pool
+ *
+ * Transactions don't nest deeply, a few stacks per thread suffice.
+ */
+#define STACK_POOL_SIZE (4)
+
+/**
+ * Per-thread pool of released stacks
+ *
+ * @note stacks pooled by a thread are not released when the thread exits
+ */
+static __thread struct {
+    struct ws_processor_stack stacks[STACK_POOL_SIZE];
+    size_t num;
+} stack_pool;
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Make sure the stack is able to hold at least `slots` values
+ *
+ * @return 0 on success, a negative error number otherwise
+ */
+static int
+stack_reserve(
+    struct ws_processor_stack* self, //!< the stack
+    size_t slots //!< number of slots required
+);
+
+/**
+ * Deinitialize all values above a new top
+ */
+static void
+stack_clear(
+    struct ws_processor_stack* self, //!< the stack
+    size_t new_top //!< new top of the stack
+);
+
+/*
+ *
+ * Interface implementation
+ *
+ */
 
 int
 ws_processor_stack_init(
@@ -48,8 +95,10 @@ ws_processor_stack_init(
         return -ENOMEM;
     }
 
-    self->size = INITIAL_STACK_SIZE;
-    self->top  = 0;
+    self->size  = INITIAL_STACK_SIZE;
+    self->top   = 0;
+    self->frame = 0;
+    self->high  = 0;
 
     return 0;
 }
@@ -58,13 +107,48 @@ void
 ws_processor_stack_deinit(
     struct ws_processor_stack* self
 ) {
-    union ws_value_union* cur = self->data +  self->top;
-    while (cur > self->data) {
-        --cur;
-        ws_value_deinit(&cur->value);
+    stack_clear(self, 0);
+    free(self->data);
+}
+
+int
+ws_processor_stack_acquire(
+    struct ws_processor_stack* self,
+    size_t hint
+) {
+    if (stack_pool.num > 0) {
+        *self = stack_pool.stacks[--stack_pool.num];
+    } else {
+        int res = ws_processor_stack_init(self);
+        if (res < 0) {
+            return res;
+        }
     }
 
-    free(self->data);
+    return stack_reserve(self, hint);
+}
+
+void
+ws_processor_stack_release(
+    struct ws_processor_stack* self
+) {
+    if (stack_pool.num >= STACK_POOL_SIZE) {
+        ws_processor_stack_deinit(self);
+        return;
+    }
+
+    stack_clear(self, 0);
+    self->top   = 0;
+    self->frame = 0;
+    self->high  = 0;
+    stack_pool.stacks[stack_pool.num++] = *self;
+}
+
+size_t
+ws_processor_stack_high_water(
+    struct ws_processor_stack const* self
+) {
+    return self->high;
 }
 
 int
@@ -72,37 +156,30 @@ ws_processor_stack_push(
     struct ws_processor_stack* self,
     size_t slots
 ) {
-    // calculate the new `top` and, assuming a resize, calculate the new size
-    size_t new_size = self->size;
-    size_t new_top  = self->top + slots;
-    while ((new_top + 1) > new_size) {
-        new_size *= 2;
-    }
+    size_t new_top = self->top + slots;
 
-    // check whether we have to resize
-    if (new_size != self->size) {
-        // try to reallocate
-        union ws_value_union* new_data;
-        new_data = realloc(self->data, sizeof(*(self->data)) * new_size);
-        if (!new_data) {
-            return -ENOMEM;
+    // we always keep one slot above the top
+    if ((new_top + 1) > self->size) {
+        int res = stack_reserve(self, new_top + 1);
+        if (res < 0) {
+            return res;
         }
+    }
 
-        // initialize all the things we have to initialize
-        self->data = new_data;
-        self->size = new_size;
-        memset(new_data + self->top, 0,
-               sizeof(*(self->data)) * (new_size - self->top));
+    // initialize all the values pushed
+    size_t cur = new_top;
+    while (cur > self->top) {
+        --cur;
+        ws_value_nil_init(&self->data[cur].nil);
     }
 
+    // commands detect the end of their arguments by the slot above the top
+    self->data[new_top].value.type = WS_VALUE_TYPE_NONE;
+
     // set the new top
     self->top = new_top;
-
-    // initialize all the values pushed
-    size_t old_top = self->top;
-    while (new_top > old_top) {
-        --new_top;
-        ws_value_nil_init(&self->data[new_top].nil);
+    if (new_top > self->high) {
+        self->high = new_top;
     }
 
     return 0;
@@ -118,40 +195,7 @@ ws_processor_stack_pop(
         return -EINVAL;
     }
 
-    // calculate the new `top` and, assuming a resize, calculate the new size
-    size_t new_size = self->size;
-    size_t new_top  = self->top - slots;
-    while (((new_top + 1) > new_size) && ((new_top + 1) > INITIAL_STACK_SIZE)) {
-        new_size /= 2;
-    }
-
-    // deinitialize all the values on the way down
-    size_t cur = self->top;
-    while (cur > new_top) {
-        --cur;
-        ws_value_deinit(&self->data[cur].value);
-        self->data[cur].value.type = WS_VALUE_TYPE_NONE;
-    }
-
-    memset(self->data + new_top, 0, self->top - new_top);
-
-    // set the top
-    self->top = new_top;
-
-    // check whether we may resize
-    if (new_size != self->size) {
-        // try to reallocate
-        union ws_value_union* new_data;
-        new_data = realloc(self->data, sizeof(*(self->data)) * new_size);
-        if (!new_data) {
-            // noncritical error
-            return 0;
-        }
-
-        self->data = new_data;
-        self->size = new_size;
-    }
-
+    stack_clear(self, self->top - slots);
     return 0;
 }
 
@@ -238,3 +282,55 @@ ws_processor_stack_restore_frame(
     return 0;
 }
 
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static int
+stack_reserve(
+    struct ws_processor_stack* self,
+    size_t slots
+) {
+    if (slots <= self->size) {
+        return 0;
+    }
+
+    size_t new_size = self->size ? self->size : INITIAL_STACK_SIZE;
+    while (slots > new_size) {
+        new_size *= 2;
+    }
+
+    // the slots above the top are initialized on push, no need to clear them
+    union ws_value_union* new_data;
+    new_data = realloc(self->data, sizeof(*(self->data)) * new_size);
+    if (!new_data) {
+        return -ENOMEM;
+    }
+
+    self->data = new_data;
+    self->size = new_size;
+    return 0;
+}
+
+static void
+stack_clear(
+    struct ws_processor_stack* self,
+    size_t new_top
+) {
+    size_t cur = self->top;
+    while (cur > new_top) {
+        --cur;
+        struct ws_value* val = &self->data[cur].value;
+
+        // trivially destructible values are just dropped
+        if (val->deinit_callback && (val->deinit_callback != ws_value_deinit)) {
+            val->deinit_callback(val);
+        }
+    }
+
+    // the slots further up are reinitialized when pushed
+    self->data[new_top].value.type = WS_VALUE_TYPE_NONE;
+    self->top = new_top;
+}
@@ -69,6 +69,7 @@ struct ws_processor_stack {
     size_t size; //!< @private size of the stack
     size_t top; //!< @private top of the stack, as position from the basepointer
     size_t frame; //!< @private base pointer of the current frame
+    size_t high; //!< @private highest `top` observed since initialization
 };
 
 /**
@@ -95,6 +96,52 @@ ws_processor_stack_deinit(
 __ws_nonnull__(1)
 ;
 
+/**
+ * Acquire a processor stack from the calling thread's pool
+ *
+ * This function initializes the stack passed, reusing a buffer released by a
+ * previous run on the same thread, if available.
+ * The stack is guaranteed to hold at least `hint` values without any further
+ * allocation.
+ *
+ * A stack acquired via this function must be returned via
+ * `ws_processor_stack_release()`.
+ *
+ * @return 0 on success, a negative error number otherwise
+ */
+int
+ws_processor_stack_acquire(
+    struct ws_processor_stack* self, //!< stack to initialize
+    size_t hint //!< number of slots to reserve, e.g. a previous high-water mark
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Release a processor stack to the calling thread's pool
+ *
+ * All values still on the stack are deinitialized. The buffer is kept for
+ * reuse by a later `ws_processor_stack_acquire()`.
+ */
+void
+ws_processor_stack_release(
+    struct ws_processor_stack* self //!< stack to release
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Get the high-water mark of the stack
+ *
+ * @return the maximum number of slots used since initialization
+ */
+size_t
+ws_processor_stack_high_water(
+    struct ws_processor_stack const* self //!< the stack
+)
+__ws_nonnull__(1)
+;
+
 /**
  * Push values on the stack
  *
@@ -116,6 +163,8 @@ __ws_nonnull__(1)
  *
  * This function decreases the top counter, deinitializing and invalidating the
  * values popped.
+ * The stack is never shrunk, values without a deinit callback are simply
+ * dropped.
  *
  * @return 0 if the operation succeeded, a negative error number otherwise
  */
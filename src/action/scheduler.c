@@ -0,0 +1,180 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <ev.h>
+#include <stdlib.h>
+
+#include "action/job.h"
+#include "action/scheduler.h"
+
+/**
+ * Queue of jobs of one priority
+ */
+struct job_queue {
+    struct ws_action_job* head; //!< next job to run
+    struct ws_action_job* tail; //!< job queued last
+};
+
+/**
+ * Internal context of the scheduler
+ */
+static struct {
+    struct job_queue queues[WS_ACTION_PRIORITY_NUM]; //!< queues, by priority
+    ev_idle idle; //!< watcher running the slices
+} sched;
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Idle callback, runs one slice of the most important job
+ */
+static void
+scheduler_idle_cb(
+    struct ev_loop* loop, //!< loop on which the callback was called
+    ev_idle* watcher, //!< watcher which triggered the callback
+    int revents //!< events
+);
+
+/**
+ * Get the queue holding the most important job
+ *
+ * @return the queue or NULL, if all queues are empty
+ */
+static struct job_queue*
+scheduler_next_queue(void);
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+void
+ws_action_scheduler_init(void)
+{
+    ev_idle_init(&sched.idle, scheduler_idle_cb);
+}
+
+void
+ws_action_scheduler_deinit(void)
+{
+    ev_idle_stop(EV_DEFAULT_ &sched.idle);
+
+    struct job_queue* queue;
+    while ((queue = scheduler_next_queue())) {
+        struct ws_action_job* job = queue->head;
+        queue->head = job->next;
+        if (!queue->head) {
+            queue->tail = NULL;
+        }
+
+        ws_action_job_deinit(job);
+        free(job);
+    }
+}
+
+bool
+ws_action_scheduler_is_idle(void)
+{
+    return !scheduler_next_queue();
+}
+
+void
+ws_action_scheduler_enqueue(
+    struct ws_action_job* job,
+    enum ws_action_priority priority
+) {
+    if (priority >= WS_ACTION_PRIORITY_NUM) {
+        priority = WS_ACTION_PRIORITY_BACKGROUND;
+    }
+
+    struct job_queue* queue = sched.queues + priority;
+    job->next = NULL;
+    if (queue->tail) {
+        queue->tail->next = job;
+    } else {
+        queue->head = job;
+    }
+    queue->tail = job;
+
+    ev_idle_start(EV_DEFAULT_ &sched.idle);
+}
+
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static void
+scheduler_idle_cb(
+    struct ev_loop* loop,
+    ev_idle* watcher,
+    int revents
+) {
+    struct job_queue* queue = scheduler_next_queue();
+    if (!queue) {
+        ev_idle_stop(loop, watcher);
+        return;
+    }
+
+    struct ws_action_job* job = queue->head;
+    if (!ws_action_job_step(job, WS_ACTION_SCHEDULER_BUDGET)) {
+        // we'll resume the job on the next iteration
+        return;
+    }
+
+    // dequeue the job _before_ calling back, the callback may queue new jobs
+    queue->head = job->next;
+    if (!queue->head) {
+        queue->tail = NULL;
+    }
+
+    job->done(job);
+
+    if (!scheduler_next_queue()) {
+        ev_idle_stop(loop, watcher);
+    }
+}
+
+static struct job_queue*
+scheduler_next_queue(void)
+{
+    size_t i;
+    for (i = 0; i < WS_ACTION_PRIORITY_NUM; ++i) {
+        if (sched.queues[i].head) {
+            return sched.queues + i;
+        }
+    }
+
+    return NULL;
+}
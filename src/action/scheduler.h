@@ -0,0 +1,121 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup action "Action manager"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup action_scheduler "Action manager scheduler"
+ *
+ * The scheduler runs jobs in the background of the main loop
+ *
+ * Jobs are queued by priority and run in slices of a fixed number of
+ * statements, one slice per loop iteration, whenever the loop has nothing else
+ * to do. Hence, long running transactions don't block input handling or
+ * wayland dispatch.
+ * Within a priority, jobs are run in the order they were queued. A job of a
+ * higher priority is run as soon as the slice of the current job is done.
+ *
+ * @warning The scheduler must only be used from the main thread.
+ *
+ * @{
+ */
+
+#ifndef __WS_ACTION_SCHEDULER_H__
+#define __WS_ACTION_SCHEDULER_H__
+
+#include <stdbool.h>
+
+#include "util/attributes.h"
+
+// forward declarations
+struct ws_action_job;
+
+/**
+ * Number of statements run per slice
+ */
+#define WS_ACTION_SCHEDULER_BUDGET (256)
+
+/**
+ * Priorities of jobs
+ */
+enum ws_action_priority {
+    WS_ACTION_PRIORITY_HOTKEY = 0, //!< jobs triggered by hotkeys
+    WS_ACTION_PRIORITY_IPC, //!< jobs some client waits for
+    WS_ACTION_PRIORITY_BACKGROUND, //!< jobs nobody waits for
+    WS_ACTION_PRIORITY_NUM //!< number of priorities, not a priority
+};
+
+/**
+ * Initialize the scheduler
+ */
+void
+ws_action_scheduler_init(void);
+
+/**
+ * Deinitialize the scheduler
+ *
+ * Jobs still queued are dropped without invoking their callbacks.
+ */
+void
+ws_action_scheduler_deinit(void);
+
+/**
+ * Check whether there are no jobs queued
+ *
+ * @return true if there are no jobs queued, false otherwise
+ */
+bool
+ws_action_scheduler_is_idle(void);
+
+/**
+ * Queue a job
+ *
+ * The job has to be allocated via `malloc()` and is handed over to the
+ * scheduler. Once the job is finished, its `done` callback is invoked.
+ */
+void
+ws_action_scheduler_enqueue(
+    struct ws_action_job* job, //!< job to queue
+    enum ws_action_priority priority //!< priority of the job
+)
+__ws_nonnull__(1)
+;
+
+#endif // __WS_ACTION_SCHEDULER_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
@@ -0,0 +1,222 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+
+#include "command/bytecode.h"
+#include "command/command.h"
+#include "command/statement.h"
+#include "objects/string.h"
+#include "values/string.h"
+#include "values/union.h"
+#include "values/value.h"
+#include "values/value_type.h"
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Compile the arguments of a statement into operands
+ *
+ * @return 0 on success, a negative error code otherwise
+ */
+static int
+compile_operands(
+    struct ws_bytecode* code, //!< bytecode being compiled
+    struct ws_statement const* stmt, //!< statement to compile operands of
+    struct ws_bytecode_operand* operands //!< where to put the operands
+);
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+struct ws_bytecode*
+ws_bytecode_compile(
+    struct ws_statement const* statements,
+    size_t num
+) {
+    struct ws_bytecode* code = calloc(1, sizeof(*code));
+    if (!code) {
+        return NULL;
+    }
+
+    // count operands and constants, so we can allocate everything at once
+    size_t operands_num = 0;
+    size_t constants_num = 0;
+    for (size_t i = 0; i < num; ++i) {
+        struct ws_command_args const* args = &statements[i].args;
+        if (!args->vals) {
+            continue;
+        }
+
+        operands_num += args->num;
+        for (size_t j = 0; j < args->num; ++j) {
+            constants_num += args->vals[j].type == direct;
+        }
+    }
+
+    code->insns = calloc(num ? num : 1, sizeof(*code->insns));
+    code->operands = calloc(operands_num ? operands_num : 1,
+                            sizeof(*code->operands));
+    code->constants = calloc(constants_num ? constants_num : 1,
+                             sizeof(*code->constants));
+    if (!code->insns || !code->operands || !code->constants) {
+        goto cleanup;
+    }
+
+    struct ws_bytecode_operand* operands = code->operands;
+    for (size_t i = 0; i < num; ++i) {
+        struct ws_statement const* stmt = statements + i;
+        struct ws_bytecode_insn* insn = code->insns + i;
+
+        insn->stmt = stmt;
+        insn->argc = stmt->args.num;
+        ++code->num;
+
+        switch (stmt->command->command_type) {
+        case regular:
+            insn->func.regular = stmt->command->func.regular;
+            if (!stmt->args.vals) {
+                insn->op = WS_BYTECODE_OP_REGULAR_STACK;
+                continue;
+            }
+
+            insn->op = WS_BYTECODE_OP_REGULAR;
+            insn->operands = operands;
+            if (compile_operands(code, stmt, operands) < 0) {
+                goto cleanup;
+            }
+            operands += stmt->args.num;
+            break;
+
+        case special:
+            // special commands interpret their arguments themselves
+            insn->op = WS_BYTECODE_OP_SPECIAL;
+            insn->func.special = stmt->command->func.special;
+            break;
+
+        default:
+            goto cleanup;
+        }
+    }
+
+    return code;
+
+cleanup:
+    ws_bytecode_destroy(code);
+    return NULL;
+}
+
+void
+ws_bytecode_destroy(
+    struct ws_bytecode* self
+) {
+    if (!self) {
+        return;
+    }
+
+    if (self->constants) {
+        size_t i = self->constants_num;
+        while (i--) {
+            ws_value_deinit(&self->constants[i].value);
+        }
+    }
+
+    free(self->constants);
+    free(self->operands);
+    free(self->insns);
+    free(self);
+}
+
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static int
+compile_operands(
+    struct ws_bytecode* code,
+    struct ws_statement const* stmt,
+    struct ws_bytecode_operand* operands
+) {
+    for (size_t i = 0; i < stmt->args.num; ++i) {
+        struct ws_argument const* arg = stmt->args.vals + i;
+        struct ws_bytecode_operand* operand = operands + i;
+
+        if (arg->type == indirect) {
+            operand->kind = (arg->arg.pos < 0) ? WS_BYTECODE_OPERAND_RELATIVE :
+                                                 WS_BYTECODE_OPERAND_ABSOLUTE;
+            operand->arg.pos = arg->arg.pos;
+            continue;
+        }
+
+        // initialize the constant once and for all
+        union ws_value_union* constant = code->constants + code->constants_num;
+        int res = ws_value_union_init_from_val(constant, arg->arg.val);
+        if (res < 0) {
+            return res;
+        }
+        ++code->constants_num;
+
+        operand->kind = WS_BYTECODE_OPERAND_CONST;
+        operand->arg.val = constant;
+
+        // values which don't hold any references may be copied bitwise
+        switch (ws_value_get_type(&constant->value)) {
+        case WS_VALUE_TYPE_NIL:
+        case WS_VALUE_TYPE_BOOL:
+        case WS_VALUE_TYPE_INT:
+            operand->trivial = true;
+            break;
+
+        case WS_VALUE_TYPE_STRING: {
+            // constant strings are compared a lot, make that a pointer compare
+            struct ws_string* str = ws_string_intern(constant->string.str);
+            if (str) {
+                ws_value_string_set_str(&constant->string, str);
+                ws_object_unref(&str->obj);
+            }
+            operand->trivial = false;
+            break;
+        }
+
+        default:
+            operand->trivial = false;
+            break;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,151 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @addtogroup command "Command"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup command_bytecode "Command bytecode"
+ *
+ * Pre-linked form of a list of statements
+ *
+ * Interpreting a list of statements requires figuring out the type of each
+ * command and each argument and copying each constant argument for every
+ * single invocation. For transactions which are run often, e.g. the ones bound
+ * to hotkeys, this is done once by compiling the statements into bytecode:
+ *
+ *  * each instruction holds the opcode, the function to call and the number of
+ *    stack slots it needs,
+ *  * constant arguments are initialized once in a constant pool,
+ *  * argument positions are pre-decoded into operands.
+ *
+ * Instruction `n` always corresponds to statement `n` of the list compiled,
+ * so the program counter of a processor remains meaningful.
+ *
+ * @{
+ */
+
+#ifndef __WS_COMMAND_BYTECODE_H__
+#define __WS_COMMAND_BYTECODE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+
+#include "command/command.h"
+#include "util/attributes.h"
+
+// forward declarations
+struct ws_statement;
+union ws_value_union;
+
+/**
+ * Bytecode opcode
+ */
+enum ws_bytecode_opcode {
+    WS_BYTECODE_OP_REGULAR, //!< regular command, arguments given by operands
+    WS_BYTECODE_OP_REGULAR_STACK, //!< regular command, arguments on the stack
+    WS_BYTECODE_OP_SPECIAL, //!< special command
+    WS_BYTECODE_OP_NUM //!< number of opcodes, not an opcode
+};
+
+/**
+ * Pre-decoded argument of an instruction
+ */
+struct ws_bytecode_operand {
+    enum {
+        WS_BYTECODE_OPERAND_CONST, //!< constant from the constant pool
+        WS_BYTECODE_OPERAND_ABSOLUTE, //!< position from the stack bottom
+        WS_BYTECODE_OPERAND_RELATIVE //!< position from the top of the stack
+    } kind; //!< @public kind of operand
+    bool trivial; //!< @public constant may be copied bitwise
+    union {
+        ssize_t pos; //!< position on the stack
+        union ws_value_union const* val; //!< constant in the pool
+    } arg; //!< @public the operand
+};
+
+/**
+ * Bytecode instruction
+ */
+struct ws_bytecode_insn {
+    enum ws_bytecode_opcode op; //!< @public opcode
+    size_t argc; //!< @public number of stack slots the command consumes
+    union {
+        ws_regular_command_func regular; //!< @public regular command
+        ws_special_command_func special; //!< @public special command
+    } func; //!< @public function to call
+    struct ws_bytecode_operand const* operands; //!< @public operands
+    struct ws_statement const* stmt; //!< @public statement compiled
+};
+
+/**
+ * Compiled list of statements
+ */
+struct ws_bytecode {
+    size_t num; //!< @public number of instructions
+    struct ws_bytecode_insn* insns; //!< @public instructions
+    struct ws_bytecode_operand* operands; //!< @private all the operands
+    union ws_value_union* constants; //!< @private constant pool
+    size_t constants_num; //!< @private number of constants
+};
+
+/**
+ * Compile a list of statements
+ *
+ * @note the statements must outlive the bytecode
+ *
+ * @return the bytecode or `NULL` on failure
+ */
+struct ws_bytecode*
+ws_bytecode_compile(
+    struct ws_statement const* statements, //!< statements to compile
+    size_t num //!< number of statements
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Destroy bytecode
+ */
+void
+ws_bytecode_destroy(
+    struct ws_bytecode* self //!< bytecode to destroy
+);
+
+#endif // __WS_COMMAND_BYTECODE_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
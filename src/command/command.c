@@ -32,6 +32,7 @@
 
 #include "command/command.h"
 #include "command/list.h"
+#include "command/phash.h"
 
 #include "util/cleaner.h"
 #include "util/string.h"
@@ -41,6 +42,9 @@
 
 /**
  * Command list
+ *
+ * Holds the commands added at runtime, sorted by name. The builtin commands are
+ * looked up via the perfect hash.
  */
 struct {
     struct ws_command* commands; //!< @public commands
@@ -60,6 +64,16 @@ struct {
 void
 deinit_command(void* dummy);
 
+/**
+ * Find a builtin command by name
+ *
+ * @returns builtin command with the name given or NULL
+ */
+static struct ws_command const*
+get_builtin(
+    char const* name //!< name of the command
+);
+
 /*
  *
  * Interface implementation
@@ -77,11 +91,6 @@ ws_command_init(void) {
     cmd_ctx.commands = NULL;
     cmd_ctx.num = 0;
 
-    int res = ws_command_add(ws_command_list, ws_command_cnt);
-    if (res < 0) {
-        return res;
-    }
-
     return ws_cleaner_add(deinit_command, NULL);
 }
 
@@ -93,13 +102,19 @@ ws_command_get(
         return NULL;
     }
 
+    // most lookups are for builtin commands
+    struct ws_command const* builtin = get_builtin(name);
+    if (builtin) {
+        return builtin;
+    }
+
     // initialize bounds
     size_t first = 0;
     size_t alast = cmd_ctx.num;
     size_t cur;
 
     // perform a binary search
-    while (first + LINEAR_THRESHOLD > alast) {
+    while (first + LINEAR_THRESHOLD < alast) {
         cur = (first + alast) / 2;
 
         // compare the current name with what we want
@@ -138,6 +153,12 @@ ws_command_add(
     struct ws_command* commands,
     size_t num
 ) {
+    // initialization would drop the commands we add
+    int res = ws_command_init();
+    if (res < 0) {
+        return res;
+    }
+
     // make sure we have enoug memory
     size_t dest = cmd_ctx.num + num;
     struct ws_command* buf = realloc(cmd_ctx.commands, sizeof(*buf) * dest);
@@ -183,3 +204,22 @@ deinit_command(
     free(cmd_ctx.commands);
 }
 
+static struct ws_command const*
+get_builtin(
+    char const* name
+) {
+    if (!ws_command_phash_size) {
+        return NULL;
+    }
+
+    uint32_t hash = ws_command_phash(name);
+    uint32_t bucket = ws_command_phash_bucket(hash, ws_command_phash_buckets);
+    uint32_t slot = ws_command_phash_slot(hash, ws_command_phash_disp[bucket],
+                                          ws_command_phash_size);
+
+    // the hash is only perfect for the builtin names, so verify the hit
+    struct ws_command const* cmd = ws_command_list +
+                                   ws_command_phash_slots[slot];
+    return ws_streq(name, cmd->name) ? cmd : NULL;
+}
+
@@ -103,6 +103,13 @@ typedef int (*ws_special_command_func)(struct ws_processor*,
  * is a `regular` or a `special` one.
  * A processor may then use the appropriate member of the embedded union `func`.
  *
+ * ### Purity
+ *
+ * A command is `pure` if its result only depends on its arguments and the
+ * attributes of the objects it reads, and if it has no other side effects.
+ * Results of transactions consisting of pure commands only may be cached.
+ * Commands are impure unless stated otherwise.
+ *
  */
 struct ws_command {
     char const* name; //!< @public name of the command
@@ -112,6 +119,8 @@ struct ws_command {
         special //!< it's a special command (like jump)
     } command_type; //!< @public type of the command
 
+    bool pure; //!< @public whether the command is free of side effects
+
     union {
         ws_regular_command_func regular; //!< @public regular commands' callback
         ws_special_command_func special; //!< @public special commands' callback
@@ -129,6 +138,10 @@ ws_command_init(void);
 /**
  * Find a command by name
  *
+ * Builtin commands are found in constant time via a perfect hash generated at
+ * build time. Commands added via `ws_command_add()` are found via a binary
+ * search.
+ *
  * @returns command with the name given or NULL
  */
 struct ws_command const*
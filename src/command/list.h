@@ -71,17 +71,25 @@
  * Command list entry
  *
  * This macro expands to a command list entry for a command which the name
- * `name_` and the type `type_`.
- * Valid types are `regular` and `special`.
+ * `name_`, the type `type_` and the purity `purity_`.
+ * Valid types are `regular` and `special`, valid purities are `pure` and
+ * `impure`.
  *
  * The macro is intended for use in the (generated) command list.
  */
-#define COMMAND(name_, type_) {\
+#define COMMAND(name_, type_, purity_) {\
     .name = #name_,\
     .command_type = type_,\
+    .pure = COMMAND_PURITY_##purity_,\
     .func.type_ = ws_builtin_cmd_##name_,\
 },
 
+/**
+ * Purity values for the `COMMAND` macro
+ */
+#define COMMAND_PURITY_pure (true)
+#define COMMAND_PURITY_impure (false)
+
 /**
  * List holding all the commands in alphabetical order
  *
@@ -26,17 +26,51 @@
 
 #include <errno.h>
 #include <stdbool.h>
+#include <stdlib.h>
 
 #include "command/object.h"
 
+#include "command/util.h"
 #include "objects/object.h"
 #include "objects/string.h"
+#include "values/int.h"
 #include "values/object_id.h"
+#include "values/ordered_set.h"
+#include "values/set.h"
 #include "values/string.h"
+#include "values/table.h"
 #include "values/union.h"
 #include "values/value_type.h"
 #include "util/condition.h"
 
+/**
+ * List of objects collected from the arguments of a command
+ */
+struct object_list {
+    struct ws_object** objs; //!< the objects, referenced
+    size_t num; //!< number of objects
+    size_t cap; //!< capacity of the list
+};
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Append an object to an object list, taking a reference
+ *
+ * @return 0 on success, a negative error code otherwise
+ */
+static int
+object_list_append(
+    struct object_list* list, //!< list to append to
+    struct ws_object* obj //!< object to append
+)
+__ws_nonnull__(1, 2)
+;
+
 /*
  *
  * Interface implementation
@@ -54,10 +88,9 @@ ws_builtin_cmd_hastypename(
 
     struct ws_object* o = ws_value_object_id_get(&args[0].object_id);
 
-    struct ws_string* type_name_str     = ws_value_string_get(&args[1].string);
-    const char* type_name               = ws_string_raw(type_name_str);
-
-    bool b = ws_object_has_typename(o, type_name);
+    struct ws_string* type_name_str = ws_value_string_get(&args[1].string);
+    bool b = ws_object_has_typename(o, ws_string_cstr(type_name_str));
+    ws_object_unref(&type_name_str->obj);
 
     int res = ws_value_union_reinit(args, WS_VALUE_TYPE_BOOL);
     if (res != 0) {
@@ -83,22 +116,15 @@ ws_builtin_cmd_call(
         return -EINVAL;
     }
 
-    char* name;
-    {
-        struct ws_string* buf = ws_value_string_get(&args[1].string);
-        if (!buf) {
-            return -EINVAL;
-        }
-
-        name = ws_string_raw(buf); //name is a copy
-        ws_object_unref(&buf->obj);
-        if (!name) {
-            return -EINVAL;
-        }
+    struct ws_string* name = ws_value_string_get(&args[1].string);
+    if (!name) {
+        return -EINVAL;
     }
 
-
-    return ws_object_call_cmd(obj, name, args);
+    // the name is borrowed, our reference keeps it alive during the call
+    int res = ws_object_call_cmd(obj, ws_string_cstr(name), args);
+    ws_object_unref(&name->obj);
+    return res;
 }
 
 int
@@ -113,9 +139,8 @@ ws_builtin_cmd_has_meth(
     struct ws_object* o = ws_value_object_id_get(&args[0].object_id);
 
     struct ws_string* cmdstr = ws_value_string_get(&args[1].string);
-    const char* cmd = ws_string_raw(cmdstr);
-
-    bool b = ws_object_has_cmd(o, cmd);
+    bool b = ws_object_has_cmd(o, ws_string_cstr(cmdstr));
+    ws_object_unref(&cmdstr->obj);
 
     int res = ws_value_union_reinit(args, WS_VALUE_TYPE_BOOL);
     if (res != 0) {
@@ -139,9 +164,8 @@ ws_builtin_cmd_has_attr(
     struct ws_object* o = ws_value_object_id_get(&args[0].object_id);
 
     struct ws_string* attrstr = ws_value_string_get(&args[1].string);
-    const char* attr = ws_string_raw(attrstr);
-
-    bool b = ws_object_has_attr(o, attr);
+    bool b = ws_object_has_attr(o, ws_string_cstr(attrstr));
+    ws_object_unref(&attrstr->obj);
 
     int res = ws_value_union_reinit(args, WS_VALUE_TYPE_BOOL);
     if (res != 0) {
@@ -164,19 +188,19 @@ ws_builtin_cmd_get_attr(
     int res = -EINVAL;
 
     struct ws_object* obj = ws_value_object_id_get(&args[0].object_id);
+    if (unlikely(!obj)) {
+        return -EINVAL;
+    }
+
     struct ws_string* name = ws_value_string_get(&args[1].string);
     if (unlikely(!name)) {
         goto out;
     }
 
-    char* ident = ws_string_raw(name); // copies!
+    // resolving is cheap for known attributes and lets us reuse the stack slot
+    intmax_t handle = ws_object_attr_handle(obj->id, ws_string_cstr(name));
     ws_object_unref(&name->obj);
-
-    if (likely(ident)) {
-        res = ws_object_attr_read(obj, ident, &args->value);
-    }
-
-    free(ident);
+    res = (handle < 0) ? handle : ws_object_attr_read_handle(obj, handle, args);
 
 out:
     ws_object_unref(obj);
@@ -201,19 +225,214 @@ ws_builtin_cmd_set_attr(
         goto out;
     }
 
-    char* ident = ws_string_raw(name); // copies!
+    res = ws_object_attr_write(obj, ws_string_cstr(name), &args[2].value);
+    ws_object_unref(&name->obj);
+
+out:
+    ws_object_unref(obj);
+    return res;
+}
+
+int
+ws_builtin_cmd_attr_handle(
+    union ws_value_union* args
+) {
+    if ((args[0].value.type != WS_VALUE_TYPE_OBJECT_ID) ||
+        (args[1].value.type != WS_VALUE_TYPE_STRING)) {
+        return -EINVAL;
+    }
+
+    struct ws_object* obj = ws_value_object_id_get(&args[0].object_id);
+    if (unlikely(!obj)) {
+        return -EINVAL;
+    }
+    ws_object_type_id* type = obj->id;
+    ws_object_unref(obj);
+
+    struct ws_string* name = ws_value_string_get(&args[1].string);
+    if (unlikely(!name)) {
+        return -EINVAL;
+    }
+
+    intmax_t handle = ws_object_attr_handle(type, ws_string_cstr(name));
     ws_object_unref(&name->obj);
-    if (likely(ident)) {
-        res = ws_object_attr_write(obj, ident, &args[2].value);
+    if (handle < 0) {
+        return handle;
+    }
+
+    int res = ws_value_union_reinit(args, WS_VALUE_TYPE_INT);
+    if (res != 0) {
+        return res;
     }
 
-    free(ident);
+    return ws_value_int_set(&args[0].int_, handle);
+}
+
+int
+ws_builtin_cmd_get_attr_by_handle(
+    union ws_value_union* args
+) {
+    if ((args[0].value.type != WS_VALUE_TYPE_OBJECT_ID) ||
+        (args[1].value.type != WS_VALUE_TYPE_INT)) {
+        return -EINVAL;
+    }
+
+    struct ws_object* obj = ws_value_object_id_get(&args[0].object_id);
+    if (unlikely(!obj)) {
+        return -EINVAL;
+    }
+
+    intmax_t handle = ws_value_int_get(&args[1].int_);
+    int res = ws_object_attr_read_handle(obj, handle, args);
+
+    ws_object_unref(obj);
+    return res;
+}
+
+int
+ws_builtin_cmd_set_attr_by_handle(
+    union ws_value_union* args
+) {
+    if ((args[0].value.type != WS_VALUE_TYPE_OBJECT_ID) ||
+        (args[1].value.type != WS_VALUE_TYPE_INT) ||
+        (args[2].value.type == WS_VALUE_TYPE_NONE)) {
+        return -EINVAL;
+    }
+
+    struct ws_object* obj = ws_value_object_id_get(&args[0].object_id);
+    if (unlikely(!obj)) {
+        return -EINVAL;
+    }
+
+    intmax_t handle = ws_value_int_get(&args[1].int_);
+    int res = ws_object_attr_write_handle(obj, handle, &args[2].value);
 
-out:
     ws_object_unref(obj);
     return res;
 }
 
+int
+ws_builtin_cmd_get_attrs(
+    union ws_value_union* args
+) {
+    union ws_value_union* it;
+    size_t handles_num = 0;
+    size_t objs_num = 0;
+
+    // count the handles and objects, sets contribute all their elements
+    ITERATE_ARGS(it, args) {
+        switch (ws_value_get_type(&it->value)) {
+        case WS_VALUE_TYPE_INT:
+            ++handles_num;
+            break;
+
+        case WS_VALUE_TYPE_OBJECT_ID:
+            ++objs_num;
+            break;
+
+        case WS_VALUE_TYPE_SET:
+            objs_num += ws_value_set_cardinality(&it->set);
+            break;
+
+        case WS_VALUE_TYPE_ORDERED_SET:
+            objs_num += ws_value_ordered_set_cardinality(&it->ordered_set);
+            break;
+
+        default:
+            return -EINVAL;
+        }
+    }
+
+    struct object_list objs = { .objs = NULL, .num = 0, .cap = objs_num };
+    intmax_t* handles = calloc(handles_num + 1, sizeof(*handles));
+    objs.objs = calloc(objs_num + 1, sizeof(*objs.objs));
+    int res = -ENOMEM;
+    if (unlikely(!handles || !objs.objs)) {
+        goto out;
+    }
+
+    // collect them, holding references on the objects
+    size_t h = 0;
+    ITERATE_ARGS(it, args) {
+        switch (ws_value_get_type(&it->value)) {
+        case WS_VALUE_TYPE_INT:
+            handles[h++] = ws_value_int_get(&it->int_);
+            break;
+
+        case WS_VALUE_TYPE_OBJECT_ID:
+            {
+                struct ws_object* obj = ws_value_object_id_get(&it->object_id);
+                if (obj) {
+                    objs.objs[objs.num++] = obj;
+                }
+            }
+            break;
+
+        case WS_VALUE_TYPE_SET:
+            res = ws_value_set_select(&it->set, NULL, NULL,
+                                      (ws_value_set_procf) object_list_append,
+                                      &objs);
+            if (unlikely(res < 0)) {
+                goto out;
+            }
+            break;
+
+        case WS_VALUE_TYPE_ORDERED_SET:
+            res = ws_value_ordered_set_select(&it->ordered_set,
+                                              (ws_ordered_set_procf)
+                                              object_list_append,
+                                              &objs);
+            if (unlikely(res < 0)) {
+                goto out;
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    // one row per object: the object, followed by the attributes
+    struct ws_value_table table;
+    ws_value_table_init(&table);
+    res = ws_value_table_resize(&table, objs.num, handles_num + 1);
+    if (unlikely(res < 0)) {
+        goto out;
+    }
+
+    size_t row;
+    for (row = 0; row < objs.num; ++row) {
+        union ws_value_union* cell = ws_value_table_cell(&table, row, 0);
+        ws_value_union_reinit(cell, WS_VALUE_TYPE_OBJECT_ID);
+        ws_value_object_id_set(&cell->object_id, objs.objs[row]);
+
+        for (h = 0; h < handles_num; ++h) {
+            cell = ws_value_table_cell(&table, row, h + 1);
+            if (ws_object_attr_read_handle(objs.objs[row], handles[h],
+                                           cell) < 0) {
+                // the object doesn't have that attribute
+                ws_value_union_reinit(cell, WS_VALUE_TYPE_NIL);
+            }
+        }
+    }
+
+    // move the table onto the stack
+    res = ws_value_union_reinit(args, WS_VALUE_TYPE_TABLE);
+    if (unlikely(res < 0)) {
+        ws_value_deinit(&table.value);
+        goto out;
+    }
+    args->table = table;
+
+out:
+    while (objs.num--) {
+        ws_object_unref(objs.objs[objs.num]);
+    }
+    free(objs.objs);
+    free(handles);
+    return res;
+}
+
 int
 ws_builtin_cmd_is_instance_of(
     union ws_value_union* args
@@ -242,3 +461,22 @@ ws_builtin_cmd_is_instance_of(
 
     return 0;
 }
+
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static int
+object_list_append(
+    struct object_list* list,
+    struct ws_object* obj
+) {
+    if (unlikely(list->num >= list->cap)) {
+        return -EINVAL;
+    }
+
+    list->objs[list->num++] = getref(obj);
+    return 0;
+}
@@ -0,0 +1,319 @@
+/* waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+
+#include <errno.h>
+#include <stdint.h>
+
+#include "command/ordered_set.h"
+
+#include "command/util.h"
+#include "objects/ordered_set.h"
+#include "objects/set.h"
+#include "values/int.h"
+#include "values/object_id.h"
+#include "values/ordered_set.h"
+#include "values/set.h"
+#include "values/union.h"
+#include "values/value.h"
+#include "values/value_type.h"
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Resolve a position passed to a command
+ *
+ * Negative positions count from the end of the set. The result is clamped to
+ * the range [0, `card`].
+ *
+ * @return the position as an index into the set
+ */
+static size_t
+resolve_position(
+    intmax_t pos, //!< position passed to the command
+    size_t card //!< cardinality of the set
+);
+
+/**
+ * Copy a range of elements from one ordered set to another, keeping the keys
+ *
+ * @return zero on success, else negative error code from errno.h
+ */
+static int
+copy_range(
+    struct ws_ordered_set* dest, //!< set to copy the elements to
+    struct ws_ordered_set* src, //!< set to copy the elements from
+    size_t from, //!< position of the first element to copy
+    size_t to //!< position after the last element to copy
+);
+
+/**
+ * Processor inserting elements into an ordered set
+ *
+ * @return zero on success, else negative error code from errno.h
+ */
+static int
+insert_into(
+    void* etc, //!< ordered set to insert into
+    void const* obj //!< object to insert
+);
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+int
+ws_builtin_cmd_ordered_set(
+    union ws_value_union* args
+) {
+    struct ws_ordered_set* res = ws_ordered_set_new();
+    if (!res) {
+        return -ENOMEM;
+    }
+
+    int retval = 0;
+    union ws_value_union* it;
+
+    // objects and the elements of sets are collected into the result
+    ITERATE_ARGS(it, args) {
+        switch (ws_value_get_type(&it->value)) {
+        case WS_VALUE_TYPE_OBJECT_ID:
+            {
+                struct ws_object* obj = ws_value_object_id_get(&it->object_id);
+                if (!obj) {
+                    retval = -EINVAL;
+                    break;
+                }
+                retval = ws_ordered_set_insert(res, obj);
+                ws_object_unref(obj);
+            }
+            break;
+
+        case WS_VALUE_TYPE_SET:
+            retval = ws_value_set_select(&it->set, NULL, NULL, insert_into,
+                                         res);
+            break;
+
+        case WS_VALUE_TYPE_ORDERED_SET:
+            retval = copy_range(res, it->ordered_set.set, 0, SIZE_MAX);
+            break;
+
+        default:
+            retval = -EINVAL;
+            break;
+        }
+
+        if (retval < 0) {
+            ws_object_unref(&res->obj);
+            return retval;
+        }
+    }
+
+    ws_value_deinit(&args->value);
+    ws_value_ordered_set_init_set(&args->ordered_set, res);
+    ws_object_unref(&res->obj);
+
+    return 0;
+}
+
+int
+ws_builtin_cmd_ordered_set_at(
+    union ws_value_union* args
+) {
+    if (ws_value_get_type(&args->value) != WS_VALUE_TYPE_ORDERED_SET ||
+            ws_value_get_type(&args[1].value) != WS_VALUE_TYPE_INT) {
+        return -EINVAL;
+    }
+
+    if (ws_value_get_type(&args[2].value) != WS_VALUE_TYPE_NONE) {
+        return -E2BIG;
+    }
+
+    struct ws_ordered_set* set = args->ordered_set.set;
+    intmax_t pos = ws_value_int_get(&args[1].int_);
+    size_t card = ws_ordered_set_cardinality(set);
+
+    // out of range positions yield nil rather than an error
+    struct ws_object* obj = NULL;
+    uintmax_t dist = (pos < 0) ? (uintmax_t) -(pos + 1) : (uintmax_t) pos;
+    if (dist < card) {
+        obj = ws_ordered_set_at(set, resolve_position(pos, card), NULL);
+    }
+
+    if (!obj) {
+        return ws_value_union_reinit(args, WS_VALUE_TYPE_NIL);
+    }
+
+    ws_value_union_reinit(args, WS_VALUE_TYPE_OBJECT_ID);
+    ws_value_object_id_set(&args->object_id, obj);
+    ws_object_unref(obj);
+
+    return 0;
+}
+
+int
+ws_builtin_cmd_ordered_set_rank(
+    union ws_value_union* args
+) {
+    if (ws_value_get_type(&args->value) != WS_VALUE_TYPE_ORDERED_SET ||
+            ws_value_get_type(&args[1].value) != WS_VALUE_TYPE_OBJECT_ID) {
+        return -EINVAL;
+    }
+
+    // the key is optional
+    intmax_t key = 0;
+    union ws_value_union* end = args + 2;
+    if (ws_value_get_type(&end->value) == WS_VALUE_TYPE_INT) {
+        key = ws_value_int_get(&end->int_);
+        ++end;
+    }
+
+    if (!AT_END(end)) {
+        return -E2BIG;
+    }
+
+    struct ws_object* obj = ws_value_object_id_get(&args[1].object_id);
+    if (!obj) {
+        return -EINVAL;
+    }
+
+    ssize_t rank = ws_ordered_set_rank_keyed(args->ordered_set.set, obj, key);
+    ws_object_unref(obj);
+
+    // elements not contained yield nil rather than an error
+    if (rank < 0) {
+        return ws_value_union_reinit(args, WS_VALUE_TYPE_NIL);
+    }
+
+    ws_value_union_reinit(args, WS_VALUE_TYPE_INT);
+    ws_value_int_set(&args->int_, rank);
+
+    return 0;
+}
+
+int
+ws_builtin_cmd_ordered_set_slice(
+    union ws_value_union* args
+) {
+    if (ws_value_get_type(&args->value) != WS_VALUE_TYPE_ORDERED_SET ||
+            ws_value_get_type(&args[1].value) != WS_VALUE_TYPE_INT) {
+        return -EINVAL;
+    }
+
+    struct ws_ordered_set* set = args->ordered_set.set;
+    size_t card = ws_ordered_set_cardinality(set);
+    size_t from = resolve_position(ws_value_int_get(&args[1].int_), card);
+
+    // the end is optional
+    size_t to = card;
+    union ws_value_union* end = args + 2;
+    if (ws_value_get_type(&end->value) == WS_VALUE_TYPE_INT) {
+        to = resolve_position(ws_value_int_get(&end->int_), card);
+        ++end;
+    }
+
+    if (!AT_END(end)) {
+        return -E2BIG;
+    }
+
+    struct ws_ordered_set* res = ws_ordered_set_new();
+    if (!res) {
+        return -ENOMEM;
+    }
+
+    int retval = copy_range(res, set, from, to);
+    if (retval < 0) {
+        ws_object_unref(&res->obj);
+        return retval;
+    }
+
+    ws_value_deinit(&args->value);
+    ws_value_ordered_set_init_set(&args->ordered_set, res);
+    ws_object_unref(&res->obj);
+
+    return 0;
+}
+
+/*
+ *
+ * Static function implementations
+ *
+ */
+
+static size_t
+resolve_position(
+    intmax_t pos,
+    size_t card
+) {
+    if (pos >= 0) {
+        return ((uintmax_t) pos < card) ? (size_t) pos : card;
+    }
+    // -(pos + 1) won't overflow, unlike -pos
+    uintmax_t dist = (uintmax_t) -(pos + 1);
+    return (dist < card) ? card - 1 - (size_t) dist : 0;
+}
+
+static int
+copy_range(
+    struct ws_ordered_set* dest,
+    struct ws_ordered_set* src,
+    size_t from,
+    size_t to
+) {
+    intmax_t key;
+    struct ws_object* obj;
+
+    for (; from < to; ++from) {
+        obj = ws_ordered_set_at(src, from, &key);
+        if (!obj) {
+            break;
+        }
+
+        int res = ws_ordered_set_insert_keyed(dest, obj, key);
+        ws_object_unref(obj);
+        if (res < 0) {
+            return res;
+        }
+    }
+
+    return 0;
+}
+
+static int
+insert_into(
+    void* etc,
+    void const* obj
+) {
+    return ws_ordered_set_insert((struct ws_ordered_set*) etc,
+                                 (struct ws_object*) obj);
+}
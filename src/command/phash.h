@@ -0,0 +1,150 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup command "Command"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup command_phash "Builtin command hash"
+ *
+ * Minimal perfect hash over the names of the builtin commands
+ *
+ * The tables are generated at build time by `phash_gen` from the names in the
+ * `*.commands` files. The names are distributed over buckets by their hash.
+ * Each bucket has a displacement value, which is mixed into the hash to yield
+ * the slot. Each slot holds the index of the command in `ws_command_list`.
+ *
+ * @{
+ */
+
+#ifndef __WS_COMMAND_PHASH_H__
+#define __WS_COMMAND_PHASH_H__
+
+#include <stdint.h>
+
+/**
+ * Hash a command name
+ *
+ * @return the hash of the name
+ */
+static inline uint32_t
+ws_command_phash(
+    char const* name //!< name of the command
+) {
+    uint32_t hash = 2166136261u;
+    while (*name) {
+        hash ^= (unsigned char) *name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Map a value onto a range
+ *
+ * Multiply-shift rather than modulo, which avoids a division.
+ *
+ * @return a value in `[0, range)`
+ */
+static inline uint32_t
+ws_command_phash_reduce(
+    uint32_t val, //!< value to map, should be well distributed
+    uint32_t range //!< size of the range
+) {
+    return (uint32_t) (((uint64_t) val * range) >> 32);
+}
+
+/**
+ * Compute the bucket of a name from its hash
+ *
+ * @return the bucket
+ */
+static inline uint32_t
+ws_command_phash_bucket(
+    uint32_t hash, //!< hash of the name
+    uint32_t buckets //!< number of buckets
+) {
+    return ws_command_phash_reduce(hash, buckets);
+}
+
+/**
+ * Compute the slot of a name from its hash and the bucket's displacement
+ *
+ * @note The generator uses this very function, so changing it only requires a
+ *       rebuild.
+ *
+ * @return the slot
+ */
+static inline uint32_t
+ws_command_phash_slot(
+    uint32_t hash, //!< hash of the name
+    uint32_t disp, //!< displacement of the name's bucket
+    uint32_t size //!< number of slots
+) {
+    // re-mix, so different displacements yield unrelated slots
+    hash ^= disp * 2654435761u;
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return ws_command_phash_reduce(hash, size);
+}
+
+/**
+ * Number of buckets in the hash
+ */
+extern uint32_t const ws_command_phash_buckets;
+
+/**
+ * Number of slots in the hash, equal to the number of builtin commands
+ */
+extern uint32_t const ws_command_phash_size;
+
+/**
+ * Displacement value for each bucket
+ */
+extern uint32_t const ws_command_phash_disp[];
+
+/**
+ * Index into `ws_command_list` for each slot
+ */
+extern uint32_t const ws_command_phash_slots[];
+
+#endif // __WS_COMMAND_PHASH_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
@@ -0,0 +1,249 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup command "Command"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup command_phash_gen "Builtin command hash generator"
+ *
+ * Build time tool generating the tables of the builtin command hash
+ *
+ * Usage: `phash_gen <output file> <command names...>`
+ *
+ * The names have to be passed in the order of `ws_command_list`, since the
+ * position of a name is the index stored in its slot.
+ *
+ * @{
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "command/phash.h"
+
+/**
+ * Maximum displacement value tried for a single bucket
+ */
+#define MAX_DISPLACEMENT (1u << 20)
+
+/**
+ * Marker for an unoccupied slot
+ */
+#define SLOT_FREE UINT32_MAX
+
+/**
+ * Bucket of names
+ */
+struct bucket {
+    uint32_t index; //!< index of the bucket
+    uint32_t num; //!< number of names in the bucket
+    uint32_t* names; //!< indices of the names in the bucket
+};
+
+/**
+ * Order buckets by number of names, descending
+ *
+ * @return comparison result for qsort()
+ */
+static int
+bucket_cmp(
+    void const* a, //!< first bucket
+    void const* b //!< second bucket
+) {
+    struct bucket const* ba = a;
+    struct bucket const* bb = b;
+    if (ba->num != bb->num) {
+        return (ba->num < bb->num) ? 1 : -1;
+    }
+    return (ba->index < bb->index) ? -1 : (ba->index > bb->index);
+}
+
+/**
+ * Try to place a bucket with a specific displacement
+ *
+ * @return true if the bucket was placed, false if a slot collided
+ */
+static bool
+place_bucket(
+    struct bucket const* bucket, //!< bucket to place
+    char* const* names, //!< all the names
+    uint32_t* slots, //!< slots
+    uint32_t size, //!< number of slots
+    uint32_t disp //!< displacement to try
+) {
+    uint32_t i;
+    for (i = 0; i < bucket->num; ++i) {
+        uint32_t name = bucket->names[i];
+        uint32_t slot = ws_command_phash_slot(ws_command_phash(names[name]),
+                                              disp, size);
+        if (slots[slot] != SLOT_FREE) {
+            break;
+        }
+        slots[slot] = name;
+    }
+
+    if (i == bucket->num) {
+        return true;
+    }
+
+    // roll back
+    while (i--) {
+        uint32_t name = bucket->names[i];
+        slots[ws_command_phash_slot(ws_command_phash(names[name]), disp,
+                                    size)] = SLOT_FREE;
+    }
+    return false;
+}
+
+/**
+ * Write a table as C array definition
+ */
+static void
+write_table(
+    FILE* out, //!< output
+    char const* name, //!< name of the table
+    uint32_t const* vals, //!< values
+    uint32_t num //!< number of values
+) {
+    fprintf(out, "uint32_t const %s[] = {", name);
+    for (uint32_t i = 0; i < num; ++i) {
+        fprintf(out, "%s%s%u,", (i % 8) ? "" : "\n", (i % 8) ? " " : "    ",
+                vals[i]);
+    }
+    // C doesn't allow empty arrays
+    fprintf(out, "%s};\n\n", num ? "\n" : " 0 ");
+}
+
+int
+main(
+    int argc,
+    char** argv
+) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <output file> <names...>\n", argv[0]);
+        return 1;
+    }
+
+    char* const* names = argv + 2;
+    uint32_t size = argc - 2;
+    uint32_t num_buckets = size / 2 + 1;
+
+    // distribute the names over the buckets
+    struct bucket* buckets = calloc(num_buckets, sizeof(*buckets));
+    uint32_t* bucket_names = calloc(size + 1, sizeof(*bucket_names));
+    uint32_t* slots = calloc(size + 1, sizeof(*slots));
+    uint32_t* disp = calloc(num_buckets, sizeof(*disp));
+    if (!buckets || !bucket_names || !slots || !disp) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < size; ++i) {
+        for (uint32_t j = 0; j < i; ++j) {
+            if (strcmp(names[i], names[j]) == 0) {
+                fprintf(stderr, "Duplicate command: %s\n", names[i]);
+                return 1;
+            }
+        }
+        uint32_t b = ws_command_phash_bucket(ws_command_phash(names[i]),
+                                             num_buckets);
+        ++buckets[b].num;
+        slots[i] = SLOT_FREE;
+    }
+
+    uint32_t offset = 0;
+    for (uint32_t b = 0; b < num_buckets; ++b) {
+        buckets[b].index = b;
+        buckets[b].names = bucket_names + offset;
+        offset += buckets[b].num;
+        buckets[b].num = 0;
+    }
+
+    for (uint32_t i = 0; i < size; ++i) {
+        struct bucket* bucket = buckets +
+            ws_command_phash_bucket(ws_command_phash(names[i]), num_buckets);
+        bucket->names[bucket->num++] = i;
+    }
+
+    // place the big buckets first, while there are still many free slots
+    qsort(buckets, num_buckets, sizeof(*buckets), bucket_cmp);
+
+    for (uint32_t b = 0; b < num_buckets && buckets[b].num; ++b) {
+        uint32_t d;
+        for (d = 1; d < MAX_DISPLACEMENT; ++d) {
+            if (place_bucket(buckets + b, names, slots, size, d)) {
+                break;
+            }
+        }
+        if (d == MAX_DISPLACEMENT) {
+            fprintf(stderr, "Could not find a perfect hash\n");
+            return 1;
+        }
+        disp[buckets[b].index] = d;
+    }
+
+    // write the tables
+    FILE* out = fopen(argv[1], "w");
+    if (!out) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    fprintf(out, "/* Generated by phash_gen, do not edit */\n\n");
+    fprintf(out, "#include \"command/phash.h\"\n\n");
+    fprintf(out, "uint32_t const ws_command_phash_buckets = %u;\n\n",
+            num_buckets);
+    fprintf(out, "uint32_t const ws_command_phash_size = %u;\n\n", size);
+    write_table(out, "ws_command_phash_disp", disp, num_buckets);
+    write_table(out, "ws_command_phash_slots", slots, size);
+
+    if (fclose(out) != 0) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    free(disp);
+    free(slots);
+    free(bucket_names);
+    free(buckets);
+    return 0;
+}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
@@ -0,0 +1,157 @@
+/* waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <errno.h>
+#include <stdbool.h>
+
+#include "command/set.h"
+
+#include "command/util.h"
+#include "objects/set.h"
+#include "values/bool.h"
+#include "values/set.h"
+#include "values/union.h"
+#include "values/value.h"
+#include "values/value_type.h"
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Fold all the set arguments into a new set using an in-place set operation
+ *
+ * The first set is copied into the result, which is then combined with each of
+ * the following sets using `op`. On success, `args` is replaced by the result.
+ *
+ * @return zero on success, else negative error code from errno.h
+ */
+static int
+fold_sets(
+    union ws_value_union* args, //!< arguments passed to the command
+    int (*op)(struct ws_set*, struct ws_set const*) //!< in-place operation
+);
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+int
+ws_builtin_cmd_set_union(
+    union ws_value_union* args
+) {
+    return fold_sets(args, ws_set_union_inplace);
+}
+
+int
+ws_builtin_cmd_set_intersection(
+    union ws_value_union* args
+) {
+    return fold_sets(args, ws_set_intersection_inplace);
+}
+
+int
+ws_builtin_cmd_set_xor(
+    union ws_value_union* args
+) {
+    return fold_sets(args, ws_set_xor_inplace);
+}
+
+int
+ws_builtin_cmd_set_is_subset(
+    union ws_value_union* args
+) {
+    if (ws_value_get_type(&args->value) != WS_VALUE_TYPE_SET ||
+            ws_value_get_type(&args[1].value) != WS_VALUE_TYPE_SET) {
+        return -EINVAL;
+    }
+
+    if (ws_value_get_type(&args[2].value) != WS_VALUE_TYPE_NONE) {
+        return -E2BIG;
+    }
+
+    // `set_is_subset a b` checks whether `a` is a subset of `b`
+    bool is_subset = ws_set_is_subset(args[1].set.set, args->set.set);
+
+    ws_value_union_reinit(args, WS_VALUE_TYPE_BOOL);
+    ws_value_bool_set(&args->bool_, is_subset);
+
+    return 0;
+}
+
+/*
+ *
+ * Static function implementations
+ *
+ */
+
+static int
+fold_sets(
+    union ws_value_union* args,
+    int (*op)(struct ws_set*, struct ws_set const*)
+) {
+    union ws_value_union* it;
+    struct ws_set* val;
+
+    if (ws_value_get_type(&args->value) != WS_VALUE_TYPE_SET) {
+        return -EINVAL;
+    }
+
+    // the arguments' sets may be shared, so we build a new one
+    struct ws_set* res = ws_set_new();
+    if (!res) {
+        return -ENOMEM;
+    }
+
+    int retval = ws_set_union_inplace(res, args->set.set);
+
+    ITERATE_ARGS_TYPE(it, args + 1, val, set) {
+        if (retval >= 0) {
+            retval = op(res, val);
+        }
+        ws_object_unref(&val->obj);
+    }
+
+    if (retval >= 0 && !AT_END(it)) {
+        retval = -EINVAL;
+    }
+
+    if (retval < 0) {
+        ws_object_unref(&res->obj);
+        return retval;
+    }
+
+    ws_value_deinit(&args->value);
+    ws_value_set_init_set(&args->set, res);
+    ws_object_unref(&res->obj);
+
+    return 0;
+}
@@ -29,6 +29,7 @@
 
 #include "command/command.h"
 #include "command/statement.h"
+#include "util/slab.h"
 #include "values/value.h"
 
 /*
@@ -115,7 +116,7 @@ ws_statement_deinit(
     while (self->args.num--) {
         if (self->args.vals[self->args.num].type == direct) {
             ws_value_deinit(self->args.vals[self->args.num].arg.val);
-            free(self->args.vals[self->args.num].arg.val);
+            ws_slab_release(self->args.vals[self->args.num].arg.val);
         }
     }
 
@@ -134,6 +134,10 @@ __ws_nonnull__(1, 2)
 /**
  * Add a direct argument to a statement
  *
+ * The statement takes ownership of the value, which is released via
+ * `ws_slab_release()`. It must be allocated using `ws_value_union_alloc()` or
+ * `malloc()` and friends.
+ *
  * @return 0 if the operation was successful, a negative error value otherwise
  */
 int
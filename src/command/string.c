@@ -62,22 +62,31 @@ ws_builtin_cmd_strcat(
 ) {
     union ws_value_union* it;
     struct ws_string* val;
-    struct ws_string* res = args->string.str;
+
+    // the arguments' strings may be shared, so we build a new one
+    struct ws_string* res = ws_string_new();
+    if (!res) {
+        return -ENOMEM;
+    }
 
     //iterate over all arguments, checking whether they are ws_value_strings
     ITERATE_ARGS_TYPE(it, args, val, string) {
-        res = ws_string_cat(res, val);
-        if (!res) {
+        struct ws_string* cat = ws_string_cat(res, val);
+        ws_object_unref(&val->obj);
+        if (!cat) {
+            ws_object_unref(&res->obj);
             return -ENOMEM;
         }
     }
 
     if (!AT_END(it)) {
+        ws_object_unref(&res->obj);
         return -EINVAL;
     }
 
     ws_value_union_reinit(args, WS_VALUE_TYPE_STRING);
     ws_value_string_set_str(&args->string, res);
+    ws_object_unref(&res->obj);
 
     return 0;
 }
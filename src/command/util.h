@@ -73,6 +73,8 @@
 #define WS_VALUE_TYPE_string    WS_VALUE_TYPE_STRING
 #define WS_VALUE_TYPE_object_id WS_VALUE_TYPE_OBJECT_ID
 #define WS_VALUE_TYPE_set       WS_VALUE_TYPE_SET
+#define WS_VALUE_TYPE_table     WS_VALUE_TYPE_TABLE
+#define WS_VALUE_TYPE_ordered_set WS_VALUE_TYPE_ORDERED_SET
 
 
 /**
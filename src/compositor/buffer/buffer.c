@@ -30,6 +30,7 @@
 
 #include "compositor/buffer/buffer.h"
 #include "compositor/internal_context.h"
+#include "trace/module.h"
 #include "util/arithmetical.h"
 #include "util/egl.h"
 
@@ -237,10 +238,12 @@ ws_buffer_blit(
 
     int stride_dst = ws_buffer_stride(dest);
     int stride_src = ws_buffer_stride(src);
+    ws_trace_begin(WS_TRACE_EVENT_BLIT, (uintptr_t) dest, min_x * min_y);
     for (int y = 0; y < min_y; ++y) {
         memcpy(((char*) buf_dst) + (y * stride_dst),
                 ((char*) buf_src) + (y * stride_src),
                 min_x
         );
     }
+    ws_trace_end(WS_TRACE_EVENT_BLIT, (uintptr_t) dest, min_x * min_y);
 }
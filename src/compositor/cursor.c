@@ -30,6 +30,8 @@
 #include <wayland-server.h>
 #include <xf86drmMode.h>
 
+#include "connection/event_ring.h"
+#include "connection/hub.h"
 #include "objects/object.h"
 #include "util/arithmetical.h"
 
@@ -191,6 +193,16 @@ ws_cursor_set_active_surface(
     }
 
     ws_wayland_release_display();
+
+    struct ws_event_record rec = {
+        .type   = WS_EVENT_RECORD_FOCUS_POINTER,
+        .obj    = self->active_surface ?
+                  ws_object_uuid(&self->active_surface->wl_obj.obj) : 0,
+    };
+    ws_event_ring_push(&rec);
+
+    ws_connection_hub_emit("focus.mouse", self->active_surface ?
+                           &self->active_surface->wl_obj.obj : NULL);
     return true;
 }
 
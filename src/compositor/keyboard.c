@@ -38,6 +38,8 @@
 #include <wayland-server-protocol.h>
 #include <xkbcommon/xkbcommon.h>
 
+#include "connection/event_ring.h"
+#include "connection/hub.h"
 #include "objects/object.h"
 #include "objects/wayland_obj.h"
 #include "compositor/keyboard.h"
@@ -459,6 +461,15 @@ ws_keyboard_set_active_surface(
         ws_keyboard_send_enter(self);
     }
 
+    struct ws_event_record rec = {
+        .type   = WS_EVENT_RECORD_FOCUS_KEYBOARD,
+        .obj    = self->active_surface ?
+                  ws_object_uuid(&self->active_surface->wl_obj.obj) : 0,
+    };
+    ws_event_ring_push(&rec);
+
+    ws_connection_hub_emit("focus.keyboard", self->active_surface ?
+                           &self->active_surface->wl_obj.obj : NULL);
     return true;
 }
 
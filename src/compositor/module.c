@@ -51,6 +51,7 @@
 #include "compositor/wayland/compositor.h"
 #include "compositor/wayland/shell.h"
 #include "compositor/wayland/xdg_shell.h"
+#include "connection/hub.h"
 #include "logger/module.h"
 #include "util/cleaner.h"
 #include "util/egl.h"
@@ -348,6 +349,7 @@ find_connector_with_crtc(
     struct ws_monitor dummy;
     memset(&dummy, 0, sizeof(dummy));
     dummy.obj.id = &WS_OBJECT_TYPE_ID_MONITOR;
+    dummy.obj.settings = WS_OBJECT_CONFINED;
     dummy.crtc = crtc;
     dummy.fb_dev = ws_comp_ctx.fb;
     return (struct ws_monitor*) ws_set_get(&ws_comp_ctx.monitors,
@@ -488,6 +490,7 @@ populate_connectors(void) {
 insert:
         new_monitor->id = i;
         ws_set_insert(&ws_comp_ctx.monitors, &new_monitor->obj);
+        ws_connection_hub_emit("monitor.add", &new_monitor->obj);
     }
     return 0;
 }
@@ -43,6 +43,7 @@
 #include "compositor/monitor.h"
 #include "logger/module.h"
 #include "objects/object.h"
+#include "trace/module.h"
 #include "util/wayland.h"
 
 static struct ws_logger_context log_ctx = { .prefix = "[Compositor/Monitor] " };
@@ -188,8 +189,9 @@ ws_monitor_populate_fb(
     if (ret) {
         ws_log(&log_ctx, LOG_ERR, "Could not set the CRTC for self %d.",
                 self->crtc);
+        return;
     }
-    return;
+    ws_trace_instant(WS_TRACE_EVENT_PAGE_FLIP, self->crtc, self->buffer->fb);
 }
 
 void
@@ -200,6 +202,7 @@ ws_monitor_set_mode_with_id(
     struct ws_monitor_mode mode;
     memset(&mode, 0, sizeof(mode));
     mode.obj.id = &WS_OBJECT_TYPE_ID_MONITOR_MODE;
+    mode.obj.settings = WS_OBJECT_CONFINED;
     mode.id = id;
     self->current_mode =
         (struct ws_monitor_mode*) ws_set_get(
@@ -91,6 +91,7 @@ ws_wayland_client_get(
     memset(&dum, 0, sizeof(dum));
     ws_object_init(&dum.obj);
     dum.obj.id = &WS_OBJECT_TYPE_ID_WAYLAND_CLIENT;
+    dum.obj.settings |= WS_OBJECT_CONFINED;
     dum.client = c;
 
     struct ws_wayland_client* found;
@@ -37,7 +37,9 @@
 #include "compositor/wayland/client.h"
 #include "compositor/wayland/region.h"
 #include "compositor/wayland/surface.h"
+#include "connection/hub.h"
 #include "objects/set.h"
+#include "trace/module.h"
 #include "util/wayland.h"
 
 /**
@@ -262,6 +264,7 @@ ws_surface_new(
     // initialize the members
     ws_wayland_buffer_init(&self->img_buf, NULL);
 
+    ws_connection_hub_emit("surface.create", &self->wl_obj.obj);
     return self;
 
 cleanup_surface:
@@ -388,6 +391,9 @@ surface_commit_cb(
         return;
     }
 
+    ws_trace_begin(WS_TRACE_EVENT_SURFACE_COMMIT,
+                   wl_resource_get_id(resource), 0);
+
     ws_buffer_transfer2texture(ws_wayland_buffer_get_buffer(&s->img_buf),
                                &s->texture);
 
@@ -398,12 +404,17 @@ surface_commit_cb(
     if (s->frame_callback) {
         wl_callback_send_done(s->frame_callback,
                                 clock() / (CLOCKS_PER_SEC/1000));
+        ws_trace_instant(WS_TRACE_EVENT_FRAME_DONE,
+                         wl_resource_get_id(resource), 0);
         wl_resource_destroy(s->frame_callback);
         s->frame_callback = NULL;
     }
 
     ws_wayland_buffer_release(&s->img_buf);
 
+    ws_trace_end(WS_TRACE_EVENT_SURFACE_COMMIT,
+                 wl_resource_get_id(resource), 0);
+
 }
 
 static int
@@ -477,6 +488,8 @@ resource_destroy(
         ws_cursor_set_image(cursor, NULL);
     }
 
+    ws_connection_hub_emit("surface.destroy", &surface->wl_obj.obj);
+
     // invalidate
     ws_object_lock_write(&surface->wl_obj.obj);
     surface->wl_obj.resource = NULL;
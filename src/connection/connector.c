@@ -27,6 +27,8 @@
 
 #include <errno.h>
 #include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
 #include <unistd.h>
 
 #include "connection/connector.h"
@@ -35,6 +37,17 @@
 
 #define BUFFSIZE 4096
 
+/**
+ * Write the output buffer, passing the attached file descriptors along
+ *
+ * @return number of bytes written, -1 on failure (setting `errno`)
+ */
+static ssize_t
+connector_send_fds(
+    struct ws_connector* self, //!< The connector object itself
+    size_t len //!< number of bytes to write
+);
+
 int
 ws_connector_init(
     struct ws_connector* self,
@@ -53,6 +66,7 @@ ws_connector_init(
 
     self->readonly = false;
     self->fd = fd;
+    self->fds_num = 0;
 
     return 0;
 }
@@ -69,6 +83,7 @@ int ws_connector_init_readonly(
 
     self->readonly = true;
     self->fd = fd;
+    self->fds_num = 0;
 
     return 0;
 }
@@ -86,6 +101,10 @@ ws_connector_deinit(
     if (self->fd >= 0) {
         close(self->fd);
     }
+
+    while (self->fds_num > 0) {
+        close(self->fds[--self->fds_num]);
+    }
 }
 
 int
@@ -127,18 +146,81 @@ ws_connector_flush(
         return -1;
     }
 
-    size_t used_mem = self->outbuf.data;
-    int res;
+    size_t used_mem = ws_connbuf_data(&self->outbuf);
+    if (used_mem == 0) {
+        // nothing to do
+        return 0;
+    }
 
-    res = write(self->fd, self->outbuf.buffer, used_mem);
+    ssize_t res;
+    if (self->fds_num > 0) {
+        res = connector_send_fds(self, used_mem);
+    } else {
+        res = write(self->fd, self->outbuf.buffer, used_mem);
+    }
     if (res < 0 ) {
         return -errno;
     }
 
-    res = ws_connbuf_discard(&self->outbuf, used_mem);
-    if (res != 0) {
-        return res;
+    // only discard what was actually written
+    if (res > 0) {
+        int discarded = ws_connbuf_discard(&self->outbuf, res);
+        if (discarded != 0) {
+            return discarded;
+        }
+    }
+
+    return ((size_t) res < used_mem) ? -EAGAIN : 0;
+}
+
+int
+ws_connector_attach_fd(
+    struct ws_connector* self,
+    int fd
+){
+    if (self->readonly || (self->fds_num >= WS_CONNECTOR_MAX_FDS)) {
+        close(fd);
+        return -ENOBUFS;
     }
 
+    self->fds[self->fds_num++] = fd;
     return 0;
 }
+
+static ssize_t
+connector_send_fds(
+    struct ws_connector* self,
+    size_t len
+){
+    char control[CMSG_SPACE(sizeof(self->fds))];
+    memset(control, 0, sizeof(control));
+
+    struct iovec iov = {
+        .iov_base   = self->outbuf.buffer,
+        .iov_len    = len,
+    };
+    struct msghdr msg = {
+        .msg_iov        = &iov,
+        .msg_iovlen     = 1,
+        .msg_control    = control,
+        .msg_controllen = CMSG_SPACE(sizeof(int) * self->fds_num),
+    };
+
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level    = SOL_SOCKET;
+    cmsg->cmsg_type     = SCM_RIGHTS;
+    cmsg->cmsg_len      = CMSG_LEN(sizeof(int) * self->fds_num);
+    memcpy(CMSG_DATA(cmsg), self->fds, sizeof(int) * self->fds_num);
+
+    ssize_t res = sendmsg(self->fd, &msg, MSG_NOSIGNAL);
+    if (res < 0) {
+        return res;
+    }
+
+    // the peer holds its own copies now
+    while (self->fds_num > 0) {
+        close(self->fds[--self->fds_num]);
+    }
+
+    return res;
+}
@@ -40,6 +40,11 @@
 
 #include "connection/connbuf.h"
 
+/**
+ * Maximum number of file descriptors which may be attached to a connector
+ */
+#define WS_CONNECTOR_MAX_FDS 4
+
 /**
  * Connector
  *
@@ -61,6 +66,9 @@
  * That call will try to `write()` the buffered data to the file descriptor
  * passed and discard the data written, making room for more data.
  *
+ * File descriptors may be passed to the peer by attaching them using
+ * `ws_connector_attach_fd()`. They are sent along with the next flush.
+ *
  * A connection may be read-only.
  * A read-only connection holds an uninitialized `outbuf` which it will not use.
  * E.g. `ws_connector_flush()` will fail on a read-only connection.
@@ -71,6 +79,8 @@ struct ws_connector {
     struct ws_connbuf outbuf; /**!< @public buffer for data
                                 * to be written in next flush*/
     bool readonly; //!< @protected Is the connector read-only?
+    int fds[WS_CONNECTOR_MAX_FDS]; //!< @protected fds to pass on next flush
+    size_t fds_num; //!< @protected number of fds to pass
 };
 
 /**
@@ -124,12 +134,35 @@ ws_connector_read(
     struct ws_connector* self
 );
 
+/**
+ * Attach a file descriptor to be passed to the peer
+ *
+ * The file descriptor is sent (as `SCM_RIGHTS` ancillary data) along with the
+ * data written by the next flush and closed afterwards.
+ *
+ * @memberof ws_connector
+ *
+ * @note the connector takes ownership of the file descriptor, even on failure
+ *
+ * @return zero on success, else negative error code from errno.h
+ */
+int
+ws_connector_attach_fd(
+    struct ws_connector* self, //!< The connector object itself
+    int fd //!< File descriptor to pass
+);
+
 /**
  * Write data from output buffer which is then emptied
  *
+ * All the data buffered is written with a single `write()`. Only the data
+ * actually written is discarded from the output buffer. Attached file
+ * descriptors are sent with the data.
+ *
  * @memberof ws_connector
  *
- * @return zero on succes, else -1 or negative error code from errno.h
+ * @return zero if the buffer was flushed completely, `-EAGAIN` if data is left
+ *         in the buffer, else -1 or negative error code from errno.h
  */
 int
 ws_connector_flush(
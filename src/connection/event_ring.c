@@ -0,0 +1,402 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <ev.h>
+#include <fcntl.h>
+#include <linux/memfd.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "connection/event_ring.h"
+#include "logger/module.h"
+#include "util/cleaner.h"
+
+/**
+ * Number of records in the ring, must be a power of two
+ */
+#define EVENT_RING_CAPACITY 4096
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Create the ring
+ *
+ * @return 0 on success, a negative error code otherwise
+ */
+static int
+event_ring_create(void);
+
+/**
+ * Destroy the ring
+ */
+static void
+event_ring_destroy(
+    void* dummy
+);
+
+/**
+ * Register the eventfd of a new reader
+ *
+ * @return 0 on success, a negative error code otherwise
+ */
+static int
+event_ring_subscribe(
+    int reader //!< our end of the reader's eventfd
+);
+
+/**
+ * Wake up readers, if records were written since the last wakeup
+ */
+static void
+event_ring_notify(
+    struct ev_loop* loop, //!< loop on which the callback was called
+    ev_prepare* watcher, //!< watcher which triggered the update
+    int revents //!< events
+);
+
+/*
+ *
+ * Internal variables
+ *
+ */
+
+static struct {
+    struct ws_event_ring_header* header; //!< mapped ring, `NULL` if not created
+    struct ws_event_record* records; //!< records following the header
+    size_t size; //!< size of the mapping
+    int memfd; //!< file descriptor of the ring memory
+    ev_prepare notifier; //!< watcher for waking up readers
+    bool pending; //!< flag indicating whether records were written
+    pthread_mutex_t lock; //!< lock for the members below
+    int* readers; //!< eventfds for waking up readers, one per reader
+    size_t readers_num; //!< number of readers
+    size_t readers_cap; //!< number of eventfds `readers` has room for
+} ring = { .memfd = -1, .lock = PTHREAD_MUTEX_INITIALIZER };
+
+static struct ws_logger_context log_ctx = {
+    .prefix = "[Connection/EventRing] ",
+};
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+int
+ws_event_ring_open(
+    int* memfd,
+    int* wakefd
+) {
+    int res;
+
+    if (!ring.header) {
+        res = event_ring_create();
+        if (res < 0) {
+            return res;
+        }
+    }
+
+    // hand out a read-only descriptor, so clients can't scribble on the ring
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/fd/%d", ring.memfd);
+    *memfd = open(path, O_RDONLY | O_CLOEXEC);
+    if (*memfd < 0) {
+        return -errno;
+    }
+
+    // an eventfd is a single counter, so every reader needs one of its own
+    int reader = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (reader < 0) {
+        res = -errno;
+        goto cleanup_memfd;
+    }
+
+    *wakefd = fcntl(reader, F_DUPFD_CLOEXEC, 0);
+    if (*wakefd < 0) {
+        res = -errno;
+        goto cleanup_reader;
+    }
+
+    res = event_ring_subscribe(reader);
+    if (res < 0) {
+        goto cleanup_wakefd;
+    }
+
+    return reader;
+
+cleanup_wakefd:
+    close(*wakefd);
+
+cleanup_reader:
+    close(reader);
+
+cleanup_memfd:
+    close(*memfd);
+    return res;
+}
+
+void
+ws_event_ring_close(
+    int reader
+) {
+    pthread_mutex_lock(&ring.lock);
+    for (size_t i = 0; i < ring.readers_num; ++i) {
+        if (ring.readers[i] == reader) {
+            ring.readers[i] = ring.readers[--ring.readers_num];
+            break;
+        }
+    }
+    pthread_mutex_unlock(&ring.lock);
+
+    close(reader);
+}
+
+void
+ws_event_ring_push(
+    struct ws_event_record* rec
+) {
+    if (!ring.header) {
+        // nobody is listening
+        return;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    rec->time = (uint64_t) now.tv_sec * 1000000 + now.tv_nsec / 1000;
+
+    uint64_t head = ring.header->head;
+    struct ws_event_record* slot;
+    slot = ring.records + (head & (EVENT_RING_CAPACITY - 1));
+
+    // invalidate the slot while we write it, so readers notice
+    __atomic_store_n(&slot->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    rec->seq = 0;
+    memcpy(slot, rec, sizeof(*slot));
+
+    __atomic_store_n(&slot->seq, head + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring.header->head, head + 1, __ATOMIC_RELEASE);
+
+    ring.pending = true;
+}
+
+int
+ws_event_ring_read(
+    struct ws_event_ring_header const* hdr,
+    uint64_t* cursor,
+    struct ws_event_record* rec
+) {
+    struct ws_event_record const* records;
+    records = (struct ws_event_record const*) (hdr + 1);
+    uint64_t mask = hdr->capacity - 1;
+    uint16_t flags = 0;
+
+    while (1) {
+        uint64_t head = __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE);
+        if (*cursor >= head) {
+            return -EAGAIN;
+        }
+
+        // skip the records which were overwritten already
+        if (head - *cursor > hdr->capacity) {
+            *cursor = head - hdr->capacity;
+            flags |= WS_EVENT_RECORD_FLAG_LOST;
+        }
+
+        struct ws_event_record const* slot = records + (*cursor & mask);
+        uint64_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        memcpy(rec, slot, sizeof(*rec));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+        if ((seq != *cursor + 1) ||
+                (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != seq)) {
+            // the writer lapped us while we were reading
+            ++*cursor;
+            flags |= WS_EVENT_RECORD_FLAG_LOST;
+            continue;
+        }
+
+        rec->flags |= flags;
+        ++*cursor;
+        return 0;
+    }
+}
+
+/*
+ *
+ * static function implementations
+ *
+ */
+
+static int
+event_ring_create(void)
+{
+    int res;
+
+    ring.size = sizeof(*ring.header) +
+                EVENT_RING_CAPACITY * sizeof(*ring.records);
+
+    ring.memfd = syscall(SYS_memfd_create, "waysome-events", MFD_CLOEXEC);
+    if (ring.memfd < 0) {
+        res = -errno;
+        goto out;
+    }
+
+    if (ftruncate(ring.memfd, ring.size) < 0) {
+        res = -errno;
+        goto cleanup_memfd;
+    }
+
+    void* mem = mmap(NULL, ring.size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                     ring.memfd, 0);
+    if (mem == MAP_FAILED) {
+        res = -errno;
+        goto cleanup_memfd;
+    }
+
+    res = ws_cleaner_add(event_ring_destroy, &ring);
+    if (res < 0) {
+        goto cleanup_mem;
+    }
+
+    // the memory is zero-filled, so only the header needs to be set up
+    ring.header                 = mem;
+    ring.header->magic          = WS_EVENT_RING_MAGIC;
+    ring.header->version        = WS_EVENT_RING_VERSION;
+    ring.header->record_size    = sizeof(*ring.records);
+    ring.header->capacity       = EVENT_RING_CAPACITY;
+    ring.records                = (struct ws_event_record*) (ring.header + 1);
+    ring.pending                = false;
+
+    ev_prepare_init(&ring.notifier, event_ring_notify);
+    ev_prepare_start(ev_default_loop(EVFLAG_AUTO), &ring.notifier);
+
+    ws_log(&log_ctx, LOG_DEBUG, "Created event ring with %d records",
+           EVENT_RING_CAPACITY);
+    return 0;
+
+cleanup_mem:
+    munmap(mem, ring.size);
+
+cleanup_memfd:
+    close(ring.memfd);
+    ring.memfd = -1;
+
+out:
+    ws_log(&log_ctx, LOG_ERR, "Could not create event ring");
+    return res;
+}
+
+static void
+event_ring_destroy(
+    void* dummy
+) {
+    if (!ring.header) {
+        return;
+    }
+
+    ev_prepare_stop(ev_default_loop(EVFLAG_AUTO), &ring.notifier);
+
+    munmap(ring.header, ring.size);
+    ring.header = NULL;
+    ring.records = NULL;
+
+    close(ring.memfd);
+    ring.memfd = -1;
+
+    pthread_mutex_lock(&ring.lock);
+    while (ring.readers_num > 0) {
+        close(ring.readers[--ring.readers_num]);
+    }
+    free(ring.readers);
+    ring.readers = NULL;
+    ring.readers_cap = 0;
+    pthread_mutex_unlock(&ring.lock);
+}
+
+static int
+event_ring_subscribe(
+    int reader
+) {
+    int res = 0;
+
+    pthread_mutex_lock(&ring.lock);
+    if (ring.readers_num >= ring.readers_cap) {
+        size_t cap = ring.readers_cap ? ring.readers_cap * 2 : 4;
+        int* readers = realloc(ring.readers, cap * sizeof(*readers));
+        if (!readers) {
+            res = -ENOMEM;
+            goto out;
+        }
+
+        ring.readers = readers;
+        ring.readers_cap = cap;
+    }
+
+    ring.readers[ring.readers_num++] = reader;
+
+out:
+    pthread_mutex_unlock(&ring.lock);
+    return res;
+}
+
+static void
+event_ring_notify(
+    struct ev_loop* loop,
+    ev_prepare* watcher,
+    int revents
+) {
+    if (!ring.pending) {
+        return;
+    }
+    ring.pending = false;
+
+    // never block, readers will find their counter non-zero anyway
+    uint64_t one = 1;
+    pthread_mutex_lock(&ring.lock);
+    for (size_t i = 0; i < ring.readers_num; ++i) {
+        if (write(ring.readers[i], &one, sizeof(one)) < 0 && errno != EAGAIN) {
+            ws_log(&log_ctx, LOG_ERR, "Could not wake up reader");
+        }
+    }
+    pthread_mutex_unlock(&ring.lock);
+}
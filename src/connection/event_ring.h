@@ -0,0 +1,205 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @addtogroup connection "Connection"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup connection_event_ring "Event ring"
+ *
+ * Shared memory stream of input and focus events
+ *
+ * Some clients, e.g. input recorders, want to see every single input event.
+ * Pushing those through the IPC socket would be way too heavy, so we offer a
+ * ring buffer of fixed size binary records in shared memory instead.
+ *
+ * A client obtains the ring by calling the `event_stream` method of its
+ * connection object. Two file descriptors are passed along with the reply
+ * (as `SCM_RIGHTS` ancillary data): a read-only memfd holding the ring and an
+ * eventfd which becomes readable whenever new records were written.
+ *
+ * The ring starts with a `struct ws_event_ring_header`, followed by
+ * `capacity` records of `record_size` bytes each. The header's `head` holds
+ * the number of records written so far. Record number `n` lives in slot
+ * `n % capacity` and carries `n + 1` as its sequence number once written
+ * completely (0 while being written).
+ *
+ * The compositor never waits for readers. A reader which falls behind more
+ * than `capacity` records loses the oldest records. `ws_event_ring_read()`
+ * detects this and flags the first record after the gap with
+ * `WS_EVENT_RECORD_FLAG_LOST`.
+ *
+ * @{
+ */
+
+#ifndef __WS_CONNECTION_EVENT_RING_H__
+#define __WS_CONNECTION_EVENT_RING_H__
+
+#include <stdint.h>
+
+#include "util/attributes.h"
+
+/**
+ * Magic number at the start of the ring ("WSER")
+ */
+#define WS_EVENT_RING_MAGIC 0x57534552
+
+/**
+ * Version of the ring layout
+ */
+#define WS_EVENT_RING_VERSION 1
+
+/**
+ * Type of an event record
+ */
+enum ws_event_record_type {
+    WS_EVENT_RECORD_NONE = 0, //!< invalid record
+    WS_EVENT_RECORD_POINTER_MOTION, //!< cursor moved, see `x` and `y`
+    WS_EVENT_RECORD_POINTER_BUTTON, //!< button `code` changed to `value`
+    WS_EVENT_RECORD_KEY, //!< key `code` changed to `value`
+    WS_EVENT_RECORD_FOCUS_POINTER, //!< pointer focus moved to `obj`
+    WS_EVENT_RECORD_FOCUS_KEYBOARD, //!< keyboard focus moved to `obj`
+};
+
+/**
+ * Flags of an event record
+ */
+enum ws_event_record_flags {
+    WS_EVENT_RECORD_FLAG_LOST = 1 << 0, //!< records before this were lost
+};
+
+/**
+ * Header of the ring
+ */
+struct ws_event_ring_header {
+    uint32_t magic; //!< `WS_EVENT_RING_MAGIC`
+    uint32_t version; //!< `WS_EVENT_RING_VERSION`
+    uint32_t record_size; //!< size of a single record
+    uint32_t capacity; //!< number of records in the ring, a power of two
+    uint64_t reserved[6]; //!< padding, keeps `head` on its own cache line
+    uint64_t head; //!< number of records written
+    uint64_t reserved_[7]; //!< padding
+};
+
+/**
+ * Event record
+ */
+struct ws_event_record {
+    uint64_t seq; //!< sequence number + 1, 0 while written
+    uint64_t time; //!< time of the event, monotonic clock, in microseconds
+    uint16_t type; //!< type, see `enum ws_event_record_type`
+    uint16_t flags; //!< flags, see `enum ws_event_record_flags`
+    uint32_t code; //!< key or button code
+    int32_t value; //!< key or button state
+    int32_t x; //!< cursor position
+    int32_t y; //!< cursor position
+    uint32_t reserved; //!< padding
+    uint64_t obj; //!< UUID of the object focused, if any
+};
+
+/**
+ * Get file descriptors for the ring, creating it if necessary
+ *
+ * The ring is only created once the first client asks for it, so there's no
+ * cost at all as long as nobody is interested.
+ *
+ * Every call registers a new reader with an eventfd of its own. The reader
+ * must be unregistered using `ws_event_ring_close()` once it's gone.
+ *
+ * @note the caller owns the file descriptors returned via `memfd` and `wakefd`
+ *
+ * @warning may only be called from the main thread
+ *
+ * @return a non-negative handle for the reader on success, a negative error
+ *         code otherwise
+ */
+int
+ws_event_ring_open(
+    int* memfd, //!< where to put a read-only descriptor of the ring memory
+    int* wakefd //!< where to put the reader's descriptor for wakeups
+)
+__ws_nonnull__(1, 2)
+;
+
+/**
+ * Unregister a reader
+ *
+ * The reader is no longer woken up. Descriptors handed out to it are not
+ * affected.
+ *
+ * @note Threadsafe!
+ */
+void
+ws_event_ring_close(
+    int reader //!< handle returned by `ws_event_ring_open()`
+);
+
+/**
+ * Write a record to the ring
+ *
+ * Sets the sequence number and the time of the record. This function does
+ * nothing if the ring was not created yet. Readers are woken up once per loop
+ * iteration.
+ *
+ * @warning may only be called from the main thread
+ */
+void
+ws_event_ring_push(
+    struct ws_event_record* rec //!< record to write
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Read the next record from a ring
+ *
+ * This function is meant for readers and works on a mapping of the ring.
+ * `cursor` holds the number of the next record to read and is advanced.
+ *
+ * @return 0 if a record was read, `-EAGAIN` if there are no new records
+ */
+int
+ws_event_ring_read(
+    struct ws_event_ring_header const* ring, //!< mapped ring
+    uint64_t* cursor, //!< number of the next record to read
+    struct ws_event_record* rec //!< where to put the record
+)
+__ws_nonnull__(1, 2, 3)
+;
+
+#endif // __WS_CONNECTION_EVENT_RING_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
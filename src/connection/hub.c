@@ -0,0 +1,532 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <fnmatch.h>
+#include <stdlib.h>
+#include <string.h>
+#include <wayland-util.h>
+
+#include "connection/hub.h"
+#include "connection/processor.h"
+#include "logger/module.h"
+#include "objects/message/event.h"
+#include "objects/string.h"
+#include "serialize/json/serializer.h"
+#include "serialize/serialized.h"
+#include "serialize/serializer.h"
+#include "util/arithmetical.h"
+#include "util/string.h"
+#include "values/bool.h"
+#include "values/int.h"
+#include "values/object_id.h"
+#include "values/string.h"
+#include "values/union.h"
+#include "values/value_type.h"
+
+/**
+ * A connection subscribed to events
+ */
+struct subscriber {
+    struct wl_list link; //!< link in the list of subscribers
+    struct ws_connection_processor* proc; //!< connection to deliver events to
+    struct wl_list subscriptions; //!< subscriptions of the connection
+};
+
+/**
+ * A single subscription
+ */
+struct subscription {
+    struct wl_list link; //!< link in the list of the subscriber
+    char* pattern; //!< pattern event names are matched against
+    union ws_value_union filter; //!< filter, `WS_VALUE_TYPE_NONE` for none
+};
+
+/**
+ * Wire format we can serialize events for
+ */
+struct hub_format {
+    char const* name; //!< name of the format
+    struct ws_serializer* (*create)(void); //!< constructor for serializers
+    struct ws_serializer* serializer; //!< serializer used by the hub
+};
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Find the subscriber entry for a connection
+ *
+ * @return the subscriber or `NULL`, if the connection isn't subscribed
+ */
+static struct subscriber*
+find_subscriber(
+    struct ws_connection_processor* proc //!< connection to look up
+);
+
+/**
+ * Remove a subscriber, if it has no subscriptions left
+ */
+static void
+subscriber_cleanup(
+    struct subscriber* sub //!< subscriber to clean up
+);
+
+/**
+ * Check whether any of the subscriptions of a subscriber matches an event
+ */
+static bool
+subscriber_matches(
+    struct subscriber* sub, //!< subscriber to check
+    char const* name, //!< name of the event
+    union ws_value_union* context //!< context of the event
+);
+
+/**
+ * Check whether a context value satisfies a filter
+ */
+static bool
+filter_matches(
+    union ws_value_union* filter, //!< filter
+    union ws_value_union* context //!< context of the event
+);
+
+/**
+ * Destroy a subscription
+ */
+static void
+subscription_destroy(
+    struct subscription* subscription //!< subscription to destroy
+);
+
+/**
+ * Find the index of the format a connection talks
+ *
+ * @return the index in the format table or a negative value
+ */
+static ssize_t
+format_of(
+    struct ws_connection_processor* proc //!< connection
+);
+
+/**
+ * Serialize an event for a format
+ *
+ * @return the serialized event or `NULL` on failure
+ */
+static struct ws_serialized_message*
+serialize_for(
+    size_t format, //!< index of the format
+    struct ws_event* ev //!< event to serialize
+);
+
+/*
+ *
+ * Internal variables
+ *
+ */
+
+static struct hub_format formats[] = {
+    { .name = "json", .create = ws_serializer_json_serializer_new },
+};
+
+static struct {
+    struct wl_list subscribers; //!< all connections subscribed
+    bool is_init; //!< flag indicating whether the hub was initialized
+} hub;
+
+static struct ws_logger_context log_ctx = {
+    .prefix = "[Connection/Hub] ",
+};
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+int
+ws_connection_hub_init(void)
+{
+    if (hub.is_init) {
+        return 0;
+    }
+
+    wl_list_init(&hub.subscribers);
+    hub.is_init = true;
+    return 0;
+}
+
+void
+ws_connection_hub_deinit(void)
+{
+    if (!hub.is_init) {
+        return;
+    }
+
+    struct subscriber* sub;
+    struct subscriber* tmp;
+    wl_list_for_each_safe(sub, tmp, &hub.subscribers, link) {
+        ws_connection_hub_unsubscribe(sub->proc, NULL);
+    }
+
+    for (size_t i = 0; i < ARYLEN(formats); ++i) {
+        if (formats[i].serializer) {
+            ws_serializer_deinit(formats[i].serializer);
+            free(formats[i].serializer);
+            formats[i].serializer = NULL;
+        }
+    }
+
+    hub.is_init = false;
+}
+
+int
+ws_connection_hub_subscribe(
+    struct ws_connection_processor* proc,
+    char const* pattern,
+    union ws_value_union* filter
+) {
+    if (!hub.is_init || !proc->serializer) {
+        // we can't deliver anything to read-only connections
+        return -EINVAL;
+    }
+
+    struct subscription* subscription = calloc(1, sizeof(*subscription));
+    if (!subscription) {
+        return -ENOMEM;
+    }
+
+    subscription->pattern = strdup(pattern);
+    if (!subscription->pattern) {
+        goto cleanup_subscription;
+    }
+
+    if (filter && (ws_value_union_init_from_val(&subscription->filter,
+                                                &filter->value) != 0)) {
+        goto cleanup_pattern;
+    }
+
+    struct subscriber* sub = find_subscriber(proc);
+    if (!sub) {
+        sub = calloc(1, sizeof(*sub));
+        if (!sub) {
+            goto cleanup_filter;
+        }
+
+        sub->proc = getref(proc);
+        wl_list_init(&sub->subscriptions);
+        wl_list_insert(&hub.subscribers, &sub->link);
+    }
+
+    wl_list_insert(sub->subscriptions.prev, &subscription->link);
+    return 0;
+
+cleanup_filter:
+    ws_value_deinit(&subscription->filter.value);
+
+cleanup_pattern:
+    free(subscription->pattern);
+
+cleanup_subscription:
+    free(subscription);
+    return -ENOMEM;
+}
+
+int
+ws_connection_hub_unsubscribe(
+    struct ws_connection_processor* proc,
+    char const* pattern
+) {
+    if (!hub.is_init) {
+        return 0;
+    }
+
+    struct subscriber* sub = find_subscriber(proc);
+    if (!sub) {
+        return 0;
+    }
+
+    struct subscription* subscription;
+    struct subscription* tmp;
+    wl_list_for_each_safe(subscription, tmp, &sub->subscriptions, link) {
+        if (!pattern || ws_streq(subscription->pattern, pattern)) {
+            wl_list_remove(&subscription->link);
+            subscription_destroy(subscription);
+        }
+    }
+
+    subscriber_cleanup(sub);
+    return 0;
+}
+
+bool
+ws_connection_hub_has_subscribers(void)
+{
+    return hub.is_init && !wl_list_empty(&hub.subscribers);
+}
+
+int
+ws_connection_hub_publish(
+    struct ws_event* ev
+) {
+    if (!ws_connection_hub_has_subscribers()) {
+        return 0;
+    }
+
+    char* name = ws_string_raw(&ev->name);
+    if (!name) {
+        return -ENOMEM;
+    }
+
+    // each event is serialized at most once per format
+    struct ws_serialized_message* serialized[ARYLEN(formats)];
+    memset(serialized, 0, sizeof(serialized));
+
+    int res = 0;
+    struct subscriber* sub;
+    wl_list_for_each(sub, &hub.subscribers, link) {
+        if (!subscriber_matches(sub, name, &ev->context)) {
+            continue;
+        }
+
+        ssize_t format = format_of(sub->proc);
+        if (format < 0) {
+            continue;
+        }
+
+        if (!serialized[format]) {
+            serialized[format] = serialize_for(format, ev);
+            if (!serialized[format]) {
+                res = -ENOMEM;
+                continue;
+            }
+        }
+
+        if (ws_connection_processor_post_serialized(sub->proc,
+                                                    serialized[format]) < 0) {
+            ws_log(&log_ctx, LOG_DEBUG, "Dropped event %s for connection %d",
+                   name, sub->proc->conn.fd);
+        }
+    }
+
+    for (size_t i = 0; i < ARYLEN(formats); ++i) {
+        if (serialized[i]) {
+            ws_object_unref(&serialized[i]->obj);
+        }
+    }
+
+    free(name);
+    return res;
+}
+
+int
+ws_connection_hub_emit(
+    char const* name,
+    struct ws_object* obj
+) {
+    // don't bother constructing the event if nobody listens
+    if (!ws_connection_hub_has_subscribers()) {
+        return 0;
+    }
+
+    struct ws_string* str = ws_string_new();
+    if (!str) {
+        return -ENOMEM;
+    }
+
+    int res = ws_string_set_from_raw(str, name);
+    if (res < 0) {
+        goto cleanup_str;
+    }
+
+    struct ws_value_object_id ctx;
+    ws_value_object_id_init(&ctx);
+    if (obj) {
+        ws_value_object_id_set(&ctx, obj);
+    }
+
+    struct ws_event* ev = ws_event_new(str, obj ? &ctx.val : NULL);
+    ws_value_deinit(&ctx.val);
+    if (!ev) {
+        res = -ENOMEM;
+        goto cleanup_str;
+    }
+
+    res = ws_connection_hub_publish(ev);
+    ws_object_unref(&ev->m.obj);
+
+cleanup_str:
+    ws_object_unref(&str->obj);
+    return res;
+}
+
+/*
+ *
+ * static function implementations
+ *
+ */
+
+static struct subscriber*
+find_subscriber(
+    struct ws_connection_processor* proc
+) {
+    struct subscriber* sub;
+    wl_list_for_each(sub, &hub.subscribers, link) {
+        if (sub->proc == proc) {
+            return sub;
+        }
+    }
+
+    return NULL;
+}
+
+static void
+subscriber_cleanup(
+    struct subscriber* sub
+) {
+    if (!wl_list_empty(&sub->subscriptions)) {
+        return;
+    }
+
+    wl_list_remove(&sub->link);
+    ws_object_unref(&sub->proc->obj);
+    free(sub);
+}
+
+static bool
+subscriber_matches(
+    struct subscriber* sub,
+    char const* name,
+    union ws_value_union* context
+) {
+    struct subscription* subscription;
+    wl_list_for_each(subscription, &sub->subscriptions, link) {
+        if ((fnmatch(subscription->pattern, name, 0) == 0) &&
+                filter_matches(&subscription->filter, context)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static bool
+filter_matches(
+    union ws_value_union* filter,
+    union ws_value_union* context
+) {
+    enum ws_value_type type = ws_value_get_type(&filter->value);
+    if (type == WS_VALUE_TYPE_NONE) {
+        // no filter
+        return true;
+    }
+
+    if (type != ws_value_get_type(&context->value)) {
+        return false;
+    }
+
+    switch (type) {
+    case WS_VALUE_TYPE_NIL:
+        return true;
+
+    case WS_VALUE_TYPE_BOOL:
+        return ws_value_bool_get(&filter->bool_) ==
+               ws_value_bool_get(&context->bool_);
+
+    case WS_VALUE_TYPE_INT:
+        return ws_value_int_get(&filter->int_) ==
+               ws_value_int_get(&context->int_);
+
+    case WS_VALUE_TYPE_OBJECT_ID:
+        // compare the identity, no need to grab references
+        return filter->object_id.obj == context->object_id.obj;
+
+    case WS_VALUE_TYPE_STRING:
+        {
+            struct ws_string* a = ws_value_string_get(&filter->string);
+            struct ws_string* b = ws_value_string_get(&context->string);
+            bool retval = a && b && ws_string_equal(a, b);
+            if (a) {
+                ws_object_unref(&a->obj);
+            }
+            if (b) {
+                ws_object_unref(&b->obj);
+            }
+            return retval;
+        }
+
+    default:
+        return false;
+    }
+}
+
+static void
+subscription_destroy(
+    struct subscription* subscription
+) {
+    ws_value_deinit(&subscription->filter.value);
+    free(subscription->pattern);
+    free(subscription);
+}
+
+static ssize_t
+format_of(
+    struct ws_connection_processor* proc
+) {
+    if (!proc->serializer || !proc->serializer->format) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < ARYLEN(formats); ++i) {
+        if (ws_streq(formats[i].name, proc->serializer->format)) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static struct ws_serialized_message*
+serialize_for(
+    size_t format,
+    struct ws_event* ev
+) {
+    struct hub_format* fmt = formats + format;
+
+    if (!fmt->serializer) {
+        fmt->serializer = fmt->create();
+        if (!fmt->serializer) {
+            return NULL;
+        }
+    }
+
+    return ws_serialized_message_new(fmt->serializer, &ev->m);
+}
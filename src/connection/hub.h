@@ -0,0 +1,151 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @addtogroup connection "Connection"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup connection_hub "Event hub"
+ *
+ * Publish/subscribe hub for pushing events to IPC clients
+ *
+ * Connections may subscribe to events using the `subscribe` method of their
+ * connection object, passing an event name pattern (as understood by
+ * `fnmatch()`) and, optionally, a filter value. An event is delivered to a
+ * connection if its name matches any of the connection's patterns and, if a
+ * filter was given, its context equals the filter value.
+ *
+ * An event published is serialized only once per wire format. The serialized
+ * bytes are shared by all the connections the event is delivered to.
+ *
+ * @warning the hub may only be used from the main thread
+ *
+ * @{
+ */
+
+#ifndef __WS_CONNECTION_HUB_H__
+#define __WS_CONNECTION_HUB_H__
+
+#include <stdbool.h>
+
+#include "util/attributes.h"
+
+// forward declarations
+struct ws_connection_processor;
+struct ws_event;
+struct ws_object;
+union ws_value_union;
+
+/**
+ * Initialize the hub
+ *
+ * @return 0 on success, a negative error code otherwise
+ */
+int
+ws_connection_hub_init(void);
+
+/**
+ * Deinitialize the hub, dropping all subscriptions
+ */
+void
+ws_connection_hub_deinit(void);
+
+/**
+ * Subscribe a connection to events
+ *
+ * @return 0 on success, a negative error code otherwise
+ */
+int
+ws_connection_hub_subscribe(
+    struct ws_connection_processor* proc, //!< connection to deliver events to
+    char const* pattern, //!< pattern the event names have to match
+    union ws_value_union* filter //!< value the context must equal, or `NULL`
+)
+__ws_nonnull__(1, 2)
+;
+
+/**
+ * Unsubscribe a connection from events
+ *
+ * Removes all the subscriptions of the connection with the pattern given or,
+ * if `pattern` is `NULL`, all of its subscriptions.
+ *
+ * @return 0 on success, a negative error code otherwise
+ */
+int
+ws_connection_hub_unsubscribe(
+    struct ws_connection_processor* proc, //!< connection to unsubscribe
+    char const* pattern //!< pattern to unsubscribe or `NULL`
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Check whether anyone subscribed to events at all
+ *
+ * This allows publishers to skip constructing events nobody is interested in.
+ */
+bool
+ws_connection_hub_has_subscribers(void);
+
+/**
+ * Publish an event to all subscribed connections
+ *
+ * @return 0 on success, a negative error code otherwise
+ */
+int
+ws_connection_hub_publish(
+    struct ws_event* ev //!< event to publish
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Construct and publish an event, if anybody is subscribed
+ *
+ * @return 0 on success, a negative error code otherwise
+ */
+int
+ws_connection_hub_emit(
+    char const* name, //!< name of the event
+    struct ws_object* obj //!< object to pass as context, may be `NULL`
+)
+__ws_nonnull__(1)
+;
+
+#endif // __WS_CONNECTION_HUB_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
@@ -29,8 +29,11 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "action/memo.h"
+#include "connection/hub.h"
 #include "connection/manager.h"
 #include "connection/processor.h"
+#include "connection/worker.h"
 #include "objects/set.h"
 #include "serialize/deserializer.h"
 #include "serialize/json/deserializer.h"
@@ -96,6 +99,18 @@ ws_connection_manager_init(void)
         return res;
     }
 
+    res = ws_connection_hub_init();
+    if (res != 0) {
+        ws_object_deinit(&connman.connections.obj);
+        return res;
+    }
+
+    res = ws_connection_workers_init();
+    if (res != 0) {
+        ws_object_deinit(&connman.connections.obj);
+        return res;
+    }
+
     // `20` is the hardcoded backlog by now
     res = ws_socket_init(&connman.sock, create_connection_cb, SOCK_NAME, 20);
     if (res != 0 && res != -EADDRINUSE) {
@@ -144,7 +159,14 @@ ws_connection_manager_open_connection(
         goto clean_deser;
     }
 
-    if (ws_connection_processor_start(p) < 0) {
+    // serve the connection on a worker, if we have any
+    struct ws_connection_worker* worker = ws_connection_workers_assign();
+    if (worker) {
+        res = ws_connection_worker_adopt(worker, p);
+    } else {
+        res = ws_connection_processor_start(p);
+    }
+    if (res < 0) {
         goto clean_deser;
     }
 
@@ -164,6 +186,16 @@ ws_connection_manager_close_connection(
     struct ws_connection_processor* proc
 ) {
     ws_connection_processor_close(proc);
+
+    // the set of connections may only be touched from the main thread
+    if (!ws_connection_workers_on_main_thread()) {
+        return ws_connection_worker_handoff(proc, NULL);
+    }
+
+    ws_connection_hub_unsubscribe(proc, NULL);
+
+    // the result cache doesn't keep the connection alive, so it must let go
+    ws_action_memo_forget(&proc->obj);
     return ws_set_remove(&connman.connections, &proc->obj);
 }
 
@@ -178,8 +210,14 @@ static void
 connection_manager_deinit(
     void* dummy
 ) {
+    // the workers must not touch the connections while we tear them down
+    ws_connection_workers_stop();
+
+    ws_connection_hub_deinit();
     ws_object_deinit(&connman.connections.obj);
     ws_socket_deinit(&connman.sock);
+
+    ws_connection_workers_deinit();
 }
 
 int
@@ -67,6 +67,9 @@ ws_connection_manager_open_connection(
  *
  * @note only for internal use
  *
+ * @note if called from a worker thread, the connection is removed by the main
+ *       thread later on
+ *
  * @return zero on success, else negative errno.h number
  */
 int
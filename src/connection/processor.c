@@ -30,20 +30,50 @@
 #include <malloc.h>
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 #include <unistd.h>
 
 #include "action/manager.h"
 #include "connection/connector.h"
+#include "connection/event_ring.h"
+#include "connection/hub.h"
 #include "connection/manager.h"
 #include "connection/processor.h"
+#include "connection/worker.h"
 #include "logger/module.h"
 #include "objects/object.h"
 #include "objects/message/message.h"
 #include "objects/message/reply.h"
+#include "objects/queue.h"
+#include "objects/string.h"
 #include "serialize/deserializer.h"
+#include "serialize/serialized.h"
 #include "serialize/serializer.h"
 #include "util/error.h"
 #include "util/arithmetical.h"
+#include "values/bool.h"
+#include "values/object_id.h"
+#include "values/string.h"
+#include "values/union.h"
+#include "values/value_type.h"
+
+/**
+ * Number of queued replies at which we stop reading from a connection
+ */
+#define REPLY_HIGH_WATER 64
+
+/**
+ * Number of queued replies at which we resume reading from a connection
+ */
+#define REPLY_LOW_WATER 16
+
+/**
+ * Number of queued messages at which we drop events pushed to a connection
+ *
+ * We can't throttle the hub, so a client which doesn't read at all loses its
+ * events instead of making us buffer them indefinitely.
+ */
+#define EVENT_DROP_WATER (4 * REPLY_HIGH_WATER)
 
 /*
  *
@@ -76,16 +106,149 @@ connection_processor_flush(
 );
 
 /**
- * Try to flush the message currently queued
+ * Queue a reply for sending
+ *
+ * The reply is not serialized right away but queued, so all replies resulting
+ * from one batch of incoming messages can be flushed at once.
  *
- * @return 0 if the serializer may now take a new message, a negative error
- *         code on failure, especially `-EAGAIN` if the message was not
- *         flushed.
+ * @note the reference passed in is consumed
+ *
+ * @return 0 on success, a negative error code otherwise
  */
 static int
-connection_processor_flush_msg(
-    struct ws_connection_processor* proc,
-    struct ws_message* message
+connection_processor_queue_reply(
+    struct ws_connection_processor* proc, //!< processor to queue the reply in
+    struct ws_reply* reply //!< reply to queue
+);
+
+/**
+ * Serialize and flush queued replies
+ *
+ * Serializes as many of the queued replies as fit into the output buffer and
+ * writes the entire buffer with a single `write()`, repeating until either
+ * all replies are sent or the connection would block.
+ *
+ * @return 0 if all the replies were flushed, a negative error code on failure,
+ *         especially `-EAGAIN` if data is left to be flushed.
+ */
+static int
+connection_processor_flush_replies(
+    struct ws_connection_processor* proc //!< processor to flush
+);
+
+/**
+ * Serialize queued replies into the output buffer
+ *
+ * @return 0 if all the replies were serialized, `-ENOSPC` if the output buffer
+ *         is full or another negative error code on failure.
+ */
+static int
+connection_processor_serialize_replies(
+    struct ws_connection_processor* proc //!< processor to serialize for
+);
+
+/**
+ * Check whether there's data left to be serialized
+ */
+static bool
+connection_processor_has_pending(
+    struct ws_connection_processor* proc //!< processor to check
+);
+
+/**
+ * Pause or resume reading from the connection, depending on the backlog
+ *
+ * If the number of queued replies reaches `REPLY_HIGH_WATER`, the dispatcher
+ * is stopped until the backlog drops to `REPLY_LOW_WATER` again. This way, a
+ * client which doesn't read its replies can't make us buffer an unbounded
+ * amount of replies.
+ */
+static void
+connection_processor_update_throttle(
+    struct ws_connection_processor* proc //!< processor to update
+);
+
+/**
+ * Copy (part of) the serialized message currently sent to the output buffer
+ *
+ * @return 0 if the message was sent completely, `-ENOSPC` if the output buffer
+ *         is full or another negative error code on failure.
+ */
+static int
+connection_processor_copy_blob(
+    struct ws_connection_processor* proc //!< processor to copy for
+);
+
+/**
+ * Subscribe the connection to events
+ *
+ * @memberof ws_connection_processor
+ *
+ * Takes up to two parameters:
+ *  1) pattern of the event names to subscribe to
+ *  2) (optional) value the context of the events must equal
+ */
+static int
+cmd_func_subscribe(
+    union ws_value_union* stack // The stack to use
+);
+
+/**
+ * Unsubscribe the connection from events
+ *
+ * @memberof ws_connection_processor
+ *
+ * Takes up to one parameter:
+ *  1) (optional) pattern to unsubscribe, all subscriptions are dropped if not
+ *     given
+ */
+static int
+cmd_func_unsubscribe(
+    union ws_value_union* stack // The stack to use
+);
+
+/**
+ * Hand the shared memory event stream to the connection
+ *
+ * @memberof ws_connection_processor
+ *
+ * Takes no parameters. The file descriptors of the event ring are passed
+ * along with the reply.
+ */
+static int
+cmd_func_event_stream(
+    union ws_value_union* stack // The stack to use
+);
+
+/**
+ * Lock a connection processor for being modified from the main thread
+ *
+ * Processors not served by a worker are only ever touched by the main thread,
+ * which may hold their lock already while dispatching. Hence, only processors
+ * served by a worker are actually locked.
+ */
+static void
+connection_processor_lock_foreign(
+    struct ws_connection_processor* proc //!< processor to lock
+);
+
+/**
+ * Unlock a processor locked using `connection_processor_lock_foreign()`
+ */
+static void
+connection_processor_unlock_foreign(
+    struct ws_connection_processor* proc //!< processor to unlock
+);
+
+/**
+ * Get the connection processor and a raw string parameter from a stack
+ *
+ * @return the processor (with a reference) or `NULL` on failure
+ */
+static struct ws_connection_processor*
+cmd_get_proc(
+    union ws_value_union* stack, //!< stack passed to a command function
+    char** pattern //!< where to put the pattern, if any, may be `NULL`
 );
 
 /**
@@ -119,6 +282,16 @@ connection_processor_cmp_callback(
  *
  */
 
+/**
+ * Callback function table for commands
+ */
+static const struct ws_object_function FUNCTIONS[] = {
+    { .name = "subscribe",      .func = cmd_func_subscribe },
+    { .name = "unsubscribe",    .func = cmd_func_unsubscribe },
+    { .name = "event_stream",   .func = cmd_func_event_stream },
+    { .name = NULL,             .func = NULL } // iteration stopper
+};
+
 /**
  * Type information for ws_wayland_obj type
  */
@@ -132,7 +305,7 @@ ws_object_type_id WS_OBJECT_TYPE_ID_COMMAND_PROCESSOR = {
     .uuid_callback = NULL,
 
     .attribute_table = NULL,
-    .function_table = NULL,
+    .function_table = FUNCTIONS,
 };
 
 static struct ws_logger_context log_ctx = {
@@ -187,11 +360,20 @@ ws_connection_processor_new(
     retval->deserializer    = deserializer;
     retval->serializer      = serializer;
 
-    // now get the libev loop
-    struct ev_loop* loop = ev_default_loop(EVFLAG_AUTO);
-    if (!loop) {
+    // initialize the reply queue, replies may be posted from any thread
+    if (ws_queue_init_mpsc(&retval->replies) < 0) {
         goto cleanup_mem;
     }
+    retval->replies_num     = 0;
+    retval->is_throttled    = false;
+    retval->event_ring      = -1;
+
+    // now get the libev loop, a worker may replace it before we're started
+    retval->loop = ev_default_loop(EVFLAG_AUTO);
+    if (!retval->loop) {
+        goto cleanup_mem;
+    }
+    retval->worker = NULL;
 
     if (!getref(retval)) {
         goto cleanup_mem;
@@ -201,10 +383,9 @@ ws_connection_processor_new(
     ev_io_init(&retval->dispatcher, connection_processor_dispatch, fd, EV_READ);
     retval->dispatcher.data = retval;
 
-    if (serializer) {
-        ev_prepare_init(&retval->flusher, connection_processor_flush);
-        retval->flusher.data    = retval;
-    }
+    // even read-only connections need the flusher for resuming after throttle
+    ev_prepare_init(&retval->flusher, connection_processor_flush);
+    retval->flusher.data    = retval;
 
     // return the command processor
     return retval;
@@ -224,13 +405,11 @@ ws_connection_processor_start(
 ) {
     ws_object_lock_write(&conn->obj);
 
-    ev_io_start(EV_DEFAULT_ &conn->dispatcher);
-    if (conn->serializer) {
-        ev_prepare_start(EV_DEFAULT_ &conn->flusher);
-    }
+    ev_io_start(conn->loop, &conn->dispatcher);
+    ev_prepare_start(conn->loop, &conn->flusher);
 
     // mark the object as initialized
-    conn->is_started = true;
+    __atomic_store_n(&conn->is_started, true, __ATOMIC_RELEASE);
 
     ws_object_unlock(&conn->obj);
     return 0;
@@ -243,18 +422,78 @@ ws_connection_processor_close(
     ws_object_lock_write(&conn->obj);
 
     if (conn->is_started) {
-        conn->is_started = false;
+        __atomic_store_n(&conn->is_started, false, __ATOMIC_RELEASE);
 
-        ev_io_stop(EV_DEFAULT_ &conn->dispatcher);
-        if (conn->serializer) {
-            ev_prepare_start(EV_DEFAULT_ &conn->flusher);
-        }
+        ev_io_stop(conn->loop, &conn->dispatcher);
+        ev_prepare_stop(conn->loop, &conn->flusher);
     }
 
     ws_object_unlock(&conn->obj);
     return 0;
 }
 
+int
+ws_connection_processor_post_reply(
+    struct ws_connection_processor* conn,
+    struct ws_reply* reply
+) {
+    int res = 0;
+
+    // the worker may be busy with the socket, so we don't take its lock
+    if (reply && conn->serializer) {
+        // the reply was accounted for when the message was handed off
+        res = ws_queue_push(&conn->replies, &reply->m.obj);
+    } else {
+        // there won't be a reply to this message
+        __atomic_sub_fetch(&conn->replies_num, 1, __ATOMIC_RELAXED);
+    }
+
+    if (reply) {
+        ws_object_unref(&reply->m.obj);
+    }
+
+    // let the worker flush the reply or resume reading
+    if (conn->worker) {
+        ws_connection_worker_wakeup(conn->worker);
+    }
+
+    return res;
+}
+
+void
+ws_connection_processor_deferred_reply(
+    struct ws_reply* reply,
+    struct ws_object* conn
+) {
+    (void) ws_connection_processor_post_reply(
+        (struct ws_connection_processor*) conn, reply);
+}
+
+int
+ws_connection_processor_post_serialized(
+    struct ws_connection_processor* conn,
+    struct ws_serialized_message* msg
+) {
+    int res = -ENOBUFS;
+
+    // the hub may publish while we're dispatching on this very thread, hence
+    // we must not take the processor's lock here
+    bool started = __atomic_load_n(&conn->is_started, __ATOMIC_ACQUIRE);
+    size_t num = __atomic_load_n(&conn->replies_num, __ATOMIC_RELAXED);
+    if (started && (num < EVENT_DROP_WATER)) {
+        res = ws_queue_push(&conn->replies, &msg->obj);
+        if (res >= 0) {
+            __atomic_add_fetch(&conn->replies_num, 1, __ATOMIC_RELAXED);
+        }
+    }
+
+    if ((res >= 0) && conn->worker) {
+        ws_connection_worker_wakeup(conn->worker);
+    }
+
+    return res;
+}
+
 
 /*
  *
@@ -276,14 +515,6 @@ connection_processor_dispatch(
         return;
     }
 
-    // if we intend to reply to the messages, we should first check this
-    if (proc->serializer) {
-        res = connection_processor_flush_msg(proc, NULL);
-        if ((res < 0) && (res != -EAGAIN) && (res != -EINTR)) {
-            goto deinit;
-        }
-    }
-
     // try to read from the connection
     res = ws_connector_read(&proc->conn);
     if (res < 0) {
@@ -306,14 +537,38 @@ connection_processor_dispatch(
 
         // handle the message
         if (!msg) {
-            // nothing to do!
-            ws_object_unlock(&proc->obj);
-            return;
+            // nothing left to do for this batch
+            break;
+        }
+
+        // if we're running on a worker, pass the message to the main thread
+        if (proc->worker) {
+            res = ws_connection_worker_handoff(proc, msg);
+            ws_object_unref(&msg->obj);
+            if (res < 0) {
+                break;
+            }
+
+            // account for the reply we're expecting
+            __atomic_add_fetch(&proc->replies_num, 1, __ATOMIC_RELAXED);
+            connection_processor_update_throttle(proc);
+            continue;
         }
 
         // pass the message to the transaction manager
-        struct ws_reply* reply = ws_action_manager_process(msg, &proc->obj);
+        struct ws_reply* reply;
+        int deferred;
+        ws_action_reply_callback cb = ws_connection_processor_deferred_reply;
+        deferred = ws_action_manager_submit(msg, &proc->obj,
+                                            WS_ACTION_PRIORITY_IPC, cb, &reply);
         ws_object_unref(&msg->obj);
+        if (deferred) {
+            // account for the reply we're expecting
+            __atomic_add_fetch(&proc->replies_num, 1, __ATOMIC_RELAXED);
+            connection_processor_update_throttle(proc);
+            continue;
+        }
+
         if (!reply) {
             // reply being `NULL` can have a number of reasons
             continue;
@@ -326,17 +581,23 @@ connection_processor_dispatch(
             continue;
         }
 
-        // flush the buffer
-        res = connection_processor_flush_msg(proc, &reply->m);
+        // queue the reply, it will be flushed along with the rest of the batch
+        res = connection_processor_queue_reply(proc, reply);
         if (res < 0) {
             break;
         }
     }
 
+    // flush all the replies to this batch of messages at once
+    if ((res >= 0) && proc->serializer) {
+        res = connection_processor_flush_replies(proc);
+    }
+
 error_handling:
     ws_object_unlock(&proc->obj);
 
-    if ((res == -EAGAIN) || (res == -EWOULDBLOCK) || (res == -EINTR)) {
+    if ((res == 0) || (res == -EAGAIN) || (res == -EWOULDBLOCK) ||
+            (res == -EINTR)) {
         return;
     }
 
@@ -349,7 +610,6 @@ error_handling:
         }
     }
 
-deinit:
     ws_connection_manager_close_connection(proc);
 }
 
@@ -367,8 +627,16 @@ connection_processor_flush(
         return;
     }
 
-    // flush the buffer
-    int res = connection_processor_flush_msg(proc, NULL);
+    // flush the buffer, if there's anything to flush
+    int res = 0;
+    if (connection_processor_has_pending(proc) ||
+            (proc->serializer && ws_connbuf_data(&proc->conn.outbuf))) {
+        res = connection_processor_flush_replies(proc);
+    }
+
+    // replies which turned out to be `NULL` don't show up in the queue, but
+    // may still allow us to resume reading
+    connection_processor_update_throttle(proc);
     ws_object_unlock(&proc->obj);
 
     if ((res == 0) || (res == -EAGAIN) || (res == -EWOULDBLOCK) ||
@@ -386,36 +654,167 @@ connection_processor_flush(
 }
 
 static int
-connection_processor_flush_msg(
+connection_processor_queue_reply(
     struct ws_connection_processor* proc,
-    struct ws_message* message
+    struct ws_reply* reply
+) {
+    int res = ws_queue_push(&proc->replies, &reply->m.obj);
+    ws_object_unref(&reply->m.obj);
+    if (res < 0) {
+        return res;
+    }
+
+    __atomic_add_fetch(&proc->replies_num, 1, __ATOMIC_RELAXED);
+    connection_processor_update_throttle(proc);
+    return 0;
+}
+
+static int
+connection_processor_flush_replies(
+    struct ws_connection_processor* proc
 ) {
     int res;
     // iterate until there's nothing left to do
     do {
-        // allocate memory to write the reply
-        size_t avail = ws_connbuf_available(&proc->conn.outbuf);
-        char* buf = ws_connbuf_reserve(&proc->conn.outbuf, avail);
+        // fill the buffer with as many replies as possible
+        res = connection_processor_serialize_replies(proc);
+        if ((res < 0) && (res != -ENOSPC)) {
+            break;
+        }
+
+        // flush the entire batch with a single write
+        res = ws_connector_flush(&proc->conn);
+    } while ((res == 0) && connection_processor_has_pending(proc));
+
+    connection_processor_update_throttle(proc);
+    return res;
+}
+
+static int
+connection_processor_serialize_replies(
+    struct ws_connection_processor* proc
+) {
+    struct ws_connbuf* outbuf = &proc->conn.outbuf;
+
+    while (connection_processor_has_pending(proc)) {
+        // finish sending pre-serialized data first
+        if (proc->blob) {
+            int res = connection_processor_copy_blob(proc);
+            if (res < 0) {
+                return res;
+            }
+            continue;
+        }
+
+        // allocate memory to write the replies
+        size_t avail = ws_connbuf_available(outbuf);
+        char* buf = ws_connbuf_reserve(outbuf, avail);
         if (!buf) {
-            return -EAGAIN;
+            return -ENOSPC;
+        }
+
+        // only feed the serializer a new reply if it's done with the last one
+        struct ws_message* msg = NULL;
+        if (!proc->serializer->buffer) {
+            struct ws_object* obj = ws_queue_pop(&proc->replies);
+            if (!obj) {
+                ws_connbuf_unblock(outbuf);
+                return -EAGAIN;
+            }
+            __atomic_sub_fetch(&proc->replies_num, 1, __ATOMIC_RELAXED);
+
+            // pre-serialized messages are copied rather than serialized
+            if (obj->id == &WS_OBJECT_TYPE_ID_SERIALIZED_MESSAGE) {
+                ws_connbuf_unblock(outbuf);
+                proc->blob = (struct ws_serialized_message*) obj;
+                proc->blob_offset = 0;
+                continue;
+            }
+
+            msg = (struct ws_message*) obj;
         }
 
         // serialize reply
-        res = ws_serialize(proc->serializer, buf, avail, message);
+        ssize_t res = ws_serialize(proc->serializer, buf, avail, msg);
+        if (msg) {
+            ws_object_unref(&msg->obj);
+        }
         if (res < 0) {
-            break;
+            ws_connbuf_unblock(outbuf);
+            return res;
         }
 
         // communicate the changes to the buffer
-        res = ws_connbuf_append(&proc->conn.outbuf, res);
+        res = ws_connbuf_append(outbuf, res);
         if (res < 0) {
-            break;
+            return res;
         }
+    }
 
-        // flush
-        res = ws_connector_flush(&proc->conn);
-    } while (res == 0);
-    return res;
+    return 0;
+}
+
+static bool
+connection_processor_has_pending(
+    struct ws_connection_processor* proc
+) {
+    return proc->serializer && (proc->blob || proc->serializer->buffer ||
+                                !ws_queue_empty(&proc->replies));
+}
+
+static int
+connection_processor_copy_blob(
+    struct ws_connection_processor* proc
+) {
+    struct ws_connbuf* outbuf = &proc->conn.outbuf;
+
+    size_t len = MIN(ws_connbuf_available(outbuf),
+                     proc->blob->len - proc->blob_offset);
+    if (len == 0) {
+        return -ENOSPC;
+    }
+
+    char* buf = ws_connbuf_reserve(outbuf, len);
+    if (!buf) {
+        return -ENOSPC;
+    }
+
+    memcpy(buf, proc->blob->data + proc->blob_offset, len);
+    int res = ws_connbuf_append(outbuf, len);
+    if (res < 0) {
+        return res;
+    }
+
+    proc->blob_offset += len;
+    if (proc->blob_offset >= proc->blob->len) {
+        ws_object_unref(&proc->blob->obj);
+        proc->blob = NULL;
+    }
+
+    return 0;
+}
+
+static void
+connection_processor_update_throttle(
+    struct ws_connection_processor* proc
+) {
+    size_t num = __atomic_load_n(&proc->replies_num, __ATOMIC_RELAXED);
+
+    if (!proc->is_throttled && (num >= REPLY_HIGH_WATER)) {
+        // the client doesn't keep up reading, stop processing its requests
+        ev_io_stop(proc->loop, &proc->dispatcher);
+        proc->is_throttled = true;
+        ws_log(&log_ctx, LOG_DEBUG, "Throttling connection %d", proc->conn.fd);
+        return;
+    }
+
+    if (proc->is_throttled && (num <= REPLY_LOW_WATER)) {
+        proc->is_throttled = false;
+        if (proc->is_started) {
+            ev_io_start(proc->loop, &proc->dispatcher);
+        }
+        ws_log(&log_ctx, LOG_DEBUG, "Resuming connection %d", proc->conn.fd);
+    }
 }
 
 bool
@@ -425,10 +824,21 @@ connection_processor_deinit(
     struct ws_connection_processor* proc = (struct ws_connection_processor*) obj;
 
     // close for good messure
-    ws_connection_manager_close_connection(proc);
+    ws_connection_processor_close(proc);
 
     ws_connector_deinit(&proc->conn);
 
+    // drop replies which didn't make it
+    if (proc->blob) {
+        ws_object_unref(&proc->blob->obj);
+    }
+    ws_object_deinit(&proc->replies.obj);
+
+    // stop waking up a reader which is gone
+    if (proc->event_ring >= 0) {
+        ws_event_ring_close(proc->event_ring);
+    }
+
     ws_deserializer_deinit(proc->deserializer);
     if (proc->serializer) {
         ws_serializer_deinit(proc->serializer);
@@ -443,6 +853,157 @@ connection_processor_deinit(
  *
  */
 
+static int
+cmd_func_subscribe(
+    union ws_value_union* stack
+) {
+    char* pattern = NULL;
+    struct ws_connection_processor* proc = cmd_get_proc(stack, &pattern);
+    if (!proc || !pattern) {
+        free(pattern);
+        if (proc) {
+            ws_object_unref(&proc->obj);
+        }
+        return -EINVAL;
+    }
+
+    // the filter is optional
+    union ws_value_union* filter = stack + 3;
+    if (ws_value_get_type(&stack[2].value) == WS_VALUE_TYPE_NIL ||
+            ws_value_get_type(&filter->value) == WS_VALUE_TYPE_NIL) {
+        filter = NULL;
+    }
+
+    int res = ws_connection_hub_subscribe(proc, pattern, filter);
+
+    free(pattern);
+    ws_object_unref(&proc->obj);
+    return res;
+}
+
+static int
+cmd_func_unsubscribe(
+    union ws_value_union* stack
+) {
+    char* pattern = NULL;
+    struct ws_connection_processor* proc = cmd_get_proc(stack, &pattern);
+    if (!proc) {
+        return -EINVAL;
+    }
+
+    int res = ws_connection_hub_unsubscribe(proc, pattern);
+
+    free(pattern);
+    ws_object_unref(&proc->obj);
+    return res;
+}
+
+static int
+cmd_func_event_stream(
+    union ws_value_union* stack
+) {
+    struct ws_connection_processor* proc = cmd_get_proc(stack, NULL);
+    if (!proc) {
+        return -EINVAL;
+    }
+
+    int res = -EINVAL;
+    if (!proc->serializer) {
+        // we couldn't even reply
+        goto cleanup_proc;
+    }
+
+    int memfd;
+    int wakefd;
+    int reader = ws_event_ring_open(&memfd, &wakefd);
+    if (reader < 0) {
+        res = reader;
+        goto cleanup_proc;
+    }
+
+    // the descriptors are passed along with the next flush, i.e. the reply
+    connection_processor_lock_foreign(proc);
+    res = ws_connector_attach_fd(&proc->conn, memfd);
+    if (res == 0) {
+        res = ws_connector_attach_fd(&proc->conn, wakefd);
+    } else {
+        close(wakefd);
+    }
+    if (res == 0) {
+        // a client asking again gets a new eventfd, the old one is useless
+        if (proc->event_ring >= 0) {
+            ws_event_ring_close(proc->event_ring);
+        }
+        proc->event_ring = reader;
+    }
+    connection_processor_unlock_foreign(proc);
+    if (res < 0) {
+        ws_event_ring_close(reader);
+        goto cleanup_proc;
+    }
+
+    ws_value_union_reinit(stack, WS_VALUE_TYPE_BOOL);
+    ws_value_bool_set(&stack->bool_, true);
+
+cleanup_proc:
+    ws_object_unref(&proc->obj);
+    return res;
+}
+
+static void
+connection_processor_lock_foreign(
+    struct ws_connection_processor* proc
+) {
+    if (proc->worker) {
+        ws_object_lock_write(&proc->obj);
+    }
+}
+
+static void
+connection_processor_unlock_foreign(
+    struct ws_connection_processor* proc
+) {
+    if (proc->worker) {
+        ws_object_unlock(&proc->obj);
+    }
+}
+
+static struct ws_connection_processor*
+cmd_get_proc(
+    union ws_value_union* stack,
+    char** pattern
+) {
+    if (ws_value_get_type(&stack[0].value) != WS_VALUE_TYPE_OBJECT_ID) {
+        return NULL;
+    }
+
+    struct ws_object* obj = ws_value_object_id_get(&stack[0].object_id);
+    if (!obj) {
+        return NULL;
+    }
+    if (obj->id != &WS_OBJECT_TYPE_ID_COMMAND_PROCESSOR) {
+        ws_object_unref(obj);
+        return NULL;
+    }
+
+    if (!pattern) {
+        return (struct ws_connection_processor*) obj;
+    }
+
+    stack += 2; // Ignore the object and the command name
+
+    *pattern = NULL;
+    if (ws_value_get_type(&stack[0].value) == WS_VALUE_TYPE_STRING) {
+        struct ws_string* str = ws_value_string_get(&stack[0].string);
+        if (str) {
+            *pattern = ws_string_raw(str);
+            ws_object_unref(&str->obj);
+        }
+    }
+
+    return (struct ws_connection_processor*) obj;
+}
+
 size_t
 connection_processor_hash_callback(
     struct ws_object* const self
@@ -38,10 +38,14 @@
 
 #include "connection/connector.h"
 #include "objects/object.h"
+#include "objects/queue.h"
 #include "util/attributes.h"
 
 // forward declarations
+struct ws_connection_worker;
 struct ws_deserializer;
+struct ws_reply;
+struct ws_serialized_message;
 struct ws_serializer;
 
 /**
@@ -52,9 +56,17 @@ struct ws_connection_processor {
     struct ws_connector conn; //!< @protected connection to process
     struct ws_deserializer* deserializer; //!< @protected deserializer to use
     struct ws_serializer* serializer; //!< @protected serializer to use
+    struct ev_loop* loop; //!< @protected loop the watchers run on
+    struct ws_connection_worker* worker; //!< @protected worker, may be `NULL`
     ev_io dispatcher; //!< @protected dispatching watcher
     ev_prepare flusher; //!< @protected flushing watcher
     bool is_started; //!< @protected flag indicating whether it's started
+    struct ws_queue replies; //!< @protected replies waiting to be serialized
+    size_t replies_num; //!< @protected replies pending, accessed atomically
+    bool is_throttled; //!< @protected flag indicating whether reading paused
+    struct ws_serialized_message* blob; //!< @protected message being copied
+    size_t blob_offset; //!< @protected number of bytes of `blob` sent
+    int event_ring; //!< @protected event ring reader, -1 if not subscribed
 };
 
 /**
@@ -107,6 +119,64 @@ ws_connection_processor_close(
 __ws_nonnull__(1)
 ;
 
+/**
+ * Post a reply to a message handed off to the main thread
+ *
+ * This function is used for passing replies to connections which are served
+ * by a worker (see `ws_connection_worker_handoff()`). `NULL` may be passed as
+ * `reply` if processing the message did not yield a reply.
+ *
+ * @note the reference to the reply is consumed
+ *
+ * @note Threadsafe!
+ *
+ * @return 0 on success, a negative error value otherwise
+ */
+int
+ws_connection_processor_post_reply(
+    struct ws_connection_processor* conn, //!< connection processor to reply on
+    struct ws_reply* reply //!< reply to post
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Deliver the reply to a message whose processing was deferred
+ *
+ * This function is passed as callback to `ws_action_manager_submit()`. It
+ * posts the reply via `ws_connection_processor_post_reply()`.
+ */
+void
+ws_connection_processor_deferred_reply(
+    struct ws_reply* reply, //!< reply to deliver (may be NULL)
+    struct ws_object* conn //!< the connection processor
+)
+__ws_nonnull__(2)
+;
+
+/**
+ * Post a message which was already serialized
+ *
+ * The message is queued and copied to the connection's output buffer as-is.
+ * This is used by the event hub for sending one event to many connections.
+ * If the connection has too many messages waiting already, the message is
+ * dropped.
+ *
+ * @note the caller keeps its reference to the message
+ *
+ * @note Threadsafe!
+ *
+ * @return 0 on success, `-ENOBUFS` if the message was dropped or another
+ *         negative error value
+ */
+int
+ws_connection_processor_post_serialized(
+    struct ws_connection_processor* conn, //!< connection processor to send on
+    struct ws_serialized_message* msg //!< message to post
+)
+__ws_nonnull__(1, 2)
+;
+
 #endif // __WS_CONNECTION_PROCESSOR_H__
 
 /**
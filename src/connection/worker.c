@@ -0,0 +1,425 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <ev.h>
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "action/manager.h"
+#include "connection/manager.h"
+#include "connection/processor.h"
+#include "connection/worker.h"
+#include "logger/module.h"
+#include "objects/message/message.h"
+#include "objects/message/reply.h"
+#include "util/mpsc.h"
+#include "util/slab.h"
+
+/**
+ * Maximum number of workers we start
+ */
+#define MAX_WORKERS 64
+
+/**
+ * Worker thread
+ */
+struct ws_connection_worker {
+    pthread_t thread; //!< @private the thread running the loop
+    struct ev_loop* loop; //!< @private the loop of the worker
+    ev_async wakeup; //!< @private watcher for waking the worker
+    struct ws_mpsc_queue adopted; //!< @private processors to start
+    bool stop; //!< @private flag telling the worker to exit
+};
+
+/**
+ * Item passed through the queues
+ *
+ * @note the node must be the first member, so we can cast nodes to items
+ */
+struct handoff_item {
+    struct ws_mpsc_node node; //!< @private queue node
+    struct ws_connection_processor* proc; //!< @private processor affected
+    struct ws_message* msg; //!< @private message to process (may be `NULL`)
+};
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Thread function of a worker
+ */
+static void*
+worker_run(
+    void* arg //!< the worker
+);
+
+/**
+ * Wakeup callback, runs on the worker
+ */
+static void
+worker_wakeup_cb(
+    struct ev_loop* loop, //!< loop on which the callback was called
+    ev_async* watcher, //!< watcher which triggered the callback
+    int revents //!< events
+);
+
+/**
+ * Handoff callback, runs on the main thread
+ */
+static void
+handoff_cb(
+    struct ev_loop* loop, //!< loop on which the callback was called
+    ev_async* watcher, //!< watcher which triggered the callback
+    int revents //!< events
+);
+
+/**
+ * Create a new hand-off item, taking references to the objects passed
+ *
+ * @return a new item or `NULL` on failure
+ */
+static struct handoff_item*
+handoff_item_new(
+    struct ws_connection_processor* proc, //!< processor
+    struct ws_message* msg //!< message, may be `NULL`
+);
+
+/**
+ * Destroy a hand-off item, releasing the references held
+ */
+static void
+handoff_item_destroy(
+    struct handoff_item* item //!< item to destroy
+);
+
+/*
+ *
+ * Internal variables
+ *
+ */
+
+static struct {
+    struct ws_connection_worker* workers; //!< @private the workers
+    size_t num; //!< @private number of workers
+    size_t next; //!< @private next worker to assign a connection to
+    pthread_t main_thread; //!< @private thread running the default loop
+    ev_async handoff_watcher; //!< @private watcher for messages handed off
+    struct ws_mpsc_queue handoff; //!< @private messages to process
+} pool;
+
+/**
+ * Pool for hand-off items, which are created for every message handed off
+ */
+static struct ws_slab_pool handoff_item_pool =
+    WS_SLAB_POOL_INIT("handoff_item", sizeof(struct handoff_item));
+
+static struct ws_logger_context log_ctx = {
+    .prefix = "[Connection/Worker] ",
+};
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+int
+ws_connection_workers_init(void)
+{
+    pool.main_thread = pthread_self();
+    pool.num = 0;
+
+    char* num_str = getenv("WAYSOME_IPC_WORKERS");
+    if (!num_str) {
+        return 0;
+    }
+
+    char* num_end = NULL;
+    long num = strtol(num_str, &num_end, 10);
+    if ((num_str == num_end) || (num <= 0)) {
+        return 0;
+    }
+    if (num > MAX_WORKERS) {
+        num = MAX_WORKERS;
+    }
+
+    pool.workers = calloc(num, sizeof(*pool.workers));
+    if (!pool.workers) {
+        return -ENOMEM;
+    }
+
+    // set up the main thread's end
+    ws_mpsc_queue_init(&pool.handoff);
+    ev_async_init(&pool.handoff_watcher, handoff_cb);
+    ev_async_start(EV_DEFAULT_ &pool.handoff_watcher);
+
+    // start the workers
+    while (pool.num < (size_t) num) {
+        struct ws_connection_worker* worker = pool.workers + pool.num;
+
+        worker->loop = ev_loop_new(EVFLAG_AUTO);
+        if (!worker->loop) {
+            break;
+        }
+
+        ws_mpsc_queue_init(&worker->adopted);
+        ev_async_init(&worker->wakeup, worker_wakeup_cb);
+        worker->wakeup.data = worker;
+        ev_async_start(worker->loop, &worker->wakeup);
+
+        if (pthread_create(&worker->thread, NULL, worker_run, worker) != 0) {
+            ev_loop_destroy(worker->loop);
+            break;
+        }
+
+        ++pool.num;
+    }
+
+    ws_log(&log_ctx, LOG_DEBUG, "Started %zu IPC worker(s)", pool.num);
+
+    if (pool.num == 0) {
+        // we could not start a single worker, run single-threaded
+        ev_async_stop(EV_DEFAULT_ &pool.handoff_watcher);
+        free(pool.workers);
+        pool.workers = NULL;
+    }
+
+    return 0;
+}
+
+void
+ws_connection_workers_stop(void)
+{
+    for (size_t i = 0; i < pool.num; ++i) {
+        struct ws_connection_worker* worker = pool.workers + i;
+        if (worker->stop) {
+            continue;
+        }
+
+        __atomic_store_n(&worker->stop, true, __ATOMIC_RELEASE);
+        ev_async_send(worker->loop, &worker->wakeup);
+        pthread_join(worker->thread, NULL);
+    }
+}
+
+void
+ws_connection_workers_deinit(void)
+{
+    if (!pool.workers) {
+        return;
+    }
+
+    struct ws_mpsc_node* node;
+    for (size_t i = 0; i < pool.num; ++i) {
+        struct ws_connection_worker* worker = pool.workers + i;
+
+        // drop processors which were never started
+        while ((node = ws_mpsc_queue_pop(&worker->adopted))) {
+            handoff_item_destroy((struct handoff_item*) node);
+        }
+
+        ev_async_stop(worker->loop, &worker->wakeup);
+        ev_loop_destroy(worker->loop);
+    }
+
+    // drop messages which were never processed
+    ev_async_stop(EV_DEFAULT_ &pool.handoff_watcher);
+    while ((node = ws_mpsc_queue_pop(&pool.handoff))) {
+        handoff_item_destroy((struct handoff_item*) node);
+    }
+
+    free(pool.workers);
+    pool.workers = NULL;
+    pool.num = 0;
+}
+
+struct ws_connection_worker*
+ws_connection_workers_assign(void)
+{
+    if (pool.num == 0) {
+        return NULL;
+    }
+
+    // plain round-robin
+    struct ws_connection_worker* worker = pool.workers + pool.next;
+    pool.next = (pool.next + 1) % pool.num;
+    return worker;
+}
+
+bool
+ws_connection_workers_on_main_thread(void)
+{
+    return pool.num == 0 || pthread_equal(pthread_self(), pool.main_thread);
+}
+
+int
+ws_connection_worker_adopt(
+    struct ws_connection_worker* self,
+    struct ws_connection_processor* proc
+) {
+    struct handoff_item* item = handoff_item_new(proc, NULL);
+    if (!item) {
+        return -ENOMEM;
+    }
+
+    // the processor was not started yet, so nobody else touches it
+    proc->loop      = self->loop;
+    proc->worker    = self;
+
+    ws_mpsc_queue_push(&self->adopted, &item->node);
+    ev_async_send(self->loop, &self->wakeup);
+    return 0;
+}
+
+int
+ws_connection_worker_handoff(
+    struct ws_connection_processor* proc,
+    struct ws_message* msg
+) {
+    struct handoff_item* item = handoff_item_new(proc, msg);
+    if (!item) {
+        return -ENOMEM;
+    }
+
+    ws_mpsc_queue_push(&pool.handoff, &item->node);
+    ev_async_send(EV_DEFAULT_ &pool.handoff_watcher);
+    return 0;
+}
+
+void
+ws_connection_worker_wakeup(
+    struct ws_connection_worker* self
+) {
+    ev_async_send(self->loop, &self->wakeup);
+}
+
+/*
+ *
+ * static function implementations
+ *
+ */
+
+static void*
+worker_run(
+    void* arg
+) {
+    struct ws_connection_worker* worker = (struct ws_connection_worker*) arg;
+
+    ev_loop(worker->loop, 0);
+    return NULL;
+}
+
+static void
+worker_wakeup_cb(
+    struct ev_loop* loop,
+    ev_async* watcher,
+    int revents
+) {
+    struct ws_connection_worker* worker;
+    worker = (struct ws_connection_worker*) watcher->data;
+
+    if (__atomic_load_n(&worker->stop, __ATOMIC_ACQUIRE)) {
+        ev_unloop(loop, EVUNLOOP_ALL);
+        return;
+    }
+
+    // start the processors handed to us
+    struct ws_mpsc_node* node;
+    while ((node = ws_mpsc_queue_pop(&worker->adopted))) {
+        struct handoff_item* item = (struct handoff_item*) node;
+
+        if (ws_connection_processor_start(item->proc) < 0) {
+            ws_log(&log_ctx, LOG_ERR, "Could not start connection");
+            ws_connection_manager_close_connection(item->proc);
+        }
+
+        handoff_item_destroy(item);
+    }
+
+    // replies posted to our processors are flushed by their prepare watchers
+}
+
+static void
+handoff_cb(
+    struct ev_loop* loop,
+    ev_async* watcher,
+    int revents
+) {
+    struct ws_mpsc_node* node;
+    while ((node = ws_mpsc_queue_pop(&pool.handoff))) {
+        struct handoff_item* item = (struct handoff_item*) node;
+
+        if (item->msg) {
+            // process the message and send the reply back, possibly later
+            struct ws_reply* reply;
+            int deferred;
+            ws_action_reply_callback cb;
+            cb = ws_connection_processor_deferred_reply;
+            deferred = ws_action_manager_submit(item->msg, &item->proc->obj,
+                                                WS_ACTION_PRIORITY_IPC, cb,
+                                                &reply);
+            if (!deferred) {
+                ws_connection_processor_post_reply(item->proc, reply);
+            }
+        } else {
+            // the worker closed the connection
+            ws_connection_manager_close_connection(item->proc);
+        }
+
+        handoff_item_destroy(item);
+    }
+}
+
+static struct handoff_item*
+handoff_item_new(
+    struct ws_connection_processor* proc,
+    struct ws_message* msg
+) {
+    struct handoff_item* item = ws_slab_alloc(&handoff_item_pool);
+    if (!item) {
+        return NULL;
+    }
+
+    item->proc  = getref(proc);
+    item->msg   = msg ? getref(msg) : NULL;
+    return item;
+}
+
+static void
+handoff_item_destroy(
+    struct handoff_item* item
+) {
+    if (item->msg) {
+        ws_object_unref(&item->msg->obj);
+    }
+    ws_object_unref(&item->proc->obj);
+    ws_slab_release(item);
+}
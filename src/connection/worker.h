@@ -0,0 +1,167 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @addtogroup connection "Connection"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup connection_worker "Connection workers"
+ *
+ * Optional pool of threads serving IPC connections
+ *
+ * By default, all connections are served on the default loop, alongside
+ * wayland and input handling. If the environment variable
+ * `WAYSOME_IPC_WORKERS` is set to a positive number, that number of worker
+ * threads is started instead, each running its own libev loop.
+ *
+ * Connections are distributed among the workers, which perform all the
+ * reading, writing and (de)serialisation for them. Deserialized messages are
+ * handed to the main thread via a lock-free queue and an `ev_async` watcher,
+ * since the action manager may only run on the main thread. Replies are
+ * passed back via the reply queue of the connection processor.
+ *
+ * @{
+ */
+
+#ifndef __WS_CONNECTION_WORKER_H__
+#define __WS_CONNECTION_WORKER_H__
+
+#include <stdbool.h>
+
+#include "util/attributes.h"
+
+// forward declarations
+struct ws_connection_processor;
+struct ws_connection_worker;
+struct ws_message;
+
+/**
+ * Initialize the worker pool
+ *
+ * Starts the number of worker threads requested via `WAYSOME_IPC_WORKERS`.
+ * If the variable is not set, no threads are started and all connections will
+ * be served on the default loop.
+ *
+ * @return 0 on success, a negative error code otherwise
+ */
+int
+ws_connection_workers_init(void);
+
+/**
+ * Stop all worker threads
+ *
+ * After this function returned, no worker loop is run anymore. The loops are
+ * still valid, though, so watchers may be stopped safely.
+ */
+void
+ws_connection_workers_stop(void);
+
+/**
+ * Deinitialize the worker pool
+ *
+ * @warning the workers must be stopped before calling this function
+ */
+void
+ws_connection_workers_deinit(void);
+
+/**
+ * Pick a worker for a new connection
+ *
+ * @return a worker or `NULL`, if connections are served on the default loop
+ */
+struct ws_connection_worker*
+ws_connection_workers_assign(void);
+
+/**
+ * Check whether the caller runs on the main thread
+ */
+bool
+ws_connection_workers_on_main_thread(void);
+
+/**
+ * Hand a connection processor over to a worker
+ *
+ * The processor will be served on the loop of the worker, which will also
+ * start it.
+ *
+ * @warning must be called from the main thread
+ *
+ * @return 0 on success, a negative error code otherwise
+ */
+int
+ws_connection_worker_adopt(
+    struct ws_connection_worker* self, //!< worker to hand the processor to
+    struct ws_connection_processor* proc //!< processor to hand over
+)
+__ws_nonnull__(1, 2)
+;
+
+/**
+ * Hand a message over to the main thread for processing
+ *
+ * The message will be processed by the action manager on the main thread and
+ * the reply will be posted to the processor via
+ * `ws_connection_processor_post_reply()`.
+ * If `msg` is `NULL`, the connection will be removed from the connection
+ * manager instead.
+ *
+ * @note Threadsafe!
+ *
+ * @return 0 on success, a negative error code otherwise
+ */
+int
+ws_connection_worker_handoff(
+    struct ws_connection_processor* proc, //!< processor the message is from
+    struct ws_message* msg //!< message to process
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Wake a worker, e.g. because replies are ready for being flushed
+ *
+ * @note Threadsafe!
+ */
+void
+ws_connection_worker_wakeup(
+    struct ws_connection_worker* self //!< worker to wake
+)
+__ws_nonnull__(1)
+;
+
+#endif // __WS_CONNECTION_WORKER_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
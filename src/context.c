@@ -38,6 +38,7 @@
 #include "compositor/wayland/surface.h"
 #include "context.h"
 #include "input/hotkeys.h"
+#include "logger/module.h"
 #include "objects/object.h"
 #include "objects/string.h"
 #include "util/arithmetical.h"
@@ -62,6 +63,14 @@ func_log(
     union ws_value_union* stack
 );
 
+/**
+ * Set the log levels, see ws_logger_set_levels()
+ */
+static int
+func_log_level(
+    union ws_value_union* stack
+);
+
 /**
  * A way to start a programm
  */
@@ -145,6 +154,7 @@ func_unregister_transaction_on_event(
 static const struct ws_object_function functions[] = {
     { .name = "exit", .func = func_exit },
     { .name = "log", .func = func_log },
+    { .name = "log_level", .func = func_log_level },
     { .name = "exec", .func = func_exec },
     { .name = "add_hotkey_event", .func = add_hotkey_event },
     { .name = "remove_hotkey_event", .func = remove_hotkey_event },
@@ -231,6 +241,37 @@ func_log(
     return 0;
 }
 
+static int
+func_log_level(
+    union ws_value_union* stack
+) {
+    union ws_value_union* retval = stack;
+    stack += 2; // We don't care about object itself and command name
+
+    if (ws_value_get_type(&stack->value) != WS_VALUE_TYPE_STRING) {
+        return -EINVAL;
+    }
+
+    struct ws_string* levels = ws_value_string_get(&stack->string);
+    if (!levels) {
+        return -ENOENT;
+    }
+
+    char* raw = ws_string_raw(levels);
+    ws_object_unref(&levels->obj);
+    if (!raw) {
+        return -ENOMEM;
+    }
+
+    int res = ws_logger_set_levels(raw);
+    free(raw);
+
+    ws_value_union_reinit(retval, WS_VALUE_TYPE_BOOL);
+    ws_value_bool_set(&retval->bool_, res == 0);
+
+    return res;
+}
+
 static int
 func_exec(
     union ws_value_union* stack
@@ -40,6 +40,7 @@
 #include "objects/string.h"
 #include "objects/message/event.h"
 #include "objects/message/reply.h"
+#include "trace/module.h"
 #include "util/cleaner.h"
 
 /**
@@ -188,6 +189,8 @@ ws_hotkeys_eval(
         return eventlist_reset();
     }
 
+    ws_trace_instant(WS_TRACE_EVENT_HOTKEY, ws_object_uuid(&event->m.obj), 0);
+
     // emit the event
     {
         char* buf = ws_string_raw(&ws_hotkeys_ctx.state->event->name);
@@ -196,11 +199,14 @@ ws_hotkeys_eval(
         free(buf);
     }
 
+    // hotkeys go before everything else, results of events are dropped anyway
     struct ws_reply* reply;
-    reply = ws_action_manager_process(&event->m, NULL);
+    (void) ws_action_manager_submit(&event->m, NULL,
+                                    WS_ACTION_PRIORITY_HOTKEY, NULL, &reply);
     if (reply) {
         ws_object_unref(&reply->m.obj);
     }
+    ws_object_unref(&event->m.obj);
 
     // reset the eventlist
     ws_hotkeys_ctx.state = NULL;
@@ -235,6 +241,7 @@ ws_hotkey_remove(
     struct ws_string name;
     memset(&name, 0, sizeof(name));
     ws_string_init(&name);
+    name.obj.settings |= WS_OBJECT_CONFINED;
 
     struct ws_hotkey_event event;
     memset(&event, 0, sizeof(event));
@@ -243,6 +250,7 @@ ws_hotkey_remove(
     if (res < 0) {
         return res;
     }
+    event.obj.settings |= WS_OBJECT_CONFINED;
     ws_object_deinit(&name.obj);
 
     res = ws_hotkey_dag_remove(&ws_hotkeys_ctx.root, &event);
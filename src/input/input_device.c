@@ -35,9 +35,11 @@
 
 #include "compositor/cursor.h"
 #include "compositor/keyboard.h"
+#include "connection/event_ring.h"
 #include "input/hotkeys.h"
 #include "input/input_device.h"
 #include "input/utils.h"
+#include "trace/module.h"
 #include "util/arithmetical.h"
 
 /*
@@ -172,9 +174,17 @@ handle_relative_event(
             ws_cursor_add_position(pointer, 0, ev->value);
             break;
         }
+    default:
+        return;
     }
 
-
+    struct ws_cursor* pointer = ws_cursor_get();
+    struct ws_event_record rec = {
+        .type   = WS_EVENT_RECORD_POINTER_MOTION,
+        .x      = pointer->x,
+        .y      = pointer->y,
+    };
+    ws_event_ring_push(&rec);
 }
 
 static void
@@ -188,6 +198,15 @@ handle_mouse_click_event(
 
     struct ws_cursor* pointer = ws_cursor_get();
     ws_cursor_set_button_state(pointer, &ev->time, ev->code, state);
+
+    struct ws_event_record rec = {
+        .type   = WS_EVENT_RECORD_POINTER_BUTTON,
+        .code   = ev->code,
+        .value  = ev->value,
+        .x      = pointer->x,
+        .y      = pointer->y,
+    };
+    ws_event_ring_push(&rec);
 }
 
 static void
@@ -203,6 +222,13 @@ handle_keyboard_press_event(
 
     // XKB map has an offset of 8 to linux/input.h concerning to keycodes
     ws_keyboard_send_key(k, &ev->time, ev->code, state);
+
+    struct ws_event_record rec = {
+        .type   = WS_EVENT_RECORD_KEY,
+        .code   = ev->code,
+        .value  = ev->value,
+    };
+    ws_event_ring_push(&rec);
 }
 
 static void
@@ -236,6 +262,9 @@ watch_pointers(
             continue;
         }
 
+        ws_trace_instant(WS_TRACE_EVENT_INPUT, (ev.type << 16) | ev.code,
+                         ev.value);
+
         if (ev.type == EV_REL) {
             handle_relative_event(&ev);
             continue;
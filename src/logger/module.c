@@ -25,33 +25,212 @@
  * along with waysome. If not, see <http://www.gnu.org/licenses/>.
  */
 
+
+#include <ctype.h>
 #include <errno.h>
 #include <pthread.h>
+#include <semaphore.h>
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <syslog.h>
+#include <sys/types.h>
+#include <time.h>
 
 #include "logger/module.h"
+#include "util/arithmetical.h"
 #include "util/attributes.h"
 #include "util/cleaner.h"
 
+/**
+ * Number of records in the ring buffer of a thread, must be a power of two
+ */
+#define RING_SLOTS (256)
+
+/**
+ * Maximum number of arguments stored in a record
+ */
+#define RECORD_ARGS (8)
+
+/**
+ * Size of the text area of a record, holding the prefix and copied strings
+ */
+#define RECORD_TEXT (256)
+
+/**
+ * Maximum length of a conversion specification
+ */
+#define SPEC_LEN (32)
+
+/**
+ * Maximum length of a formatted line
+ */
+#define LINE_LEN (1024)
+
+/**
+ * Size of the buffer the writer collects lines in before writing them
+ */
+#define BATCH_LEN (16 * LINE_LEN)
+
+/**
+ * Time the writer sleeps at most if there is nothing to write, in ns
+ */
+#define WRITER_TIMEOUT (100 * 1000 * 1000)
+
+/**
+ * Least severe level at which messages bypass the rings
+ *
+ * Serious messages must neither be dropped nor get lost if we exit right after
+ * logging them, so they are written synchronously.
+ */
+#define SYNC_LEVEL (LOG_ERR)
+
+/*
+ *
+ * Types
+ *
+ */
+
+/**
+ * Level set for a module
+ */
+struct module_level {
+    char* name; //!< name of the module
+    size_t len; //!< length of the name
+    int level; //!< level of the module
+};
+
+/**
+ * Level configuration
+ */
+struct levels {
+    int fallback; //!< level of contexts not matching any module
+    size_t num; //!< number of modules
+    struct module_level* modules; //!< levels of the modules
+};
+
+/**
+ * Length modifier of a conversion specification
+ */
+enum length {
+    LENGTH_NONE,
+    LENGTH_HH,
+    LENGTH_H,
+    LENGTH_L,
+    LENGTH_LL,
+    LENGTH_J,
+    LENGTH_Z,
+    LENGTH_T,
+    LENGTH_BIG_L,
+};
+
+/**
+ * Parsed conversion specification
+ */
+struct spec {
+    size_t len; //!< length of the specification, including the `%`
+    bool width_star; //!< whether the width is passed as an argument
+    bool prec_star; //!< whether the precision is passed as an argument
+    int prec; //!< precision given in the format, -1 if none
+    enum length length; //!< length modifier
+    char conv; //!< conversion specifier
+};
+
+/**
+ * Packed argument
+ */
+union arg {
+    intmax_t i; //!< signed integer or star argument
+    uintmax_t u; //!< unsigned integer
+    long double f; //!< floating point number
+    void* p; //!< pointer
+    size_t str; //!< offset of a copied string in the text area
+};
+
+/**
+ * Log record
+ */
+struct record {
+    size_t seq; //!< sequence number, for ordering records of different threads
+    char const* fmt; //!< format string, NULL if the message is preformatted
+    unsigned int nargs; //!< number of arguments packed
+    size_t msg; //!< offset of the preformatted message
+    size_t text_len; //!< used part of the text area
+    union arg args[RECORD_ARGS]; //!< packed arguments
+    char text[RECORD_TEXT]; //!< prefix, followed by copied strings
+};
+
+/**
+ * Single-producer single-consumer ring buffer of records
+ *
+ * Each thread logs to its own ring, which is drained by the writer. A ring is
+ * never freed. Rings of threads which exited are adopted by new threads.
+ */
+struct ring {
+    struct ring* next; //!< next ring in the list of all rings
+    bool owned; //!< whether a thread logs to the ring, accessed atomically
+    size_t dropped; //!< number of records dropped, accessed atomically
+    size_t head __attribute__((aligned(64))); //!< next record to write
+    size_t tail __attribute__((aligned(64))); //!< next record to read
+    struct record records[RING_SLOTS]; //!< the records
+};
+
 /*
  *
  * local variables
  *
  */
 
-static int runtime_log_lvl = LOG_ERR;
+unsigned int ws_logger_generation = 1;
+
+/**
+ * The level configuration
+ */
+static struct {
+    pthread_mutex_t lock; //!< lock for the configuration
+    struct levels levels; //!< the current configuration
+} config = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .levels = { .fallback = LOG_ERR, .num = 0, .modules = NULL },
+};
 
 /**
  * Logger type
  */
 static struct {
-    pthread_mutex_t loglock; //!< Log mutex for synchronizing logging
-} logger;
+    struct ring* rings; //!< list of all rings, pushed to atomically
+    pthread_key_t ring_key; //!< key for releasing a ring on thread exit
+    pthread_t writer; //!< the writer thread
+    bool running; //!< whether the writer is running, accessed atomically
+    bool stop; //!< whether the writer should stop, accessed atomically
+    bool sleeping; //!< whether the writer may be sleeping, accessed atomically
+    sem_t wakeup; //!< semaphore the writer sleeps on
+    size_t seq; //!< next sequence number, accessed atomically
+    size_t written; //!< records written by the writer, accessed atomically
+    pthread_mutex_t flush_lock; //!< lock for waiting for the writer
+    pthread_cond_t flushed; //!< signalled when the writer wrote records
+} logger = {
+    .rings = NULL,
+    .running = false,
+    .flush_lock = PTHREAD_MUTEX_INITIALIZER,
+    .flushed = PTHREAD_COND_INITIALIZER,
+};
+
+/**
+ * Ring of the current thread
+ */
+static __thread struct ring* local_ring = NULL;
+
+/*
+ *
+ * Forward declarations
+ *
+ */
 
 /**
  * Cleanup function for the logger singleton
@@ -60,10 +239,151 @@ static struct {
  */
 static void
 cleanup_logger(
-    void* etc __ws_unused__
-) {
-    pthread_mutex_destroy(&logger.loglock);
-}
+    void* etc
+);
+
+/**
+ * Parse a level
+ *
+ * @return the level or -EINVAL if `str` is not a valid level
+ */
+static int
+parse_level(
+    char const* str, //!< level to parse
+    size_t len //!< length of the level
+);
+
+/**
+ * Parse a level configuration
+ *
+ * @return zero on success, else negative error code from errno.h
+ */
+static int
+parse_levels(
+    struct levels* levels, //!< configuration to parse into
+    char const* str //!< configuration to parse
+);
+
+/**
+ * Free the modules of a level configuration
+ */
+static void
+free_levels(
+    struct levels* levels //!< configuration to free
+);
+
+/**
+ * Look up the level of a context in the current configuration
+ *
+ * @warning must be called with the configuration locked
+ *
+ * @return the level of the context
+ */
+static int
+lookup_level(
+    struct ws_logger_context const* ctx //!< the logging context
+);
+
+/**
+ * Get the ring of the current thread
+ *
+ * @return the ring of the current thread or NULL if none could be allocated
+ */
+static struct ring*
+get_ring(void);
+
+/**
+ * Release the ring of an exiting thread
+ */
+static void
+release_ring(
+    void* ring //!< the ring to release
+);
+
+/**
+ * Parse a conversion specification
+ *
+ * @return true if the specification is supported, false otherwise
+ */
+static bool
+parse_spec(
+    char const* str, //!< specification to parse, starting with `%`
+    struct spec* spec //!< output for the parsed specification
+);
+
+/**
+ * Copy a string into the text area of a record
+ *
+ * The string is truncated if it does not fit.
+ *
+ * @return offset of the copy in the text area
+ */
+static size_t
+store_text(
+    struct record* rec, //!< record to store the string in
+    char const* str, //!< string to store
+    size_t len //!< length of the string
+);
+
+/**
+ * Pack a message into a record
+ *
+ * Messages with format strings which can not be packed are formatted right away
+ */
+static void
+pack_record(
+    struct record* rec, //!< record to pack the message into
+    struct ws_logger_context* const ctx, //!< the logging context
+    char const* fmt, //!< format string
+    va_list args //!< arguments
+);
+
+/**
+ * Format a record
+ *
+ * The line is terminated with a newline and truncated if it does not fit.
+ *
+ * @return the length of the line written to `buf`
+ */
+static size_t
+format_record(
+    struct record const* rec, //!< record to format
+    char* buf, //!< buffer to format the record into
+    size_t len //!< size of the buffer, at least 2
+);
+
+/**
+ * Write a record right away
+ */
+static void
+write_record(
+    struct record const* rec //!< record to write
+);
+
+/**
+ * Publish a record in the ring of the current thread
+ */
+static void
+publish_record(
+    struct ring* ring, //!< ring of the current thread
+    size_t head //!< position of the record
+);
+
+/**
+ * Write all records available
+ *
+ * @return number of records written
+ */
+static size_t
+drain_rings(void);
+
+/**
+ * Thread function of the writer
+ */
+static void*
+writer_run(
+    void* arg //!< unused
+);
 
 /*
  *
@@ -80,71 +400,107 @@ ws_logger_init(void)
         return 0;
     }
 
-    pthread_mutex_init(&logger.loglock, NULL);
-    ws_cleaner_add(cleanup_logger, NULL);
     is_used = true;
 
-    int lvl;
-    char* loglvl = getenv("WAYSOME_LOG_LEVEL");
+    // a malformed configuration leaves the default level in place
+    char* levels = getenv("WAYSOME_LOG_LEVEL");
+    if (levels) {
+        ws_logger_set_levels(levels);
+    }
 
-    if (!loglvl) {
-        lvl = LOG_ERR;
-        goto out;
+    // without a writer, messages are simply written by the logging thread
+    if (pthread_key_create(&logger.ring_key, release_ring) != 0) {
+        return 0;
     }
 
-    char* loglvlend = NULL;
-    lvl = strtol(loglvl, &loglvlend, 10);
+    if (sem_init(&logger.wakeup, 0, 0) != 0) {
+        pthread_key_delete(logger.ring_key);
+        return 0;
+    }
 
-    if ((loglvl == loglvlend) || /* There was no digit */
-            (loglvlend == '\0' && (lvl > LOG_DEBUG || lvl < LOG_EMERG))) {
-        lvl = LOG_ERR;
+    if (pthread_create(&logger.writer, NULL, writer_run, NULL) != 0) {
+        sem_destroy(&logger.wakeup);
+        pthread_key_delete(logger.ring_key);
+        return 0;
     }
 
-out:
-    runtime_log_lvl = lvl;
+    __atomic_store_n(&logger.running, true, __ATOMIC_RELEASE);
+    ws_cleaner_add(cleanup_logger, NULL);
     return 0;
 }
 
-void
-ws_log(
-    struct ws_logger_context* const ctx,
-    int prio,
-    char* fmt,
-    ...
+int
+ws_logger_set_levels(
+    char const* levels
 ) {
-    if (prio > runtime_log_lvl) { // (kindof) reverted logic here
-        return;
+    struct levels parsed;
+    int res = parse_levels(&parsed, levels);
+    if (res < 0) {
+        return res;
     }
 
-    va_list list;
-    size_t pref_len = 0;
-    size_t buf_len = strlen(fmt);
-
-    if (ctx && ctx->prefix) {
-        pref_len = strlen(ctx->prefix);
-        buf_len += pref_len;
-    }
+    pthread_mutex_lock(&config.lock);
+    free_levels(&config.levels);
+    config.levels = parsed;
+    // invalidates the levels cached in the contexts
+    __atomic_add_fetch(&ws_logger_generation, 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&config.lock);
 
-    buf_len += 2; // newline-char and zero-byte
-
-    char buf[buf_len];
+    return 0;
+}
 
-    memcpy(buf + pref_len, fmt, strlen(fmt));
+int
+ws_logger_level(
+    struct ws_logger_context* const ctx
+) {
+    pthread_mutex_lock(&config.lock);
 
-    if (ctx && ctx->prefix) {
-        memcpy(buf, ctx->prefix, pref_len);
+    int level = config.levels.fallback;
+    if (ctx) {
+        level = lookup_level(ctx);
+        __atomic_store_n(&ctx->level, level, __ATOMIC_RELAXED);
+        __atomic_store_n(&ctx->generation, ws_logger_generation,
+                         __ATOMIC_RELEASE);
     }
 
-    buf[buf_len - 2] = '\n';
-    buf[buf_len - 1] = '\0';
+    pthread_mutex_unlock(&config.lock);
+    return level;
+}
 
+void
+ws_log_fmt(
+    struct ws_logger_context* const ctx,
+    int prio,
+    char* fmt,
+    ...
+) {
+    va_list list;
     va_start(list, fmt);
 
-    pthread_mutex_lock(&logger.loglock);
-    vfprintf(stderr, (char *) buf, list);
-    pthread_mutex_unlock(&logger.loglock);
+    struct ring* ring = (prio > SYNC_LEVEL) ? get_ring() : NULL;
+    if (!ring) {
+        struct record rec;
+        pack_record(&rec, ctx, fmt, list);
+        va_end(list);
 
+        // messages queued before go first
+        ws_logger_flush();
+        write_record(&rec);
+        return;
+    }
+
+    size_t head = ring->head;
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= RING_SLOTS) {
+        // we never block the caller on a slow writer
+        __atomic_add_fetch(&ring->dropped, 1, __ATOMIC_RELAXED);
+        va_end(list);
+        return;
+    }
+
+    pack_record(&ring->records[head % RING_SLOTS], ctx, fmt, list);
     va_end(list);
+
+    publish_record(ring, head);
 }
 
 void
@@ -153,29 +509,810 @@ ws_log_ary(
     int lvl,
     char** ary
 ) {
-    if (lvl > runtime_log_lvl) {
+    if (!ws_log_enabled(ctx, lvl)) {
         return;
     }
 
-    pthread_mutex_lock(&logger.loglock);
+    struct record local;
+    struct record* rec = &local;
 
-    if (ctx) {
-        fprintf(stderr, "%s", ctx->prefix);
+    struct ring* ring = (lvl > SYNC_LEVEL) ? get_ring() : NULL;
+    size_t head = 0;
+    if (ring) {
+        head = ring->head;
+        if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >=
+                RING_SLOTS) {
+            __atomic_add_fetch(&ring->dropped, 1, __ATOMIC_RELAXED);
+            return;
+        }
+        rec = &ring->records[head % RING_SLOTS];
     }
 
-    while (*ary) {
-        fprintf(stderr, "%s", *ary);
+    // the strings are concatenated into a preformatted message
+    rec->fmt = NULL;
+    rec->nargs = 0;
+    rec->text_len = 0;
+    store_text(rec, (ctx && ctx->prefix) ? ctx->prefix : "",
+               (ctx && ctx->prefix) ? strlen(ctx->prefix) : 0);
+    rec->msg = rec->text_len;
+
+    size_t len = rec->msg;
+    while (*ary && len < RECORD_TEXT - 1) {
+        size_t part = MIN(strlen(*ary), RECORD_TEXT - 1 - len);
+        memcpy(rec->text + len, *ary, part);
+        len += part;
         ++ary;
     }
-    fprintf(stderr, "\n");
+    rec->text[len] = '\0';
+    rec->text_len = len + 1;
+
+    if (ring) {
+        publish_record(ring, head);
+    } else {
+        ws_logger_flush();
+        write_record(rec);
+    }
+}
+
+void
+ws_logger_flush(void)
+{
+    if (!__atomic_load_n(&logger.running, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+
+    size_t target = __atomic_load_n(&logger.seq, __ATOMIC_ACQUIRE);
+
+    pthread_mutex_lock(&logger.flush_lock);
+    while (__atomic_load_n(&logger.written, __ATOMIC_ACQUIRE) < target &&
+            __atomic_load_n(&logger.running, __ATOMIC_ACQUIRE)) {
+        sem_post(&logger.wakeup);
+        pthread_cond_wait(&logger.flushed, &logger.flush_lock);
+    }
+    pthread_mutex_unlock(&logger.flush_lock);
+}
+
+size_t
+ws_logger_dropped(void)
+{
+    size_t dropped = 0;
+
+    struct ring* ring = __atomic_load_n(&logger.rings, __ATOMIC_ACQUIRE);
+    while (ring) {
+        dropped += __atomic_load_n(&ring->dropped, __ATOMIC_RELAXED);
+        ring = ring->next;
+    }
 
-    pthread_mutex_unlock(&logger.loglock);
+    return dropped;
 }
 
 /*
- * void
- * ws_log_str(
- *     struct ws_string* const str
- * );
+ *
+ * Internal implementation
  *
  */
+
+static void
+cleanup_logger(
+    void* etc __ws_unused__
+) {
+    // new messages are written synchronously from now on
+    __atomic_store_n(&logger.running, false, __ATOMIC_RELEASE);
+    __atomic_store_n(&logger.stop, true, __ATOMIC_RELEASE);
+    sem_post(&logger.wakeup);
+    pthread_join(logger.writer, NULL);
+
+    // wake up anyone still waiting for a flush
+    pthread_mutex_lock(&logger.flush_lock);
+    pthread_cond_broadcast(&logger.flushed);
+    pthread_mutex_unlock(&logger.flush_lock);
+
+    sem_destroy(&logger.wakeup);
+}
+
+static int
+parse_level(
+    char const* str,
+    size_t len
+) {
+    static char const* const names[] = {
+        [LOG_EMERG] = "emerg",
+        [LOG_ALERT] = "alert",
+        [LOG_CRIT] = "crit",
+        [LOG_ERR] = "err",
+        [LOG_WARNING] = "warning",
+        [LOG_NOTICE] = "notice",
+        [LOG_INFO] = "info",
+        [LOG_DEBUG] = "debug",
+    };
+
+    if (len == 1 && str[0] >= '0' + LOG_EMERG && str[0] <= '0' + LOG_DEBUG) {
+        return str[0] - '0';
+    }
+
+    for (size_t i = 0; i < ARYLEN(names); ++i) {
+        if (strlen(names[i]) == len && !strncasecmp(str, names[i], len)) {
+            return i;
+        }
+    }
+
+    if (len == 5 && !strncasecmp(str, "error", len)) {
+        return LOG_ERR;
+    }
+    if (len == 4 && !strncasecmp(str, "warn", len)) {
+        return LOG_WARNING;
+    }
+    if (len == 3 && !strncasecmp(str, "off", len)) {
+        return LOG_EMERG - 1;
+    }
+
+    return -EINVAL;
+}
+
+static int
+parse_levels(
+    struct levels* levels,
+    char const* str
+) {
+    levels->fallback = LOG_ERR;
+    levels->num = 0;
+    levels->modules = NULL;
+
+    // the number of entries is bounded by the number of separators
+    size_t max = 1;
+    for (char const* it = str; *it; ++it) {
+        max += (*it == ',');
+    }
+
+    levels->modules = calloc(max, sizeof(*levels->modules));
+    if (!levels->modules) {
+        return -ENOMEM;
+    }
+
+    int res = 0;
+    while (*str) {
+        size_t len = strcspn(str, ",");
+        char const* next = str + len + (str[len] == ',');
+
+        // strip whitespace
+        while (len && isspace((unsigned char) *str)) {
+            ++str;
+            --len;
+        }
+        while (len && isspace((unsigned char) str[len - 1])) {
+            --len;
+        }
+
+        if (!len) {
+            str = next;
+            continue;
+        }
+
+        char const* colon = memchr(str, ':', len);
+        char const* level = colon ? colon + 1 : str;
+        size_t level_len = len - (level - str);
+        while (level_len && isspace((unsigned char) *level)) {
+            ++level;
+            --level_len;
+        }
+
+        int lvl = parse_level(level, level_len);
+        if (lvl < LOG_EMERG - 1) {
+            res = -EINVAL;
+            goto cleanup;
+        }
+
+        if (!colon) {
+            levels->fallback = lvl;
+            str = next;
+            continue;
+        }
+
+        size_t name_len = colon - str;
+        while (name_len && isspace((unsigned char) str[name_len - 1])) {
+            --name_len;
+        }
+        if (!name_len) {
+            res = -EINVAL;
+            goto cleanup;
+        }
+
+        struct module_level* module = levels->modules + levels->num;
+        module->name = strndup(str, name_len);
+        if (!module->name) {
+            res = -ENOMEM;
+            goto cleanup;
+        }
+        module->len = name_len;
+        module->level = lvl;
+        ++levels->num;
+
+        str = next;
+    }
+
+    return 0;
+
+cleanup:
+    free_levels(levels);
+    return res;
+}
+
+static void
+free_levels(
+    struct levels* levels
+) {
+    while (levels->num) {
+        free(levels->modules[--levels->num].name);
+    }
+    free(levels->modules);
+    levels->modules = NULL;
+}
+
+static int
+lookup_level(
+    struct ws_logger_context const* ctx
+) {
+    int level = config.levels.fallback;
+    if (!ctx->prefix) {
+        return level;
+    }
+
+    // the name is the prefix without the brackets, e.g. "Compositor/Cursor"
+    char const* name = ctx->prefix;
+    while (*name && !isalnum((unsigned char) *name)) {
+        ++name;
+    }
+
+    size_t matched = 0;
+    for (size_t i = 0; i < config.levels.num; ++i) {
+        struct module_level const* module = config.levels.modules + i;
+        if (module->len > matched &&
+                !strncasecmp(name, module->name, module->len) &&
+                !isalnum((unsigned char) name[module->len])) {
+            level = module->level;
+            matched = module->len;
+        }
+    }
+
+    return level;
+}
+
+static struct ring*
+get_ring(void)
+{
+    // once the writer is gone, messages are written by the logging thread
+    if (!__atomic_load_n(&logger.running, __ATOMIC_ACQUIRE)) {
+        return NULL;
+    }
+
+    if (local_ring) {
+        return local_ring;
+    }
+
+    // adopt the ring of a thread which exited, if any
+    struct ring* ring = __atomic_load_n(&logger.rings, __ATOMIC_ACQUIRE);
+    while (ring) {
+        bool owned = false;
+        if (__atomic_compare_exchange_n(&ring->owned, &owned, true, false,
+                                        __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            break;
+        }
+        ring = ring->next;
+    }
+
+    if (!ring) {
+        if (posix_memalign((void**) &ring, __alignof__(*ring),
+                           sizeof(*ring)) != 0) {
+            return NULL;
+        }
+        memset(ring, 0, sizeof(*ring));
+        ring->owned = true;
+
+        ring->next = __atomic_load_n(&logger.rings, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&logger.rings, &ring->next, ring,
+                                            true, __ATOMIC_RELEASE,
+                                            __ATOMIC_RELAXED));
+    }
+
+    pthread_setspecific(logger.ring_key, ring);
+    local_ring = ring;
+    return ring;
+}
+
+static void
+release_ring(
+    void* ring
+) {
+    local_ring = NULL;
+    __atomic_store_n(&((struct ring*) ring)->owned, false, __ATOMIC_RELEASE);
+}
+
+static bool
+parse_spec(
+    char const* str,
+    struct spec* spec
+) {
+    char const* it = str + 1;
+
+    spec->width_star = false;
+    spec->prec_star = false;
+    spec->prec = -1;
+    spec->length = LENGTH_NONE;
+
+    while (*it && strchr("-+ #0", *it)) {
+        ++it;
+    }
+
+    if (*it == '*') {
+        spec->width_star = true;
+        ++it;
+    } else {
+        while (*it >= '0' && *it <= '9') {
+            ++it;
+        }
+    }
+
+    if (*it == '.') {
+        ++it;
+        if (*it == '*') {
+            spec->prec_star = true;
+            ++it;
+        } else {
+            spec->prec = 0;
+            while (*it >= '0' && *it <= '9') {
+                spec->prec = spec->prec * 10 + (*it - '0');
+                ++it;
+            }
+        }
+    }
+
+    switch (*it) {
+    case 'h':
+        spec->length = (it[1] == 'h') ? LENGTH_HH : LENGTH_H;
+        it += (it[1] == 'h') ? 2 : 1;
+        break;
+    case 'l':
+        spec->length = (it[1] == 'l') ? LENGTH_LL : LENGTH_L;
+        it += (it[1] == 'l') ? 2 : 1;
+        break;
+    case 'j': spec->length = LENGTH_J; ++it; break;
+    case 'z': spec->length = LENGTH_Z; ++it; break;
+    case 't': spec->length = LENGTH_T; ++it; break;
+    case 'L': spec->length = LENGTH_BIG_L; ++it; break;
+    default:
+        break;
+    }
+
+    spec->conv = *it;
+    spec->len = it + 1 - str;
+    if (!*it || spec->len >= SPEC_LEN) {
+        return false;
+    }
+
+    switch (spec->conv) {
+    case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+        return spec->length != LENGTH_BIG_L;
+
+    case 'e': case 'E': case 'f': case 'F':
+    case 'g': case 'G': case 'a': case 'A':
+        return spec->length == LENGTH_NONE || spec->length == LENGTH_L ||
+               spec->length == LENGTH_BIG_L;
+
+    case 'c': case 's': case 'p': case '%':
+        return spec->length == LENGTH_NONE;
+
+    case 'n':
+        return true;
+
+    default:
+        // wide characters, `%m` and the like are formatted right away
+        return false;
+    }
+}
+
+static size_t
+store_text(
+    struct record* rec,
+    char const* str,
+    size_t len
+) {
+    size_t offset = rec->text_len;
+    len = MIN(len, RECORD_TEXT - 1 - offset);
+
+    memcpy(rec->text + offset, str, len);
+    rec->text[offset + len] = '\0';
+    rec->text_len = MIN(offset + len + 1, RECORD_TEXT - 1);
+
+    return offset;
+}
+
+static void
+pack_record(
+    struct record* rec,
+    struct ws_logger_context* const ctx,
+    char const* fmt,
+    va_list args
+) {
+    va_list copy;
+    va_copy(copy, args);
+
+    rec->fmt = fmt;
+    rec->nargs = 0;
+    rec->text_len = 0;
+    store_text(rec, (ctx && ctx->prefix) ? ctx->prefix : "",
+               (ctx && ctx->prefix) ? strlen(ctx->prefix) : 0);
+    size_t const prefix_end = rec->text_len;
+
+    struct spec spec;
+    char const* it = fmt;
+    while ((it = strchr(it, '%'))) {
+        if (!parse_spec(it, &spec)) {
+            goto preformat;
+        }
+        it += spec.len;
+
+        if (spec.conv == '%') {
+            continue;
+        }
+
+        unsigned int needed = spec.width_star + spec.prec_star + 1;
+        if (rec->nargs + needed > RECORD_ARGS) {
+            goto preformat;
+        }
+
+        union arg* arg = rec->args + rec->nargs;
+
+        if (spec.width_star) {
+            (arg++)->i = va_arg(args, int);
+        }
+
+        int prec = spec.prec;
+        if (spec.prec_star) {
+            prec = va_arg(args, int);
+            (arg++)->i = prec;
+        }
+
+        switch (spec.conv) {
+        case 'd': case 'i':
+            switch (spec.length) {
+            case LENGTH_L:  arg->i = va_arg(args, long); break;
+            case LENGTH_LL: arg->i = va_arg(args, long long); break;
+            case LENGTH_J:  arg->i = va_arg(args, intmax_t); break;
+            case LENGTH_Z:  arg->i = va_arg(args, ssize_t); break;
+            case LENGTH_T:  arg->i = va_arg(args, ptrdiff_t); break;
+            default:        arg->i = va_arg(args, int); break;
+            }
+            break;
+
+        case 'o': case 'u': case 'x': case 'X':
+            switch (spec.length) {
+            case LENGTH_L:  arg->u = va_arg(args, unsigned long); break;
+            case LENGTH_LL: arg->u = va_arg(args, unsigned long long); break;
+            case LENGTH_J:  arg->u = va_arg(args, uintmax_t); break;
+            case LENGTH_Z:  arg->u = va_arg(args, size_t); break;
+            case LENGTH_T:  arg->u = va_arg(args, ptrdiff_t); break;
+            default:        arg->u = va_arg(args, unsigned int); break;
+            }
+            break;
+
+        case 'c':
+            arg->i = va_arg(args, int);
+            break;
+
+        case 'e': case 'E': case 'f': case 'F':
+        case 'g': case 'G': case 'a': case 'A':
+            if (spec.length == LENGTH_BIG_L) {
+                arg->f = va_arg(args, long double);
+            } else {
+                arg->f = va_arg(args, double);
+            }
+            break;
+
+        case 's': {
+            // the string may be gone by the time the record is written
+            char const* str = va_arg(args, char const*);
+            if (!str) {
+                str = "(null)";
+            }
+            size_t len = (prec >= 0) ? strnlen(str, prec) : strlen(str);
+            arg->str = store_text(rec, str, len);
+            break;
+        }
+
+        case 'p':
+            arg->p = va_arg(args, void*);
+            break;
+
+        case 'n':
+            // nothing is written back, hence nothing to store
+            va_arg(args, void*);
+            --arg;
+            break;
+        }
+
+        rec->nargs = arg + 1 - rec->args;
+    }
+
+    va_end(copy);
+    return;
+
+preformat:
+    rec->fmt = NULL;
+    rec->nargs = 0;
+    rec->msg = prefix_end;
+    vsnprintf(rec->text + prefix_end, RECORD_TEXT - prefix_end, fmt, copy);
+    rec->text_len = RECORD_TEXT - 1;
+    va_end(copy);
+}
+
+static size_t
+format_record(
+    struct record const* rec,
+    char* buf,
+    size_t len
+) {
+    // leave room for the newline
+    size_t const room = len - 1;
+    size_t pos = 0;
+
+#define APPEND(res_) do { \
+        int res = (res_); \
+        if (res > 0) { \
+            pos = MIN(pos + res, room); \
+        } \
+    } while (0)
+
+    APPEND(snprintf(buf, room + 1, "%s", rec->text));
+
+    if (!rec->fmt) {
+        APPEND(snprintf(buf + pos, room + 1 - pos, "%s", rec->text + rec->msg));
+        goto out;
+    }
+
+    char const* it = rec->fmt;
+    union arg const* arg = rec->args;
+    struct spec spec;
+    while (*it && pos < room) {
+        char const* conv = strchr(it, '%');
+        if (!conv) {
+            APPEND(snprintf(buf + pos, room + 1 - pos, "%s", it));
+            break;
+        }
+
+        size_t lit = MIN((size_t) (conv - it), room - pos);
+        memcpy(buf + pos, it, lit);
+        pos += lit;
+
+        // the format was parsed successfully when the record was packed
+        parse_spec(conv, &spec);
+        it = conv + spec.len;
+
+        if (spec.conv == '%') {
+            if (pos < room) {
+                buf[pos++] = '%';
+            }
+            continue;
+        }
+
+        if (spec.conv == 'n') {
+            continue;
+        }
+
+        // build a specification with the star arguments filled in
+        char fmt[SPEC_LEN + 2 * 24];
+        size_t flen = 0;
+        for (char const* c = conv; c < it; ++c) {
+            if (*c == '*' && c[-1] == '.') {
+                --flen; // drop the dot in case of a negative precision
+                int prec = (arg++)->i;
+                if (prec >= 0) {
+                    flen += sprintf(fmt + flen, ".%d", prec);
+                }
+            } else if (*c == '*') {
+                flen += sprintf(fmt + flen, "%d", (int) (arg++)->i);
+            } else {
+                fmt[flen++] = *c;
+            }
+        }
+        fmt[flen] = '\0';
+
+        char* out = buf + pos;
+        size_t out_len = room + 1 - pos;
+        switch (spec.conv) {
+        case 'd': case 'i':
+            switch (spec.length) {
+            case LENGTH_L:  APPEND(snprintf(out, out_len, fmt, (long) arg->i));
+                            break;
+            case LENGTH_LL: APPEND(snprintf(out, out_len, fmt,
+                                            (long long) arg->i));
+                            break;
+            case LENGTH_J:  APPEND(snprintf(out, out_len, fmt, arg->i)); break;
+            case LENGTH_Z:  APPEND(snprintf(out, out_len, fmt,
+                                            (ssize_t) arg->i));
+                            break;
+            case LENGTH_T:  APPEND(snprintf(out, out_len, fmt,
+                                            (ptrdiff_t) arg->i));
+                            break;
+            default:        APPEND(snprintf(out, out_len, fmt, (int) arg->i));
+                            break;
+            }
+            break;
+
+        case 'o': case 'u': case 'x': case 'X':
+            switch (spec.length) {
+            case LENGTH_L:  APPEND(snprintf(out, out_len, fmt,
+                                            (unsigned long) arg->u));
+                            break;
+            case LENGTH_LL: APPEND(snprintf(out, out_len, fmt,
+                                            (unsigned long long) arg->u));
+                            break;
+            case LENGTH_J:  APPEND(snprintf(out, out_len, fmt, arg->u)); break;
+            case LENGTH_Z:
+            case LENGTH_T:  APPEND(snprintf(out, out_len, fmt,
+                                            (size_t) arg->u));
+                            break;
+            default:        APPEND(snprintf(out, out_len, fmt,
+                                            (unsigned int) arg->u));
+                            break;
+            }
+            break;
+
+        case 'c':
+            APPEND(snprintf(out, out_len, fmt, (int) arg->i));
+            break;
+
+        case 'e': case 'E': case 'f': case 'F':
+        case 'g': case 'G': case 'a': case 'A':
+            if (spec.length == LENGTH_BIG_L) {
+                APPEND(snprintf(out, out_len, fmt, arg->f));
+            } else {
+                APPEND(snprintf(out, out_len, fmt, (double) arg->f));
+            }
+            break;
+
+        case 's':
+            APPEND(snprintf(out, out_len, fmt, rec->text + arg->str));
+            break;
+
+        case 'p':
+            APPEND(snprintf(out, out_len, fmt, arg->p));
+            break;
+        }
+        ++arg;
+    }
+
+#undef APPEND
+
+out:
+    buf[pos++] = '\n';
+    return pos;
+}
+
+static void
+write_record(
+    struct record const* rec
+) {
+    char line[LINE_LEN];
+    size_t len = format_record(rec, line, sizeof(line));
+    fwrite(line, 1, len, stderr);
+}
+
+static void
+publish_record(
+    struct ring* ring,
+    size_t head
+) {
+    ring->records[head % RING_SLOTS].seq =
+        __atomic_fetch_add(&logger.seq, 1, __ATOMIC_RELAXED);
+    __atomic_store_n(&ring->head, head + 1, __ATOMIC_SEQ_CST);
+
+    // only bother the writer if it may be sleeping
+    if (__atomic_load_n(&logger.sleeping, __ATOMIC_SEQ_CST) &&
+            __atomic_exchange_n(&logger.sleeping, false, __ATOMIC_SEQ_CST)) {
+        sem_post(&logger.wakeup);
+    }
+}
+
+static size_t
+drain_rings(void)
+{
+    static char batch[BATCH_LEN];
+    static size_t reported = 0;
+    size_t len = 0;
+    size_t count = 0;
+
+    struct ring* rings = __atomic_load_n(&logger.rings, __ATOMIC_ACQUIRE);
+
+    while (true) {
+        // pick the oldest record available, keeping the order across threads
+        struct ring* next = NULL;
+        size_t next_seq = 0;
+        for (struct ring* ring = rings; ring; ring = ring->next) {
+            size_t tail = ring->tail;
+            if (tail == __atomic_load_n(&ring->head, __ATOMIC_SEQ_CST)) {
+                continue;
+            }
+
+            size_t seq = ring->records[tail % RING_SLOTS].seq;
+            if (!next || seq < next_seq) {
+                next = ring;
+                next_seq = seq;
+            }
+        }
+
+        if (!next) {
+            break;
+        }
+
+        if (BATCH_LEN - len < LINE_LEN) {
+            fwrite(batch, 1, len, stderr);
+            len = 0;
+        }
+
+        len += format_record(&next->records[next->tail % RING_SLOTS],
+                             batch + len, LINE_LEN);
+        __atomic_store_n(&next->tail, next->tail + 1, __ATOMIC_RELEASE);
+        ++count;
+    }
+
+    size_t dropped = ws_logger_dropped();
+    if (dropped != reported) {
+        if (BATCH_LEN - len < LINE_LEN) {
+            fwrite(batch, 1, len, stderr);
+            len = 0;
+        }
+        len += snprintf(batch + len, LINE_LEN,
+                        "[Logger] %zu messages dropped\n", dropped - reported);
+        reported = dropped;
+    }
+
+    if (len) {
+        fwrite(batch, 1, len, stderr);
+    }
+
+    if (count) {
+        __atomic_add_fetch(&logger.written, count, __ATOMIC_RELEASE);
+    }
+
+    pthread_mutex_lock(&logger.flush_lock);
+    pthread_cond_broadcast(&logger.flushed);
+    pthread_mutex_unlock(&logger.flush_lock);
+
+    return count;
+}
+
+static void*
+writer_run(
+    void* arg __ws_unused__
+) {
+    while (true) {
+        if (drain_rings()) {
+            continue;
+        }
+
+        if (__atomic_load_n(&logger.stop, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+
+        // announce that we may sleep, then check for late records
+        __atomic_store_n(&logger.sleeping, true, __ATOMIC_SEQ_CST);
+        if (drain_rings()) {
+            __atomic_store_n(&logger.sleeping, false, __ATOMIC_SEQ_CST);
+            continue;
+        }
+
+        struct timespec timeout;
+        clock_gettime(CLOCK_REALTIME, &timeout);
+        timeout.tv_nsec += WRITER_TIMEOUT;
+        if (timeout.tv_nsec >= 1000 * 1000 * 1000) {
+            timeout.tv_nsec -= 1000 * 1000 * 1000;
+            ++timeout.tv_sec;
+        }
+        while (sem_timedwait(&logger.wakeup, &timeout) != 0 && errno == EINTR);
+        __atomic_store_n(&logger.sleeping, false, __ATOMIC_SEQ_CST);
+    }
+
+    // a final round, for records published while we were stopping
+    drain_rings();
+    return NULL;
+}
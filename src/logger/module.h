@@ -37,16 +37,41 @@
 #define __WS_LOGGER_MODULE_H__
 
 #include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include <pthread.h>
 #include <syslog.h>
 
+/**
+ * Greatest log level compiled in
+ *
+ * Calls to `ws_log()` with a greater (i.e. less important) level are compiled
+ * out entirely. Set via the `LOG_LEVEL_MAX` CMake option.
+ */
+#ifndef WS_LOG_LEVEL_MAX
+#define WS_LOG_LEVEL_MAX LOG_DEBUG
+#endif
+
 /**
  * Logging context
+ *
+ * The level of a context is looked up by the name in its prefix, e.g.
+ * "compositor/cursor" for the prefix "[Compositor/Cursor] ", and cached in the
+ * context.
  */
 struct ws_logger_context {
     char const* prefix;
+    int level; //!< @private cached level of the context
+    unsigned int generation; //!< @private level configuration `level` is from
 };
 
+/**
+ * Generation of the level configuration
+ *
+ * @private Incremented each time the levels are set
+ */
+extern unsigned int ws_logger_generation;
+
 /**
  * Initialize the logger module
  *
@@ -55,13 +80,97 @@ struct ws_logger_context {
 int
 ws_logger_init(void);
 
+/**
+ * Set the log levels
+ *
+ * `levels` is a comma separated list of levels, each optionally preceded by a
+ * module name and a colon, e.g. "err,compositor:debug,json:warning". A level
+ * without a module name is the default level. Levels are given either by
+ * their number or by their name as in `syslog.h`, without the `LOG_` prefix
+ * (e.g. "debug"), or as "off".
+ *
+ * A module name matches contexts whose name starts with it, followed by a
+ * non-alphanumerical character or the end of the name. "compositor" hence
+ * matches "compositor" and "compositor/cursor", but not "compositors". If
+ * several module names match, the longest one is used.
+ *
+ * The initial levels are taken from the `WAYSOME_LOG_LEVEL` environment
+ * variable.
+ *
+ * @return zero on success, -EINVAL if `levels` is malformed or another negative
+ *         error code from errno.h
+ */
+int
+ws_logger_set_levels(
+    char const* levels //!< levels to set
+);
+
+/**
+ * Get the level of a logging context
+ *
+ * @note `ctx` can be NULL, in which case the default level is returned
+ *
+ * @return the greatest level messages are logged with for `ctx`
+ */
+int
+ws_logger_level(
+    struct ws_logger_context* const ctx //!< The logging context
+);
+
+/**
+ * Check whether messages with a level would be logged
+ *
+ * @note `ctx` can be NULL
+ */
+static inline bool
+ws_log_enabled(
+    struct ws_logger_context* const ctx, //!< The logging context
+    int lvl //!< Logging level
+) {
+    if (ctx && __atomic_load_n(&ctx->generation, __ATOMIC_ACQUIRE) ==
+            __atomic_load_n(&ws_logger_generation, __ATOMIC_RELAXED)) {
+        return lvl <= __atomic_load_n(&ctx->level, __ATOMIC_RELAXED);
+    }
+
+    return lvl <= ws_logger_level(ctx);
+}
+
 /**
  * Log with a logger
  *
+ * The level is checked before the arguments are evaluated, and messages with a
+ * level greater than `WS_LOG_LEVEL_MAX` are compiled out entirely.
+ *
+ * @note `ctx` can be NULL
+ */
+#define ws_log(ctx_, lvl_, ...) do {                                    \
+        if ((lvl_) <= WS_LOG_LEVEL_MAX && ws_log_enabled((ctx_), (lvl_))) { \
+            ws_log_fmt((ctx_), (lvl_), __VA_ARGS__);                    \
+        }                                                               \
+    } while (0)
+
+/**
+ * Log with a logger, regardless of the level
+ *
+ * Once the logger is initialized, messages are not written by the calling
+ * thread. Instead, the format string and the arguments are stored in a ring
+ * buffer local to the calling thread and formatted and written by a dedicated
+ * writer thread. Strings passed for `%s` conversions are copied, so they need
+ * not outlive the call. The format string itself, however, must be a literal
+ * or otherwise outlive the logger.
+ *
+ * If the ring buffer of the calling thread is full, the message is dropped
+ * rather than blocking the caller. Dropped messages are counted and reported
+ * by the writer.
+ *
+ * Messages at `LOG_ERR` or more severe are never queued or dropped. They are
+ * written synchronously, after all messages queued before, so they are not
+ * lost if the process exits right afterwards.
+ *
  * @note `ctx` can be NULL
  */
 void
-ws_log(
+ws_log_fmt(
     struct ws_logger_context* const ctx, //!< The logging context
     int lvl, //!< Logging level
     char* fmt,  //!< Format string
@@ -71,6 +180,8 @@ ws_log(
 /**
  * Log an null-terminated array of strings with a logger
  *
+ * Unlike `ws_log()`, this function checks the level itself.
+ *
  * @note `ctx` can be NULL
  */
 void
@@ -80,6 +191,22 @@ ws_log_ary(
     char** ary //!< ary to log
 );
 
+/**
+ * Wait until all messages logged so far are written
+ *
+ * @note Does nothing if the logger is not initialized
+ */
+void
+ws_logger_flush(void);
+
+/**
+ * Get the number of messages dropped so far
+ *
+ * @return the number of messages dropped because a ring buffer was full
+ */
+size_t
+ws_logger_dropped(void);
+
 /*
  * void
  * ws_log_str(
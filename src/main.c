@@ -38,6 +38,7 @@
 #include "input/module.h"
 #include "logger/module.h"
 #include "objects/object.h"
+#include "trace/module.h"
 #include "util/cleaner.h"
 #include "util/wayland.h"
 
@@ -114,6 +115,12 @@ main(
 
     ws_log(&log_main, LOG_DEBUG, "Logger initalized.");
 
+    retval = ws_trace_init();
+    if (retval != 0) {
+        ws_log(&log_main, LOG_ERR, "Could not start tracing.");
+        goto cleanup;
+    }
+
     retval = ws_connection_manager_init();
     if (retval != 0) {
         ws_log(&log_main, LOG_EMERG, "Failed to init Connection manager.");
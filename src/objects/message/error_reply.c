@@ -29,6 +29,7 @@
 
 #include "objects/message/error_reply.h"
 #include "objects/message/transaction.h"
+#include "util/slab.h"
 #include "values/value.h"
 
 
@@ -71,6 +72,12 @@ ws_object_type_id WS_OBJECT_TYPE_ID_ERROR_REPLY = {
     .function_table = NULL,
 };
 
+/**
+ * Pool for error replies allocated via `ws_error_reply_new()`
+ */
+static struct ws_slab_pool error_reply_pool =
+    WS_SLAB_POOL_INIT("ws_error_reply", sizeof(struct ws_error_reply));
+
 
 /*
  *
@@ -85,13 +92,13 @@ ws_error_reply_new(
     char const* description,
     char const* cause
 ) {
-    struct ws_error_reply* retval = calloc(1, sizeof(*retval));
+    struct ws_error_reply* retval = ws_slab_alloc(&error_reply_pool);
     if (!retval) {
         return NULL;
     }
 
     if (ws_message_init((struct ws_message*) retval, src->m.id) < 0) {
-        free(retval);
+        ws_slab_release(retval);
         return NULL;
     }
     ((struct ws_object*) retval)->id = &WS_OBJECT_TYPE_ID_ERROR_REPLY;
@@ -110,6 +117,9 @@ ws_error_reply_new(
         retval->cause = strdup(cause);
     }
 
+    // the reply is complete and won't change, so it doesn't need a lock
+    ((struct ws_object*) retval)->settings |= WS_OBJ_CONST;
+
     return retval;
 }
 
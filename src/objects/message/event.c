@@ -30,6 +30,7 @@
 #include "objects/message/event.h"
 #include "objects/string.h"
 #include "util/condition.h"
+#include "util/slab.h"
 #include "values/union.h"
 
 /*
@@ -62,6 +63,12 @@ ws_object_type_id WS_OBJECT_TYPE_ID_EVENT = {
     .function_table = NULL,
 };
 
+/**
+ * Pool for events allocated via `ws_event_new()`
+ */
+static struct ws_slab_pool event_pool =
+    WS_SLAB_POOL_INIT("ws_event", sizeof(struct ws_event));
+
 /*
  *
  * Interface implementation
@@ -114,7 +121,7 @@ ws_event_new(
     struct ws_string* name,
     struct ws_value* ctx
 ) {
-    struct ws_event* ev = calloc(1, sizeof(*ev));
+    struct ws_event* ev = ws_slab_alloc(&event_pool);
 
     if (!ev) {
         return NULL;
@@ -123,7 +130,7 @@ ws_event_new(
     int res = ws_event_init(ev, name, ctx);
 
     if (res != 0) {
-        free(ev);
+        ws_slab_release(ev);
         return NULL;
     }
 
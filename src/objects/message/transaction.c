@@ -28,10 +28,12 @@
 #include <errno.h>
 #include <stdlib.h>
 
+#include "command/bytecode.h"
 #include "command/command.h"
 #include "command/statement.h"
 #include "objects/message/message.h"
 #include "objects/message/transaction.h"
+#include "util/slab.h"
 
 /*
  *
@@ -47,6 +49,55 @@ deinit_transaction(
     struct ws_object* self
 );
 
+/**
+ * Create a new, empty command list
+ *
+ * @return the command list or NULL on failure
+ */
+static struct ws_transaction_command_list*
+command_list_new(void);
+
+/**
+ * Compile a command list
+ *
+ * @return zero on success, else negative errno.h number
+ */
+static int
+command_list_compile(
+    struct ws_transaction_command_list* cmds //!< commands to compile
+);
+
+/**
+ * Destroy a command list, including its statements
+ */
+static void
+command_list_destroy(
+    struct ws_transaction_command_list* cmds //!< commands to destroy
+);
+
+/**
+ * Get a transaction's own copy of a name
+ *
+ * Names identify transactions and never change, so transactions hold interned
+ * copies, which don't need locking. The caller's string is left alone.
+ *
+ * @return the copy, a reference on `name` if interning failed or NULL
+ */
+static struct ws_string*
+name_copy(
+    struct ws_string* name //!< name to copy, may be NULL
+);
+
+/**
+ * Hash callback for ws_transaction
+ *
+ * Transactions are hashed by their name, consistent with `cmp_transactions()`.
+ */
+static size_t
+hash_transaction(
+    struct ws_object* self
+);
+
 /**
  * Compare two transactions
  *
@@ -69,7 +120,7 @@ ws_object_type_id WS_OBJECT_TYPE_ID_TRANSACTION = {
     .typestr    = "ws_transaction",
 
     .deinit_callback = deinit_transaction,
-    .hash_callback = NULL,
+    .hash_callback = hash_transaction,
     .cmp_callback = cmp_transactions,
     .uuid_callback = NULL,
 
@@ -77,6 +128,12 @@ ws_object_type_id WS_OBJECT_TYPE_ID_TRANSACTION = {
     .function_table = NULL,
 };
 
+/**
+ * Pool for transactions allocated via `ws_transaction_new()`
+ */
+static struct ws_slab_pool transaction_pool =
+    WS_SLAB_POOL_INIT("ws_transaction", sizeof(struct ws_transaction));
+
 /*
  *
  * Interface implementation
@@ -95,8 +152,10 @@ ws_transaction_init(
     }
     self->m.obj.id = &WS_OBJECT_TYPE_ID_TRANSACTION;
 
-    self->name = getref(name);
+    self->name = name_copy(name);
     self->cmds = NULL;
+    self->parts = NULL;
+    self->parts_num = 0;
     self->flags = 0;
     return 0;
 }
@@ -108,14 +167,14 @@ ws_transaction_new(
     enum ws_transaction_flags flags,
     struct ws_transaction_command_list* cmds
 ) {
-    struct ws_transaction* t = calloc(1, sizeof(*t));
+    struct ws_transaction* t = ws_slab_alloc(&transaction_pool);
 
     if (!t) {
         return NULL;
     }
 
     if (ws_transaction_init(t, id, name) < 0) {
-        free(t);
+        ws_slab_release(t);
         return NULL;
     }
     t->m.obj.settings |= WS_OBJECT_HEAPALLOCED;
@@ -176,7 +235,7 @@ ws_transaction_set_name(
     struct ws_transaction* t,
     struct ws_string* name
 ) {
-    t->name = getref(name);
+    t->name = name_copy(name);
 }
 
 struct ws_transaction_command_list*
@@ -186,6 +245,57 @@ ws_transaction_commands(
     return t->cmds;
 }
 
+int
+ws_transaction_start_part(
+    struct ws_transaction* t
+) {
+    int res = -ENOMEM;
+    ws_object_lock_write(&t->m.obj);
+
+    // the commands we already have form the first part
+    size_t num = t->parts_num ? t->parts_num + 1 : (t->cmds ? 2 : 1);
+    struct ws_transaction_command_list** parts;
+    parts = realloc(t->parts, num * sizeof(*parts));
+    if (!parts) {
+        goto out;
+    }
+    t->parts = parts;
+
+    struct ws_transaction_command_list* cmds = command_list_new();
+    if (!cmds) {
+        goto out;
+    }
+
+    if (!t->parts_num && t->cmds) {
+        t->parts[t->parts_num++] = t->cmds;
+    }
+    t->parts[t->parts_num++] = cmds;
+    t->cmds = cmds;
+    res = 0;
+
+out:
+    ws_object_unlock(&t->m.obj);
+    return res;
+}
+
+size_t
+ws_transaction_parts_num(
+    struct ws_transaction* t
+) {
+    return t->parts_num;
+}
+
+struct ws_transaction_command_list*
+ws_transaction_part(
+    struct ws_transaction* t,
+    size_t part
+) {
+    if (part >= t->parts_num) {
+        return NULL;
+    }
+    return t->parts[part];
+}
+
 int
 ws_transaction_push_statement(
     struct ws_transaction* t,
@@ -194,16 +304,17 @@ ws_transaction_push_statement(
     ws_object_lock_write(&t->m.obj);
 
     if (!t->cmds) {
-        t->cmds = calloc(1, sizeof(*t->cmds));
+        t->cmds = command_list_new();
         if (!t->cmds) {
+            ws_object_unlock(&t->m.obj);
             return -ENOMEM;
         }
-
-        t->cmds->statements = NULL;
-        t->cmds->len          = 1;
-        t->cmds->num        = 0;
     }
 
+    // the bytecode is outdated now
+    ws_bytecode_destroy(t->cmds->code);
+    t->cmds->code = NULL;
+
     if (t->cmds->len + 1 >= t->cmds->num) {
         struct ws_statement* tmp;
         size_t newsize = (t->cmds->len * 2) * sizeof(*t->cmds->statements);
@@ -228,6 +339,28 @@ ws_transaction_push_statement(
     return 0;
 }
 
+int
+ws_transaction_compile(
+    struct ws_transaction* t
+) {
+    int res = 0;
+    ws_object_lock_write(&t->m.obj);
+
+    if (!t->parts_num) {
+        res = command_list_compile(t->cmds);
+        goto out;
+    }
+
+    size_t part;
+    for (part = 0; part < t->parts_num && res == 0; ++part) {
+        res = command_list_compile(t->parts[part]);
+    }
+
+out:
+    ws_object_unlock(&t->m.obj);
+    return res;
+}
+
 /*
  *
  * static function implementations
@@ -243,25 +376,102 @@ deinit_transaction(
 
     ws_object_unref((struct ws_object*) t->name);
 
-    if (!t->cmds) {
-        goto out;
-    }
-
-    if (!t->cmds->statements) {
+    if (!t->parts_num) {
+        command_list_destroy(t->cmds);
+        t->cmds = NULL;
         goto out;
     }
 
-    size_t statement = t->cmds->num;
-    while (statement--) {
-        ws_statement_deinit(&t->cmds->statements[statement]);
+    // the last part is also referenced by `cmds`
+    while (t->parts_num--) {
+        command_list_destroy(t->parts[t->parts_num]);
     }
-    t->cmds->num = 0;
+    free(t->parts);
+    t->parts = NULL;
+    t->parts_num = 0;
+    t->cmds = NULL;
 
 out:
     ws_object_unlock(self);
     return true;
 }
 
+static struct ws_transaction_command_list*
+command_list_new(void)
+{
+    struct ws_transaction_command_list* cmds = calloc(1, sizeof(*cmds));
+    if (!cmds) {
+        return NULL;
+    }
+
+    cmds->statements    = NULL;
+    cmds->len           = 1;
+    cmds->num           = 0;
+    cmds->code          = NULL;
+    cmds->stack_hint    = 0;
+    return cmds;
+}
+
+static int
+command_list_compile(
+    struct ws_transaction_command_list* cmds
+) {
+    if (!cmds || !cmds->statements) {
+        return -EINVAL;
+    }
+
+    if (cmds->code) {
+        // already compiled
+        return 0;
+    }
+
+    cmds->code = ws_bytecode_compile(cmds->statements, cmds->num);
+    if (!cmds->code) {
+        return -ENOMEM;
+    }
+    return 0;
+}
+
+static void
+command_list_destroy(
+    struct ws_transaction_command_list* cmds
+) {
+    if (!cmds) {
+        return;
+    }
+
+    ws_bytecode_destroy(cmds->code);
+
+    size_t statement = cmds->num;
+    while (statement--) {
+        ws_statement_deinit(&cmds->statements[statement]);
+    }
+
+    free(cmds->statements);
+    free(cmds);
+}
+
+static struct ws_string*
+name_copy(
+    struct ws_string* name
+) {
+    if (!name) {
+        return NULL;
+    }
+
+    // a plain reference merely costs locking
+    struct ws_string* copy = ws_string_intern(name);
+    return copy ? copy : getref(name);
+}
+
+static size_t
+hash_transaction(
+    struct ws_object* self
+) {
+    struct ws_transaction* t = (struct ws_transaction*) self;
+    return ws_string_hash(t->name);
+}
+
 static int
 cmp_transactions(
     struct ws_object const* o1,
@@ -47,6 +47,9 @@
 #include "objects/message/message.h"
 #include "objects/string.h"
 
+// forward declarations
+struct ws_bytecode;
+
 /**
  * Transaction action type
  *
@@ -64,11 +67,16 @@ struct ws_transaction_command_list {
     size_t len; //!< @protected length of the command array
     size_t num; //!< @protected next free position/number of statements
     struct ws_statement* statements; //!< @protected Transaction statements
+    struct ws_bytecode* code; //!< @protected compiled statements, if any
+    size_t stack_hint; //!< @protected stack high-water mark of previous runs
 };
 
 /**
  * Transaction type
  *
+ * A transaction may be a batch of several transactions, called parts, which
+ * are run in order and yield one aggregated reply.
+ *
  * @extends ws_message
  */
 struct ws_transaction {
@@ -80,6 +88,8 @@ struct ws_transaction {
     enum ws_transaction_flags flags; //!< @protected What should be done?
 
     struct ws_transaction_command_list* cmds; //!< @protected Commands
+    struct ws_transaction_command_list** parts; //!< @protected batch parts
+    size_t parts_num; //!< @protected number of parts, 0 if not a batch
 };
 
 extern ws_object_type_id WS_OBJECT_TYPE_ID_TRANSACTION;
@@ -87,7 +97,7 @@ extern ws_object_type_id WS_OBJECT_TYPE_ID_TRANSACTION;
 /**
  * Initialize a `ws_transaction` object
  *
- * @note Gets a ref on the name object for you
+ * @note Takes a copy of the name, the object passed is left alone
  *
  * @return 0 if the initialization was successful, a negative error number
  *         otherwise
@@ -104,7 +114,7 @@ __ws_nonnull__(1, 3)
 /**
  * Get a new `ws_transaction` object
  *
- * @note Gets a ref on the name object for you
+ * @note Takes a copy of the name, the object passed is left alone
  *
  * @return New transaction object or NULL on failure
  */
@@ -171,7 +181,7 @@ ws_transaction_name(
 /**
  * Set the name of the transaction
  *
- * @note Gets a ref on the name string object if it exists
+ * @note Takes a copy of the name, the object passed is left alone
  */
 void
 ws_transaction_set_name(
@@ -182,6 +192,8 @@ ws_transaction_set_name(
 /**
  * Get the command list of the transaction
  *
+ * For batches, this is the command list of the last part.
+ *
  * @return list of commands of the transaction
  */
 struct ws_transaction_command_list*
@@ -189,6 +201,41 @@ ws_transaction_commands(
     struct ws_transaction* t //!< The transaction
 );
 
+/**
+ * Start a new part of a batch
+ *
+ * Turns the transaction into a batch, if it isn't one already. Statements
+ * appended afterwards end up in the new part. Statements appended before the
+ * transaction became a batch form its first part.
+ *
+ * @return zero on success, else negative errno.h number
+ */
+int
+ws_transaction_start_part(
+    struct ws_transaction* t //!< The transaction
+);
+
+/**
+ * Get the number of parts of a batch
+ *
+ * @return number of parts or 0, if the transaction is not a batch
+ */
+size_t
+ws_transaction_parts_num(
+    struct ws_transaction* t //!< The transaction
+);
+
+/**
+ * Get the command list of a part of a batch
+ *
+ * @return list of commands of the part or NULL, if there is no such part
+ */
+struct ws_transaction_command_list*
+ws_transaction_part(
+    struct ws_transaction* t, //!< The transaction
+    size_t part //!< index of the part
+);
+
 /**
  * Append a statement to the transaction
  *
@@ -202,6 +249,20 @@ ws_transaction_push_statement(
     struct ws_statement* statement //!< The statement to add
 );
 
+/**
+ * Compile the statements of the transaction
+ *
+ * Compiles the statements into bytecode which will be used by processors
+ * running the transaction from then on. This is worth the effort only for
+ * transactions which are run repeatedly. All parts of a batch are compiled.
+ *
+ * @return zero on success, else negative errno.h number
+ */
+int
+ws_transaction_compile(
+    struct ws_transaction* t //!< The transaction
+);
+
 #endif //__WS_OBJECTS_TRANSACTION_H__
 
 /**
@@ -27,6 +27,7 @@
 
 #include "objects/message/transaction.h"
 #include "objects/message/value_reply.h"
+#include "util/slab.h"
 
 /*
  *
@@ -61,6 +62,12 @@ ws_object_type_id WS_OBJECT_TYPE_ID_VALUE_REPLY = {
     .function_table = NULL,
 };
 
+/**
+ * Pool for value replies allocated via `ws_value_reply_new()`
+ */
+static struct ws_slab_pool value_reply_pool =
+    WS_SLAB_POOL_INIT("ws_value_reply", sizeof(struct ws_value_reply));
+
 
 /*
  *
@@ -73,7 +80,7 @@ ws_value_reply_new(
     struct ws_transaction* src,
     struct ws_value* value
 ) {
-    struct ws_value_reply* retval = calloc(1, sizeof(*retval));
+    struct ws_value_reply* retval = ws_slab_alloc(&value_reply_pool);
     if (!retval) {
         return NULL;
     }
@@ -96,10 +103,13 @@ ws_value_reply_new(
         ws_value_nil_init(&retval->value.nil);
     }
 
+    // the reply is complete and won't change, so it doesn't need a lock
+    ((struct ws_object*) retval)->settings |= WS_OBJ_CONST;
+
     return retval;
 
 cleanup:
-    free(retval);
+    ws_slab_release(retval);
     return NULL;
 }
 
@@ -28,6 +28,7 @@
 #include <malloc.h>
 
 #include "objects/named.h"
+#include "util/slab.h"
 
 /*
  *
@@ -60,6 +61,12 @@ ws_object_type_id WS_OBJECT_TYPE_ID_NAMED = {
     .function_table = NULL,
 };
 
+/**
+ * Pool for named objects allocated via `ws_named_new()`
+ */
+static struct ws_slab_pool named_pool =
+    WS_SLAB_POOL_INIT("ws_named", sizeof(struct ws_named));
+
 
 /*
  *
@@ -80,6 +87,9 @@ ws_named_init(
     }
     self->str.obj.id = &WS_OBJECT_TYPE_ID_NAMED;
 
+    // named objects never change, so they don't need a lock
+    self->str.obj.settings |= WS_OBJ_CONST;
+
     if (!ws_string_set_from_str(&self->str, name)) {
         return -1;
     }
@@ -96,13 +106,13 @@ ws_named_new(
     struct ws_string* name, //!< name of the object
     struct ws_object* val //!< valu eof the object
 ) {
-    struct ws_named* retval = calloc(1, sizeof(*retval));
+    struct ws_named* retval = ws_slab_alloc(&named_pool);
     if (!retval) {
         return NULL;
     }
 
     if (ws_named_init(retval, name, val) < 0) {
-        free(retval);
+        ws_slab_release(retval);
         return NULL;
     }
 
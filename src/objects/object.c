@@ -34,7 +34,10 @@
 
 #include "logger/module.h"
 #include "objects/object.h"
+#include "util/arithmetical.h"
+#include "util/cleaner.h"
 #include "util/condition.h"
+#include "util/slab.h"
 #include "util/string.h"
 #include "values/bool.h"
 #include "values/int.h"
@@ -42,18 +45,283 @@
 #include "values/object_id.h"
 #include "values/set.h"
 #include "values/string.h"
+#include "values/union.h"
 #include "values/value_type.h"
 
 static struct ws_logger_context log_ctx = {
     .prefix = "[Object] ",
 };
 
+/**
+ * Settings of objects which are never locked
+ */
+#define NO_LOCK_SETTINGS (WS_OBJ_CONST | WS_OBJECT_CONFINED)
+
+/**
+ * Number of buckets in the type index cache, power of two
+ */
+#define TYPE_INDEX_BUCKETS 64
+
+/**
+ * Entry in a type index table
+ */
+struct type_index_entry {
+    char const* name; //!< name of the attribute or function, NULL if free
+    uint32_t hash; //!< hash of the name
+    void const* item; //!< the ws_object_attribute or ws_object_function
+};
+
+/**
+ * Hashed index over the attributes and functions of a type
+ *
+ * The index contains the entries of the type's tables and those of all its
+ * supertypes, with entries of subtypes shadowing the ones of supertypes. Both
+ * tables use open addressing with linear probing. Indices are created on first
+ * use and never change afterwards.
+ */
+struct type_index {
+    ws_object_type_id* type; //!< the type the index is for
+    struct type_index* next; //!< next index in the same cache bucket
+
+    struct type_index_entry* attrs; //!< attribute table
+    size_t attrs_mask; //!< number of attribute slots minus one
+    struct type_index_entry* funcs; //!< function table
+    size_t funcs_mask; //!< number of function slots minus one
+};
+
+/**
+ * Cache of type indices
+ *
+ * Buckets are chains which are only ever prepended to, using atomic
+ * operations. Readers don't need a lock.
+ */
+static struct {
+    pthread_mutex_t lock; //!< lock serializing index creation
+    struct type_index* buckets[TYPE_INDEX_BUCKETS]; //!< chains of indices
+    bool cleaner_registered; //!< whether the cleanup is registered
+} type_index_cache = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/**
+ * Number of attribute handles per chunk
+ */
+#define ATTR_HANDLE_CHUNK 256
+
+/**
+ * Maximum number of attribute handles
+ */
+#define ATTR_HANDLE_MAX (ATTR_HANDLE_CHUNK * ATTR_HANDLE_CHUNK)
+
+/**
+ * Resolved attribute, referred to by a handle
+ */
+struct attr_handle {
+    ws_object_type_id* type; //!< type the attribute was resolved for
+    struct ws_object_attribute const* attr; //!< the attribute
+};
+
+/**
+ * Registry of attribute handles
+ *
+ * A handle is the index of its entry plus one. Entries live in fixed size
+ * chunks which are never moved, so readers only need to check the handle
+ * against the number of entries.
+ */
+static struct {
+    pthread_mutex_t lock; //!< lock serializing the creation of handles
+    struct attr_handle* chunks[ATTR_HANDLE_CHUNK]; //!< chunks of entries
+    size_t num; //!< number of entries
+} attr_handles = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+/**
+ * Read log active on the current thread, if any
+ */
+static __thread struct ws_object_read_log* read_log;
+
+/**
+ * Pools serving `ws_object_new()`, by increasing chunk size
+ *
+ * Types with a dedicated pool allocate from it directly, these pools serve
+ * all other types.
+ */
+static struct ws_slab_pool object_pools[] = {
+    WS_SLAB_POOL_INIT("ws_object/64",   64),
+    WS_SLAB_POOL_INIT("ws_object/128",  128),
+    WS_SLAB_POOL_INIT("ws_object/256",  256),
+    WS_SLAB_POOL_INIT("ws_object/512",  512),
+};
+
+/**
+ * Pool for the lazily created locks of objects
+ */
+static struct ws_slab_pool lock_pool =
+    WS_SLAB_POOL_INIT("ws_object/lock", sizeof(pthread_rwlock_t));
+
 /*
  *
  * Forward declarations
  *
  */
 
+/**
+ * Get the lock of an object, creating it if necessary
+ *
+ * `*lock` is set to NULL for objects which are never locked.
+ *
+ * @return zero on success, else negative error code from errno.h
+ */
+static int
+get_lock(
+    struct ws_object* self, //!< The object
+    pthread_rwlock_t** lock //!< Output: the lock of the object
+)
+__ws_nonnull__(1, 2)
+;
+
+/**
+ * Read an attribute's member into a value of the matching type
+ *
+ * @warning the caller has to hold a read lock on the object
+ *
+ * @return zero on success, else negative error code from errno.h
+ */
+static int
+attr_read_member(
+    struct ws_object* self, //!< The object
+    struct ws_object_attribute const* attr, //!< The attribute to read
+    struct ws_value* dest //!< Destination of the data
+)
+__ws_nonnull__(1, 2, 3)
+;
+
+/**
+ * Log an attribute read of an object in the thread's read log
+ *
+ * @warning the caller has to hold a read lock on the object
+ */
+static void
+read_log_record(
+    struct ws_object* self //!< The object read
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Check the type of a value and write it to an attribute's member
+ *
+ * @return zero on success, else negative error code from errno.h
+ */
+static int
+attr_write_checked(
+    struct ws_object* self, //!< The object
+    struct ws_object_attribute const* attr, //!< The attribute to write
+    struct ws_value* src //!< Source of the data
+)
+__ws_nonnull__(1, 2, 3)
+;
+
+/**
+ * Get the entry at a specific index in the handle registry
+ *
+ * @return the entry
+ */
+static struct attr_handle const*
+attr_handle_at(
+    size_t index //!< index of the entry
+);
+
+/**
+ * Get the entry of a handle
+ *
+ * @return the entry or NULL, if the handle is invalid
+ */
+static struct attr_handle const*
+attr_handle_get(
+    intmax_t handle //!< handle to look up
+);
+
+/**
+ * Release the handle registry
+ */
+static void
+attr_handles_cleanup(
+    void* dummy //!< unused
+);
+
+/**
+ * Get the index of a type, create it if necessary
+ *
+ * @return the index or NULL if it could not be created
+ */
+static struct type_index const*
+type_index_get(
+    ws_object_type_id* type //!< type to get the index for
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Create the index of a type
+ *
+ * @return a new index or NULL on failure
+ */
+static struct type_index*
+type_index_new(
+    ws_object_type_id* type //!< type to create the index for
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Look up an item in a table of a type index
+ *
+ * @return the item or NULL, if there is no item with the name
+ */
+static void const*
+type_index_find(
+    struct type_index_entry const* table, //!< table to search in
+    size_t mask, //!< number of slots minus one
+    char const* name //!< name to search
+)
+__ws_nonnull__(3)
+;
+
+/**
+ * Insert an item into a table of a type index, unless the name is present
+ */
+static void
+type_index_insert(
+    struct type_index_entry* table, //!< table to insert into
+    size_t mask, //!< number of slots minus one
+    char const* name, //!< name of the item
+    void const* item //!< the item
+)
+__ws_nonnull__(1, 3, 4)
+;
+
+/**
+ * Hash a name
+ *
+ * @return the hash of the name
+ */
+static uint32_t
+hash_name(
+    char const* name //!< name to hash
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Release all type indices
+ */
+static void
+type_index_cleanup(
+    void* dummy //!< unused
+);
+
 /*
  * Attribute information about the type
  */
@@ -91,9 +359,13 @@ ws_object_type_id WS_OBJECT_TYPE_ID_OBJECT = {
 static const struct {
     enum ws_value_type type;
 } ATTR_TYPE_VALUE_TYPE_MAP[] = {
-//    [WS_OBJ_ATTR_TYPE_CHAR]     = {
-//        .type = WS_VALUE_TYPE_STRING,
-//    },
+    [WS_OBJ_ATTR_TYPE_BOOL]     = {
+        .type = WS_VALUE_TYPE_BOOL,
+    },
+
+    [WS_OBJ_ATTR_TYPE_CHAR]     = {
+        .type = WS_VALUE_TYPE_INT,
+    },
 
     [WS_OBJ_ATTR_TYPE_INT32]    = {
         .type = WS_VALUE_TYPE_INT,
@@ -131,7 +403,16 @@ ws_object_new(
 
     ws_log(&log_ctx, LOG_DEBUG, "Allocating");
 
-    struct ws_object* o = calloc(1, s);
+    struct ws_object* o = NULL;
+    for (size_t i = 0; i < ARYLEN(object_pools); ++i) {
+        if (s <= object_pools[i].size) {
+            o = ws_slab_alloc(object_pools + i);
+            break;
+        }
+    }
+    if (!o) {
+        o = calloc(1, s);
+    }
 
     if (o) {
         ws_object_init(o);
@@ -180,10 +461,23 @@ ws_object_set_settings(
     struct ws_object* self,
     enum ws_object_settings settings
 ) {
-    if (self) {
-        ws_object_lock_write(self);
-        self->settings = settings;
-        ws_object_unlock(self);
+    if (!self) {
+        return;
+    }
+
+    // the settings decide whether the object is locked at all, so we have to
+    // stick to the lock we got before the change
+    pthread_rwlock_t* lock;
+    if (get_lock(self, &lock) < 0) {
+        return;
+    }
+
+    if (lock) {
+        pthread_rwlock_wrlock(lock);
+    }
+    self->settings = settings;
+    if (lock) {
+        pthread_rwlock_unlock(lock);
     }
 }
 
@@ -196,11 +490,11 @@ ws_object_init(
 
         self->settings = WS_OBJ_NO_SETTINGS;
 
-        pthread_rwlock_init(&self->rw_lock, NULL);
-        pthread_mutex_init(&self->ref_counting.lock, NULL);
+        self->rw_lock = NULL;
         self->ref_counting.refcnt = 1;
 
         self->uuid = 0;
+        self->attr_version = 0;
 
         self->id = &WS_OBJECT_TYPE_ID_OBJECT;
 
@@ -218,11 +512,8 @@ ws_object_getref(
         return self;
     }
 
-    if (pthread_mutex_lock(&self->ref_counting.lock) != 0) {
-        return NULL;
-    };
-    self->ref_counting.refcnt++;
-    pthread_mutex_unlock(&self->ref_counting.lock);
+    // the caller already holds a reference, so nothing has to be ordered here
+    __atomic_add_fetch(&self->ref_counting.refcnt, 1, __ATOMIC_RELAXED);
 
     return self;
 }
@@ -235,19 +526,14 @@ ws_object_unref(
         return;
     }
 
-    if (pthread_mutex_lock(&self->ref_counting.lock) != 0) {
-        return;
-    };
-    self->ref_counting.refcnt--;
-
-    if (self->ref_counting.refcnt) {
-        pthread_mutex_unlock(&self->ref_counting.lock);
+    // release our accesses to the object, and make sure whoever drops the last
+    // reference sees the accesses of all the others before destroying it
+    if (__atomic_sub_fetch(&self->ref_counting.refcnt, 1, __ATOMIC_ACQ_REL)) {
         return;
     }
-    pthread_mutex_unlock(&self->ref_counting.lock);
 
     ws_object_deinit(self);
-    free(self);
+    ws_slab_release(self);
 }
 
 ssize_t
@@ -281,42 +567,74 @@ bool
 ws_object_lock_read(
     struct ws_object* self
 ) {
-    return 0 == pthread_rwlock_rdlock(&self->rw_lock);
+    pthread_rwlock_t* lock;
+    if (get_lock(self, &lock) < 0) {
+        return false;
+    }
+
+    return !lock || 0 == pthread_rwlock_rdlock(lock);
 }
 
 bool
 ws_object_lock_write(
     struct ws_object* self
 ) {
-    return 0 == pthread_rwlock_wrlock(&self->rw_lock);
+    pthread_rwlock_t* lock;
+    if (get_lock(self, &lock) < 0) {
+        return false;
+    }
+
+    return !lock || 0 == pthread_rwlock_wrlock(lock);
 }
 
 int
 ws_object_lock_try_read(
     struct ws_object* self
 ) {
-    return -pthread_rwlock_tryrdlock(&self->rw_lock);
+    pthread_rwlock_t* lock;
+    int res = get_lock(self, &lock);
+    if (res < 0 || !lock) {
+        return res;
+    }
+
+    return -pthread_rwlock_tryrdlock(lock);
 }
 
 int
 ws_object_lock_try_write(
     struct ws_object* self
 ) {
-    return -pthread_rwlock_trywrlock(&self->rw_lock);
+    pthread_rwlock_t* lock;
+    int res = get_lock(self, &lock);
+    if (res < 0 || !lock) {
+        return res;
+    }
+
+    return -pthread_rwlock_trywrlock(lock);
 }
 
 bool
 ws_object_unlock(
     struct ws_object* self
 ) {
-    return 0 == pthread_rwlock_unlock(&self->rw_lock);
+    if (self->settings & NO_LOCK_SETTINGS) {
+        return true;
+    }
+
+    // if there is no lock, nobody can hold it
+    pthread_rwlock_t* lock = __atomic_load_n(&self->rw_lock, __ATOMIC_ACQUIRE);
+    return !lock || 0 == pthread_rwlock_unlock(lock);
 }
 
 void
 ws_object_deinit(
     struct ws_object* self
 ) {
-    ws_object_lock_write(self);
+    // wait for other holders of the lock, but don't create one just for that
+    pthread_rwlock_t* lock = __atomic_load_n(&self->rw_lock, __ATOMIC_ACQUIRE);
+    if (lock) {
+        pthread_rwlock_wrlock(lock);
+    }
 
     // traverse towards the root, deinitializing
     ws_object_type_id* type = self->id;
@@ -330,9 +648,16 @@ ws_object_deinit(
         type = type->supertype;
     }
 
-    // destroy the locks
-    pthread_mutex_destroy(&self->ref_counting.lock);
-    pthread_rwlock_destroy(&self->rw_lock);
+    if (lock) {
+        pthread_rwlock_unlock(lock);
+    }
+
+    // destroy the lock, which may also have been created by the callbacks
+    lock = __atomic_exchange_n(&self->rw_lock, NULL, __ATOMIC_ACQ_REL);
+    if (lock) {
+        pthread_rwlock_destroy(lock);
+        ws_slab_release(lock);
+    }
 }
 
 bool
@@ -340,28 +665,11 @@ ws_object_has_attr(
     struct ws_object* self,
     char const* ident
 ) {
-    ws_object_lock_read(self);
-    if (unlikely(!self->id || !self->id->attribute_table)) {
-        ws_object_unlock(self);
+    if (unlikely(!self->id)) {
         return false;
     }
 
-    ws_object_type_id* curtype = self->id;
-
-    while (curtype != &WS_OBJECT_TYPE_ID_OBJECT) {
-        struct ws_object_attribute const* iter;
-        for (iter = &self->id->attribute_table[0]; iter->name; iter++) {
-            if (ws_streq(iter->name, ident)) {
-                ws_object_unlock(self);
-                return true;
-            }
-        }
-
-        curtype = curtype->supertype;
-    }
-
-    ws_object_unlock(self);
-    return false;
+    return !!ws_object_type_get_attr(self->id, ident);
 }
 
 int
@@ -370,106 +678,32 @@ ws_object_attr_read(
     char const* ident,
     struct ws_value* dest
 ) {
-    if (unlikely(!self->id || !self->id->attribute_table)) {
+    if (unlikely(!self->id)) {
         return -EINVAL;
     }
 
-
-    ws_object_lock_read(self);
-
-    bool found = false;
-    size_t offset = 0;
-    enum ws_object_attribute_type type = WS_OBJ_ATTR_NO_TYPE;
-
-    struct ws_object_attribute const* iter;
-    ws_object_type_id* otype = self->id;
-    while (!found && otype != &WS_OBJECT_TYPE_ID_OBJECT) {
-        for (iter = &self->id->attribute_table[0];
-                iter->name && !found; iter++) {
-            if (ws_streq(iter->name, ident)) {
-                offset  = iter->offset_in_struct;
-                type    = iter->type;
-                found   = true;
-            }
-        }
-
-        otype = otype->supertype;
-    }
-
-    if (unlikely(!found)) {
-        ws_object_unlock(self);
+    // the lookup doesn't touch the object, so we don't need the lock yet
+    struct ws_object_attribute const* attr;
+    attr = ws_object_type_get_attr(self->id, ident);
+    if (unlikely(!attr)) {
         return -ECANCELED;
     }
 
-    if (unlikely(type & WS_OBJ_ATTR_NO_TYPE)) {
-        ws_object_unlock(self);
+    if (unlikely(attr->type == WS_OBJ_ATTR_NO_TYPE)) {
         return -EFAULT;
     }
 
-    if (unlikely(ATTR_TYPE_VALUE_TYPE_MAP[type].type !=
+    if (unlikely(ATTR_TYPE_VALUE_TYPE_MAP[attr->type].type !=
                 ws_value_get_type(dest))) {
         /* Types not matching */
-        ws_object_unlock(self);
         return -EINVAL;
     }
 
-    void* member_pos = (void *) (((char *) self) + offset);
-    switch (type) {
-    case WS_OBJ_ATTR_TYPE_BOOL:
-        ws_value_bool_set((struct ws_value_bool*) dest,
-                          (bool) *((bool*) member_pos));
-        break;
-
-    case WS_OBJ_ATTR_TYPE_CHAR:
-        ws_value_int_set((struct ws_value_int*) dest,
-                         (char) *((int32_t*) member_pos));
-        break;
-
-    case WS_OBJ_ATTR_TYPE_INT32:
-        ws_value_int_set((struct ws_value_int*) dest,
-                         (intmax_t) *((int32_t*) member_pos));
-        break;
-
-    case WS_OBJ_ATTR_TYPE_INT64:
-        ws_value_int_set((struct ws_value_int*) dest,
-                         (intmax_t) *((int64_t*) member_pos));
-        break;
-
-    case WS_OBJ_ATTR_TYPE_UINT32:
-        ws_value_int_set((struct ws_value_int*) dest,
-                         (intmax_t) *((uint32_t*) member_pos));
-        break;
-
-    case WS_OBJ_ATTR_TYPE_UINT64:
-        ws_value_int_set((struct ws_value_int*) dest,
-                         (intmax_t) *((uint64_t*) member_pos));
-        break;
-
-    case WS_OBJ_ATTR_TYPE_STRING:
-        {
-            struct ws_string* s = ws_string_new();
-            if (unlikely(!s)) {
-                return -ENOMEM;
-            }
-
-            ws_string_set_from_raw(s, *(char**) member_pos);
-
-            ws_value_string_set_str((struct ws_value_string*) dest, s);
-        }
-        break;
-
-    case WS_OBJ_ATTR_TYPE_OBJ:
-        ws_value_object_id_set((struct ws_value_object_id*) dest,
-                                *(struct ws_object**) member_pos);
-        break;
-
-    default:
-        ws_log(&log_ctx, LOG_EMERG, "Unhandleable value type identifier");
-        break;
-    };
-
+    ws_object_lock_read(self);
+    int res = attr_read_member(self, attr, dest);
     ws_object_unlock(self);
-    return 0;
+
+    return res;
 }
 
 int
@@ -478,128 +712,203 @@ ws_object_attr_write(
     char const* ident, //!< The identifier for the attribute
     struct ws_value* src //!< Source of the data
 ) {
-    if (unlikely(!self->id || !self->id->attribute_table)) {
+    if (unlikely(!self->id)) {
         return -EINVAL;
     }
 
-    bool found = false;
-    size_t offset = 0;
-    enum ws_object_attribute_type type = WS_OBJ_ATTR_NO_TYPE;
-
-    ws_object_lock_write(self);
-
-    struct ws_object_attribute const* iter;
-    ws_object_type_id* otype = self->id;
-    while (!found && otype != &WS_OBJECT_TYPE_ID_OBJECT) {
-        for (iter = &self->id->attribute_table[0];
-                iter->name && !found; iter++) {
-            if (ws_streq(iter->name, ident)) {
-                offset  = iter->offset_in_struct;
-                type    = iter->type;
-                found   = true;
-            }
-        }
-
-        otype = otype->supertype;
+    struct ws_object_attribute const* attr;
+    attr = ws_object_type_get_attr(self->id, ident);
+    if (unlikely(!attr)) {
+        return -ECANCELED;
     }
 
-    if (unlikely(!found)) {
-        ws_object_unlock(self);
+    return attr_write_checked(self, attr, src);
+}
+
+intmax_t
+ws_object_attr_handle(
+    ws_object_type_id* type,
+    char const* ident
+) {
+    struct ws_object_attribute const* attr;
+    attr = ws_object_type_get_attr(type, ident);
+    if (!attr) {
         return -ECANCELED;
     }
 
-    if (unlikely(type & WS_OBJ_ATTR_NO_TYPE)) {
-        ws_object_unlock(self);
+    if (unlikely(attr->type == WS_OBJ_ATTR_NO_TYPE)) {
         return -EFAULT;
     }
 
-    if (unlikely(ATTR_TYPE_VALUE_TYPE_MAP[type].type !=
-                ws_value_get_type(src))) {
-        /* Types not matching */
-        ws_object_unlock(self);
-        return -EINVAL;
-    }
-
-    void* member_pos = (void *) (((char *) self) + offset);
+    pthread_mutex_lock(&attr_handles.lock);
 
-    switch (type) {
-    case WS_OBJ_ATTR_TYPE_CHAR:
-        return -ENOTSUP;
-        break;
-
-    case WS_OBJ_ATTR_TYPE_INT32:
-        {
-            intmax_t i = ws_value_int_get((struct ws_value_int*) src);
-            *((int32_t*) member_pos) = (int32_t) i;
-        }
-        break;
-
-    case WS_OBJ_ATTR_TYPE_INT64:
-        {
-            intmax_t i = ws_value_int_get((struct ws_value_int*) src);
-            *((int64_t*) member_pos) = (int64_t) i;
+    // hand out the same handle for the same attribute
+    size_t i;
+    for (i = 0; i < attr_handles.num; ++i) {
+        struct attr_handle const* h = attr_handle_at(i);
+        if ((h->type == type) && (h->attr == attr)) {
+            pthread_mutex_unlock(&attr_handles.lock);
+            return i + 1;
         }
-        break;
+    }
 
-    case WS_OBJ_ATTR_TYPE_UINT32:
-        {
-            intmax_t i = ws_value_int_get((struct ws_value_int*) src);
-            *((uint32_t*) member_pos) = (uint32_t) i;
-        }
-        break;
+    if (unlikely(attr_handles.num >= ATTR_HANDLE_MAX)) {
+        pthread_mutex_unlock(&attr_handles.lock);
+        return -ENOSPC;
+    }
 
-    case WS_OBJ_ATTR_TYPE_UINT64:
-        {
-            intmax_t i = ws_value_int_get((struct ws_value_int*) src);
-            *((uint64_t*) member_pos) = (uint64_t) i;
+    size_t chunk = attr_handles.num / ATTR_HANDLE_CHUNK;
+    if (!attr_handles.chunks[chunk]) {
+        attr_handles.chunks[chunk] = calloc(ATTR_HANDLE_CHUNK,
+                                            sizeof(struct attr_handle));
+        if (unlikely(!attr_handles.chunks[chunk])) {
+            pthread_mutex_unlock(&attr_handles.lock);
+            return -ENOMEM;
         }
-        break;
 
-    case WS_OBJ_ATTR_TYPE_STRING:
-        {
-            struct ws_value_string* _s = (struct ws_value_string*) src;
-            struct ws_string* s = ws_value_string_get(_s);
-            free(member_pos);
-            *((char**) member_pos) = ws_string_raw(s); // copies!
+        if (chunk == 0) {
+            ws_cleaner_add(attr_handles_cleanup, &attr_handles);
         }
-        break;
+    }
 
-    case WS_OBJ_ATTR_TYPE_OBJ:
-        return -ENOTSUP;
-        break;
+    struct attr_handle* h = attr_handles.chunks[chunk] +
+                            attr_handles.num % ATTR_HANDLE_CHUNK;
+    h->type = type;
+    h->attr = attr;
 
-    default:
-        ws_log(&log_ctx, LOG_EMERG, "Unhandleable value type identifier");
-        return -ENOTSUP;
-        break;
-    };
+    // publish the entry before the new count
+    __atomic_store_n(&attr_handles.num, attr_handles.num + 1,
+                     __ATOMIC_RELEASE);
+    intmax_t handle = attr_handles.num;
 
-    ws_object_unlock(self);
-    return 0;
+    pthread_mutex_unlock(&attr_handles.lock);
+    return handle;
 }
 
-enum ws_object_attribute_type
-ws_object_attr_type(
+int
+ws_object_attr_read_handle(
     struct ws_object* self,
-    char* ident
+    intmax_t handle,
+    union ws_value_union* dest
 ) {
+    struct attr_handle const* h = attr_handle_get(handle);
+    if (unlikely(!h)) {
+        return -EINVAL;
+    }
+
+    if (unlikely((self->id != h->type) &&
+                 !ws_object_is_instance_of(self, h->type))) {
+        return -ECANCELED;
+    }
+
+    // the handle knows the type, so we just make dest fit
+    int res = ws_value_union_reinit(dest,
+                                    ATTR_TYPE_VALUE_TYPE_MAP[h->attr->type].type);
+    if (unlikely(res < 0)) {
+        return res;
+    }
+
     ws_object_lock_read(self);
+    res = attr_read_member(self, h->attr, &dest->value);
+    ws_object_unlock(self);
+
+    return res;
+}
+
+int
+ws_object_attr_write_handle(
+    struct ws_object* self,
+    intmax_t handle,
+    struct ws_value* src
+) {
+    struct attr_handle const* h = attr_handle_get(handle);
+    if (unlikely(!h)) {
+        return -EINVAL;
+    }
+
+    if (unlikely((self->id != h->type) &&
+                 !ws_object_is_instance_of(self, h->type))) {
+        return -ECANCELED;
+    }
+
+    return attr_write_checked(self, h->attr, src);
+}
+
+uint32_t
+ws_object_attr_version(
+    struct ws_object* self
+) {
+    return __atomic_load_n(&self->attr_version, __ATOMIC_ACQUIRE);
+}
+
+void
+ws_object_attr_touch(
+    struct ws_object* self
+) {
+    __atomic_add_fetch(&self->attr_version, 1, __ATOMIC_RELEASE);
+}
+
+void
+ws_object_read_log_init(
+    struct ws_object_read_log* log
+) {
+    log->num = 0;
+    log->incomplete = false;
+}
+
+void
+ws_object_read_log_start(
+    struct ws_object_read_log* log
+) {
+    read_log = log;
+}
+
+void
+ws_object_read_log_stop(void)
+{
+    read_log = NULL;
+}
 
-    if (!self->id || !self->id->attribute_table) {
-        goto err;
+void
+ws_object_read_log_deinit(
+    struct ws_object_read_log* log
+) {
+    while (log->num) {
+        ws_object_unref(log->entries[--log->num].obj);
+    }
+}
+
+bool
+ws_object_read_log_valid(
+    struct ws_object_read_log const* log
+) {
+    if (log->incomplete) {
+        return false;
     }
 
     size_t i;
-    for (i = 0; self->id->attribute_table[i].name != NULL; i++) {
-        if (ws_streq(self->id->attribute_table[i].name, ident)) {
-            ws_object_unlock(self);
-            return self->id->attribute_table[i].type;
+    for (i = 0; i < log->num; ++i) {
+        struct ws_object* obj = log->entries[i].obj;
+        if (ws_object_attr_version(obj) != log->entries[i].version) {
+            return false;
         }
     }
 
-err:
-    ws_object_unlock(self);
-    return WS_OBJ_ATTR_NO_TYPE;
+    return true;
+}
+
+enum ws_object_attribute_type
+ws_object_attr_type(
+    struct ws_object* self,
+    char* ident
+) {
+    if (!self->id) {
+        return WS_OBJ_ATTR_NO_TYPE;
+    }
+
+    struct ws_object_attribute const* attr;
+    attr = ws_object_type_get_attr(self->id, ident);
+    return attr ? attr->type : WS_OBJ_ATTR_NO_TYPE;
 }
 
 enum ws_value_type
@@ -607,23 +916,13 @@ ws_object_attr_value_type(
     struct ws_object* self, //!< The object
     char* ident //!< The identifier for the attribute
 ) {
-    ws_object_lock_read(self);
-
-    if (!self->id || !self->id->attribute_table) {
-        goto err;
+    if (!self->id) {
+        return WS_VALUE_TYPE_NONE;
     }
 
-    size_t i;
-    for (i = 0; self->id->attribute_table[i].name != NULL; i++) {
-        if (ws_streq(self->id->attribute_table[i].name, ident)) {
-            ws_object_unlock(self);
-            return self->id->attribute_table[i].vtype;
-        }
-    }
-
-err:
-    ws_object_unlock(self);
-    return WS_VALUE_TYPE_NONE;
+    struct ws_object_attribute const* attr;
+    attr = ws_object_type_get_attr(self->id, ident);
+    return attr ? attr->vtype : WS_VALUE_TYPE_NONE;
 }
 
 int
@@ -779,20 +1078,10 @@ ws_object_call_cmd(
         return -EINVAL;
     }
 
-    if (self->id->function_table == NULL) {
-        return -ENOTSUP;
-    }
-
-    ws_regular_command_func func = NULL;
-    struct ws_object_function const* iter;
-    for (iter = self->id->function_table; func == NULL && iter->name; iter++) {
-        if (ws_streq(iter->name, ident)) {
-            func = iter->func;
-        }
-    }
-
+    struct ws_object_function const* func;
+    func = ws_object_type_get_function(self->id, ident);
     if (func) {
-        return func(stack);
+        return func->func(stack);
     }
 
     return -ENOENT;
@@ -807,23 +1096,33 @@ ws_object_has_cmd(
         return false;
     }
 
-    ws_object_lock_read(self);
-    ws_object_type_id* curtype = self->id;
+    return !!ws_object_type_get_function(self->id, ident);
+}
 
-    while (curtype != &WS_OBJECT_TYPE_ID_OBJECT) {
-        struct ws_object_function const* iter;
-        for (iter = self->id->function_table; iter->name; iter++) {
-            if (ws_streq(iter->name, ident)) {
-                ws_object_unlock(self);
-                return true;
-            }
-        }
+struct ws_object_attribute const*
+ws_object_type_get_attr(
+    ws_object_type_id* type,
+    char const* ident
+) {
+    struct type_index const* index = type_index_get(type);
+    if (unlikely(!index)) {
+        return NULL;
+    }
 
-        curtype = curtype->supertype;
+    return type_index_find(index->attrs, index->attrs_mask, ident);
+}
+
+struct ws_object_function const*
+ws_object_type_get_function(
+    ws_object_type_id* type,
+    char const* ident
+) {
+    struct type_index const* index = type_index_get(type);
+    if (unlikely(!index)) {
+        return NULL;
     }
 
-    ws_object_unlock(self);
-    return false;
+    return type_index_find(index->funcs, index->funcs_mask, ident);
 }
 
 const char*
@@ -838,3 +1137,454 @@ ws_object_typename(
  * static function implementations
  *
  */
+
+static struct type_index const*
+type_index_get(
+    ws_object_type_id* type
+) {
+    size_t bucket = ((uintptr_t) type / sizeof(void*)) &
+                    (TYPE_INDEX_BUCKETS - 1);
+    struct type_index* const* head = type_index_cache.buckets + bucket;
+
+    // fast path: the index exists already
+    struct type_index* index = __atomic_load_n(head, __ATOMIC_ACQUIRE);
+    for (; index; index = index->next) {
+        if (index->type == type) {
+            return index;
+        }
+    }
+
+    pthread_mutex_lock(&type_index_cache.lock);
+
+    // someone else may have been faster
+    for (index = *head; index; index = index->next) {
+        if (index->type == type) {
+            pthread_mutex_unlock(&type_index_cache.lock);
+            return index;
+        }
+    }
+
+    index = type_index_new(type);
+    if (likely(index)) {
+        if (!type_index_cache.cleaner_registered) {
+            ws_cleaner_add(type_index_cleanup, &type_index_cache);
+            type_index_cache.cleaner_registered = true;
+        }
+
+        index->next = *head;
+        __atomic_store_n(type_index_cache.buckets + bucket, index,
+                         __ATOMIC_RELEASE);
+    }
+
+    pthread_mutex_unlock(&type_index_cache.lock);
+    return index;
+}
+
+static struct type_index*
+type_index_new(
+    ws_object_type_id* type
+) {
+    // count the entries, including the ones of the supertypes
+    size_t attrs_num = 0;
+    size_t funcs_num = 0;
+    ws_object_type_id* cur = type;
+    while (1) {
+        struct ws_object_attribute const* attr = cur->attribute_table;
+        while (attr && attr->name) {
+            ++attrs_num;
+            ++attr;
+        }
+
+        struct ws_object_function const* func = cur->function_table;
+        while (func && func->name) {
+            ++funcs_num;
+            ++func;
+        }
+
+        if (cur == cur->supertype) {
+            break;
+        }
+        cur = cur->supertype;
+    }
+
+    // keep the load factor at or below 1/2
+    size_t attrs_size = 1;
+    while (attrs_size < attrs_num * 2) {
+        attrs_size *= 2;
+    }
+    size_t funcs_size = 1;
+    while (funcs_size < funcs_num * 2) {
+        funcs_size *= 2;
+    }
+
+    struct type_index* index = calloc(1, sizeof(*index));
+    if (unlikely(!index)) {
+        return NULL;
+    }
+
+    index->type = type;
+    index->attrs = calloc(attrs_size, sizeof(*index->attrs));
+    index->attrs_mask = attrs_size - 1;
+    index->funcs = calloc(funcs_size, sizeof(*index->funcs));
+    index->funcs_mask = funcs_size - 1;
+    if (unlikely(!index->attrs || !index->funcs)) {
+        free(index->attrs);
+        free(index->funcs);
+        free(index);
+        return NULL;
+    }
+
+    // walk towards the root, so entries of subtypes shadow the others
+    cur = type;
+    while (1) {
+        struct ws_object_attribute const* attr = cur->attribute_table;
+        while (attr && attr->name) {
+            type_index_insert(index->attrs, index->attrs_mask, attr->name,
+                              attr);
+            ++attr;
+        }
+
+        struct ws_object_function const* func = cur->function_table;
+        while (func && func->name) {
+            type_index_insert(index->funcs, index->funcs_mask, func->name,
+                              func);
+            ++func;
+        }
+
+        if (cur == cur->supertype) {
+            break;
+        }
+        cur = cur->supertype;
+    }
+
+    ws_log(&log_ctx, LOG_DEBUG, "Indexed type %s: %zu attributes, %zu functions",
+           type->typestr, attrs_num, funcs_num);
+
+    return index;
+}
+
+static void const*
+type_index_find(
+    struct type_index_entry const* table,
+    size_t mask,
+    char const* name
+) {
+    uint32_t hash = hash_name(name);
+    size_t pos = hash & mask;
+
+    // the tables always have a free slot, so this terminates
+    while (table[pos].name) {
+        if ((table[pos].hash == hash) && ws_streq(table[pos].name, name)) {
+            return table[pos].item;
+        }
+        pos = (pos + 1) & mask;
+    }
+
+    return NULL;
+}
+
+static void
+type_index_insert(
+    struct type_index_entry* table,
+    size_t mask,
+    char const* name,
+    void const* item
+) {
+    uint32_t hash = hash_name(name);
+    size_t pos = hash & mask;
+
+    while (table[pos].name) {
+        if ((table[pos].hash == hash) && ws_streq(table[pos].name, name)) {
+            // shadowed by a subtype
+            return;
+        }
+        pos = (pos + 1) & mask;
+    }
+
+    table[pos].name = name;
+    table[pos].hash = hash;
+    table[pos].item = item;
+}
+
+static uint32_t
+hash_name(
+    char const* name
+) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    while (*name) {
+        hash ^= (unsigned char) *name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void
+type_index_cleanup(
+    void* dummy
+) {
+    pthread_mutex_lock(&type_index_cache.lock);
+
+    size_t bucket;
+    for (bucket = 0; bucket < TYPE_INDEX_BUCKETS; ++bucket) {
+        struct type_index* index = type_index_cache.buckets[bucket];
+        while (index) {
+            struct type_index* next = index->next;
+            free(index->attrs);
+            free(index->funcs);
+            free(index);
+            index = next;
+        }
+        type_index_cache.buckets[bucket] = NULL;
+    }
+    type_index_cache.cleaner_registered = false;
+
+    pthread_mutex_unlock(&type_index_cache.lock);
+}
+
+static int
+attr_read_member(
+    struct ws_object* self,
+    struct ws_object_attribute const* attr,
+    struct ws_value* dest
+) {
+    void* member_pos = (void *) (((char *) self) + attr->offset_in_struct);
+    switch (attr->type) {
+    case WS_OBJ_ATTR_TYPE_BOOL:
+        ws_value_bool_set((struct ws_value_bool*) dest,
+                          (bool) *((bool*) member_pos));
+        break;
+
+    case WS_OBJ_ATTR_TYPE_CHAR:
+        ws_value_int_set((struct ws_value_int*) dest,
+                         *((char*) member_pos));
+        break;
+
+    case WS_OBJ_ATTR_TYPE_INT32:
+        ws_value_int_set((struct ws_value_int*) dest,
+                         (intmax_t) *((int32_t*) member_pos));
+        break;
+
+    case WS_OBJ_ATTR_TYPE_INT64:
+        ws_value_int_set((struct ws_value_int*) dest,
+                         (intmax_t) *((int64_t*) member_pos));
+        break;
+
+    case WS_OBJ_ATTR_TYPE_UINT32:
+        ws_value_int_set((struct ws_value_int*) dest,
+                         (intmax_t) *((uint32_t*) member_pos));
+        break;
+
+    case WS_OBJ_ATTR_TYPE_UINT64:
+        ws_value_int_set((struct ws_value_int*) dest,
+                         (intmax_t) *((uint64_t*) member_pos));
+        break;
+
+    case WS_OBJ_ATTR_TYPE_STRING:
+        {
+            struct ws_string* s = ws_string_new();
+            if (unlikely(!s)) {
+                return -ENOMEM;
+            }
+
+            ws_string_set_from_raw(s, *(char**) member_pos);
+
+            ws_value_string_set_str((struct ws_value_string*) dest, s);
+            ws_object_unref(&s->obj);
+        }
+        break;
+
+    case WS_OBJ_ATTR_TYPE_OBJ:
+        ws_value_object_id_set((struct ws_value_object_id*) dest,
+                                *(struct ws_object**) member_pos);
+        break;
+
+    default:
+        ws_log(&log_ctx, LOG_EMERG, "Unhandleable value type identifier");
+        break;
+    };
+
+    if (read_log) {
+        read_log_record(self);
+    }
+
+    return 0;
+}
+
+static void
+read_log_record(
+    struct ws_object* self
+) {
+    // the version can't change while we hold the read lock
+    uint32_t version = ws_object_attr_version(self);
+
+    size_t i;
+    for (i = 0; i < read_log->num; ++i) {
+        if (read_log->entries[i].obj == self) {
+            // the object changed in between two reads
+            if (read_log->entries[i].version != version) {
+                read_log->incomplete = true;
+            }
+            return;
+        }
+    }
+
+    if (read_log->num >= WS_OBJECT_READ_LOG_SIZE) {
+        read_log->incomplete = true;
+        return;
+    }
+
+    read_log->entries[read_log->num].obj = ws_object_getref(self);
+    read_log->entries[read_log->num].version = version;
+    ++read_log->num;
+}
+
+static int
+attr_write_checked(
+    struct ws_object* self,
+    struct ws_object_attribute const* attr,
+    struct ws_value* src
+) {
+    if (unlikely(attr->type == WS_OBJ_ATTR_NO_TYPE)) {
+        return -EFAULT;
+    }
+
+    if (unlikely(ATTR_TYPE_VALUE_TYPE_MAP[attr->type].type !=
+                ws_value_get_type(src))) {
+        /* Types not matching */
+        return -EINVAL;
+    }
+
+    switch (attr->type) {
+    case WS_OBJ_ATTR_TYPE_CHAR:
+    case WS_OBJ_ATTR_TYPE_OBJ:
+        return -ENOTSUP;
+
+    default:
+        break;
+    }
+
+    ws_object_lock_write(self);
+
+    void* member_pos = (void *) (((char *) self) + attr->offset_in_struct);
+
+    switch (attr->type) {
+    case WS_OBJ_ATTR_TYPE_INT32:
+        {
+            intmax_t i = ws_value_int_get((struct ws_value_int*) src);
+            *((int32_t*) member_pos) = (int32_t) i;
+        }
+        break;
+
+    case WS_OBJ_ATTR_TYPE_INT64:
+        {
+            intmax_t i = ws_value_int_get((struct ws_value_int*) src);
+            *((int64_t*) member_pos) = (int64_t) i;
+        }
+        break;
+
+    case WS_OBJ_ATTR_TYPE_UINT32:
+        {
+            intmax_t i = ws_value_int_get((struct ws_value_int*) src);
+            *((uint32_t*) member_pos) = (uint32_t) i;
+        }
+        break;
+
+    case WS_OBJ_ATTR_TYPE_UINT64:
+        {
+            intmax_t i = ws_value_int_get((struct ws_value_int*) src);
+            *((uint64_t*) member_pos) = (uint64_t) i;
+        }
+        break;
+
+    case WS_OBJ_ATTR_TYPE_STRING:
+        {
+            struct ws_value_string* _s = (struct ws_value_string*) src;
+            struct ws_string* s = ws_value_string_get(_s);
+            free(*((char**) member_pos));
+            *((char**) member_pos) = ws_string_raw(s); // copies!
+            ws_object_unref(&s->obj);
+        }
+        break;
+
+    default:
+        ws_log(&log_ctx, LOG_EMERG, "Unhandleable value type identifier");
+        ws_object_unlock(self);
+        return -ENOTSUP;
+    };
+
+    ws_object_attr_touch(self);
+    ws_object_unlock(self);
+    return 0;
+}
+
+static struct attr_handle const*
+attr_handle_at(
+    size_t index
+) {
+    return attr_handles.chunks[index / ATTR_HANDLE_CHUNK] +
+           index % ATTR_HANDLE_CHUNK;
+}
+
+static struct attr_handle const*
+attr_handle_get(
+    intmax_t handle
+) {
+    size_t num = __atomic_load_n(&attr_handles.num, __ATOMIC_ACQUIRE);
+    if ((handle <= 0) || ((uintmax_t) handle > num)) {
+        return NULL;
+    }
+
+    return attr_handle_at(handle - 1);
+}
+
+static void
+attr_handles_cleanup(
+    void* dummy
+) {
+    pthread_mutex_lock(&attr_handles.lock);
+
+    size_t chunk;
+    for (chunk = 0; chunk < ARYLEN(attr_handles.chunks); ++chunk) {
+        free(attr_handles.chunks[chunk]);
+        attr_handles.chunks[chunk] = NULL;
+    }
+    attr_handles.num = 0;
+
+    pthread_mutex_unlock(&attr_handles.lock);
+}
+
+static int
+get_lock(
+    struct ws_object* self,
+    pthread_rwlock_t** lock
+) {
+    if (self->settings & NO_LOCK_SETTINGS) {
+        *lock = NULL;
+        return 0;
+    }
+
+    *lock = __atomic_load_n(&self->rw_lock, __ATOMIC_ACQUIRE);
+    if (*lock) {
+        return 0;
+    }
+
+    pthread_rwlock_t* new_lock = ws_slab_alloc(&lock_pool);
+    if (!new_lock) {
+        return -ENOMEM;
+    }
+    pthread_rwlock_init(new_lock, NULL);
+
+    // another thread may have been faster, in which case we use its lock
+    pthread_rwlock_t* expected = NULL;
+    if (!__atomic_compare_exchange_n(&self->rw_lock, &expected, new_lock,
+                                     false, __ATOMIC_ACQ_REL,
+                                     __ATOMIC_ACQUIRE)) {
+        pthread_rwlock_destroy(new_lock);
+        ws_slab_release(new_lock);
+        new_lock = expected;
+    }
+
+    *lock = new_lock;
+    return 0;
+}
@@ -177,6 +177,12 @@ struct ws_object_type {
  * Object settings type
  *
  * For identifying an object "setting"
+ *
+ * Objects which are immutable (`WS_OBJ_CONST`) or never leave the thread they
+ * were created on (`WS_OBJECT_CONFINED`) are never locked: the locking
+ * functions succeed without doing anything for them. These settings have to be
+ * set right after initialization, before the object is locked for the first
+ * time. Types opt out of locking by setting them in their init function.
  */
 enum ws_object_settings {
     WS_OBJ_NO_SETTINGS = 0,
@@ -184,27 +190,55 @@ enum ws_object_settings {
     WS_OBJ_SELF_DESTROYING  = 1 << 1,
     WS_OBJECT_HEAPALLOCED   = 1 << 2,
     WS_OBJECT_LOCKABLE      = 1 << 3,
+    WS_OBJECT_CONFINED      = 1 << 4,
 };
 
 /**
  * Object type
  *
  * The object type is the root class for all classes
+ *
+ * The read/write lock of an object is only created when the object is locked
+ * for the first time, objects which are never locked don't pay for it. Locks
+ * are taken from a slab pool rather than allocated individually.
  */
 struct ws_object {
     ws_object_type_id* id;        //!< Object id, identifies the actual type
 
     struct {
-        pthread_mutex_t lock;
-        size_t refcnt;
+        size_t refcnt; //!< Number of references, only accessed atomically
     } ref_counting; //!< @private Ref counting
 
     enum ws_object_settings settings; //!< @private Object settings
-    pthread_rwlock_t rw_lock; //!< @private Read/Write lock
+    uint32_t attr_version; //!< @private Incremented on attribute changes
+
+    pthread_rwlock_t* rw_lock; //!< @private Lazily created read/write lock
 
     uintmax_t uuid; // @protected Unique ID for the object
 };
 
+/**
+ * Maximum number of objects a ws_object_read_log may hold
+ */
+#define WS_OBJECT_READ_LOG_SIZE (16)
+
+/**
+ * Log of objects whose attributes were read
+ *
+ * While a log is active on a thread, every attribute read performed by that
+ * thread is logged, together with the attribute version of the object at the
+ * time of the read.
+ * The log holds a reference on each object logged.
+ */
+struct ws_object_read_log {
+    size_t num; //!< @public number of objects logged
+    bool incomplete; //!< @public not all reads could be logged consistently
+    struct {
+        struct ws_object* obj; //!< @public object read
+        uint32_t version; //!< @public attribute version at the time of reading
+    } entries[WS_OBJECT_READ_LOG_SIZE]; //!< @public objects logged
+};
+
 /**
  * Variable which holds type information about the ws_object type
  */
@@ -217,6 +251,9 @@ extern ws_object_type_id WS_OBJECT_TYPE_ID_OBJECT;
  *
  * @note One ref on the object is used
  *
+ * Small objects are allocated from slab pools. The object must therefore be
+ * released via `ws_object_unref()` rather than `free()`.
+ *
  * @return A new ws_object object or NULL on failure
  */
 struct ws_object*
@@ -294,6 +331,8 @@ ws_object_init(
  *
  * @memberof ws_object
  *
+ * @note Threadsafe, the reference counter is manipulated atomically
+ *
  * @return The object itself or NULL on failure
  */
 struct ws_object*
@@ -312,7 +351,8 @@ ws_object_getref(
  *
  * @warning It is not save to use the object after this operation _in any kind_.
  * The object might be unavailable after this operation, as it was freed from
- * the heap.
+ * the heap. Objects are released via `ws_slab_release()`, so they may have
+ * been allocated from a slab pool or using `malloc()` and friends.
  */
 void
 ws_object_unref(
@@ -350,6 +390,8 @@ ws_object_hash(
  *
  * @memberof ws_object
  *
+ * @note Creates the lock of the object if it doesn't exist yet
+ *
  * @return true if the lock was aquired, false on error
  */
 bool
@@ -362,6 +404,8 @@ ws_object_lock_read(
  *
  * @memberof ws_object
  *
+ * @note Creates the lock of the object if it doesn't exist yet
+ *
  * @return true if the lock was aquired, false on error
  */
 bool
@@ -465,7 +509,7 @@ ws_object_has_attr(
  * parsed into the type of the passed ws_value type, get the data from the
  * object and put it into the `dest` ws_value type.
  *
- * @note Does string-match the attribute name with the `ident` parameter in O(n)
+ * @note The attribute is looked up in O(1), see ws_object_type_get_attr()
  *
  * @return zero on success, else negative error code from errno.h
  *      -EINVAL - if the passed `dest` type does not match the attribute type
@@ -501,6 +545,160 @@ ws_object_attr_write(
 __ws_nonnull__(1, 2, 3)
 ;
 
+/*
+ *
+ * Forward declaration
+ *
+ */
+union ws_value_union;
+
+/**
+ * Resolve an attribute of a type into a handle
+ *
+ * A handle refers to an attribute of a type and its subtypes. It may be used
+ * for reading and writing the attribute of objects of these types, without
+ * looking up the attribute by name or checking types again.
+ *
+ * Handles are positive integers. Resolving the same attribute of the same type
+ * yields the same handle. Handles stay valid until the program exits.
+ *
+ * @return a handle or negative errno.h number:
+ *      -ECANCELED - if the type has no such attribute
+ *      -EFAULT - if the attribute has no type
+ *      -ENOSPC - if no more handles are available
+ *      -ENOMEM - failed to allocate resources
+ */
+intmax_t
+ws_object_attr_handle(
+    ws_object_type_id* type, //!< The type
+    char const* ident //!< The identifier for the attribute
+)
+__ws_nonnull__(1, 2)
+;
+
+/**
+ * Read an attribute of an object via a handle
+ *
+ * @memberof ws_object
+ *
+ * `dest` is reinitialized to the value type of the attribute.
+ *
+ * @return zero on success, else negative errno.h number:
+ *      -EINVAL - if the handle is invalid
+ *      -ECANCELED - if the object is not of the handle's type
+ *      -ENOMEM - failed to allocate resources
+ */
+int
+ws_object_attr_read_handle(
+    struct ws_object* self, //!< The object
+    intmax_t handle, //!< Handle of the attribute
+    union ws_value_union* dest //!< Destination of the data
+)
+__ws_nonnull__(1, 3)
+;
+
+/**
+ * Write an attribute of an object via a handle
+ *
+ * @memberof ws_object
+ *
+ * @return zero on success, else negative errno.h number, see
+ *         ws_object_attr_read_handle() and ws_object_attr_write()
+ */
+int
+ws_object_attr_write_handle(
+    struct ws_object* self, //!< The object
+    intmax_t handle, //!< Handle of the attribute
+    struct ws_value* src //!< Source of the data
+)
+__ws_nonnull__(1, 3)
+;
+
+/**
+ * Get the attribute version of an object
+ *
+ * @memberof ws_object
+ *
+ * The version changes whenever an attribute of the object is written.
+ *
+ * @return the current attribute version
+ */
+uint32_t
+ws_object_attr_version(
+    struct ws_object* self //!< The object
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Mark the attributes of an object as changed
+ *
+ * @memberof ws_object
+ *
+ * Writes via ws_object_attr_write() and ws_object_attr_write_handle() do this
+ * implicitly. Code altering attribute members directly has to call this
+ * function afterwards.
+ */
+void
+ws_object_attr_touch(
+    struct ws_object* self //!< The object
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Initialize a read log
+ */
+void
+ws_object_read_log_init(
+    struct ws_object_read_log* log //!< log to initialize
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Start logging attribute reads of the calling thread
+ *
+ * Reads are appended to the ones already logged, so logging may be suspended
+ * and resumed.
+ *
+ * @note Only one log may be active per thread.
+ */
+void
+ws_object_read_log_start(
+    struct ws_object_read_log* log //!< log to activate
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Stop logging attribute reads of the calling thread
+ */
+void
+ws_object_read_log_stop(void);
+
+/**
+ * Release all the objects referenced by a read log
+ */
+void
+ws_object_read_log_deinit(
+    struct ws_object_read_log* log //!< log to deinitialize
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Check whether no object logged was changed since it was read
+ *
+ * @return true if all the objects logged are unchanged, false otherwise
+ */
+bool
+ws_object_read_log_valid(
+    struct ws_object_read_log const* log //!< log to check
+)
+__ws_nonnull__(1)
+;
+
 /**
  * Get the type of an attribute identified by its name
  *
@@ -606,13 +804,6 @@ ws_object_has_typename(
 __ws_nonnull__(1, 2)
 ;
 
-/*
- *
- * Forward declaration
- *
- */
-union ws_value_union;
-
 /**
  * Call a command on the object
  *
@@ -642,6 +833,43 @@ ws_object_has_cmd(
     char const* ident //!< Name of command to check the object for
 );
 
+/**
+ * Find an attribute of a type by name
+ *
+ * The attributes of the supertypes are included, an attribute of a subtype
+ * shadows attributes with the same name of its supertypes.
+ *
+ * @note Uses a hashed index over all the attributes of the type, which is
+ *       created on first use. Lookups are O(1).
+ *
+ * @return the attribute or NULL, if there is no such attribute
+ */
+struct ws_object_attribute const*
+ws_object_type_get_attr(
+    ws_object_type_id* type, //!< The type
+    char const* ident //!< The identifier for the attribute
+)
+__ws_nonnull__(1, 2)
+;
+
+/**
+ * Find a function of a type by name
+ *
+ * The functions of the supertypes are included, a function of a subtype
+ * shadows functions with the same name of its supertypes.
+ *
+ * @note Uses the same index as ws_object_type_get_attr()
+ *
+ * @return the function or NULL, if there is no such function
+ */
+struct ws_object_function const*
+ws_object_type_get_function(
+    ws_object_type_id* type, //!< The type
+    char const* ident //!< Name of the function
+)
+__ws_nonnull__(1, 2)
+;
+
 /**
  * Get the typename of the object
  *
@@ -0,0 +1,674 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+
+#include "objects/object.h"
+#include "objects/ordered_set.h"
+#include "util/arithmetical.h"
+#include "util/slab.h"
+
+/**
+ * Node of the tree backing a ws_ordered_set
+ *
+ * The tree is an AVL tree. Each node also knows the size of its subtree, which
+ * allows positional queries.
+ */
+struct ws_ordered_set_node {
+    struct ws_ordered_set_node* child[2]; //!< lower and greater subtree
+    struct ws_object* obj; //!< the element
+    intmax_t key; //!< key of the element
+    size_t size; //!< number of nodes in the subtree
+    int height; //!< height of the subtree
+};
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Deinit callback for ws_ordered_set type
+ */
+static bool
+deinit_ordered_set(
+    struct ws_object* const self
+);
+
+/**
+ * Compare an element to the element of a node
+ *
+ * @return negative if the element is lower than the node's element, positive
+ *         if it is greater and zero if they are equal
+ */
+static int
+compare(
+    struct ws_object const* obj, //!< element to compare
+    intmax_t key, //!< key of the element
+    struct ws_ordered_set_node const* node //!< node to compare to
+);
+
+/**
+ * Get the size of a (possibly empty) subtree
+ *
+ * @return number of nodes in the subtree
+ */
+static inline size_t
+node_size(
+    struct ws_ordered_set_node const* node //!< root of the subtree or NULL
+);
+
+/**
+ * Get the height of a (possibly empty) subtree
+ *
+ * @return height of the subtree
+ */
+static inline int
+node_height(
+    struct ws_ordered_set_node const* node //!< root of the subtree or NULL
+);
+
+/**
+ * Recompute the size and height of a node from its children
+ */
+static void
+node_update(
+    struct ws_ordered_set_node* node //!< node to update
+);
+
+/**
+ * Rotate a subtree
+ *
+ * Rotates the subtree so that `node` becomes the `dir` child of its current
+ * `!dir` child.
+ *
+ * @return the new root of the subtree
+ */
+static struct ws_ordered_set_node*
+node_rotate(
+    struct ws_ordered_set_node* node, //!< root of the subtree
+    int dir //!< direction: 0 for a left, 1 for a right rotation
+);
+
+/**
+ * Update a node's metadata and rebalance the subtree rooted at it
+ *
+ * @return the new root of the subtree
+ */
+static struct ws_ordered_set_node*
+node_rebalance(
+    struct ws_ordered_set_node* node //!< root of the subtree
+);
+
+/**
+ * Insert an element into a subtree
+ *
+ * @return zero on success, -EEXIST if the element is already present, else
+ *         negative error code from errno.h
+ */
+static int
+node_insert(
+    struct ws_ordered_set_node** node, //!< subtree to insert into
+    struct ws_object* obj, //!< element to insert
+    intmax_t key //!< key of the element
+);
+
+/**
+ * Detach the lowest node from a non-empty subtree
+ *
+ * @return the node detached
+ */
+static struct ws_ordered_set_node*
+node_detach_min(
+    struct ws_ordered_set_node** node //!< subtree to detach the node from
+);
+
+/**
+ * Detach the node holding an element from a subtree
+ *
+ * @return the node detached or NULL, if the element is not present
+ */
+static struct ws_ordered_set_node*
+node_detach(
+    struct ws_ordered_set_node** node, //!< subtree to detach the node from
+    struct ws_object const* obj, //!< element to remove
+    intmax_t key //!< key of the element
+);
+
+/**
+ * Destroy a subtree, dropping the references on all the elements
+ */
+static void
+node_destroy(
+    struct ws_ordered_set_node* node //!< subtree to destroy
+);
+
+/**
+ * Call a processor on a range of a subtree, in order
+ *
+ * @return zero if all elements were processed, positive if the processor
+ *         stopped the iteration, negative error code if it failed
+ */
+static int
+node_select(
+    struct ws_ordered_set_node const* node, //!< subtree to process
+    size_t from, //!< position of the first element, relative to the subtree
+    size_t to, //!< position after the last element, relative to the subtree
+    ws_ordered_set_procf proc, //!< processor function
+    void* proc_etc //!< additional parameter for the processor
+);
+
+/*
+ *
+ * Variables
+ *
+ */
+
+/**
+ * Type information for ws_ordered_set type
+ */
+ws_object_type_id WS_OBJECT_TYPE_ID_ORDERED_SET = {
+    .supertype  = &WS_OBJECT_TYPE_ID_OBJECT,
+    .typestr    = "ws_ordered_set",
+
+    .deinit_callback = deinit_ordered_set,
+
+    .hash_callback = NULL,
+    .cmp_callback = NULL,
+    .uuid_callback = NULL,
+
+    .attribute_table = NULL,
+    .function_table = NULL,
+};
+
+/**
+ * Pool for the nodes of all ordered sets
+ */
+static struct ws_slab_pool node_pool =
+    WS_SLAB_POOL_INIT("ws_ordered_set_node",
+                      sizeof(struct ws_ordered_set_node));
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+int
+ws_ordered_set_init(
+    struct ws_ordered_set* self
+) {
+    if (!self) {
+        return -EINVAL;
+    }
+    ws_object_init(&self->obj);
+
+    self->obj.id = &WS_OBJECT_TYPE_ID_ORDERED_SET;
+    self->root = NULL;
+
+    return 0;
+}
+
+struct ws_ordered_set*
+ws_ordered_set_new(void)
+{
+    struct ws_ordered_set* set;
+    set = (struct ws_ordered_set*) ws_object_new(sizeof(*set));
+
+    if (set) {
+        ws_ordered_set_init(set);
+        set->obj.settings |= WS_OBJECT_HEAPALLOCED;
+    }
+
+    return set;
+}
+
+int
+ws_ordered_set_insert(
+    struct ws_ordered_set* self,
+    struct ws_object* obj
+) {
+    return ws_ordered_set_insert_keyed(self, obj, 0);
+}
+
+int
+ws_ordered_set_insert_keyed(
+    struct ws_ordered_set* self,
+    struct ws_object* obj,
+    intmax_t key
+) {
+    int res = node_insert(&self->root, obj, key);
+
+    if (res == 0 || res == -EEXIST) {
+        return 0;
+    }
+
+    return res;
+}
+
+int
+ws_ordered_set_remove(
+    struct ws_ordered_set* self,
+    struct ws_object const* cmp
+) {
+    return ws_ordered_set_remove_keyed(self, cmp, 0);
+}
+
+int
+ws_ordered_set_remove_keyed(
+    struct ws_ordered_set* self,
+    struct ws_object const* cmp,
+    intmax_t key
+) {
+    struct ws_ordered_set_node* node = node_detach(&self->root, cmp, key);
+    if (!node) {
+        return -ENOENT;
+    }
+
+    ws_object_unref(node->obj);
+    ws_slab_release(node);
+    return 0;
+}
+
+size_t
+ws_ordered_set_cardinality(
+    struct ws_ordered_set const* self
+) {
+    return node_size(self->root);
+}
+
+struct ws_object*
+ws_ordered_set_min(
+    struct ws_ordered_set const* self
+) {
+    return ws_ordered_set_at(self, 0, NULL);
+}
+
+struct ws_object*
+ws_ordered_set_max(
+    struct ws_ordered_set const* self
+) {
+    size_t card = node_size(self->root);
+    if (!card) {
+        return NULL;
+    }
+
+    return ws_ordered_set_at(self, card - 1, NULL);
+}
+
+struct ws_object*
+ws_ordered_set_at(
+    struct ws_ordered_set const* self,
+    size_t rank,
+    intmax_t* key
+) {
+    struct ws_ordered_set_node const* node = self->root;
+
+    while (node) {
+        size_t lower = node_size(node->child[0]);
+
+        if (rank == lower) {
+            if (key) {
+                *key = node->key;
+            }
+            return ws_object_getref(node->obj);
+        }
+
+        if (rank < lower) {
+            node = node->child[0];
+        } else {
+            rank -= lower + 1;
+            node = node->child[1];
+        }
+    }
+
+    return NULL;
+}
+
+ssize_t
+ws_ordered_set_rank(
+    struct ws_ordered_set const* self,
+    struct ws_object const* cmp
+) {
+    return ws_ordered_set_rank_keyed(self, cmp, 0);
+}
+
+ssize_t
+ws_ordered_set_rank_keyed(
+    struct ws_ordered_set const* self,
+    struct ws_object const* cmp,
+    intmax_t key
+) {
+    struct ws_ordered_set_node const* node = self->root;
+    size_t rank = 0;
+
+    while (node) {
+        int c = compare(cmp, key, node);
+
+        if (c < 0) {
+            node = node->child[0];
+            continue;
+        }
+
+        rank += node_size(node->child[0]);
+        if (c == 0) {
+            return rank;
+        }
+        ++rank;
+        node = node->child[1];
+    }
+
+    return -ENOENT;
+}
+
+size_t
+ws_ordered_set_lower_bound(
+    struct ws_ordered_set const* self,
+    intmax_t key
+) {
+    struct ws_ordered_set_node const* node = self->root;
+    size_t rank = 0;
+
+    while (node) {
+        if (node->key < key) {
+            rank += node_size(node->child[0]) + 1;
+            node = node->child[1];
+        } else {
+            node = node->child[0];
+        }
+    }
+
+    return rank;
+}
+
+int
+ws_ordered_set_select_range(
+    struct ws_ordered_set const* self,
+    size_t from,
+    size_t to,
+    ws_ordered_set_procf proc,
+    void* proc_etc
+) {
+    int res = node_select(self->root, from, to, proc, proc_etc);
+    return MIN(res, 0);
+}
+
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static bool
+deinit_ordered_set(
+    struct ws_object* const self
+) {
+    struct ws_ordered_set* set = (struct ws_ordered_set*) self;
+
+    node_destroy(set->root);
+    set->root = NULL;
+    return true;
+}
+
+static int
+compare(
+    struct ws_object const* obj,
+    intmax_t key,
+    struct ws_ordered_set_node const* node
+) {
+    if (key != node->key) {
+        return key < node->key ? -1 : 1;
+    }
+
+    struct ws_object const* other = node->obj;
+    if (obj == other) {
+        return 0;
+    }
+
+    // ws_object_cmp() is only meaningful for objects of the same type
+    if (obj->id != other->id) {
+        return (uintptr_t) obj->id < (uintptr_t) other->id ? -1 : 1;
+    }
+
+    // ws_object_cmp() returns 1 if the _second_ object is the greater one
+    switch (ws_object_cmp(obj, other)) {
+    case 1:
+        return -1;
+    case 0:
+        return 0;
+    case -1:
+        return 1;
+    default:
+        // no compare callback, fall back to the address
+        return (uintptr_t) obj < (uintptr_t) other ? -1 : 1;
+    }
+}
+
+static inline size_t
+node_size(
+    struct ws_ordered_set_node const* node
+) {
+    return node ? node->size : 0;
+}
+
+static inline int
+node_height(
+    struct ws_ordered_set_node const* node
+) {
+    return node ? node->height : 0;
+}
+
+static void
+node_update(
+    struct ws_ordered_set_node* node
+) {
+    node->size = node_size(node->child[0]) + node_size(node->child[1]) + 1;
+    node->height = MAX(node_height(node->child[0]),
+                       node_height(node->child[1])) + 1;
+}
+
+static struct ws_ordered_set_node*
+node_rotate(
+    struct ws_ordered_set_node* node,
+    int dir
+) {
+    struct ws_ordered_set_node* pivot = node->child[!dir];
+
+    node->child[!dir] = pivot->child[dir];
+    pivot->child[dir] = node;
+
+    node_update(node);
+    node_update(pivot);
+
+    return pivot;
+}
+
+static struct ws_ordered_set_node*
+node_rebalance(
+    struct ws_ordered_set_node* node
+) {
+    int balance = node_height(node->child[1]) - node_height(node->child[0]);
+
+    if (balance < -1 || balance > 1) {
+        // the heavy side, and the direction to rotate the node to
+        int heavy = balance > 0;
+        struct ws_ordered_set_node* child = node->child[heavy];
+
+        // a child leaning the other way has to be straightened out first
+        int inner = node_height(child->child[!heavy]);
+        if (inner > node_height(child->child[heavy])) {
+            node->child[heavy] = node_rotate(child, heavy);
+        }
+        return node_rotate(node, !heavy);
+    }
+
+    node_update(node);
+    return node;
+}
+
+static int
+node_insert(
+    struct ws_ordered_set_node** node,
+    struct ws_object* obj,
+    intmax_t key
+) {
+    if (!*node) {
+        struct ws_ordered_set_node* leaf = ws_slab_alloc(&node_pool);
+        if (!leaf) {
+            return -ENOMEM;
+        }
+
+        leaf->obj = ws_object_getref(obj);
+        leaf->key = key;
+        leaf->size = 1;
+        leaf->height = 1;
+        *node = leaf;
+        return 0;
+    }
+
+    int c = compare(obj, key, *node);
+    if (c == 0) {
+        return -EEXIST;
+    }
+
+    int res = node_insert(&(*node)->child[c > 0], obj, key);
+    if (res == 0) {
+        *node = node_rebalance(*node);
+    }
+    return res;
+}
+
+static struct ws_ordered_set_node*
+node_detach_min(
+    struct ws_ordered_set_node** node
+) {
+    struct ws_ordered_set_node* min;
+
+    if (!(*node)->child[0]) {
+        min = *node;
+        *node = min->child[1];
+        return min;
+    }
+
+    min = node_detach_min(&(*node)->child[0]);
+    *node = node_rebalance(*node);
+    return min;
+}
+
+static struct ws_ordered_set_node*
+node_detach(
+    struct ws_ordered_set_node** node,
+    struct ws_object const* obj,
+    intmax_t key
+) {
+    if (!*node) {
+        return NULL;
+    }
+
+    struct ws_ordered_set_node* detached;
+
+    int c = compare(obj, key, *node);
+    if (c != 0) {
+        detached = node_detach(&(*node)->child[c > 0], obj, key);
+        if (!detached) {
+            return NULL;
+        }
+    } else {
+        detached = *node;
+
+        if (!detached->child[0] || !detached->child[1]) {
+            *node = detached->child[0] ? detached->child[0]
+                                       : detached->child[1];
+            return detached;
+        }
+
+        // replace the node with the lowest node of the greater subtree
+        struct ws_ordered_set_node* succ;
+        succ = node_detach_min(&detached->child[1]);
+        succ->child[0] = detached->child[0];
+        succ->child[1] = detached->child[1];
+        *node = succ;
+    }
+
+    *node = node_rebalance(*node);
+    return detached;
+}
+
+static void
+node_destroy(
+    struct ws_ordered_set_node* node
+) {
+    while (node) {
+        node_destroy(node->child[0]);
+
+        struct ws_ordered_set_node* next = node->child[1];
+        ws_object_unref(node->obj);
+        ws_slab_release(node);
+        node = next;
+    }
+}
+
+static int
+node_select(
+    struct ws_ordered_set_node const* node,
+    size_t from,
+    size_t to,
+    ws_ordered_set_procf proc,
+    void* proc_etc
+) {
+    int res = 0;
+
+    while (node && from < to) {
+        size_t lower = node_size(node->child[0]);
+
+        if (from < lower) {
+            res = node_select(node->child[0], from, to, proc, proc_etc);
+            if (res) {
+                return res;
+            }
+        }
+
+        if (from <= lower && lower < to) {
+            res = proc(proc_etc, node->obj);
+            if (res) {
+                return res;
+            }
+        }
+
+        // continue with the greater subtree
+        if (to <= lower + 1) {
+            break;
+        }
+        from = from > lower + 1 ? from - lower - 1 : 0;
+        to -= lower + 1;
+        node = node->child[1];
+    }
+
+    return res;
+}
@@ -0,0 +1,331 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @addtogroup objects "Classes"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup objects_ordered_set "Class: ordered set type"
+ *
+ * @{
+ */
+
+#ifndef __WS_OBJECTS_ORDERED_SET_H__
+#define __WS_OBJECTS_ORDERED_SET_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "objects/object.h"
+#include "util/attributes.h"
+
+// forward declarations
+struct ws_ordered_set_node;
+
+/**
+ * ws_ordered_set type definition
+ *
+ * @extends ws_object
+ *
+ * An ordered set keeps its elements sorted, allowing the lowest and greatest
+ * element, the element at some position and the position of an element to be
+ * queried in O(log n). It is implemented as a balanced binary tree.
+ *
+ * Each element is stored along with an explicit key. Elements are ordered by
+ * their key first and by `ws_object_cmp()` second. Elements which are inserted
+ * without a key get the key `0`, so a set in which no keys are used is ordered
+ * by `ws_object_cmp()` alone. Explicit keys are useful for orders which are not
+ * a property of the elements themselves, e.g. a stacking order.
+ *
+ * Elements of different types are ordered by their type. Elements of a type
+ * without a compare callback are ordered by their address.
+ *
+ * @note Like `ws_set`, the ordered set does not lock itself. Users sharing a
+ * set between threads have to lock the set object.
+ */
+struct ws_ordered_set {
+    struct ws_object obj; //!< @protected Base class.
+
+    struct ws_ordered_set_node* root; //!< @private root of the tree
+};
+
+/**
+ * Variable which holds type information about the ws_ordered_set type
+ */
+extern ws_object_type_id WS_OBJECT_TYPE_ID_ORDERED_SET;
+
+/**
+ * Processor function type
+ *
+ * A processor may return a positive value to stop the iteration or a negative
+ * error code to abort it.
+ */
+typedef int (*ws_ordered_set_procf)(void*, void const*);
+
+/**
+ * Initialize an ordered set object
+ *
+ * @memberof ws_ordered_set
+ *
+ * @return zero on success, else negative error code from errno.h
+ */
+int
+ws_ordered_set_init(
+    struct ws_ordered_set* self //!< The ordered set object
+);
+
+/**
+ * Get a new, initialized ordered set object
+ *
+ * @memberof ws_ordered_set
+ *
+ * @return new ordered set object or NULL on failure
+ */
+struct ws_ordered_set*
+ws_ordered_set_new(void);
+
+/**
+ * Insert an object into the ordered set
+ *
+ * @memberof ws_ordered_set
+ *
+ * Equivalent to `ws_ordered_set_insert_keyed()` with a key of `0`.
+ *
+ * @return zero on success, else negative error value from errno.h
+ */
+int
+ws_ordered_set_insert(
+    struct ws_ordered_set* self, //!< The ordered set
+    struct ws_object* obj //!< The object to insert
+)
+__ws_nonnull__(1, 2)
+;
+
+/**
+ * Insert an object into the ordered set with an explicit key
+ *
+ * @memberof ws_ordered_set
+ *
+ * The set gets a reference on the object. If an equal element with the same
+ * key is already present, the set is not altered.
+ *
+ * @return zero on success, else negative error value from errno.h
+ */
+int
+ws_ordered_set_insert_keyed(
+    struct ws_ordered_set* self, //!< The ordered set
+    struct ws_object* obj, //!< The object to insert
+    intmax_t key //!< The key to order the object by
+)
+__ws_nonnull__(1, 2)
+;
+
+/**
+ * Remove an object from the ordered set
+ *
+ * @memberof ws_ordered_set
+ *
+ * Equivalent to `ws_ordered_set_remove_keyed()` with a key of `0`.
+ *
+ * @return zero on success, else negative error value from errno.h
+ */
+int
+ws_ordered_set_remove(
+    struct ws_ordered_set* self, //!< The ordered set
+    struct ws_object const* cmp //!< Object to compare to
+)
+__ws_nonnull__(1, 2)
+;
+
+/**
+ * Remove an object inserted with an explicit key from the ordered set
+ *
+ * @memberof ws_ordered_set
+ *
+ * @return zero on success, -ENOENT if there is no such element, else negative
+ *         error value from errno.h
+ */
+int
+ws_ordered_set_remove_keyed(
+    struct ws_ordered_set* self, //!< The ordered set
+    struct ws_object const* cmp, //!< Object to compare to
+    intmax_t key //!< The key the object was inserted with
+)
+__ws_nonnull__(1, 2)
+;
+
+/**
+ * Get the cardinality of an ordered set
+ *
+ * @memberof ws_ordered_set
+ *
+ * @return the cardinality of `self`
+ */
+size_t
+ws_ordered_set_cardinality(
+    struct ws_ordered_set const* self //!< The ordered set
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Get the lowest element of an ordered set
+ *
+ * @memberof ws_ordered_set
+ *
+ * @note Gets one ref on the returned object for you
+ *
+ * @return the lowest element or NULL if the set is empty
+ */
+struct ws_object*
+ws_ordered_set_min(
+    struct ws_ordered_set const* self //!< The ordered set
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Get the greatest element of an ordered set
+ *
+ * @memberof ws_ordered_set
+ *
+ * @note Gets one ref on the returned object for you
+ *
+ * @return the greatest element or NULL if the set is empty
+ */
+struct ws_object*
+ws_ordered_set_max(
+    struct ws_ordered_set const* self //!< The ordered set
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Get the element at a position
+ *
+ * @memberof ws_ordered_set
+ *
+ * @note Gets one ref on the returned object for you
+ *
+ * @return the element with `rank` lower elements or NULL if there is none
+ */
+struct ws_object*
+ws_ordered_set_at(
+    struct ws_ordered_set const* self, //!< The ordered set
+    size_t rank, //!< Position of the element
+    intmax_t* key //!< Optional output for the key of the element
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Get the position of an element
+ *
+ * @memberof ws_ordered_set
+ *
+ * Equivalent to `ws_ordered_set_rank_keyed()` with a key of `0`.
+ *
+ * @return the number of lower elements or -ENOENT if the element is not present
+ */
+ssize_t
+ws_ordered_set_rank(
+    struct ws_ordered_set const* self, //!< The ordered set
+    struct ws_object const* cmp //!< Object to compare to
+)
+__ws_nonnull__(1, 2)
+;
+
+/**
+ * Get the position of an element inserted with an explicit key
+ *
+ * @memberof ws_ordered_set
+ *
+ * @return the number of lower elements or -ENOENT if the element is not present
+ */
+ssize_t
+ws_ordered_set_rank_keyed(
+    struct ws_ordered_set const* self, //!< The ordered set
+    struct ws_object const* cmp, //!< Object to compare to
+    intmax_t key //!< The key the object was inserted with
+)
+__ws_nonnull__(1, 2)
+;
+
+/**
+ * Get the position of the first element with a key not lower than `key`
+ *
+ * @memberof ws_ordered_set
+ *
+ * Together with `ws_ordered_set_select_range()`, this allows iterating over all
+ * elements within a range of keys.
+ *
+ * @return the number of elements with a key lower than `key`
+ */
+size_t
+ws_ordered_set_lower_bound(
+    struct ws_ordered_set const* self, //!< The ordered set
+    intmax_t key //!< Key to look for
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Execute a processor function for a range of elements, in order
+ *
+ * @memberof ws_ordered_set
+ *
+ * The processor is called for each element with a position in [`from`, `to`).
+ * `to` may exceed the cardinality of the set.
+ *
+ * @warning The set must not be altered by the processor
+ *
+ * @return zero on success, else negative error code from errno.h
+ */
+int
+ws_ordered_set_select_range(
+    struct ws_ordered_set const* self, //!< The ordered set
+    size_t from, //!< Position of the first element to process
+    size_t to, //!< Position after the last element to process
+    ws_ordered_set_procf proc, //!< Processor function
+    void* proc_etc //!< Additional parameter for the processor function
+)
+__ws_nonnull__(1, 4)
+;
+
+#endif // __WS_OBJECTS_ORDERED_SET_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
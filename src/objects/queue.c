@@ -26,6 +26,7 @@
  */
 
 #include <errno.h>
+#include <stdlib.h>
 #include <wayland-util.h>
 
 #include "objects/object.h"
@@ -41,6 +42,120 @@ struct queue_element {
     struct ws_object* obj;
 };
 
+/**
+ * Element of a `WS_QUEUE_MPSC` queue
+ *
+ * @note the node must be the first member, so we can cast nodes to elements
+ */
+struct ws_queue_mpsc_element {
+    struct ws_mpsc_node node; //!< queue node
+    struct ws_object* obj; //!< the object queued
+    struct ws_queue_mpsc_element* next_free; //!< next recycled element
+};
+
+/**
+ * Recycled `WS_QUEUE_MPSC` elements, owned by the current thread
+ *
+ * Producers take elements from here. If it runs dry, a producer takes _all_
+ * the elements the consumer of a queue recycled in one go. This way, the
+ * shared free list is only ever pushed to individually and emptied as a
+ * whole, which is ABA-safe without a double-width CAS.
+ *
+ * @note elements cached by a thread are not released when the thread exits
+ */
+static __thread struct ws_queue_mpsc_element* mpsc_element_cache;
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Common part of all the initialization functions
+ */
+static int
+queue_init_common(
+    struct ws_queue* q,
+    enum ws_queue_flavour flavour
+);
+
+/**
+ * Wrap initialization of a heap allocated queue
+ */
+static struct ws_queue*
+queue_new_common(
+    int (*init)(struct ws_queue*, size_t),
+    size_t capacity
+);
+
+/**
+ * Initialization functions with a common signature
+ */
+static int
+queue_init_locked(
+    struct ws_queue* q,
+    size_t capacity
+);
+
+static int
+queue_init_spsc(
+    struct ws_queue* q,
+    size_t capacity
+);
+
+static int
+queue_init_mpsc(
+    struct ws_queue* q,
+    size_t capacity
+);
+
+/**
+ * Flavour specific push and pop functions
+ */
+static int
+queue_push_spsc(
+    struct ws_queue* q,
+    struct ws_object* o
+);
+
+static struct ws_object*
+queue_pop_spsc(
+    struct ws_queue* q
+);
+
+static int
+queue_push_mpsc(
+    struct ws_queue* q,
+    struct ws_object* o
+);
+
+static struct ws_object*
+queue_pop_mpsc(
+    struct ws_queue* q
+);
+
+/**
+ * Get an element for a `WS_QUEUE_MPSC` queue
+ *
+ * @return an element, possibly recycled, or `NULL` if no memory is left
+ */
+static struct ws_queue_mpsc_element*
+mpsc_element_get(
+    struct ws_queue* q
+);
+
+/**
+ * Recycle a `WS_QUEUE_MPSC` element
+ *
+ * @warning may only be called by the consumer of the queue
+ */
+static void
+mpsc_element_put(
+    struct ws_queue* q,
+    struct ws_queue_mpsc_element* e
+);
+
 /*
  * Type information
  */
@@ -60,39 +175,61 @@ int
 ws_queue_init(
     struct ws_queue* q
 ) {
-    if (!ws_object_init(&q->obj)) {
-        return -EINVAL;
-    }
-    q->obj.id = &WS_OBJECT_TYPE_ID_QUEUE;
+    return queue_init_locked(q, 0);
+}
 
-    wl_list_init(&q->link);
+int
+ws_queue_init_spsc(
+    struct ws_queue* q,
+    size_t capacity
+) {
+    return queue_init_spsc(q, capacity);
+}
 
-    return 0;
+int
+ws_queue_init_mpsc(
+    struct ws_queue* q
+) {
+    return queue_init_mpsc(q, 0);
 }
 
 struct ws_queue*
 ws_queue_new(void)
 {
-    struct ws_queue* q = calloc(1, sizeof(*q));
-    if (!q) {
-        return NULL;
-    }
-
-    if (ws_queue_init(q) < 0) {
-        free(q);
-        return NULL;
-    }
+    return queue_new_common(queue_init_locked, 0);
+}
 
-    q->obj.settings |= WS_OBJECT_HEAPALLOCED;
+struct ws_queue*
+ws_queue_new_spsc(
+    size_t capacity
+) {
+    return queue_new_common(queue_init_spsc, capacity);
+}
 
-    return q;
+struct ws_queue*
+ws_queue_new_mpsc(void)
+{
+    return queue_new_common(queue_init_mpsc, 0);
 }
 
 struct ws_object*
 ws_queue_pop(
     struct ws_queue* q
 ) {
-    if (!q || wl_list_empty(&q->link)) {
+    if (!q) {
+        return NULL;
+    }
+
+    switch (q->flavour) {
+    case WS_QUEUE_SPSC:
+        return queue_pop_spsc(q);
+    case WS_QUEUE_MPSC:
+        return queue_pop_mpsc(q);
+    default:
+        break;
+    }
+
+    if (wl_list_empty(&q->impl.link)) {
         return NULL;
     }
 
@@ -100,7 +237,7 @@ ws_queue_pop(
         return NULL;
     }
 
-    struct queue_element* qe = wl_container_of(q->link.prev, qe, link);
+    struct queue_element* qe = wl_container_of(q->impl.link.prev, qe, link);
     struct ws_object* res = qe->obj;
 
     wl_list_remove(&qe->link);
@@ -119,6 +256,15 @@ ws_queue_push(
         return -EINVAL;
     }
 
+    switch (q->flavour) {
+    case WS_QUEUE_SPSC:
+        return queue_push_spsc(q, o);
+    case WS_QUEUE_MPSC:
+        return queue_push_mpsc(q, o);
+    default:
+        break;
+    }
+
     if (!ws_object_lock_write(&q->obj)) {
         return -EAGAIN;
     }
@@ -131,11 +277,12 @@ ws_queue_push(
 
     qe->obj = getref(o);
     if (!qe->obj) {
+        ws_object_unlock(&q->obj);
         free(qe);
         return -EINVAL;
     }
 
-    wl_list_insert(&q->link, &qe->link);
+    wl_list_insert(&q->impl.link, &qe->link);
 
     ws_object_unlock(&q->obj);
     return 0;
@@ -145,7 +292,21 @@ bool
 ws_queue_empty(
     struct ws_queue* q
 ) {
-    return (q ? wl_list_empty(&q->link) : true);
+    if (!q) {
+        return true;
+    }
+
+    switch (q->flavour) {
+    case WS_QUEUE_SPSC:
+        return __atomic_load_n(&q->impl.spsc.head, __ATOMIC_RELAXED) ==
+               __atomic_load_n(&q->impl.spsc.tail, __ATOMIC_ACQUIRE);
+    case WS_QUEUE_MPSC:
+        return ws_mpsc_queue_empty(&q->impl.mpsc.queue);
+    default:
+        break;
+    }
+
+    return wl_list_empty(&q->impl.link);
 }
 
 /*
@@ -160,12 +321,244 @@ deinit_queue(
 ) {
     struct ws_queue* queue = (struct ws_queue*) q;
 
+    // drop the elements still queued
+    struct ws_object* obj;
+    switch (queue->flavour) {
+    case WS_QUEUE_SPSC:
+        while ((obj = queue_pop_spsc(queue))) {
+            ws_object_unref(obj);
+        }
+        free(queue->impl.spsc.ring);
+        return true;
+
+    case WS_QUEUE_MPSC:
+        while ((obj = queue_pop_mpsc(queue))) {
+            ws_object_unref(obj);
+        }
+        while (queue->impl.mpsc.free) {
+            struct ws_queue_mpsc_element* e = queue->impl.mpsc.free;
+            queue->impl.mpsc.free = e->next_free;
+            free(e);
+        }
+        return true;
+
+    default:
+        break;
+    }
+
     struct queue_element* iter;
     struct queue_element* tmp;
-    wl_list_for_each_safe(iter, tmp, &queue->link, link) {
+    wl_list_for_each_safe(iter, tmp, &queue->impl.link, link) {
         ws_object_unref(iter->obj);
         wl_list_remove(&iter->link);
+        free(iter);
     }
 
     return true;
 }
+
+static int
+queue_init_common(
+    struct ws_queue* q,
+    enum ws_queue_flavour flavour
+) {
+    if (!ws_object_init(&q->obj)) {
+        return -EINVAL;
+    }
+    q->obj.id = &WS_OBJECT_TYPE_ID_QUEUE;
+
+    q->flavour = flavour;
+
+    // only initialize the state the flavour actually uses
+    switch (flavour) {
+    case WS_QUEUE_SPSC:
+        q->impl.spsc.ring = NULL;
+        q->impl.spsc.mask = 0;
+        q->impl.spsc.head = 0;
+        q->impl.spsc.tail = 0;
+        break;
+    case WS_QUEUE_MPSC:
+        ws_mpsc_queue_init(&q->impl.mpsc.queue);
+        q->impl.mpsc.free = NULL;
+        break;
+    default:
+        wl_list_init(&q->impl.link);
+        break;
+    }
+
+    return 0;
+}
+
+static struct ws_queue*
+queue_new_common(
+    int (*init)(struct ws_queue*, size_t),
+    size_t capacity
+) {
+    struct ws_queue* q = calloc(1, sizeof(*q));
+    if (!q) {
+        return NULL;
+    }
+
+    if (init(q, capacity) < 0) {
+        free(q);
+        return NULL;
+    }
+
+    q->obj.settings |= WS_OBJECT_HEAPALLOCED;
+
+    return q;
+}
+
+static int
+queue_init_locked(
+    struct ws_queue* q,
+    size_t capacity __ws_unused__
+) {
+    return queue_init_common(q, WS_QUEUE_LOCKED);
+}
+
+static int
+queue_init_spsc(
+    struct ws_queue* q,
+    size_t capacity
+) {
+    if (capacity == 0) {
+        return -EINVAL;
+    }
+
+    // round up to the next power of two, so we can mask instead of mod
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+
+    struct ws_object** ring = calloc(size, sizeof(*ring));
+    if (!ring) {
+        return -ENOMEM;
+    }
+
+    int res = queue_init_common(q, WS_QUEUE_SPSC);
+    if (res < 0) {
+        free(ring);
+        return res;
+    }
+
+    q->impl.spsc.ring = ring;
+    q->impl.spsc.mask = size - 1;
+    return 0;
+}
+
+static int
+queue_init_mpsc(
+    struct ws_queue* q,
+    size_t capacity __ws_unused__
+) {
+    return queue_init_common(q, WS_QUEUE_MPSC);
+}
+
+static int
+queue_push_spsc(
+    struct ws_queue* q,
+    struct ws_object* o
+) {
+    // only we write `tail`, but the consumer writes `head`
+    size_t tail = q->impl.spsc.tail;
+    size_t head = __atomic_load_n(&q->impl.spsc.head, __ATOMIC_ACQUIRE);
+    if (tail - head > q->impl.spsc.mask) {
+        return -ENOSPC;
+    }
+
+    struct ws_object* ref = getref(o);
+    if (!ref) {
+        return -EINVAL;
+    }
+
+    q->impl.spsc.ring[tail & q->impl.spsc.mask] = ref;
+    __atomic_store_n(&q->impl.spsc.tail, tail + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+static struct ws_object*
+queue_pop_spsc(
+    struct ws_queue* q
+) {
+    // only we write `head`, but the producer writes `tail`
+    size_t head = q->impl.spsc.head;
+    size_t tail = __atomic_load_n(&q->impl.spsc.tail, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+        return NULL;
+    }
+
+    struct ws_object* res = q->impl.spsc.ring[head & q->impl.spsc.mask];
+    __atomic_store_n(&q->impl.spsc.head, head + 1, __ATOMIC_RELEASE);
+    return res;
+}
+
+static int
+queue_push_mpsc(
+    struct ws_queue* q,
+    struct ws_object* o
+) {
+    struct ws_queue_mpsc_element* e = mpsc_element_get(q);
+    if (!e) {
+        return -ENOMEM;
+    }
+
+    e->obj = getref(o);
+    if (!e->obj) {
+        // we may not touch the queue's free list, keep it for ourselves
+        e->next_free = mpsc_element_cache;
+        mpsc_element_cache = e;
+        return -EINVAL;
+    }
+
+    ws_mpsc_queue_push(&q->impl.mpsc.queue, &e->node);
+    return 0;
+}
+
+static struct ws_object*
+queue_pop_mpsc(
+    struct ws_queue* q
+) {
+    struct ws_mpsc_node* node = ws_mpsc_queue_pop(&q->impl.mpsc.queue);
+    if (!node) {
+        return NULL;
+    }
+
+    struct ws_queue_mpsc_element* e = (struct ws_queue_mpsc_element*) node;
+    struct ws_object* res = e->obj;
+    mpsc_element_put(q, e);
+    return res;
+}
+
+static struct ws_queue_mpsc_element*
+mpsc_element_get(
+    struct ws_queue* q
+) {
+    struct ws_queue_mpsc_element* e = mpsc_element_cache;
+    if (!e) {
+        // grab everything the consumer recycled
+        e = __atomic_exchange_n(&q->impl.mpsc.free, NULL, __ATOMIC_ACQUIRE);
+    }
+
+    if (e) {
+        mpsc_element_cache = e->next_free;
+        return e;
+    }
+
+    return malloc(sizeof(*e));
+}
+
+static void
+mpsc_element_put(
+    struct ws_queue* q,
+    struct ws_queue_mpsc_element* e
+) {
+    e->obj = NULL;
+    e->next_free = __atomic_load_n(&q->impl.mpsc.free, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&q->impl.mpsc.free, &e->next_free, e,
+                                        true, __ATOMIC_RELEASE,
+                                        __ATOMIC_RELAXED)) {
+        // `e->next_free` was updated by the failed exchange, just retry
+    }
+}
@@ -41,16 +41,55 @@
 #define __WS_OBJECTS_QUEUE_H__
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <wayland-util.h>
 
 #include "objects/object.h"
+#include "util/mpsc.h"
+
+// forward declarations
+struct ws_queue_mpsc_element;
+
+/**
+ * Queue flavours
+ *
+ * All flavours share the `ws_queue` interface, but differ in which threads may
+ * push and pop concurrently:
+ *
+ * - `WS_QUEUE_LOCKED` takes the object lock for every operation, hence any
+ *   thread may push or pop at any time.
+ * - `WS_QUEUE_SPSC` is a bounded, lock-free ring. Exactly one thread may push
+ *   and exactly one (other) thread may pop. It never allocates after
+ *   initialization.
+ * - `WS_QUEUE_MPSC` is an unbounded, lock-free queue. Any thread may push, but
+ *   exactly one thread may pop. Queue nodes are recycled, so it does not
+ *   allocate in the steady state.
+ */
+enum ws_queue_flavour {
+    WS_QUEUE_LOCKED = 0,
+    WS_QUEUE_SPSC,
+    WS_QUEUE_MPSC,
+};
 
 /**
  * Queue type
  */
 struct ws_queue {
     struct ws_object obj; //!< @protected Base class
-    struct wl_list link; //!< @private Actual queue
+    enum ws_queue_flavour flavour; //!< @private flavour of the queue
+    union {
+        struct wl_list link; //!< @private Actual queue (`WS_QUEUE_LOCKED`)
+        struct {
+            struct ws_object** ring; //!< @private elements
+            size_t mask; //!< @private capacity - 1
+            size_t head; //!< @private next element to pop, written by consumer
+            size_t tail; //!< @private next slot to push to, written by producer
+        } spsc; //!< @private ring (`WS_QUEUE_SPSC`)
+        struct {
+            struct ws_mpsc_queue queue; //!< @private the actual queue
+            struct ws_queue_mpsc_element* free; //!< @private recycled nodes
+        } mpsc; //!< @private queue (`WS_QUEUE_MPSC`)
+    } impl; //!< @private flavour specific state, selected by `flavour`
 };
 
 
@@ -71,6 +110,33 @@ ws_queue_init(
     struct ws_queue* q
 );
 
+/**
+ * Initialize a lock-free single-producer single-consumer queue
+ *
+ * @memberof ws_queue
+ *
+ * @note `capacity` is rounded up to the next power of two
+ *
+ * @return zero on success, else negative errno.h number
+ */
+int
+ws_queue_init_spsc(
+    struct ws_queue* q,
+    size_t capacity //!< maximum number of elements in the queue
+);
+
+/**
+ * Initialize a lock-free multi-producer single-consumer queue
+ *
+ * @memberof ws_queue
+ *
+ * @return zero on success, else negative errno.h number
+ */
+int
+ws_queue_init_mpsc(
+    struct ws_queue* q
+);
+
 /**
  * Allocate a new queue
  *
@@ -81,6 +147,28 @@ ws_queue_init(
 struct ws_queue*
 ws_queue_new(void);
 
+/**
+ * Allocate a new lock-free single-producer single-consumer queue
+ *
+ * @memberof ws_queue
+ *
+ * @return new ws_queue object or NULL on failure
+ */
+struct ws_queue*
+ws_queue_new_spsc(
+    size_t capacity //!< maximum number of elements in the queue
+);
+
+/**
+ * Allocate a new lock-free multi-producer single-consumer queue
+ *
+ * @memberof ws_queue
+ *
+ * @return new ws_queue object or NULL on failure
+ */
+struct ws_queue*
+ws_queue_new_mpsc(void);
+
 /**
  * Get the next element from the queue
  *
@@ -89,6 +177,9 @@ ws_queue_new(void);
  * @note Removes the element from the queue, does _NOT_ unref it, so this is a
  * move operation.
  *
+ * @note A `WS_QUEUE_MPSC` queue may appear empty while an element is being
+ * pushed concurrently.
+ *
  * @return next ws_object in queue or NULL on failure (or queue empty)
  */
 struct ws_object*
@@ -101,7 +192,8 @@ ws_queue_pop(
  *
  * @memberof ws_queue
  *
- * @return zero on success, else negative errno.h number
+ * @return zero on success, else negative errno.h number, `-ENOSPC` if a
+ *         `WS_QUEUE_SPSC` queue is full
  */
 int
 ws_queue_push(
@@ -114,6 +206,8 @@ ws_queue_push(
  *
  * @memberof ws_queue
  *
+ * @warning for the lock-free flavours, this may only be called by the consumer
+ *
  * @return true if queue is empty, false otherwise
  */
 bool
@@ -32,9 +32,16 @@
 #include <libreset/set.h>
 
 #include "objects/object.h"
+#include "util/arithmetical.h"
+#include "util/parallel.h"
 
 #include "objects/set.h"
 
+/**
+ * Number of elements the predicate is evaluated for by one thread at a time
+ */
+#define SELECT_CHUNK (64)
+
 /*
  *
  * Forward declarations
@@ -44,6 +51,8 @@
 /**
  * Compare two objects
  *
+ * Either of the objects may be a `struct set_probe`.
+ *
  * @return 1 if both parameters point to the same objects, 0 otherwise
  */
 static int
@@ -52,6 +61,18 @@ cmp_objects(
     void const* b //!< object b
 );
 
+/**
+ * Hash an object
+ *
+ * The object may be a `struct set_probe`, in which case its hash is returned.
+ *
+ * @return hash of the object
+ */
+static r_hash
+hash_object(
+    void const* obj //!< object to hash
+);
+
 /**
  * Deinit callback for ws_set type
  */
@@ -78,12 +99,134 @@ get_greatest(
     void const* src //!< source
 );
 
+/**
+ * Predicate: check whether an object is contained in a set
+ *
+ * @return 1 if the object is an element of the set passed via `etc`, else 0
+ */
+static int
+contained_in(
+    void const* obj, //!< object to check
+    void* etc //!< the set to look up the object in
+);
+
+/**
+ * Predicate: check whether an object is not contained in a set
+ *
+ * @return 0 if the object is an element of the set passed via `etc`, else 1
+ */
+static int
+not_contained_in(
+    void const* obj, //!< object to check
+    void* etc //!< the set to look up the object in
+);
+
+/**
+ * Processor: insert an object into a set
+ *
+ * @return zero on success, else negative error code from errno.h
+ */
+static int
+insert_into(
+    void* etc, //!< the set to insert the object into
+    void const* obj //!< object to insert
+);
+
+/**
+ * Processor: remove an object from a set if present, insert it otherwise
+ *
+ * @return zero on success, else negative error code from errno.h
+ */
+static int
+toggle_in(
+    void* etc, //!< the set to toggle the object in
+    void const* obj //!< object to toggle
+);
+
+/**
+ * Processor: append an object to a `struct object_list`
+ *
+ * @return zero on success, else negative error code from errno.h
+ */
+static int
+collect_object(
+    void* etc, //!< the list to append the object to
+    void const* obj //!< object to append
+);
+
+/**
+ * Processor: check whether an object is contained in a set
+ *
+ * Stops the iteration as soon as an object is found which is not contained in
+ * the set.
+ *
+ * @return zero if the object is contained in the set, 1 otherwise
+ */
+static int
+check_contained(
+    void* etc, //!< the `struct subset_check`
+    void const* obj //!< object to check
+);
+
+/**
+ * Parallel loop body: evaluate the predicate for a chunk of elements
+ */
+static void
+select_chunk(
+    size_t index, //!< index of the chunk
+    void* etc //!< the `struct parallel_select`
+);
+
 /*
  *
  * Internal structs
  *
  */
 
+/**
+ * Growing list of objects, used for collecting elements during an iteration
+ */
+struct object_list {
+    struct ws_object const** objs; //!< the objects collected
+    size_t num; //!< number of objects collected
+    size_t cap; //!< capacity of `objs`
+};
+
+/**
+ * Stand-in for an object, used for looking up elements by key
+ *
+ * Like objects, probes start with a type id, which identifies them as probes.
+ * They are only ever passed to libreset for lookups, never inserted.
+ */
+struct set_probe {
+    ws_object_type_id* id; //!< always `&PROBE_TYPE`
+    size_t hash; //!< hash of the element looked up
+    void const* key; //!< key to compare elements to
+    ws_set_key_cmp cmp; //!< callback comparing elements to the key
+};
+
+/**
+ * State of a parallel select
+ *
+ * Each chunk of `elems` is evaluated by exactly one thread, which records its
+ * results in the corresponding part of `selected`, so no synchronization is
+ * needed for the results.
+ */
+struct parallel_select {
+    struct object_list elems; //!< the elements of the set
+    bool* selected; //!< per element: whether the predicate matched
+    ws_set_predf pred; //!< the predicate
+    void* pred_etc; //!< additional parameter for the predicate
+};
+
+/**
+ * State of a subset check
+ */
+struct subset_check {
+    struct ws_set const* set; //!< set which has to contain all the elements
+    bool is_subset; //!< whether all elements checked so far are contained
+};
+
 /**
  * Set configuration for libreset. Not meant to be public.
  */
@@ -91,7 +234,15 @@ static const struct r_set_cfg WS_SET_CONFIGURATION= {
     .cmpf = cmp_objects,
     .copyf = (void* (*)(void*)) ws_object_getref,
     .freef = (void (*)(void*)) ws_object_unref,
-    .hashf = (r_hash (*)(void const*)) ws_object_hash,
+    .hashf = hash_object,
+};
+
+/**
+ * Type identifying probes
+ */
+static ws_object_type_id PROBE_TYPE = {
+    .supertype  = &WS_OBJECT_TYPE_ID_OBJECT,
+    .typestr    = "ws_set probe",
 };
 
 /**
@@ -199,56 +350,189 @@ ws_set_get(
     return o;
 }
 
-// int
-// ws_set_union(
-//     struct ws_set* dest,
-//     struct ws_set const* src_a,
-//     struct ws_set const* src_b
-// ) {
-//     if (dest && src_a && src_b) {
-//         return r_set_union(dest->set, src_a->set, src_b->set);
-//     }
-//
-//     return -EINVAL;
-// }
-
-// int
-// ws_set_intersection(
-//     struct ws_set* dest,
-//     struct ws_set const* src_a,
-//     struct ws_set const* src_b
-// ) {
-//     if (dest && src_a && src_b) {
-//         return r_set_intersection(dest->set, src_a->set, src_b->set);
-//     }
-//
-//     return -EINVAL;
-// }
-
-// int
-// ws_set_xor(
-//     struct ws_set* dest,
-//     struct ws_set const* src_a,
-//     struct ws_set const* src_b
-// ) {
-//     if (dest && src_a && src_b) {
-//         return r_set_xor(dest->set, src_a->set, src_b->set);
-//     }
-//
-//     return -EINVAL;
-// }
-
-// bool
-// ws_set_is_subset(
-//     struct ws_set const* self,
-//     struct ws_set const* other
-// ) {
-//     if (self && other) {
-//         return r_set_is_subset(self->set, other->set);
-//     }
-//
-//     return false;
-// }
+struct ws_object*
+ws_set_get_by_key(
+    struct ws_set const* self,
+    size_t hash,
+    void const* key,
+    ws_set_key_cmp cmp
+) {
+    struct set_probe probe = {
+        .id = &PROBE_TYPE, .hash = hash, .key = key, .cmp = cmp
+    };
+
+    struct ws_object* o = r_set_contains(self->set, &probe);
+    ws_object_getref(o);
+    return o;
+}
+
+int
+ws_set_remove_by_key(
+    struct ws_set* self,
+    size_t hash,
+    void const* key,
+    ws_set_key_cmp cmp
+) {
+    struct set_probe probe = {
+        .id = &PROBE_TYPE, .hash = hash, .key = key, .cmp = cmp
+    };
+
+    int r = r_set_remove(self->set, &probe);
+
+    if (r == 0 || r == -EEXIST) {
+        return 0;
+    }
+
+    return r;
+}
+
+int
+ws_set_union(
+    struct ws_set* dest,
+    struct ws_set const* src_a,
+    struct ws_set const* src_b
+) {
+    if (!dest || !src_a || !src_b) {
+        return -EINVAL;
+    }
+
+    int res = ws_set_union_inplace(dest, src_a);
+    if (res < 0) {
+        return res;
+    }
+
+    return ws_set_union_inplace(dest, src_b);
+}
+
+int
+ws_set_intersection(
+    struct ws_set* dest,
+    struct ws_set const* src_a,
+    struct ws_set const* src_b
+) {
+    if (!dest || !src_a || !src_b) {
+        return -EINVAL;
+    }
+
+    // iterate the smaller set, look up in the larger one
+    if (ws_set_cardinality(src_a) > ws_set_cardinality(src_b)) {
+        struct ws_set const* tmp = src_a;
+        src_a = src_b;
+        src_b = tmp;
+    }
+
+    return ws_set_select(src_a, contained_in, (void*) src_b, insert_into, dest);
+}
+
+int
+ws_set_xor(
+    struct ws_set* dest,
+    struct ws_set const* src_a,
+    struct ws_set const* src_b
+) {
+    if (!dest || !src_a || !src_b) {
+        return -EINVAL;
+    }
+
+    int res;
+    res = ws_set_select(src_a, not_contained_in, (void*) src_b,
+                        insert_into, dest);
+    if (res < 0) {
+        return res;
+    }
+
+    return ws_set_select(src_b, not_contained_in, (void*) src_a,
+                         insert_into, dest);
+}
+
+bool
+ws_set_is_subset(
+    struct ws_set const* self,
+    struct ws_set const* other
+) {
+    if (!self || !other) {
+        return false;
+    }
+
+    if (ws_set_cardinality(other) > ws_set_cardinality(self)) {
+        return false;
+    }
+
+    struct subset_check check = { .set = self, .is_subset = true };
+    if (ws_set_select(other, NULL, NULL, check_contained, &check) < 0) {
+        return false;
+    }
+
+    return check.is_subset;
+}
+
+int
+ws_set_union_inplace(
+    struct ws_set* self,
+    struct ws_set const* other
+) {
+    if (!self || !other) {
+        return -EINVAL;
+    }
+
+    if (self == other) {
+        return 0;
+    }
+
+    // insertion skips elements already present, no need to look them up first
+    return ws_set_select(other, NULL, NULL, insert_into, self);
+}
+
+int
+ws_set_intersection_inplace(
+    struct ws_set* self,
+    struct ws_set const* other
+) {
+    if (!self || !other) {
+        return -EINVAL;
+    }
+
+    if (self == other) {
+        return 0;
+    }
+
+    // we may not remove elements from the set we are iterating over
+    struct object_list drop = { .objs = NULL, .num = 0, .cap = 0 };
+
+    int res;
+    res = ws_set_select(self, not_contained_in, (void*) other,
+                        collect_object, &drop);
+
+    for (size_t i = 0; (res >= 0) && (i < drop.num); ++i) {
+        res = ws_set_remove(self, drop.objs[i]);
+    }
+
+    free(drop.objs);
+    return (res < 0) ? res : 0;
+}
+
+int
+ws_set_xor_inplace(
+    struct ws_set* self,
+    struct ws_set const* other
+) {
+    if (!self || !other) {
+        return -EINVAL;
+    }
+
+    if (self == other) {
+        // the symmetric difference of a set with itself is the empty set
+        struct r_set* empty = r_set_new(&WS_SET_CONFIGURATION);
+        if (!empty) {
+            return -ENOMEM;
+        }
+        r_set_destroy(self->set);
+        self->set = empty;
+        return 0;
+    }
+
+    return ws_set_select(other, NULL, NULL, toggle_in, self);
+}
 
 bool
 ws_set_equal(
@@ -288,6 +572,55 @@ ws_set_select(
     return -EINVAL;
 }
 
+int
+ws_set_select_parallel(
+    struct ws_set const* self,
+    ws_set_predf pred,
+    void* pred_etc,
+    ws_set_procf proc,
+    void* proc_etc,
+    unsigned int threads
+) {
+    if (!pred) {
+        // nothing to evaluate in parallel
+        return ws_set_select(self, NULL, NULL, proc, proc_etc);
+    }
+
+    struct parallel_select sel = {
+        .elems = { .objs = NULL, .num = 0, .cap = 0 },
+        .selected = NULL,
+        .pred = pred,
+        .pred_etc = pred_etc,
+    };
+
+    // take a snapshot of the elements, which is then split into chunks
+    int res = r_set_select(self->set, NULL, NULL, collect_object, &sel.elems);
+    if (res < 0) {
+        goto cleanup;
+    }
+
+    sel.selected = calloc(sel.elems.num + 1, sizeof(*sel.selected));
+    if (!sel.selected) {
+        res = -ENOMEM;
+        goto cleanup;
+    }
+
+    size_t chunks = (sel.elems.num + SELECT_CHUNK - 1) / SELECT_CHUNK;
+    ws_parallel_for(chunks, threads, select_chunk, &sel);
+
+    // run the processor on the elements selected, in the calling thread
+    res = 0;
+    for (size_t i = 0; !res && i < sel.elems.num; ++i) {
+        if (sel.selected[i]) {
+            res = proc(proc_etc, sel.elems.objs[i]);
+        }
+    }
+
+cleanup:
+    free(sel.selected);
+    free(sel.elems.objs);
+    return res;
+}
 
 static int
 get_reference(
@@ -339,9 +672,30 @@ cmp_objects(
     struct ws_object* o1 = (struct ws_object*) a;
     struct ws_object* o2 = (struct ws_object*) b;
 
+    if (o1->id == &PROBE_TYPE) {
+        struct set_probe const* probe = a;
+        return !probe->cmp(o2, probe->key);
+    }
+    if (o2->id == &PROBE_TYPE) {
+        struct set_probe const* probe = b;
+        return !probe->cmp(o1, probe->key);
+    }
+
     return !ws_object_cmp(o1, o2);
 }
 
+static r_hash
+hash_object(
+    void const* obj
+) {
+    struct set_probe const* probe = obj;
+    if (probe->id == &PROBE_TYPE) {
+        return probe->hash;
+    }
+
+    return ws_object_hash((struct ws_object*) obj);
+}
+
 static bool
 deinit_set(
     struct ws_object* const self
@@ -387,3 +741,93 @@ get_greatest(
     return 0;
 }
 
+static int
+contained_in(
+    void const* obj,
+    void* etc
+) {
+    struct ws_set const* set = etc;
+    return r_set_contains(set->set, obj) != NULL;
+}
+
+static int
+not_contained_in(
+    void const* obj,
+    void* etc
+) {
+    struct ws_set const* set = etc;
+    return r_set_contains(set->set, obj) == NULL;
+}
+
+static int
+insert_into(
+    void* etc,
+    void const* obj
+) {
+    return ws_set_insert((struct ws_set*) etc, (struct ws_object*) obj);
+}
+
+static int
+toggle_in(
+    void* etc,
+    void const* obj
+) {
+    struct ws_set* set = etc;
+
+    if (r_set_contains(set->set, obj)) {
+        return ws_set_remove(set, obj);
+    }
+    return ws_set_insert(set, (struct ws_object*) obj);
+}
+
+static int
+collect_object(
+    void* etc,
+    void const* obj
+) {
+    struct object_list* list = etc;
+
+    if (list->num == list->cap) {
+        size_t cap = list->cap ? list->cap * 2 : 16;
+        void* objs = realloc(list->objs, cap * sizeof(*list->objs));
+        if (!objs) {
+            return -ENOMEM;
+        }
+        list->objs = objs;
+        list->cap = cap;
+    }
+
+    list->objs[list->num++] = obj;
+    return 0;
+}
+
+static int
+check_contained(
+    void* etc,
+    void const* obj
+) {
+    struct subset_check* check = etc;
+
+    if (!r_set_contains(check->set->set, obj)) {
+        check->is_subset = false;
+        return 1;
+    }
+    return 0;
+}
+
+static void
+select_chunk(
+    size_t index,
+    void* etc
+) {
+    struct parallel_select* sel = etc;
+    size_t end = MIN((index + 1) * SELECT_CHUNK, sel->elems.num);
+
+    for (size_t i = index * SELECT_CHUNK; i < end; ++i) {
+        struct ws_object* obj = (struct ws_object*) sel->elems.objs[i];
+
+        ws_object_lock_read(obj);
+        sel->selected[i] = sel->pred(obj, sel->pred_etc) != 0;
+        ws_object_unlock(obj);
+    }
+}
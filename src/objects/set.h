@@ -143,11 +143,66 @@ ws_set_get(
     struct ws_object const* cmp //!< Object to compare to
 );
 
+/**
+ * Callback comparing an element of a set to a key
+ *
+ * @return 0 if the element matches the key, non-zero otherwise
+ */
+typedef int (*ws_set_key_cmp)(
+    struct ws_object const* elem, //!< element of the set
+    void const* key //!< key to compare the element to
+);
+
+/**
+ * Get an object from a set by a key
+ *
+ * @memberof ws_set
+ *
+ * Looks up an element by a precomputed hash and a borrowed key, without
+ * constructing an object to compare to. The hash has to equal the one
+ * `ws_object_hash()` computes for the element matching the key.
+ *
+ * @note Gets one ref on the returned object for you
+ *
+ * @return the ws_object object or NULL if there is no matching element
+ */
+struct ws_object*
+ws_set_get_by_key(
+    struct ws_set const* self, //!< The set
+    size_t hash, //!< hash of the element to look up
+    void const* key, //!< key to pass to `cmp`
+    ws_set_key_cmp cmp //!< callback comparing elements to the key
+)
+__ws_nonnull__(1, 4)
+;
+
+/**
+ * Remove an object from a set by a key
+ *
+ * @memberof ws_set
+ *
+ * Like `ws_set_get_by_key()`, but removes the element.
+ *
+ * @return zero on success else negative error value from errno.h
+ */
+int
+ws_set_remove_by_key(
+    struct ws_set* self, //!< The set
+    size_t hash, //!< hash of the element to remove
+    void const* key, //!< key to pass to `cmp`
+    ws_set_key_cmp cmp //!< callback comparing elements to the key
+)
+__ws_nonnull__(1, 4)
+;
+
 /**
  * Create an union from two set objects
  *
  * @memberof ws_set
  *
+ * The elements of both sets are inserted into `dest`, elements already present
+ * in `dest` are kept.
+ *
  * @return zero on success, else negative error number from errno.h
  */
 int
@@ -162,6 +217,9 @@ ws_set_union(
  *
  * @memberof ws_set
  *
+ * The elements contained in both sets are inserted into `dest`, elements
+ * already present in `dest` are kept.
+ *
  * @return zero on success, else negative error number from errno.h
  */
 int
@@ -176,6 +234,9 @@ ws_set_intersection(
  *
  * @memberof ws_set
  *
+ * The elements contained in exactly one of the sets are inserted into `dest`,
+ * elements already present in `dest` are kept.
+ *
  * @return zero on success, else negative error number from errno.h
  */
 int
@@ -185,6 +246,52 @@ ws_set_xor(
     struct ws_set const* src_b //!< The second source set
 );
 
+/**
+ * Unite a set with another one, in place
+ *
+ * @memberof ws_set
+ *
+ * Inserts all the elements of `other` into `self`.
+ *
+ * @return zero on success, else negative error number from errno.h
+ */
+int
+ws_set_union_inplace(
+    struct ws_set* self, //!< The set to modify
+    struct ws_set const* other //!< The set to unite `self` with
+);
+
+/**
+ * Intersect a set with another one, in place
+ *
+ * @memberof ws_set
+ *
+ * Removes all the elements from `self` which are not contained in `other`.
+ *
+ * @return zero on success, else negative error number from errno.h
+ */
+int
+ws_set_intersection_inplace(
+    struct ws_set* self, //!< The set to modify
+    struct ws_set const* other //!< The set to intersect `self` with
+);
+
+/**
+ * Build the symmetric difference of a set and another one, in place
+ *
+ * @memberof ws_set
+ *
+ * Removes all the elements from `self` which are contained in `other` and
+ * inserts those elements of `other` which were not contained in `self`.
+ *
+ * @return zero on success, else negative error number from errno.h
+ */
+int
+ws_set_xor_inplace(
+    struct ws_set* self, //!< The set to modify
+    struct ws_set const* other //!< The other set
+);
+
 /**
  * Check if one set is a subset of another
  *
@@ -243,6 +350,37 @@ ws_set_select(
     void* proc_etc //!< Additional parameter for the processor function
 );
 
+/**
+ * Execute a processor function for each element of a set, evaluating the
+ * predicate in parallel
+ *
+ * @memberof ws_set
+ *
+ * Like `ws_set_select()`, but the predicate is evaluated for chunks of the set
+ * on multiple threads concurrently, each element being read-locked while the
+ * predicate runs on it. This pays off for large sets and predicates which
+ * are expensive, e.g. because they read attributes.
+ *
+ * The processor is run on the calling thread only, after all predicates were
+ * evaluated. It may stop the iteration by returning a non-zero value.
+ *
+ * @warning The predicate has to be thread safe. It must not alter the set.
+ *
+ * @return zero on success, else negative error code from errno.h or the
+ *         non-zero value returned by the processor
+ */
+int
+ws_set_select_parallel(
+    struct ws_set const* self, //!< The set
+    ws_set_predf pred, //!< Predicate function, run concurrently
+    void* pred_etc, //!< Additional parameter for the predicate function
+    ws_set_procf proc, //!< Processor function
+    void* proc_etc, //!< Additional parameter for the processor function
+    unsigned int threads //!< Maximum number of threads, 0 for the default
+)
+__ws_nonnull__(1, 4)
+;
+
 /**
  * Select first possible element
  *
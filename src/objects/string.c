@@ -26,14 +26,66 @@
  */
 
 #include <errno.h>
+#include <pthread.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
-#include <unicode/ustring.h>
+#include <sys/types.h>
+#include <unicode/utf8.h>
 
 #include "objects/object.h"
 #include "objects/string.h"
+#include "util/arithmetical.h"
+#include "util/cleaner.h"
 #include "util/condition.h"
+#include "util/slab.h"
+
+/**
+ * Initial number of slots in the intern table
+ */
+#define INTERN_TABLE_INITIAL_SIZE 64
+
+/**
+ * Initial value of a hash, the hash of the empty string
+ */
+#define HASH_INIT ((size_t) 14695981039346656037ULL)
+
+/**
+ * Reference counted storage for the contents of strings
+ *
+ * Strings with contents which do not fit their inline storage point to the
+ * `data` member of such a buffer. A buffer may be shared by any number of
+ * strings. A string which wants to modify a shared buffer has to copy it
+ * first. Interned buffers are never modified.
+ */
+struct string_buf {
+    size_t refs; //!< number of references to the buffer
+    size_t cap; //!< capacity of the buffer in bytes, without terminator
+    size_t len; //!< length of the contents in bytes, only valid if interned
+    size_t hash; //!< hash of the contents, only valid if interned
+    bool interned; //!< flag indicating whether the buffer is interned
+    char data[]; //!< the contents, zero terminated
+};
+
+/**
+ * Table of interned buffers
+ *
+ * Open addressing with linear probing. The table holds one reference on each
+ * buffer, hence interned buffers live until the table is cleaned up.
+ */
+static struct {
+    pthread_mutex_t lock; //!< lock protecting the table
+    struct string_buf** slots; //!< slots, NULL if free
+    size_t size; //!< number of slots, power of two
+    size_t used; //!< number of occupied slots
+} intern_table = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .slots = NULL,
+    .size = 0,
+    .used = 0,
+};
 
 /*
  *
@@ -48,6 +100,199 @@ deinit_callback(
     struct ws_object* const
 );
 
+static size_t
+hash_callback(
+    struct ws_object* const
+);
+
+/**
+ * Get the buffer holding some string contents
+ *
+ * @return the buffer `str` is the data of
+ */
+static struct string_buf*
+buf_of(
+    char* str //!< contents of a string
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Allocate a new buffer
+ *
+ * The buffer is empty, but may hold `cap` bytes plus the terminator.
+ *
+ * @return the data of the new buffer or NULL on failure
+ */
+static char*
+buf_new(
+    size_t cap //!< capacity of the new buffer in bytes
+);
+
+/**
+ * Get a reference on a buffer
+ *
+ * @return the data passed
+ */
+static char*
+buf_getref(
+    char* str //!< data of the buffer to reference
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Drop a reference on a buffer, free the buffer if it was the last one
+ */
+static void
+buf_unref(
+    char* str //!< data of the buffer to unreference
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Get the buffer a string's contents live in
+ *
+ * @return the data of the buffer or NULL, if the contents are stored inline
+ */
+static char*
+string_buf_data(
+    struct ws_string* self //!< the string
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Replace the contents of a string
+ *
+ * The new contents are either given as the data of a buffer, of which the
+ * string takes over the reference, or as bytes to be copied to the inline
+ * storage.
+ */
+static void
+string_assign(
+    struct ws_string* self, //!< the string to modify
+    char* buf, //!< data of a buffer holding the new contents or NULL
+    char const* inline_str, //!< the new contents, if `buf` is NULL
+    size_t len, //!< length of the new contents in bytes
+    size_t chars, //!< length of the new contents in characters
+    size_t hash //!< hash of the new contents
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Make a string's contents writable, with room for at least `len` bytes
+ *
+ * If the buffer is shared or interned, the string gets a private copy of the
+ * contents. The capacity grows geometrically, so appending is amortized O(1).
+ *
+ * @warning the caller has to hold a write lock on the string
+ *
+ * @return 0 on success, a negative error code otherwise
+ */
+static int
+string_reserve(
+    struct ws_string* self, //!< the string to modify
+    size_t len //!< length the contents must be able to hold
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Compute a hash over some contents
+ *
+ * The hash may be computed incrementally, by passing the hash of a prefix.
+ *
+ * @return hash value
+ */
+static size_t
+hash_contents(
+    size_t hash, //!< hash of the preceding contents, `HASH_INIT` if none
+    char const* str, //!< contents to hash
+    size_t len //!< length of the contents
+)
+__ws_nonnull__(2)
+;
+
+/**
+ * Count the characters in some UTF-8 contents, validating them
+ *
+ * @return number of characters or -1 if the contents are no valid UTF-8
+ */
+static ssize_t
+utf8_count(
+    char const* str, //!< contents to count the characters of
+    size_t len //!< length of the contents in bytes
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Get the length in bytes of the first characters of some UTF-8 contents
+ *
+ * @return number of bytes the first `n` characters occupy
+ */
+static size_t
+utf8_span(
+    char const* str, //!< contents, zero terminated
+    size_t len, //!< length of the contents in bytes
+    size_t chars, //!< length of the contents in characters
+    size_t n //!< number of characters
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Compare two byte sequences
+ *
+ * For UTF-8 contents, the result reflects the code point order.
+ *
+ * @return -1, 0 or 1, like `ws_string_cmp()`
+ */
+static int
+compare_bytes(
+    char const* a, //!< first sequence
+    size_t a_len, //!< length of the first sequence
+    char const* b, //!< second sequence
+    size_t b_len //!< length of the second sequence
+);
+
+/**
+ * Look up a buffer with specific contents in the intern table
+ *
+ * @warning the caller has to hold the intern table lock
+ *
+ * @return the slot holding the buffer or the free slot where it belongs
+ */
+static struct string_buf**
+intern_table_find(
+    char const* str, //!< contents to look up
+    size_t len, //!< length of the contents
+    size_t hash //!< hash of the contents
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Grow the intern table
+ *
+ * @warning the caller has to hold the intern table lock
+ *
+ * @return 0 on success, a negative error code otherwise
+ */
+static int
+intern_table_grow(void);
+
+/**
+ * Cleaner callback releasing the intern table
+ */
+static void
+intern_table_cleanup(
+    void* dummy //!< unused
+);
+
 /*
  *
  *
@@ -61,7 +306,7 @@ ws_object_type_id WS_OBJECT_TYPE_ID_STRING = {
     .typestr = "ws_string",
 
     .deinit_callback = deinit_callback,
-    .hash_callback = NULL,
+    .hash_callback = hash_callback,
     .cmp_callback = (int (*) (struct ws_object const*, struct ws_object const*))
                     ws_string_cmp,
     .uuid_callback = NULL,
@@ -70,6 +315,12 @@ ws_object_type_id WS_OBJECT_TYPE_ID_STRING = {
     .function_table = NULL,
 };
 
+/**
+ * Pool for strings allocated via `ws_string_new()`
+ */
+static struct ws_slab_pool string_pool =
+    WS_SLAB_POOL_INIT("ws_string", sizeof(struct ws_string));
+
 bool
 ws_string_init(
     struct ws_string* self
@@ -78,10 +329,12 @@ ws_string_init(
         return false;
     }
 
-    self->str = calloc(1, sizeof(*self->str)); //initialize as empty string
-    if (unlikely(!self->str)) {
-        return false;
-    }
+    //initialize as empty string
+    self->small[0]  = 0;
+    self->str       = self->small;
+    self->len       = 0;
+    self->chars     = 0;
+    self->hash      = HASH_INIT;
 
     ws_object_init(&self->obj);
     self->obj.id = &WS_OBJECT_TYPE_ID_STRING;
@@ -98,23 +351,25 @@ ws_string_set_from_str(
         return false;
     }
 
-    ws_object_lock_write(&self->obj);
-    ws_object_lock_read(&other->obj);
-
-    size_t charcount = u_strlen(other->str);
-
-    UChar* temp = realloc(self->str, (charcount + 1) * sizeof(*self->str));
-    if (unlikely(!temp)) {
-        ws_object_unlock(&other->obj);
-        ws_object_unlock(&self->obj);
-        return false;
+    if (self == other) {
+        return true;
     }
-    self->str = temp;
-
-    u_strcpy(self->str, other->str);
 
+    // grab the other string's contents before we lock ourselves
+    char small[WS_STRING_INLINE_SIZE];
+    ws_object_lock_read(&other->obj);
+    char* buf = string_buf_data(other);
+    if (buf) {
+        buf_getref(buf);
+    } else {
+        memcpy(small, other->small, other->len + 1);
+    }
+    size_t len      = other->len;
+    size_t chars    = other->chars;
+    size_t hash     = other->hash;
     ws_object_unlock(&other->obj);
-    ws_object_unlock(&self->obj);
+
+    string_assign(self, buf, small, len, chars, hash);
 
     return true;
 }
@@ -122,7 +377,7 @@ ws_string_set_from_str(
 struct ws_string*
 ws_string_new(void)
 {
-    struct ws_string* wss = calloc(1, sizeof(*wss));
+    struct ws_string* wss = ws_slab_alloc(&string_pool);
 
     if (likely(wss)) {
         ws_string_init(wss);
@@ -139,7 +394,7 @@ ws_string_len(
     if (likely(self)) {
         size_t len;
         ws_object_lock_read(&self->obj);
-        len = u_strlen(self->str);
+        len = self->chars;
         ws_object_unlock(&self->obj);
         return len;
     }
@@ -147,27 +402,72 @@ ws_string_len(
     return 0;
 }
 
+size_t
+ws_string_bytelen(
+    struct ws_string* self
+){
+    if (likely(self)) {
+        size_t len;
+        ws_object_lock_read(&self->obj);
+        len = self->len;
+        ws_object_unlock(&self->obj);
+        return len;
+    }
+
+    return 0;
+}
+
+size_t
+ws_string_hash(
+    struct ws_string* self
+){
+    if (likely(self)) {
+        size_t hash;
+        ws_object_lock_read(&self->obj);
+        hash = self->hash;
+        ws_object_unlock(&self->obj);
+        return hash;
+    }
+
+    return 0;
+}
+
 struct ws_string*
 ws_string_cat(
     struct ws_string* self,
     struct ws_string* other
 ){
+    // keep the appended contents alive, even if other is self
+    char small[WS_STRING_INLINE_SIZE];
+    ws_object_lock_read(&other->obj);
+    char* buf = string_buf_data(other);
+    char const* app = buf ? buf_getref(buf) :
+                            memcpy(small, other->small, other->len + 1);
+    size_t app_len      = other->len;
+    size_t app_chars    = other->chars;
+    ws_object_unlock(&other->obj);
+
     ws_object_lock_write(&self->obj);
-    ws_object_lock_read(&other->obj); //!< @todo Thread-safeness!
 
-    size_t new_len = u_strlen(self->str) + u_strlen(other->str) + 1;
-    UChar* temp = realloc(self->str, new_len * sizeof(*self->str));
-    if (unlikely(!temp)) {
-        ws_object_unlock(&other->obj);
+    size_t len = self->len + app_len;
+    if (unlikely(string_reserve(self, len) < 0)) {
         ws_object_unlock(&self->obj);
+        if (buf) {
+            buf_unref(buf);
+        }
         return NULL;
     }
-    self->str = temp;
 
-    u_strcat(self->str, other->str);
+    memcpy(self->str + self->len, app, app_len);
+    self->str[len] = 0;
+    self->len = len;
+    self->chars += app_chars;
+    self->hash = hash_contents(self->hash, app, app_len);
 
-    ws_object_unlock(&other->obj);
     ws_object_unlock(&self->obj);
+    if (buf) {
+        buf_unref(buf);
+    }
 
     return self;
 }
@@ -192,7 +492,8 @@ ws_string_cmp(
     ws_object_lock_read(&self->obj);
     ws_object_lock_read(&other->obj); //!< @todo Thread-safeness!
 
-    int res = u_strcmp(self->str, other->str);
+    int res = (self->str == other->str) ? 0 :
+              compare_bytes(self->str, self->len, other->str, other->len);
 
     ws_object_unlock(&other->obj);
     ws_object_unlock(&self->obj);
@@ -200,6 +501,126 @@ ws_string_cmp(
     return res;
 }
 
+bool
+ws_string_equal(
+    struct ws_string* self,
+    struct ws_string* other
+){
+    ws_object_lock_read(&self->obj);
+    ws_object_lock_read(&other->obj); //!< @todo Thread-safeness!
+
+    char* self_buf = string_buf_data(self);
+    char* other_buf = string_buf_data(other);
+
+    bool res;
+    if (self->str == other->str) {
+        res = true;
+    } else if ((self->len != other->len) || (self->hash != other->hash)) {
+        res = false;
+    } else if (self_buf && other_buf && buf_of(self_buf)->interned &&
+               buf_of(other_buf)->interned) {
+        // interned contents exist exactly once
+        res = false;
+    } else {
+        res = !memcmp(self->str, other->str, self->len);
+    }
+
+    ws_object_unlock(&other->obj);
+    ws_object_unlock(&self->obj);
+
+    return res;
+}
+
+struct ws_string*
+ws_string_intern(
+    struct ws_string* self
+){
+    if (unlikely(!self)) {
+        return NULL;
+    }
+
+    struct ws_string* canon = ws_string_new();
+    if (unlikely(!canon)) {
+        return NULL;
+    }
+
+    // interned strings are immutable, hence they don't need to be locked
+    canon->obj.settings |= WS_OBJ_CONST;
+
+    ws_object_lock_read(&self->obj);
+
+    char* data = string_buf_data(self);
+    if (data && buf_of(data)->interned) {
+        // self already holds the canonical buffer
+        data = buf_getref(data);
+        goto assign;
+    }
+
+    pthread_mutex_lock(&intern_table.lock);
+
+    // keep the load factor at or below 1/2
+    if ((intern_table.used + 1) * 2 > intern_table.size) {
+        if (unlikely(intern_table_grow() < 0)) {
+            goto cleanup;
+        }
+    }
+
+    struct string_buf** slot = intern_table_find(self->str, self->len,
+                                                 self->hash);
+    if (*slot) {
+        // contents are already interned, share the canonical buffer
+        data = buf_getref((*slot)->data);
+        pthread_mutex_unlock(&intern_table.lock);
+        goto assign;
+    }
+
+    // the canonical buffer is a copy of its own, so self stays mutable
+    data = buf_new(self->len);
+    if (unlikely(!data)) {
+        goto cleanup;
+    }
+    memcpy(data, self->str, self->len + 1);
+
+    // the table holds a reference on the canonical buffer
+    struct string_buf* buf = buf_of(data);
+    buf->len = self->len;
+    buf->hash = self->hash;
+    __atomic_store_n(&buf->interned, true, __ATOMIC_RELEASE);
+    *slot = buf;
+    buf_getref(buf->data);
+    ++intern_table.used;
+
+    pthread_mutex_unlock(&intern_table.lock);
+
+assign:
+    string_assign(canon, data, NULL, self->len, self->chars, self->hash);
+    ws_object_unlock(&self->obj);
+    return canon;
+
+cleanup:
+    pthread_mutex_unlock(&intern_table.lock);
+    ws_object_unlock(&self->obj);
+    ws_object_unref(&canon->obj);
+    return NULL;
+}
+
+bool
+ws_string_is_interned(
+    struct ws_string* self
+){
+    if (unlikely(!self)) {
+        return false;
+    }
+
+    ws_object_lock_read(&self->obj);
+    char* data = string_buf_data(self);
+    bool res = data && __atomic_load_n(&buf_of(data)->interned,
+                                       __ATOMIC_ACQUIRE);
+    ws_object_unlock(&self->obj);
+
+    return res;
+}
+
 int
 ws_string_ncmp(
     struct ws_string* self,
@@ -210,7 +631,13 @@ ws_string_ncmp(
     ws_object_lock_read(&self->obj);
     ws_object_lock_read(&other->obj); //!< @todo Thread-safeness!
 
-    int res = u_strncmp(self->str + offset, other->str, n);
+    size_t start = utf8_span(self->str, self->len, self->chars, offset);
+    char const* str = self->str + start;
+    size_t len = utf8_span(str, self->len - start,
+                           self->chars - MIN(offset, self->chars), n);
+    size_t other_len = utf8_span(other->str, other->len, other->chars, n);
+
+    int res = compare_bytes(str, len, other->str, other_len);
 
     ws_object_unlock(&self->obj);
     ws_object_unlock(&other->obj);
@@ -226,7 +653,7 @@ ws_string_substr(
     ws_object_lock_read(&self->obj);
     ws_object_lock_read(&other->obj); //!< @todo Thread-safeness!
 
-    UChar* res = u_strstr(self->str, other->str);
+    char* res = strstr(self->str, other->str);
 
     ws_object_unlock(&self->obj);
     ws_object_unlock(&other->obj);
@@ -240,32 +667,33 @@ ws_string_raw(
 ){
     ws_object_lock_read(&self->obj);
 
-    int32_t dest_len;
-    UErrorCode err = U_ZERO_ERROR;
-    size_t charcount = u_strlen(self->str);
-
-    u_strToUTF8(NULL, 0, &dest_len, self->str, charcount, &err);
-    if ((err != U_BUFFER_OVERFLOW_ERROR) && U_FAILURE(err)) {
-        return NULL;
-    }
-
-    char* output = calloc(dest_len + 1, sizeof(*output)); // +1 => Nullbyte
-    if (unlikely(!output)) {
-        return NULL;
+    char* output = NULL;
+    if (self->len) {
+        output = malloc(self->len + 1);
+        if (likely(output)) {
+            memcpy(output, self->str, self->len + 1);
+        }
     }
 
-    err = U_ZERO_ERROR;
-    output = u_strToUTF8(output, charcount, &dest_len, self->str,
-                         charcount, &err);
-
     ws_object_unlock(&self->obj);
 
-    if (U_FAILURE(err) || (dest_len <= 0)) {
-        free(output);
+    return output;
+}
+
+char const*
+ws_string_cstr(
+    struct ws_string* self
+){
+    if (unlikely(!self)) {
         return NULL;
     }
 
-    return output;
+    // the pointer is only ever replaced while the string is modified
+    ws_object_lock_read(&self->obj);
+    char const* str = self->str;
+    ws_object_unlock(&self->obj);
+
+    return str;
 }
 
 int
@@ -273,39 +701,27 @@ ws_string_set_from_raw(
     struct ws_string* self,
     const char* raw
 ){
-    if (unlikely(!self)) {
+    if (unlikely(!self || !raw)) {
         return -EINVAL;
     }
 
-    UErrorCode err = U_ZERO_ERROR;
-
-    // get the length of the buffer to allocate
-    int32_t len;
-    u_strFromUTF8(NULL, 0, &len, raw, -1, &err);
-    if ((err != U_BUFFER_OVERFLOW_ERROR) && U_FAILURE(err)) {
-        return -ENOMEM; //!< @todo is it actually -ENOMEM?
-    }
-
-    // allocate buffer
-    ++len;
-    UChar* conv_raw = calloc(1, sizeof(*conv_raw) * len);
-    if (unlikely(!conv_raw)) {
-        return -ENOMEM;
+    size_t len = strlen(raw);
+    ssize_t chars = utf8_count(raw, len);
+    if (chars < 0) {
+        return -EINVAL;
     }
 
-    // convert string (write into buffer)
-    err = U_ZERO_ERROR;
-    conv_raw = u_strFromUTF8(conv_raw, len, NULL, raw, -1, &err);
-    if (U_FAILURE(err)) {
-        return -ENOMEM; //!< @todo is it actually -ENOMEM?
+    char* buf = NULL;
+    if (len >= WS_STRING_INLINE_SIZE) {
+        buf = buf_new(len);
+        if (unlikely(!buf)) {
+            return -ENOMEM;
+        }
+        memcpy(buf, raw, len + 1);
     }
 
-    ws_object_lock_write(&self->obj);
-
-    free(self->str);
-    self->str = conv_raw;
-
-    ws_object_unlock(&self->obj);
+    size_t hash = hash_contents(HASH_INIT, raw, len);
+    string_assign(self, buf, raw, len, chars, hash);
 
     return 0;
 }
@@ -320,8 +736,300 @@ deinit_callback(
     struct ws_object* const self
 ) {
     if (likely(self)) {
-        free(((struct ws_string*) self)->str);
+        char* buf = string_buf_data((struct ws_string*) self);
+        if (buf) {
+            buf_unref(buf);
+        }
         return true;
     }
     return false;
 }
+
+static size_t
+hash_callback(
+    struct ws_object* const self
+) {
+    // called with the read lock held
+    return ((struct ws_string*) self)->hash;
+}
+
+static struct string_buf*
+buf_of(
+    char* str
+) {
+    return (struct string_buf*) (str - offsetof(struct string_buf, data));
+}
+
+static char*
+buf_new(
+    size_t cap
+) {
+    struct string_buf* buf = malloc(sizeof(*buf) + cap + 1);
+    if (unlikely(!buf)) {
+        return NULL;
+    }
+
+    buf->refs = 1;
+    buf->cap = cap;
+    buf->len = 0;
+    buf->hash = 0;
+    buf->interned = false;
+    buf->data[0] = 0;
+
+    return buf->data;
+}
+
+static char*
+buf_getref(
+    char* str
+) {
+    __atomic_add_fetch(&buf_of(str)->refs, 1, __ATOMIC_RELAXED);
+    return str;
+}
+
+static void
+buf_unref(
+    char* str
+) {
+    struct string_buf* buf = buf_of(str);
+    if (__atomic_sub_fetch(&buf->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        free(buf);
+    }
+}
+
+static char*
+string_buf_data(
+    struct ws_string* self
+) {
+    return (self->str == self->small) ? NULL : self->str;
+}
+
+static void
+string_assign(
+    struct ws_string* self,
+    char* buf,
+    char const* inline_str,
+    size_t len,
+    size_t chars,
+    size_t hash
+) {
+    ws_object_lock_write(&self->obj);
+
+    char* old = string_buf_data(self);
+    if (buf) {
+        self->str = buf;
+    } else {
+        // the new contents may be our own ones
+        memmove(self->small, inline_str, len + 1);
+        self->str = self->small;
+    }
+    self->len   = len;
+    self->chars = chars;
+    self->hash  = hash;
+
+    ws_object_unlock(&self->obj);
+
+    if (old) {
+        buf_unref(old);
+    }
+}
+
+static int
+string_reserve(
+    struct ws_string* self,
+    size_t len
+) {
+    char* data = string_buf_data(self);
+    if (!data) {
+        if (len < WS_STRING_INLINE_SIZE) {
+            return 0;
+        }
+    } else {
+        struct string_buf* buf = buf_of(data);
+        if (!__atomic_load_n(&buf->interned, __ATOMIC_ACQUIRE) &&
+                __atomic_load_n(&buf->refs, __ATOMIC_ACQUIRE) == 1) {
+            // nobody else can see the buffer, we may modify it in place
+            if (len <= buf->cap) {
+                return 0;
+            }
+
+            size_t cap = MAX(len, buf->cap * 2);
+            buf = realloc(buf, sizeof(*buf) + cap + 1);
+            if (unlikely(!buf)) {
+                return -ENOMEM;
+            }
+            buf->cap = cap;
+            self->str = buf->data;
+            return 0;
+        }
+    }
+
+    // the contents are inline or shared, copy them to a buffer of our own
+    char* str = buf_new(MAX(len, self->len * 2));
+    if (unlikely(!str)) {
+        return -ENOMEM;
+    }
+
+    memcpy(str, self->str, self->len + 1);
+    if (data) {
+        buf_unref(data);
+    }
+    self->str = str;
+
+    return 0;
+}
+
+static size_t
+hash_contents(
+    size_t hash,
+    char const* str,
+    size_t len
+) {
+    // FNV-1a over the bytes
+    while (len--) {
+        hash ^= (unsigned char) *str++;
+        hash *= (size_t) 1099511628211ULL;
+    }
+    return hash;
+}
+
+static ssize_t
+utf8_count(
+    char const* str,
+    size_t len
+) {
+    ssize_t chars = 0;
+    int32_t pos = 0;
+
+    // contents of a string are small enough to be indexed by ICU's macros
+    while ((size_t) pos < len) {
+        if ((unsigned char) str[pos] < 0x80) {
+            ++pos;
+        } else {
+            UChar32 c;
+            U8_NEXT(str, pos, (int32_t) len, c);
+            if (c < 0) {
+                return -1;
+            }
+        }
+        ++chars;
+    }
+
+    return chars;
+}
+
+static size_t
+utf8_span(
+    char const* str,
+    size_t len,
+    size_t chars,
+    size_t n
+) {
+    if (n >= chars) {
+        return len;
+    }
+
+    if (chars == len) {
+        // plain ASCII
+        return n;
+    }
+
+    size_t pos = 0;
+    while (n--) {
+        // skip the lead byte and all continuation bytes
+        do {
+            ++pos;
+        } while ((pos < len) && (((unsigned char) str[pos] & 0xC0) == 0x80));
+    }
+    return pos;
+}
+
+static int
+compare_bytes(
+    char const* a,
+    size_t a_len,
+    char const* b,
+    size_t b_len
+) {
+    int res = memcmp(a, b, MIN(a_len, b_len));
+    if (!res) {
+        return (a_len > b_len) - (a_len < b_len);
+    }
+    return (res > 0) - (res < 0);
+}
+
+static struct string_buf**
+intern_table_find(
+    char const* str,
+    size_t len,
+    size_t hash
+) {
+    size_t mask = intern_table.size - 1;
+    size_t pos = hash & mask;
+
+    while (1) {
+        struct string_buf** slot = intern_table.slots + pos;
+        struct string_buf* cur = *slot;
+        if (!cur || ((cur->hash == hash) && (cur->len == len) &&
+                     !memcmp(cur->data, str, len))) {
+            return slot;
+        }
+        pos = (pos + 1) & mask;
+    }
+}
+
+static int
+intern_table_grow(void)
+{
+    size_t size = intern_table.size ? intern_table.size * 2 :
+                                      INTERN_TABLE_INITIAL_SIZE;
+    struct string_buf** slots = calloc(size, sizeof(*slots));
+    if (unlikely(!slots)) {
+        return -ENOMEM;
+    }
+
+    if (!intern_table.slots) {
+        // first use of the table
+        ws_cleaner_add(intern_table_cleanup, &intern_table);
+    }
+
+    struct string_buf** old = intern_table.slots;
+    size_t old_size = intern_table.size;
+
+    intern_table.slots = slots;
+    intern_table.size = size;
+
+    // re-insert the buffers
+    size_t i;
+    for (i = 0; i < old_size; ++i) {
+        struct string_buf* buf = old[i];
+        if (buf) {
+            *intern_table_find(buf->data, buf->len, buf->hash) = buf;
+        }
+    }
+
+    free(old);
+    return 0;
+}
+
+static void
+intern_table_cleanup(
+    void* dummy
+) {
+    pthread_mutex_lock(&intern_table.lock);
+
+    size_t i;
+    for (i = 0; i < intern_table.size; ++i) {
+        struct string_buf* buf = intern_table.slots[i];
+        if (buf) {
+            buf_unref(buf->data);
+        }
+    }
+
+    free(intern_table.slots);
+    intern_table.slots = NULL;
+    intern_table.size = 0;
+    intern_table.used = 0;
+
+    pthread_mutex_unlock(&intern_table.lock);
+}
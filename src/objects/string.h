@@ -41,18 +41,35 @@
 #define __WS_OBJECTS_STRING_H__
 
 #include <stdbool.h>
-#include <unicode/ustring.h>
+#include <stddef.h>
 
 #include "objects/object.h"
 
+/**
+ * Size of the inline storage of a ws_string, including the terminator
+ */
+#define WS_STRING_INLINE_SIZE (24)
+
 /**
  * ws_string type definition
  *
+ * Strings hold UTF-8 encoded contents. Short contents are stored inline.
+ * Longer contents live in a reference counted buffer which may be shared
+ * between several strings. Copying a string only copies a reference, the
+ * contents are copied lazily when one of the strings is modified.
+ *
+ * The length in bytes and in characters as well as the hash of the contents
+ * are maintained alongside the contents, so querying them is cheap.
+ *
  * @extends ws_object
 */
 struct ws_string {
     struct ws_object obj; //!< @protected Base class.
-    UChar* str; //!< @protected UChar array containing the actual string
+    char* str; //!< @private zero-terminated contents, `small` or a buffer
+    size_t len; //!< @private length of the contents in bytes
+    size_t chars; //!< @private length of the contents in characters
+    size_t hash; //!< @private hash of the contents
+    char small[WS_STRING_INLINE_SIZE]; //!< @private inline storage
 };
 
 /**
@@ -102,6 +119,8 @@ ws_string_new(void);
  *
  * @memberof ws_string
  *
+ * A character is a Unicode code point.
+ *
  * @return length of ws_string, 0 on NULL passed
  */
 size_t
@@ -109,6 +128,30 @@ ws_string_len(
     struct ws_string* self
 );
 
+/**
+ * Get length of a ws_string in bytes
+ *
+ * @memberof ws_string
+ *
+ * @return length of the UTF-8 contents, without terminator, 0 on NULL passed
+ */
+size_t
+ws_string_bytelen(
+    struct ws_string* self
+);
+
+/**
+ * Get the hash of a ws_string's contents
+ *
+ * @memberof ws_string
+ *
+ * @return hash of the contents, 0 on NULL passed
+ */
+size_t
+ws_string_hash(
+    struct ws_string* self
+);
+
 /**
  * Concatenate two ws_strings
  *
@@ -150,11 +193,57 @@ ws_string_cmp(
     struct ws_string* other
 );
 
+/**
+ * Check whether the contents of two ws_strings are equal
+ *
+ * @memberof ws_string
+ *
+ * If both strings are interned, this is a pointer comparison.
+ *
+ * @return true if the contents of both strings are equal, false otherwise
+ */
+bool
+ws_string_equal(
+    struct ws_string* self,
+    struct ws_string* other
+);
+
+/**
+ * Get the interned string with the contents of a ws_string
+ *
+ * @memberof ws_string
+ *
+ * The string returned shares its contents with all other interned strings with
+ * equal contents. It is immutable (`WS_OBJ_CONST`), hence it is never locked.
+ * `self` itself is not modified. Interned contents are kept alive until the
+ * program exits.
+ *
+ * @return a new reference on an interned string or NULL on failure
+ */
+struct ws_string*
+ws_string_intern(
+    struct ws_string* self
+);
+
+/**
+ * Check whether a ws_string is interned
+ *
+ * @memberof ws_string
+ *
+ * @return true if the string is interned, false otherwise
+ */
+bool
+ws_string_is_interned(
+    struct ws_string* self
+);
+
 /**
  * Compare if a substring of a ws_string and another ws_string are equal
  *
  * @memberof ws_string
  *
+ * Both `offset` and `n` are given in characters.
+ *
  * @return 0 if the contents of self's substring and other are equal,
  * -1 if the first character that does not match has a lower value in self than
  * in other, 1 if the first character that does not match has a greater value in
@@ -190,19 +279,38 @@ ws_string_substr(
  *
  * @warning Returned string is _newly allocated_
  *
- * @return Returns the ws_string as an UTF-8 string, NULL on failure
+ * @note Use `ws_string_cstr()` if no copy is required
+ *
+ * @return Returns the ws_string as an UTF-8 string, NULL on failure or if the
+ * string is empty
  */
 char*
 ws_string_raw(
     struct ws_string* self
 );
 
+/**
+ * Get the contents of a ws_string without copying them
+ *
+ * @memberof ws_string
+ *
+ * @warning The returned contents are borrowed from the string. They are only
+ * valid as long as the string is neither modified nor destroyed.
+ *
+ * @return the zero-terminated UTF-8 contents, NULL on NULL passed
+ */
+char const*
+ws_string_cstr(
+    struct ws_string* self
+);
+
 /**
  * Set the string contained in a ws_string object to the passed UTF8 string
  *
  * @memberof ws_string
  *
- * @return 0 on success, else negative errno number
+ * @return 0 on success, -EINVAL if raw is no valid UTF-8, else negative errno
+ * number
  */
 int
 ws_string_set_from_raw(
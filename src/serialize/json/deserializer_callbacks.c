@@ -40,11 +40,13 @@
 #include "serialize/json/deserializer_callbacks.h"
 #include "serialize/json/keys.h"
 #include "serialize/json/states.h"
+#include "util/slab.h"
 #include "util/string.h"
 #include "values/bool.h"
 #include "values/int.h"
 #include "values/nil.h"
 #include "values/string.h"
+#include "values/union.h"
 #include "wayland-util.h"
 
 /**
@@ -58,6 +60,7 @@ static const struct {
     { .current = STATE_MSG, .next = STATE_UID,      .str = UID          },
     { .current = STATE_MSG, .next = STATE_TYPE,     .str = TYPE         },
     { .current = STATE_MSG, .next = STATE_COMMANDS, .str = COMMANDS     },
+    { .current = STATE_MSG, .next = STATE_BATCH,    .str = BATCH        },
     { .current = STATE_MSG, .next = STATE_FLAGS,    .str = FLAGS        },
     {
         .current = STATE_FLAGS_MAP,
@@ -159,7 +162,8 @@ yajl_null_cb(
             ws_log(&log_ctx, LOG_DEBUG,
                    "Appending as Command argument (directly)");
 
-            struct ws_value_nil* nil = calloc(1, sizeof(*nil));
+            struct ws_value_nil* nil;
+            nil = (struct ws_value_nil*) ws_value_union_alloc();
             if (!nil) {
                 state->error.parser_error = false;
                 state->error.error_num = -ENOMEM;
@@ -225,7 +229,8 @@ yajl_boolean_cb(
         {
             ws_log(&log_ctx, LOG_DEBUG,
                    "Appending as Command argument (directly)");
-            struct ws_value_bool* boo = calloc(1, sizeof(*boo));
+            struct ws_value_bool* boo;
+            boo = (struct ws_value_bool*) ws_value_union_alloc();
             if (!boo) {
                 state->error.parser_error = false;
                 state->error.error_num = -ENOMEM;
@@ -312,7 +317,8 @@ yajl_integer_cb(
     case STATE_COMMAND_ARY_COMMAND_ARGS:
         {
             ws_log(&log_ctx, LOG_DEBUG, "Using as direct argument");
-            struct ws_value_int* _i = calloc(1, sizeof(_i));
+            struct ws_value_int* _i;
+            _i = (struct ws_value_int*) ws_value_union_alloc();
             if (!_i) {
                 state->error.parser_error = false;
                 state->error.error_num = -ENOMEM;
@@ -411,10 +417,12 @@ yajl_string_cb(
 
     case STATE_COMMAND_ARY_COMMAND_ARGS:
         {
-            struct ws_value_string* s = ws_value_string_new();
+            struct ws_value_string* s;
+            s = (struct ws_value_string*) ws_value_union_alloc();
             if (!s) {
                 return 0;
             }
+            ws_value_string_init(s);
             struct ws_string* sstr = ws_value_string_get(s);
 
             int res = buff_to_string("Using as argument (%s)", sstr, str, len);
@@ -422,7 +430,7 @@ yajl_string_cb(
                 ws_log(&log_ctx, LOG_DEBUG, "Cannot deserialize string");
 
                 ws_object_unref(&sstr->obj);
-                free(s);
+                ws_slab_release(s);
 
                 return res;
             }
@@ -682,6 +690,7 @@ yajl_end_map_cb(
 
         struct ws_transaction* t = (struct ws_transaction*) d->buffer;
         ws_transaction_push_statement(t, state->tmp_statement);
+        free(state->tmp_statement);
         state->tmp_statement = NULL;
 
         state->current_state = STATE_COMMAND_ARY;
@@ -744,6 +753,28 @@ yajl_start_array_cb(
         state->current_state = STATE_COMMAND_ARY;
         break;
 
+    case STATE_BATCH:
+        ws_log(&log_ctx, LOG_DEBUG, "Start batch");
+        setup_transaction(d);
+        state->in_batch = true;
+        state->current_state = STATE_BATCH_ARY;
+        break;
+
+    case STATE_BATCH_ARY:
+        {
+            // every part of the batch is a command array of its own
+            ws_log(&log_ctx, LOG_DEBUG, "Start command array of batch part");
+            struct ws_transaction* t = (struct ws_transaction*) d->buffer;
+            int res = ws_transaction_start_part(t);
+            if (res != 0) {
+                state->error.parser_error = false;
+                state->error.error_num = res;
+                return 0;
+            }
+            state->current_state = STATE_COMMAND_ARY;
+        }
+        break;
+
     case STATE_COMMAND_ARY_COMMAND_NAME:
         ws_log(&log_ctx, LOG_DEBUG, "Start command arguments");
         // We are in the command name state and the next thing is an array, so
@@ -777,7 +808,14 @@ yajl_end_array_cb(
 
     case STATE_COMMAND_ARY:
         ws_log(&log_ctx, LOG_DEBUG, "Finish command array");
-        // We are ready with the command array parsing now.
+        // We are ready with the command array parsing now. If it was a part of
+        // a batch, there may be more parts to come.
+        state->current_state = state->in_batch ? STATE_BATCH_ARY : STATE_MSG;
+        break;
+
+    case STATE_BATCH_ARY:
+        ws_log(&log_ctx, LOG_DEBUG, "Finish batch");
+        state->in_batch = false;
         state->current_state = STATE_MSG;
         break;
 
@@ -848,7 +886,7 @@ finalize_message(
 
             ws_transaction_set_flags(t, state->flags);
 
-            // gets a ref on name
+            // takes a copy of the name
             ws_transaction_set_name(t, state->register_name);
             ws_object_unref((struct ws_object*) state->register_name);
 
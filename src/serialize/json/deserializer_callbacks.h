@@ -76,6 +76,7 @@ struct deserializer_state {
     struct ws_string* register_name; //!< @public name cache
 
     struct ws_statement* tmp_statement;
+    bool in_batch; //!< @protected whether we are parsing a batch
 
     uintmax_t nboxbrackets;
     uintmax_t ncurvedbrackets;
@@ -48,6 +48,7 @@
 #define __WS_SERIALIZE_JSON_KEYS_H__
 
 #define COMMANDS    "CMDS"
+#define BATCH       "BATCH"
 #define UID         "UID"
 #define TYPE        "TYPE"
 #define FLAGS       "FLAGS"
@@ -55,6 +55,9 @@
 #include "util/arithmetical.h"
 #include "util/condition.h"
 #include "values/object_id.h"
+#include "values/ordered_set.h"
+#include "values/table.h"
+#include "values/union.h"
 #include "values/value.h"
 
 static struct ws_logger_context log_ctx = {
@@ -167,6 +170,7 @@ ws_serializer_json_serializer_new(void)
     ser->buffer     = NULL;
     ser->serialize  = serialize;
     ser->deinit     = NULL;
+    ser->format     = "json";
 
     return ser;
 }
@@ -258,6 +262,9 @@ serialize(
         }
     }
 
+    // everything is in the yajl buffer now, only copy it out from now on
+    ctx->current_state = STATE_READY;
+
 write_buffer:
     // put the serilized stuff into the buffer
     if (ctx->yajl_buffer == NULL) {
@@ -274,6 +281,13 @@ write_buffer:
         // as the buffer we just wrote to
         ws_object_unref(&self->buffer->obj);
         self->buffer = NULL; // "I am ready here!"
+
+        // reset the generator, so we can serialize the next message
+        yajl_gen_clear(ctx->yajlgen);
+        yajl_gen_reset(ctx->yajlgen, NULL);
+        ctx->yajl_buffer        = NULL;
+        ctx->yajl_buffer_size   = 0;
+        ctx->current_state      = STATE_NO_STATE;
     } else {
         // We must wait until we get a buffer where we can write the rest
         // to.
@@ -400,10 +414,11 @@ serialize_event(
     //  '{ "event" : { <context:map>, "name": '
     // in the buffer by now
     {
-        char* plain = ws_string_raw(&ev->name);
-        size_t len = ws_string_len(&ev->name);
+        char const* plain = ws_string_cstr(&ev->name);
+        size_t len = ws_string_bytelen(&ev->name);
 
-        stat = yajl_gen_string(ctx->yajlgen, (unsigned char*) plain, len);
+        stat = yajl_gen_string(ctx->yajlgen, (unsigned char const*) plain,
+                               len);
         if (stat != yajl_gen_status_ok) {
             ws_log(&log_ctx, LOG_DEBUG, "Error serializing event name");
             return -EIO;
@@ -453,11 +468,10 @@ serialize_value(
             struct ws_string* str;
             str = ws_value_string_get((struct ws_value_string*) val);
 
-            char* buf = ws_string_raw(str); // buf is a copy
+            stat = yajl_gen_string(ctx->yajlgen,
+                                   (unsigned char const*) ws_string_cstr(str),
+                                   ws_string_bytelen(str));
             ws_object_unref((struct ws_object*) str);
-
-            stat = yajl_gen_string(ctx->yajlgen, (unsigned char*) buf,
-                                   strlen(buf));
         }
         break;
 
@@ -509,6 +523,68 @@ serialize_value(
                 stat = yajl_gen_array_close(ctx->yajlgen);
                 break;
 
+            case WS_VALUE_TYPE_ORDERED_SET:
+                stat = yajl_gen_array_open(ctx->yajlgen);
+                if (stat != yajl_gen_status_ok) {
+                    ws_log(&log_ctx, LOG_DEBUG, "Error opening array");
+                    return -EIO;
+                }
+
+                {
+                    // elements are serialized in order
+                    struct ws_value_ordered_set* set;
+                    set = (struct ws_value_ordered_set*) val;
+                    int r = ws_value_ordered_set_select(set,
+                                                (ws_ordered_set_procf)
+                                                serialize_object_to_id_string,
+                                                ctx);
+
+                    if (unlikely(r < 0)) {
+                        ws_log(&log_ctx, LOG_DEBUG,
+                               "Error serializing ordered set");
+                        return -EIO;
+                    }
+                }
+
+                stat = yajl_gen_array_close(ctx->yajlgen);
+                break;
+
+            case WS_VALUE_TYPE_TABLE:
+                {
+                    // an array of rows, each being an array of cells
+                    struct ws_value_table* table;
+                    table = (struct ws_value_table*) val;
+                    size_t rows = ws_value_table_rows(table);
+                    size_t cols = ws_value_table_cols(table);
+
+                    stat = yajl_gen_array_open(ctx->yajlgen);
+                    size_t row;
+                    for (row = 0; row < rows; ++row) {
+                        if (stat != yajl_gen_status_ok) {
+                            break;
+                        }
+                        stat = yajl_gen_array_open(ctx->yajlgen);
+
+                        size_t col;
+                        for (col = 0; col < cols; ++col) {
+                            union ws_value_union* cell;
+                            cell = ws_value_table_cell(table, row, col);
+                            if (serialize_value(ctx, &cell->value) != 0) {
+                                return -EIO;
+                            }
+                        }
+
+                        if (stat == yajl_gen_status_ok) {
+                            stat = yajl_gen_array_close(ctx->yajlgen);
+                        }
+                    }
+
+                    if (stat == yajl_gen_status_ok) {
+                        stat = yajl_gen_array_close(ctx->yajlgen);
+                    }
+                }
+                break;
+
             default:
                 {
                     const char* ty = ws_value_type_get_name(val);
@@ -51,6 +51,8 @@ enum json_backend_state {
     STATE_MSG, //!< "We are parsing the JSON object"
     STATE_UID, //!< "We parsed the "UID" key"
     STATE_COMMANDS, //!< We parsed the "commands" key
+    STATE_BATCH, //!< We parsed the "batch" key
+    STATE_BATCH_ARY, //!< We are parsing the array of batch parts
     STATE_TYPE, //!< We parsed the "type" key
     STATE_FLAGS, //!< We parsed the "flags" key
 
@@ -0,0 +1,151 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <stdlib.h>
+
+#include "objects/message/message.h"
+#include "serialize/serialized.h"
+#include "serialize/serializer.h"
+
+/**
+ * Initial size of the buffer for a serialized message
+ */
+#define INITIAL_SIZE 256
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+static bool
+serialized_message_deinit(
+    struct ws_object* self
+);
+
+/*
+ *
+ * Type information
+ *
+ */
+
+ws_object_type_id WS_OBJECT_TYPE_ID_SERIALIZED_MESSAGE = {
+    .supertype  = &WS_OBJECT_TYPE_ID_OBJECT,
+    .typestr    = "ws_serialized_message",
+
+    .hash_callback = NULL,
+    .deinit_callback = serialized_message_deinit,
+    .cmp_callback = NULL,
+    .uuid_callback = NULL,
+
+    .attribute_table = NULL,
+    .function_table = NULL,
+};
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+struct ws_serialized_message*
+ws_serialized_message_new(
+    struct ws_serializer* serializer,
+    struct ws_message* msg
+) {
+    if (serializer->buffer) {
+        return NULL;
+    }
+
+    struct ws_serialized_message* self = calloc(1, sizeof(*self));
+    if (!self) {
+        return NULL;
+    }
+
+    if (!ws_object_init(&self->obj)) {
+        goto cleanup_mem;
+    }
+    self->obj.id = &WS_OBJECT_TYPE_ID_SERIALIZED_MESSAGE;
+    self->obj.settings |= WS_OBJECT_HEAPALLOCED;
+
+    size_t size = INITIAL_SIZE;
+    self->data = malloc(size);
+    if (!self->data) {
+        goto cleanup_mem;
+    }
+
+    // serialize, growing the buffer until the message fits
+    ssize_t res = ws_serialize(serializer, self->data, size, msg);
+    while (res >= 0) {
+        self->len += res;
+        if (!serializer->buffer) {
+            return self;
+        }
+
+        // the message didn't fit
+        size *= 2;
+        char* tmp = realloc(self->data, size);
+        if (!tmp) {
+            break;
+        }
+        self->data = tmp;
+
+        res = ws_serialize(serializer, self->data + self->len,
+                           size - self->len, NULL);
+    }
+
+    // we must not leave the message in the serializer
+    if (serializer->buffer) {
+        ws_object_unref(&serializer->buffer->obj);
+        serializer->buffer = NULL;
+    }
+
+    ws_object_unref(&self->obj);
+    return NULL;
+
+cleanup_mem:
+    free(self);
+    return NULL;
+}
+
+/*
+ *
+ * static function implementations
+ *
+ */
+
+static bool
+serialized_message_deinit(
+    struct ws_object* self
+) {
+    struct ws_serialized_message* msg = (struct ws_serialized_message*) self;
+    free(msg->data);
+    msg->data = NULL;
+    msg->len = 0;
+    return true;
+}
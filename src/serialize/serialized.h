@@ -0,0 +1,100 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @addtogroup serializer "Serializer"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup serializer_serialized "Serializer: Serialized message"
+ *
+ * A message which was serialized in advance
+ *
+ * A serialized message holds the bytes a serializer generated for a message.
+ * It is meant for sending one and the same message to many connections: the
+ * message is serialized only once and the (refcounted) bytes are shared by all
+ * the connections it is queued on.
+ *
+ * @{
+ */
+
+#ifndef __WS_SERIALIZE_SERIALIZED_H__
+#define __WS_SERIALIZE_SERIALIZED_H__
+
+#include <stddef.h>
+
+#include "objects/object.h"
+#include "util/attributes.h"
+
+// forward declarations
+struct ws_message;
+struct ws_serializer;
+
+/**
+ * Serialized message
+ *
+ * @extends ws_object
+ */
+struct ws_serialized_message {
+    struct ws_object obj; //!< @protected Base class
+    char* data; //!< @public serialized bytes, not zero terminated
+    size_t len; //!< @public number of bytes
+};
+
+/**
+ * Variable which holds type information about the ws_serialized_message type
+ */
+extern ws_object_type_id WS_OBJECT_TYPE_ID_SERIALIZED_MESSAGE;
+
+/**
+ * Serialize a message into a new serialized message
+ *
+ * @memberof ws_serialized_message
+ *
+ * @warning the serializer must not hold a pending message
+ *
+ * @return a new serialized message or `NULL` on failure
+ */
+struct ws_serialized_message*
+ws_serialized_message_new(
+    struct ws_serializer* serializer, //!< serializer to use
+    struct ws_message* msg //!< message to serialize
+)
+__ws_nonnull__(1, 2)
+;
+
+#endif // __WS_SERIALIZE_SERIALIZED_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
@@ -48,7 +48,8 @@ ws_serialize(
 
         // check whether we successfully flushed the message
         if (self->buffer) {
-            return -EAGAIN;
+            // report progress if we were only asked to continue
+            return msg ? -EAGAIN : offset;
         }
 
         // update buf and nbuf
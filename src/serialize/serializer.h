@@ -81,6 +81,7 @@ struct ws_serializer {
     void (*deinit)(void*); //!< deinitialize the internal state
     void* state; //!< internal state of the serializer
     struct ws_message* buffer; //!< storage for an incompletely written message
+    char const* format; //!< name of the format generated, e.g. "json"
 };
 
 /**
@@ -100,7 +101,8 @@ struct ws_serializer {
  *       the message may be serialized successfully later.
  *
  * @note `NULL` may be passed as `msg` to progress serialization of the current
- *       message.
+ *       message. In this case, the number of bytes written is returned even if
+ *       the message isn't fully serialized yet.
  *
  */
 ssize_t
@@ -0,0 +1,161 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "trace/decode.h"
+#include "trace/format.h"
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Compare two records by their timestamp, for qsort()
+ */
+static int
+cmp_records(
+    void const* r1, //!< first record
+    void const* r2 //!< second record
+);
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+int
+ws_trace_to_json(
+    FILE* out,
+    void const* data,
+    size_t len
+) {
+    struct ws_trace_header const* header = data;
+
+    if (len < sizeof(*header) ||
+            memcmp(header->magic, WS_TRACE_MAGIC, sizeof(WS_TRACE_MAGIC)) ||
+            header->version != WS_TRACE_VERSION ||
+            header->record_size != sizeof(struct ws_trace_record) ||
+            !header->capacity ||
+            (header->capacity & (header->capacity - 1)) ||
+            header->capacity > (len - sizeof(*header)) / header->record_size) {
+        return -EINVAL;
+    }
+
+    struct ws_trace_record const* slots;
+    slots = (struct ws_trace_record const*) (header + 1);
+
+    // only the last `capacity` records are still in the ring
+    uint64_t first = 0;
+    if (header->head > header->capacity) {
+        first = header->head - header->capacity;
+    }
+
+    struct ws_trace_record* records;
+    records = calloc(header->head - first + 1, sizeof(*records));
+    if (!records) {
+        return -ENOMEM;
+    }
+
+    size_t num = 0;
+    for (uint64_t index = first; index < header->head; ++index) {
+        struct ws_trace_record const* rec;
+        rec = slots + (index & (header->capacity - 1));
+        if (rec->seq == (uint32_t) (index + 1)) {
+            records[num++] = *rec;
+        }
+    }
+
+    // records of different threads may have been committed out of order
+    qsort(records, num, sizeof(*records), cmp_records);
+
+    fprintf(out, "{\"displayTimeUnit\":\"ns\",\"otherData\":{"
+                 "\"overwritten\":%" PRIu64 ",\"invalid\":%" PRIu64 "},"
+                 "\"traceEvents\":[",
+            first, header->head - first - num);
+
+    for (size_t i = 0; i < num; ++i) {
+        struct ws_trace_record const* rec = records + i;
+
+        fprintf(out, "%s\n{\"name\":\"%s\",\"cat\":\"waysome\",\"ph\":\"%c\","
+                     "\"ts\":%" PRIu64 ".%03u,\"pid\":%" PRId64 ",\"tid\":%u,",
+                i ? "," : "", ws_trace_event_name(rec->event), rec->phase,
+                rec->time / 1000, (unsigned int) (rec->time % 1000),
+                header->pid, (unsigned int) rec->thread);
+
+        switch (rec->phase) {
+        case WS_TRACE_PHASE_INSTANT:
+            fputs("\"s\":\"t\",", out);
+            break;
+
+        case WS_TRACE_PHASE_ASYNC_BEGIN:
+        case WS_TRACE_PHASE_ASYNC_END:
+            fprintf(out, "\"id\":\"0x%" PRIx64 "\",", rec->id);
+            break;
+
+        default:
+            break;
+        }
+
+        fprintf(out, "\"args\":{\"id\":%" PRIu64 ",\"arg\":%" PRIu64 "}}",
+                rec->id, rec->arg);
+    }
+
+    fputs("\n]}\n", out);
+    free(records);
+
+    return ferror(out) ? -EIO : 0;
+}
+
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static int
+cmp_records(
+    void const* r1,
+    void const* r2
+) {
+    struct ws_trace_record const* rec1 = r1;
+    struct ws_trace_record const* rec2 = r2;
+
+    if (rec1->time != rec2->time) {
+        return rec1->time < rec2->time ? -1 : 1;
+    }
+
+    // keep the order of records with the same timestamp
+    return rec1->seq < rec2->seq ? -1 : (rec1->seq > rec2->seq);
+}
@@ -0,0 +1,66 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup trace "Tracing module"
+ *
+ * @{
+ */
+
+#ifndef __WS_TRACE_DECODE_H__
+#define __WS_TRACE_DECODE_H__
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "util/attributes.h"
+
+/**
+ * Convert a trace to the Chrome trace event format
+ *
+ * Records are written ordered by their timestamp. Slots which do not hold a
+ * valid record are skipped, their number is reported in the `otherData` of the
+ * output, along with the number of records overwritten in the ring.
+ *
+ * @return zero on success, -EINVAL if `data` is not a valid trace, else
+ *         negative error code from errno.h
+ */
+int
+ws_trace_to_json(
+    FILE* out, //!< stream to write the JSON to
+    void const* data, //!< contents of a trace file
+    size_t len //!< length of the contents
+)
+__ws_nonnull__(1, 2)
+;
+
+#endif // __WS_TRACE_DECODE_H__
+
+/**
+ * @}
+ */
@@ -0,0 +1,146 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup trace "Tracing module"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup trace_format "Trace file format"
+ *
+ * A trace file consists of a `ws_trace_header` followed by a ring of
+ * `ws_trace_record`s. Records are written in native byte order.
+ *
+ * Record `i` is stored in slot `i % capacity`. A slot only holds a valid
+ * record if its `seq` equals the lower 32 bits of `i + 1`, which allows the
+ * decoder to skip slots which were overwritten or torn, e.g. because the
+ * process died while writing.
+ *
+ * @{
+ */
+
+#ifndef __WS_TRACE_FORMAT_H__
+#define __WS_TRACE_FORMAT_H__
+
+#include <stdint.h>
+
+/**
+ * Magic at the start of a trace file
+ */
+#define WS_TRACE_MAGIC "WSTRACE"
+
+/**
+ * Version of the trace file format
+ */
+#define WS_TRACE_VERSION (1)
+
+/**
+ * Trace events
+ */
+enum ws_trace_event {
+    WS_TRACE_EVENT_INPUT, //!< input event read from a device
+    WS_TRACE_EVENT_HOTKEY, //!< key combination matched
+    WS_TRACE_EVENT_TRANSACTION, //!< transaction run by the action manager
+    WS_TRACE_EVENT_SURFACE_COMMIT, //!< surface commit handled
+    WS_TRACE_EVENT_BLIT, //!< buffer copied into another one
+    WS_TRACE_EVENT_FRAME_DONE, //!< frame callback sent to a client
+    WS_TRACE_EVENT_PAGE_FLIP, //!< scan-out buffer of a CRTC changed
+    WS_TRACE_EVENT_NUM, //!< number of events, not an event itself
+};
+
+/**
+ * Trace event phases
+ *
+ * The phases are the ones of the Chrome trace event format. Begin and end
+ * events must nest per thread, async events are matched via their `id`.
+ */
+enum ws_trace_phase {
+    WS_TRACE_PHASE_BEGIN = 'B', //!< begin of a span
+    WS_TRACE_PHASE_END = 'E', //!< end of a span
+    WS_TRACE_PHASE_INSTANT = 'i', //!< point in time
+    WS_TRACE_PHASE_ASYNC_BEGIN = 'b', //!< begin of an async span
+    WS_TRACE_PHASE_ASYNC_END = 'e', //!< end of an async span
+};
+
+/**
+ * Header of a trace file
+ */
+struct ws_trace_header {
+    char magic[8]; //!< `WS_TRACE_MAGIC`
+    uint32_t version; //!< `WS_TRACE_VERSION`
+    uint32_t record_size; //!< size of a record
+    uint64_t capacity; //!< number of slots, a power of two
+    uint64_t head; //!< index of the next record, accessed atomically
+    int64_t pid; //!< process which wrote the trace
+    uint64_t reserved[3]; //!< pads the header to 64 bytes
+};
+
+/**
+ * Trace record
+ */
+struct ws_trace_record {
+    uint64_t time; //!< CLOCK_MONOTONIC timestamp, in ns
+    uint64_t id; //!< id of the object the event is about
+    uint64_t arg; //!< event specific argument
+    uint32_t seq; //!< lower 32 bits of the index + 1, written last
+    uint16_t thread; //!< index of the thread which wrote the record
+    uint8_t event; //!< the event, see `ws_trace_event`
+    uint8_t phase; //!< the phase, see `ws_trace_phase`
+};
+
+/**
+ * Get the name of an event
+ */
+static inline char const*
+ws_trace_event_name(
+    unsigned int event //!< the event
+) {
+    static char const* const names[] = {
+        [WS_TRACE_EVENT_INPUT] = "input",
+        [WS_TRACE_EVENT_HOTKEY] = "hotkey",
+        [WS_TRACE_EVENT_TRANSACTION] = "transaction",
+        [WS_TRACE_EVENT_SURFACE_COMMIT] = "surface_commit",
+        [WS_TRACE_EVENT_BLIT] = "blit",
+        [WS_TRACE_EVENT_FRAME_DONE] = "frame_done",
+        [WS_TRACE_EVENT_PAGE_FLIP] = "page_flip",
+    };
+
+    return event < WS_TRACE_EVENT_NUM ? names[event] : "unknown";
+}
+
+#endif // __WS_TRACE_FORMAT_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
@@ -0,0 +1,239 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "trace/module.h"
+#include "util/attributes.h"
+#include "util/cleaner.h"
+
+bool ws_trace_enabled = false;
+
+/**
+ * The trace currently written
+ */
+static struct {
+    struct ws_trace_header* header; //!< the mapped file
+    struct ws_trace_record* records; //!< the ring of records
+    size_t len; //!< length of the mapping
+    uint16_t threads; //!< number of threads which traced, accessed atomically
+} trace = {
+    .header = NULL,
+    .records = NULL,
+    .len = 0,
+    .threads = 0,
+};
+
+/**
+ * Index of the current thread in the trace, 0 if not yet assigned
+ */
+static __thread uint16_t thread_index = 0;
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Cleanup function for the tracing module
+ */
+static void
+cleanup_trace(
+    void* etc
+);
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+int
+ws_trace_init(void)
+{
+    static bool is_init = false;
+
+    if (is_init) {
+        return 0;
+    }
+    is_init = true;
+
+    char const* path = getenv("WAYSOME_TRACE");
+    if (!path || !*path) {
+        return 0;
+    }
+
+    size_t records = WS_TRACE_DEFAULT_RECORDS;
+    char const* num = getenv("WAYSOME_TRACE_RECORDS");
+    if (num) {
+        char* end;
+        unsigned long long val = strtoull(num, &end, 10);
+        if (end == num || *end || !val || val > WS_TRACE_MAX_RECORDS) {
+            return -EINVAL;
+        }
+        records = val;
+    }
+
+    int res = ws_trace_open(path, records);
+    if (res < 0) {
+        return res;
+    }
+
+    return ws_cleaner_add(cleanup_trace, NULL);
+}
+
+int
+ws_trace_open(
+    char const* path,
+    size_t records
+) {
+    if (trace.header) {
+        return -EBUSY;
+    }
+
+    // keeps both the rounding and the size of the file from overflowing
+    if (!records || records > WS_TRACE_MAX_RECORDS) {
+        return -EINVAL;
+    }
+
+    size_t capacity = 1;
+    while (capacity < records) {
+        capacity <<= 1;
+    }
+    size_t len = sizeof(*trace.header) + capacity * sizeof(*trace.records);
+
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return -errno;
+    }
+
+    if (ftruncate(fd, len) < 0) {
+        int res = -errno;
+        close(fd);
+        return res;
+    }
+
+    void* map = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    int res = -errno;
+    close(fd);
+    if (map == MAP_FAILED) {
+        return res;
+    }
+
+    // the file is fresh, hence all zero and all slots are invalid
+    struct ws_trace_header* header = map;
+    memcpy(header->magic, WS_TRACE_MAGIC, sizeof(WS_TRACE_MAGIC));
+    header->version = WS_TRACE_VERSION;
+    header->record_size = sizeof(*trace.records);
+    header->capacity = capacity;
+    header->head = 0;
+    header->pid = getpid();
+
+    trace.records = (struct ws_trace_record*) (header + 1);
+    trace.len = len;
+    __atomic_store_n(&trace.header, header, __ATOMIC_RELEASE);
+    __atomic_store_n(&ws_trace_enabled, true, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+void
+ws_trace_close(void)
+{
+    if (!trace.header) {
+        return;
+    }
+
+    __atomic_store_n(&ws_trace_enabled, false, __ATOMIC_RELEASE);
+
+    struct ws_trace_header* header = trace.header;
+    __atomic_store_n(&trace.header, NULL, __ATOMIC_RELEASE);
+
+    msync(header, trace.len, MS_SYNC);
+    munmap(header, trace.len);
+    trace.records = NULL;
+    trace.len = 0;
+}
+
+void
+ws_trace_emit(
+    enum ws_trace_event event,
+    enum ws_trace_phase phase,
+    uint64_t id,
+    uint64_t arg
+) {
+    struct ws_trace_header* header;
+    header = __atomic_load_n(&trace.header, __ATOMIC_ACQUIRE);
+    if (!header) {
+        return;
+    }
+
+    if (!thread_index) {
+        thread_index = __atomic_add_fetch(&trace.threads, 1, __ATOMIC_RELAXED);
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    uint64_t index = __atomic_fetch_add(&header->head, 1, __ATOMIC_RELAXED);
+    struct ws_trace_record* rec = trace.records +
+                                  (index & (header->capacity - 1));
+
+    // invalidate the slot while we are writing it
+    __atomic_store_n(&rec->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    rec->time = (uint64_t) now.tv_sec * 1000000000 + now.tv_nsec;
+    rec->id = id;
+    rec->arg = arg;
+    rec->thread = thread_index;
+    rec->event = event;
+    rec->phase = phase;
+
+    __atomic_store_n(&rec->seq, (uint32_t) (index + 1), __ATOMIC_RELEASE);
+}
+
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static void
+cleanup_trace(
+    void* etc __ws_unused__
+) {
+    ws_trace_close();
+}
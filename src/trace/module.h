@@ -0,0 +1,172 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup trace "Tracing module"
+ *
+ * Structured, binary event tracing for latency analysis
+ *
+ * Tracepoints write fixed-size records with nanosecond timestamps into a ring
+ * in a memory mapped file. Since the file is shared, the trace survives a
+ * crash of the process. Writing a record neither takes a lock nor involves a
+ * system call. The `trace2json` tool converts a trace file to the Chrome trace
+ * event format, which may be viewed via `chrome://tracing` or Perfetto.
+ *
+ * Tracing is enabled by setting `WAYSOME_TRACE` to the path of the trace file,
+ * `WAYSOME_TRACE_RECORDS` optionally sets the number of records kept. While
+ * tracing is disabled, a tracepoint is a single load and a branch which is
+ * predicted not to be taken. With the `TRACING` CMake option turned off,
+ * tracepoints are compiled out.
+ *
+ * @{
+ */
+
+#ifndef __WS_TRACE_MODULE_H__
+#define __WS_TRACE_MODULE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "trace/format.h"
+
+/**
+ * Default number of records kept in a trace file
+ */
+#define WS_TRACE_DEFAULT_RECORDS (1 << 18)
+
+/**
+ * Maximum number of records kept in a trace file, makes for 2 GiB of records
+ */
+#define WS_TRACE_MAX_RECORDS (1 << 26)
+
+/**
+ * Whether tracing is enabled
+ *
+ * @private Use the tracepoint macros
+ */
+extern bool ws_trace_enabled;
+
+/**
+ * Initialize the tracing module
+ *
+ * Starts tracing if `WAYSOME_TRACE` is set.
+ *
+ * @return zero on success, else negative error code from errno.h
+ */
+int
+ws_trace_init(void);
+
+/**
+ * Start tracing to a file
+ *
+ * The file is created or truncated. `records` is rounded up to a power of two.
+ *
+ * @return zero on success, `-EINVAL` if `records` is zero or exceeds
+ *         `WS_TRACE_MAX_RECORDS`, else negative error code from errno.h
+ */
+int
+ws_trace_open(
+    char const* path, //!< path of the trace file
+    size_t records //!< number of records to keep
+);
+
+/**
+ * Stop tracing
+ *
+ * @warning no tracepoint may be hit concurrently
+ */
+void
+ws_trace_close(void);
+
+/**
+ * Write a trace record
+ *
+ * @private Use the tracepoint macros
+ */
+void
+ws_trace_emit(
+    enum ws_trace_event event, //!< the event
+    enum ws_trace_phase phase, //!< the phase
+    uint64_t id, //!< id of the object the event is about
+    uint64_t arg //!< event specific argument
+);
+
+#ifdef WS_TRACE_DISABLED
+#define WS_TRACE_ON (0)
+#else
+#define WS_TRACE_ON \
+    __builtin_expect(__atomic_load_n(&ws_trace_enabled, __ATOMIC_RELAXED), 0)
+#endif
+
+/**
+ * Tracepoint
+ *
+ * The arguments are only evaluated if tracing is enabled.
+ */
+#define ws_trace(event_, phase_, id_, arg_) do {                        \
+        if (WS_TRACE_ON) {                                              \
+            ws_trace_emit((event_), (phase_), (id_), (arg_));           \
+        }                                                               \
+    } while (0)
+
+/**
+ * Tracepoint marking the begin of a span
+ */
+#define ws_trace_begin(event_, id_, arg_) \
+    ws_trace((event_), WS_TRACE_PHASE_BEGIN, (id_), (arg_))
+
+/**
+ * Tracepoint marking the end of a span
+ */
+#define ws_trace_end(event_, id_, arg_) \
+    ws_trace((event_), WS_TRACE_PHASE_END, (id_), (arg_))
+
+/**
+ * Tracepoint marking a point in time
+ */
+#define ws_trace_instant(event_, id_, arg_) \
+    ws_trace((event_), WS_TRACE_PHASE_INSTANT, (id_), (arg_))
+
+/**
+ * Tracepoint marking the begin of an async span, identified by `id_`
+ */
+#define ws_trace_async_begin(event_, id_, arg_) \
+    ws_trace((event_), WS_TRACE_PHASE_ASYNC_BEGIN, (id_), (arg_))
+
+/**
+ * Tracepoint marking the end of an async span, identified by `id_`
+ */
+#define ws_trace_async_end(event_, id_, arg_) \
+    ws_trace((event_), WS_TRACE_PHASE_ASYNC_END, (id_), (arg_))
+
+#endif // __WS_TRACE_MODULE_H__
+
+/**
+ * @}
+ */
@@ -0,0 +1,118 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup trace "Tracing module"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup trace_trace2json "Trace converter"
+ *
+ * Offline tool converting a trace file to the Chrome trace event format
+ *
+ * Usage: `trace2json <trace file> [<output file>]`
+ *
+ * The output is written to stdout if no output file is given. It may be loaded
+ * into `chrome://tracing` or the Perfetto UI.
+ *
+ * @{
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "trace/decode.h"
+
+int
+main(
+    int argc,
+    char** argv
+) {
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "Usage: %s <trace file> [<output file>]\n", argv[0]);
+        return 1;
+    }
+
+    int fd = open(argv[1], O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Could not open %s: %s\n", argv[1], strerror(errno));
+        return 1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size == 0) {
+        fprintf(stderr, "Could not read %s\n", argv[1]);
+        close(fd);
+        return 1;
+    }
+
+    void* data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        fprintf(stderr, "Could not map %s: %s\n", argv[1], strerror(errno));
+        return 1;
+    }
+
+    FILE* out = stdout;
+    if (argc == 3) {
+        out = fopen(argv[2], "w");
+        if (!out) {
+            fprintf(stderr, "Could not open %s: %s\n", argv[2],
+                    strerror(errno));
+            munmap(data, st.st_size);
+            return 1;
+        }
+    }
+
+    int res = ws_trace_to_json(out, data, st.st_size);
+    if (res < 0) {
+        fprintf(stderr, "Could not convert %s: %s\n", argv[1], strerror(-res));
+    }
+
+    if (out != stdout) {
+        fclose(out);
+    }
+    munmap(data, st.st_size);
+
+    return res < 0;
+}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
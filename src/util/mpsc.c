@@ -0,0 +1,111 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+
+#include "util/mpsc.h"
+
+/*
+ * The queue is Dmitry Vyukov's intrusive MPSC node-based queue: producers
+ * swap themselves in as the new `head` and link the previous head to them
+ * afterwards. Between these two steps the list is temporarily disconnected,
+ * which the consumer detects and treats as "empty for now".
+ */
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+void
+ws_mpsc_queue_init(
+    struct ws_mpsc_queue* self
+) {
+    self->stub.next = NULL;
+    self->head      = &self->stub;
+    self->tail      = &self->stub;
+}
+
+void
+ws_mpsc_queue_push(
+    struct ws_mpsc_queue* self,
+    struct ws_mpsc_node* node
+) {
+    __atomic_store_n(&node->next, NULL, __ATOMIC_RELAXED);
+    struct ws_mpsc_node* prev = __atomic_exchange_n(&self->head, node,
+                                                    __ATOMIC_ACQ_REL);
+    __atomic_store_n(&prev->next, node, __ATOMIC_RELEASE);
+}
+
+struct ws_mpsc_node*
+ws_mpsc_queue_pop(
+    struct ws_mpsc_queue* self
+) {
+    struct ws_mpsc_node* tail = self->tail;
+    struct ws_mpsc_node* next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+
+    // skip the stub node
+    if (tail == &self->stub) {
+        if (!next) {
+            return NULL;
+        }
+        self->tail  = next;
+        tail        = next;
+        next        = __atomic_load_n(&next->next, __ATOMIC_ACQUIRE);
+    }
+
+    if (next) {
+        self->tail = next;
+        return tail;
+    }
+
+    // a producer is in the middle of pushing
+    if (tail != __atomic_load_n(&self->head, __ATOMIC_ACQUIRE)) {
+        return NULL;
+    }
+
+    // `tail` is the last node, re-insert the stub so we can take it out
+    ws_mpsc_queue_push(self, &self->stub);
+
+    next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+    if (next) {
+        self->tail = next;
+        return tail;
+    }
+
+    return NULL;
+}
+
+bool
+ws_mpsc_queue_empty(
+    struct ws_mpsc_queue* self
+) {
+    struct ws_mpsc_node* tail = self->tail;
+    return (tail == &self->stub) &&
+        !__atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,121 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @addtogroup utils "(internal) utilities"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup utils_mpsc "(internal) multi-producer single-consumer queue"
+ *
+ * Intrusive, lock-free queue which may be pushed to from any number of threads
+ * while exactly one thread pops from it.
+ *
+ * Elements are linked via a `ws_mpsc_node` embedded in the element. Pushing
+ * is a single atomic exchange, popping does not need any atomic
+ * read-modify-write operation at all. The queue never allocates memory.
+ *
+ * @{
+ */
+
+#ifndef __WS_UTIL_MPSC_H__
+#define __WS_UTIL_MPSC_H__
+
+#include <stdbool.h>
+
+/**
+ * Node to be embedded in elements of a `ws_mpsc_queue`
+ */
+struct ws_mpsc_node {
+    struct ws_mpsc_node* next; //!< @private next node in the queue
+};
+
+/**
+ * Multi-producer single-consumer queue
+ */
+struct ws_mpsc_queue {
+    struct ws_mpsc_node* head; //!< @private last node pushed, used by producers
+    struct ws_mpsc_node* tail; //!< @private next node to pop, used by consumer
+    struct ws_mpsc_node stub; //!< @private stub node, keeps the list non-empty
+};
+
+/**
+ * Initialize a queue
+ */
+void
+ws_mpsc_queue_init(
+    struct ws_mpsc_queue* self //!< queue to initialize
+);
+
+/**
+ * Push a node to a queue
+ *
+ * @note Threadsafe!
+ */
+void
+ws_mpsc_queue_push(
+    struct ws_mpsc_queue* self, //!< queue to push to
+    struct ws_mpsc_node* node //!< node to push
+);
+
+/**
+ * Pop a node from a queue
+ *
+ * @warning only one thread may pop from a queue at any time
+ *
+ * @note this function may return `NULL` while a push is in progress, even if
+ *       older nodes are in the queue. Producers should hence notify the
+ *       consumer only _after_ pushing.
+ *
+ * @return the oldest node in the queue or `NULL`
+ */
+struct ws_mpsc_node*
+ws_mpsc_queue_pop(
+    struct ws_mpsc_queue* self //!< queue to pop from
+);
+
+/**
+ * Check whether a queue is empty
+ *
+ * @warning may only be called from the consuming thread
+ */
+bool
+ws_mpsc_queue_empty(
+    struct ws_mpsc_queue* self //!< queue to check
+);
+
+#endif // __WS_UTIL_MPSC_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
@@ -0,0 +1,210 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+#include "util/arithmetical.h"
+#include "util/parallel.h"
+
+/**
+ * A loop published to the workers
+ */
+struct loop {
+    ws_parallel_func func; //!< function to run for each index
+    void* etc; //!< additional parameter for the function
+    size_t num; //!< number of indices
+    size_t next; //!< next index to hand out, accessed atomically
+    unsigned int helpers; //!< workers still wanted, protected by the lock
+    unsigned int active; //!< workers running the loop, protected by the lock
+};
+
+/**
+ * The worker pool
+ */
+static struct {
+    pthread_mutex_t busy; //!< held while a loop is run on the pool
+    pthread_mutex_t lock; //!< lock for the members below
+    pthread_cond_t work; //!< signalled when a loop is published
+    pthread_cond_t done; //!< signalled when the last worker leaves a loop
+    struct loop* loop; //!< the loop currently published, if any
+    unsigned int workers; //!< number of workers started
+} pool = {
+    .busy = PTHREAD_MUTEX_INITIALIZER,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .work = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+    .loop = NULL,
+    .workers = 0,
+};
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Run iterations of a loop until all of its indices are handed out
+ */
+static void
+run_loop(
+    struct loop* loop //!< loop to run
+);
+
+/**
+ * Thread function of a worker
+ */
+static void*
+worker_run(
+    void* arg //!< unused
+);
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+unsigned int
+ws_parallel_threads(void)
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus < 1) {
+        return 1;
+    }
+
+    return MIN((unsigned int) cpus, WS_PARALLEL_MAX_THREADS);
+}
+
+unsigned int
+ws_parallel_for(
+    size_t num,
+    unsigned int threads,
+    ws_parallel_func func,
+    void* etc
+) {
+    struct loop loop = {
+        .func = func, .etc = etc, .num = num, .next = 0,
+        .helpers = 0, .active = 0,
+    };
+
+    if (!threads) {
+        threads = ws_parallel_threads();
+    }
+    threads = MIN(threads, WS_PARALLEL_MAX_THREADS);
+    if (num < threads) {
+        threads = num;
+    }
+
+    // run the loop on our own if the pool is busy, e.g. if we are a worker
+    if (threads <= 1 || pthread_mutex_trylock(&pool.busy) != 0) {
+        run_loop(&loop);
+        return 1;
+    }
+
+    pthread_mutex_lock(&pool.lock);
+
+    // start workers as needed, keeping them for later loops
+    while (pool.workers < threads - 1) {
+        pthread_t thread;
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        int res = pthread_create(&thread, &attr, worker_run, NULL);
+        pthread_attr_destroy(&attr);
+        if (res != 0) {
+            break;
+        }
+        ++pool.workers;
+    }
+
+    unsigned int helpers = MIN(threads - 1, pool.workers);
+    loop.helpers = helpers;
+    pool.loop = &loop;
+    pthread_cond_broadcast(&pool.work);
+    pthread_mutex_unlock(&pool.lock);
+
+    run_loop(&loop);
+
+    // retract the loop and wait for the workers still running it
+    pthread_mutex_lock(&pool.lock);
+    pool.loop = NULL;
+    helpers -= loop.helpers;
+    while (loop.active) {
+        pthread_cond_wait(&pool.done, &pool.lock);
+    }
+    pthread_mutex_unlock(&pool.lock);
+
+    pthread_mutex_unlock(&pool.busy);
+    return helpers + 1;
+}
+
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static void
+run_loop(
+    struct loop* loop
+) {
+    size_t index;
+    while ((index = __atomic_fetch_add(&loop->next, 1, __ATOMIC_RELAXED)) <
+            loop->num) {
+        loop->func(index, loop->etc);
+    }
+}
+
+static void*
+worker_run(
+    void* arg
+) {
+    pthread_mutex_lock(&pool.lock);
+    while (true) {
+        struct loop* loop = pool.loop;
+        if (!loop || !loop->helpers) {
+            pthread_cond_wait(&pool.work, &pool.lock);
+            continue;
+        }
+
+        --loop->helpers;
+        ++loop->active;
+        pthread_mutex_unlock(&pool.lock);
+
+        run_loop(loop);
+
+        pthread_mutex_lock(&pool.lock);
+        if (!--loop->active) {
+            pthread_cond_signal(&pool.done);
+        }
+    }
+
+    return NULL;
+}
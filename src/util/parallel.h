@@ -0,0 +1,103 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @addtogroup utils "(internal) utilities"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup utils_parallel "(internal) data parallelism"
+ *
+ * A small pool of worker threads for splitting loops over large amounts of
+ * data, e.g. evaluating a predicate for each element of a big set.
+ *
+ * The workers are started on first use and then wait for work until the
+ * process exits. The calling thread always takes part in the work itself.
+ * Only one loop is run on the pool at a time. Loops started while the pool is
+ * busy, e.g. from within another loop, are run on the calling thread alone.
+ *
+ * @{
+ */
+
+#ifndef __WS_UTIL_PARALLEL_H__
+#define __WS_UTIL_PARALLEL_H__
+
+#include <stddef.h>
+
+#include "util/attributes.h"
+
+/**
+ * Maximum number of threads participating in a loop, including the caller
+ */
+#define WS_PARALLEL_MAX_THREADS (16)
+
+/**
+ * Function run for each index of a loop
+ */
+typedef void (*ws_parallel_func)(
+    size_t index, //!< index of the iteration
+    void* etc //!< additional parameter passed to `ws_parallel_for()`
+);
+
+/**
+ * Get the default number of threads for a loop
+ *
+ * @return number of CPUs online, at most `WS_PARALLEL_MAX_THREADS`
+ */
+unsigned int
+ws_parallel_threads(void);
+
+/**
+ * Run a function for each index in [0, `num`), using multiple threads
+ *
+ * Indices are handed out to the threads one at a time, so each index should
+ * represent a reasonable amount of work, e.g. a chunk of elements.
+ *
+ * @note Threadsafe!
+ *
+ * @return number of threads which took part in the loop
+ */
+unsigned int
+ws_parallel_for(
+    size_t num, //!< number of iterations
+    unsigned int threads, //!< maximum number of threads, 0 for the default
+    ws_parallel_func func, //!< function to run for each index
+    void* etc //!< additional parameter for the function
+)
+__ws_nonnull__(3);
+
+#endif // __WS_UTIL_PARALLEL_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
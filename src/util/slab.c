@@ -0,0 +1,535 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util/condition.h"
+#include "util/slab.h"
+
+/*
+ * Statistics are only updated while chunks are moved between a pool and the
+ * thread caches, so chunks sitting in a thread's cache are counted as live.
+ *
+ * Slabs are aligned to their size, so the slab a chunk belongs to is found by
+ * masking the chunk's address. Since `ws_slab_release()` also accepts memory
+ * from `malloc()`, the slab's address is looked up in a table of all slabs
+ * before its header is accessed. Slabs are never freed, so the table is
+ * insert-only and may be read without taking a lock.
+ */
+
+/**
+ * Size (and alignment) of a slab
+ */
+#define SLAB_SIZE (1 << 16)
+
+/**
+ * Size reserved for the header at the start of each slab
+ */
+#define SLAB_HEADER_SIZE (64)
+
+/**
+ * Alignment of the chunks
+ */
+#define CHUNK_ALIGN (16)
+
+/**
+ * Maximum number of pools with thread caches
+ */
+#define MAX_POOLS (32)
+
+/**
+ * Number of chunks a thread cache holds per pool
+ */
+#define CACHE_SIZE (64)
+
+/**
+ * Number of chunks moved between a thread cache and its pool at once
+ */
+#define CACHE_BATCH (CACHE_SIZE / 2)
+
+/**
+ * Size of the slab table, must be a power of two
+ */
+#define SLAB_TABLE_SIZE (1 << 14)
+
+/**
+ * Maximum number of slabs, keeps the slab table sparse
+ */
+#define SLAB_TABLE_MAX (SLAB_TABLE_SIZE / 4 * 3)
+
+/**
+ * Header at the start of a slab
+ */
+struct slab_header {
+    struct ws_slab_pool* pool; //!< pool the slab belongs to
+};
+
+/**
+ * Free chunk
+ */
+struct chunk {
+    struct chunk* next; //!< next free chunk
+};
+
+/**
+ * Per-thread cache of chunks of one pool
+ */
+struct cache {
+    size_t num; //!< number of chunks in the cache
+    void* chunks[CACHE_SIZE]; //!< the cached chunks
+};
+
+/*
+ *
+ * Forward declarations
+ *
+ */
+
+/**
+ * Register a pool, if it isn't already
+ */
+static void
+register_pool(
+    struct ws_slab_pool* pool //!< pool to register
+);
+
+/**
+ * Get the calling thread's cache for a pool
+ *
+ * @return the cache or NULL, if the pool has no thread caches
+ */
+static struct cache*
+get_cache(
+    struct ws_slab_pool* pool //!< pool to get the cache for
+);
+
+/**
+ * Create the key used for flushing thread caches at thread exit
+ */
+static void
+create_cache_key(void);
+
+/**
+ * Flush all caches of the calling thread
+ */
+static void
+flush_caches(
+    void* caches //!< the thread's caches
+);
+
+/**
+ * Take chunks from a pool
+ *
+ * @return number of chunks taken, which may be less than requested
+ */
+static size_t
+take_chunks(
+    struct ws_slab_pool* pool, //!< pool to take the chunks from
+    void** chunks, //!< array to store the chunks in
+    size_t num //!< number of chunks requested
+);
+
+/**
+ * Put chunks back into a pool
+ */
+static void
+put_chunks(
+    struct ws_slab_pool* pool, //!< pool to put the chunks into
+    void** chunks, //!< chunks to put back
+    size_t num //!< number of chunks
+);
+
+/**
+ * Add a slab to a pool
+ *
+ * @warning the pool's lock must be held
+ *
+ * @return 0 on success, a negative error code otherwise
+ */
+static int
+add_slab(
+    struct ws_slab_pool* pool //!< pool to add a slab to
+);
+
+/**
+ * Find the slab a chunk belongs to
+ *
+ * @return the slab's header or NULL, if the memory is not part of a slab
+ */
+static struct slab_header*
+find_slab(
+    void* ptr //!< memory to find the slab for
+);
+
+/**
+ * Get the slot of a slab in the slab table
+ *
+ * @return index of the first slot to probe
+ */
+static size_t
+slab_slot(
+    uintptr_t slab //!< address of the slab
+);
+
+/*
+ *
+ * Internal variables
+ *
+ */
+
+/**
+ * Lock for registering pools and slabs
+ */
+static pthread_mutex_t registry_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * Pools with thread caches, in order of registration
+ */
+static struct ws_slab_pool* pools[MAX_POOLS];
+
+/**
+ * Number of pools in `pools`
+ */
+static size_t pools_num;
+
+/**
+ * Addresses of all slabs, zero for free slots
+ */
+static uintptr_t slab_table[SLAB_TABLE_SIZE];
+
+/**
+ * Number of slabs in `slab_table`
+ */
+static size_t slabs_num;
+
+/**
+ * Key for flushing the thread caches at thread exit
+ */
+static pthread_key_t cache_key;
+
+/**
+ * Once-control for creating `cache_key`
+ */
+static pthread_once_t cache_key_once = PTHREAD_ONCE_INIT;
+
+/**
+ * Thread caches, indexed by pool index
+ */
+static __thread struct cache caches[MAX_POOLS];
+
+/**
+ * Whether the thread caches of the calling thread will be flushed at exit
+ */
+static __thread bool caches_active;
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+void*
+ws_slab_alloc(
+    struct ws_slab_pool* pool
+) {
+    void* chunk = NULL;
+
+    struct cache* cache = get_cache(pool);
+    if (cache) {
+        if (!cache->num) {
+            cache->num = take_chunks(pool, cache->chunks, CACHE_BATCH);
+        }
+        if (cache->num) {
+            chunk = cache->chunks[--cache->num];
+        }
+    } else {
+        take_chunks(pool, &chunk, 1);
+    }
+
+    if (!chunk) {
+        // the pool is exhausted, but we may still be able to serve the request
+        return calloc(1, pool->size);
+    }
+
+    memset(chunk, 0, pool->size);
+    return chunk;
+}
+
+void
+ws_slab_release(
+    void* ptr
+) {
+    if (!ptr) {
+        return;
+    }
+
+    struct slab_header* slab = find_slab(ptr);
+    if (!slab) {
+        free(ptr);
+        return;
+    }
+
+    struct ws_slab_pool* pool = slab->pool;
+
+    struct cache* cache = get_cache(pool);
+    if (!cache) {
+        put_chunks(pool, &ptr, 1);
+        return;
+    }
+
+    if (cache->num == CACHE_SIZE) {
+        cache->num -= CACHE_BATCH;
+        put_chunks(pool, cache->chunks + cache->num, CACHE_BATCH);
+    }
+    cache->chunks[cache->num++] = ptr;
+}
+
+void
+ws_slab_pool_stats(
+    struct ws_slab_pool* pool,
+    struct ws_slab_stats* stats
+) {
+    stats->live         = __atomic_load_n(&pool->live, __ATOMIC_RELAXED);
+    stats->high_water   = __atomic_load_n(&pool->high_water, __ATOMIC_RELAXED);
+    stats->slabs        = __atomic_load_n(&pool->slabs, __ATOMIC_RELAXED);
+}
+
+void
+ws_slab_foreach_pool(
+    void (*func)(struct ws_slab_pool*, void*),
+    void* etc
+) {
+    size_t num = __atomic_load_n(&pools_num, __ATOMIC_ACQUIRE);
+    for (size_t i = 0; i < num; ++i) {
+        func(pools[i], etc);
+    }
+}
+
+/*
+ *
+ * Internal implementation
+ *
+ */
+
+static void
+register_pool(
+    struct ws_slab_pool* pool
+) {
+    pthread_mutex_lock(&registry_lock);
+
+    if (!pool->index) {
+        if (pools_num < MAX_POOLS) {
+            pools[pools_num] = pool;
+            __atomic_store_n(&pools_num, pools_num + 1, __ATOMIC_RELEASE);
+            __atomic_store_n(&pool->index, pools_num, __ATOMIC_RELEASE);
+        } else {
+            // no thread caches left, the pool is served via its lock only
+            __atomic_store_n(&pool->index, SIZE_MAX, __ATOMIC_RELEASE);
+        }
+    }
+
+    pthread_mutex_unlock(&registry_lock);
+}
+
+static struct cache*
+get_cache(
+    struct ws_slab_pool* pool
+) {
+    size_t index = __atomic_load_n(&pool->index, __ATOMIC_ACQUIRE);
+    if (unlikely(!index)) {
+        register_pool(pool);
+        index = __atomic_load_n(&pool->index, __ATOMIC_ACQUIRE);
+    }
+
+    if (index > MAX_POOLS) {
+        return NULL;
+    }
+
+    if (unlikely(!caches_active)) {
+        // chunks in the caches would be lost if the thread exits
+        pthread_once(&cache_key_once, create_cache_key);
+        if (pthread_setspecific(cache_key, caches) != 0) {
+            return NULL;
+        }
+        caches_active = true;
+    }
+
+    return caches + index - 1;
+}
+
+static void
+create_cache_key(void)
+{
+    pthread_key_create(&cache_key, flush_caches);
+}
+
+static void
+flush_caches(
+    void* thread_caches
+) {
+    struct cache* cache = thread_caches;
+    size_t num = __atomic_load_n(&pools_num, __ATOMIC_ACQUIRE);
+
+    caches_active = false;
+    for (size_t i = 0; i < num; ++i) {
+        put_chunks(pools[i], cache[i].chunks, cache[i].num);
+        cache[i].num = 0;
+    }
+}
+
+static size_t
+take_chunks(
+    struct ws_slab_pool* pool,
+    void** chunks,
+    size_t num
+) {
+    size_t taken = 0;
+
+    pthread_mutex_lock(&pool->lock);
+
+    while (taken < num) {
+        if (!pool->free && (add_slab(pool) < 0)) {
+            break;
+        }
+
+        struct chunk* chunk = pool->free;
+        pool->free = chunk->next;
+        chunks[taken++] = chunk;
+    }
+
+    // account at batch granularity, keeping atomics out of the fast path
+    size_t live = pool->live + taken;
+    __atomic_store_n(&pool->live, live, __ATOMIC_RELAXED);
+    if (live > pool->high_water) {
+        __atomic_store_n(&pool->high_water, live, __ATOMIC_RELAXED);
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+
+    return taken;
+}
+
+static void
+put_chunks(
+    struct ws_slab_pool* pool,
+    void** chunks,
+    size_t num
+) {
+    if (!num) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+
+    __atomic_store_n(&pool->live, pool->live - num, __ATOMIC_RELAXED);
+    while (num--) {
+        struct chunk* chunk = chunks[num];
+        chunk->next = pool->free;
+        pool->free = chunk;
+    }
+
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static int
+add_slab(
+    struct ws_slab_pool* pool
+) {
+    size_t chunk_size = pool->size < sizeof(struct chunk) ?
+                        sizeof(struct chunk) : pool->size;
+    chunk_size = (chunk_size + CHUNK_ALIGN - 1) & ~((size_t) CHUNK_ALIGN - 1);
+    if (chunk_size > SLAB_SIZE - SLAB_HEADER_SIZE) {
+        return -ENOTSUP;
+    }
+
+    void* mem;
+    if (posix_memalign(&mem, SLAB_SIZE, SLAB_SIZE) != 0) {
+        return -ENOMEM;
+    }
+
+    struct slab_header* slab = mem;
+    slab->pool = pool;
+
+    // publish the slab, so chunks from it are recognized on release
+    pthread_mutex_lock(&registry_lock);
+    if (slabs_num >= SLAB_TABLE_MAX) {
+        pthread_mutex_unlock(&registry_lock);
+        free(mem);
+        return -ENOMEM;
+    }
+
+    size_t slot = slab_slot((uintptr_t) mem);
+    while (slab_table[slot]) {
+        slot = (slot + 1) & (SLAB_TABLE_SIZE - 1);
+    }
+    __atomic_store_n(slab_table + slot, (uintptr_t) mem, __ATOMIC_RELEASE);
+    ++slabs_num;
+    pthread_mutex_unlock(&registry_lock);
+
+    // carve the slab into chunks
+    char* pos = (char*) mem + SLAB_HEADER_SIZE;
+    char* end = (char*) mem + SLAB_SIZE;
+    while (pos + chunk_size <= end) {
+        struct chunk* chunk = (struct chunk*) pos;
+        chunk->next = pool->free;
+        pool->free = chunk;
+        pos += chunk_size;
+    }
+
+    __atomic_add_fetch(&pool->slabs, 1, __ATOMIC_RELAXED);
+    return 0;
+}
+
+static struct slab_header*
+find_slab(
+    void* ptr
+) {
+    uintptr_t slab = (uintptr_t) ptr & ~((uintptr_t) SLAB_SIZE - 1);
+
+    size_t slot = slab_slot(slab);
+    uintptr_t cur;
+    while ((cur = __atomic_load_n(slab_table + slot, __ATOMIC_ACQUIRE))) {
+        if (cur == slab) {
+            return (struct slab_header*) slab;
+        }
+        slot = (slot + 1) & (SLAB_TABLE_SIZE - 1);
+    }
+
+    return NULL;
+}
+
+static size_t
+slab_slot(
+    uintptr_t slab
+) {
+    return ((slab / SLAB_SIZE) * 2654435761u) & (SLAB_TABLE_SIZE - 1);
+}
+
@@ -0,0 +1,161 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @addtogroup utils "(internal) utilities"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup utils_slab "(internal) slab allocator"
+ *
+ * Pools of fixed-size chunks for objects which are allocated and released at
+ * a high rate, e.g. strings and messages created while handling IPC.
+ *
+ * Chunks are carved from aligned slabs which are never returned to the
+ * system, so a pool grows to its high-water mark and stays there. Each thread
+ * keeps a small cache of chunks per pool, which is refilled from and flushed
+ * to the pool in batches, so in steady state neither `malloc()` nor the
+ * pool's lock are touched for most allocations.
+ *
+ * Memory from a pool may be released from any thread via `ws_slab_release()`,
+ * which also accepts memory which was allocated using `malloc()` and friends.
+ *
+ * @{
+ */
+
+#ifndef __WS_UTIL_SLAB_H__
+#define __WS_UTIL_SLAB_H__
+
+#include <pthread.h>
+#include <stddef.h>
+
+#include "util/attributes.h"
+
+/**
+ * Pool of fixed-size chunks
+ *
+ * Pools are meant to be defined statically, using `WS_SLAB_POOL_INIT()`. They
+ * register themselves on first use and are never destroyed.
+ */
+struct ws_slab_pool {
+    char const* name; //!< name of the pool, for statistics
+    size_t size; //!< size of the chunks handed out by the pool
+    pthread_mutex_t lock; //!< @private lock for the members below
+    void* free; //!< @private list of free chunks
+    size_t index; //!< @private index of the pool, zero until registered
+    size_t live; //!< @private number of chunks taken from the pool
+    size_t high_water; //!< @private maximum of `live`
+    size_t slabs; //!< @private number of slabs allocated
+};
+
+/**
+ * Initializer for a `ws_slab_pool`
+ */
+#define WS_SLAB_POOL_INIT(name_, size_) { \
+        .name = (name_), \
+        .size = (size_), \
+        .lock = PTHREAD_MUTEX_INITIALIZER, \
+    }
+
+/**
+ * Statistics of a pool
+ *
+ * Statistics are updated at the granularity of the thread caches, hence they
+ * include chunks which were released to a thread's cache but not yet returned
+ * to the pool.
+ */
+struct ws_slab_stats {
+    size_t live; //!< number of chunks handed out, including thread caches
+    size_t high_water; //!< maximum number of live chunks
+    size_t slabs; //!< number of slabs allocated for the pool
+};
+
+/**
+ * Allocate a chunk from a pool
+ *
+ * If no slab can be allocated for the pool, the chunk is allocated using
+ * `calloc()` instead.
+ *
+ * @note Threadsafe!
+ *
+ * @return zero-initialized chunk of at least the pool's size or NULL
+ */
+void*
+ws_slab_alloc(
+    struct ws_slab_pool* pool //!< pool to allocate the chunk from
+)
+__ws_nonnull__(1);
+
+/**
+ * Release memory
+ *
+ * Release a chunk allocated using `ws_slab_alloc()` or memory allocated using
+ * `malloc()` and friends, which is passed to `free()`.
+ *
+ * @note Threadsafe!
+ */
+void
+ws_slab_release(
+    void* ptr //!< memory to release, may be NULL
+);
+
+/**
+ * Get the statistics of a pool
+ *
+ * @note Threadsafe!
+ */
+void
+ws_slab_pool_stats(
+    struct ws_slab_pool* pool, //!< pool to get the statistics of
+    struct ws_slab_stats* stats //!< statistics to fill
+)
+__ws_nonnull__(1, 2);
+
+/**
+ * Call a function for each pool which has been used
+ *
+ * @note Threadsafe!
+ */
+void
+ws_slab_foreach_pool(
+    void (*func)(struct ws_slab_pool*, void*), //!< function to call
+    void* etc //!< argument passed to the function
+)
+__ws_nonnull__(1);
+
+#endif // __WS_UTIL_SLAB_H__
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
+
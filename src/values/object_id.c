@@ -54,6 +54,7 @@ ws_value_object_id_init(
     }
 
     ws_value_init(&self->val);
+    self->obj = NULL;
     self->val.type = WS_VALUE_TYPE_OBJECT_ID;
     self->val.deinit_callback = value_object_id_deinit;
 }
@@ -0,0 +1,113 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "values/ordered_set.h"
+
+static void
+value_ordered_set_deinit(
+    struct ws_value* self
+) {
+    struct ws_value_ordered_set* s = (struct ws_value_ordered_set*) self;
+
+    if (!s) {
+        return;
+    }
+
+    ws_object_unref(&s->set->obj);
+}
+
+int
+ws_value_ordered_set_init(
+    struct ws_value_ordered_set* self
+) {
+    self->set = ws_ordered_set_new();
+    if (!self->set) {
+        return -ENOMEM;
+    }
+
+    self->value.type = WS_VALUE_TYPE_ORDERED_SET;
+    self->value.deinit_callback = value_ordered_set_deinit;
+
+    return 0;
+}
+
+void
+ws_value_ordered_set_init_set(
+    struct ws_value_ordered_set* self,
+    struct ws_ordered_set* set
+) {
+    self->set = getref(set);
+
+    self->value.type = WS_VALUE_TYPE_ORDERED_SET;
+    self->value.deinit_callback = value_ordered_set_deinit;
+}
+
+struct ws_value_ordered_set*
+ws_value_ordered_set_new(void) {
+    struct ws_value_ordered_set* s = calloc(1, sizeof(*s));
+    if (!s) {
+        return NULL;
+    }
+
+    if (ws_value_ordered_set_init(s) < 0) {
+        free(s);
+        return NULL;
+    }
+
+    return s;
+}
+
+struct ws_ordered_set*
+ws_value_ordered_set_get(
+    struct ws_value_ordered_set* self
+) {
+    if (self) {
+        return getref(self->set);
+    }
+    return NULL;
+}
+
+size_t
+ws_value_ordered_set_cardinality(
+    struct ws_value_ordered_set const* self
+) {
+    return ws_ordered_set_cardinality(self->set);
+}
+
+int
+ws_value_ordered_set_select(
+    struct ws_value_ordered_set const* self,
+    ws_ordered_set_procf proc,
+    void* proc_etc
+) {
+    return ws_ordered_set_select_range(self->set, 0, SIZE_MAX, proc, proc_etc);
+}
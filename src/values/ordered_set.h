@@ -0,0 +1,141 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @addtogroup values "Value types"
+ *
+ * @{
+ */
+
+#ifndef __WS_VALUES_ORDERED_SET_H__
+#define __WS_VALUES_ORDERED_SET_H__
+
+#include "objects/object.h"
+#include "objects/ordered_set.h"
+#include "values/value.h"
+
+/**
+ * ws_value_ordered_set type definiton
+ *
+ * The ordered set type used for the api and the transactions. Unlike
+ * `ws_value_set`, elements are kept (and serialized) in order.
+ */
+struct ws_value_ordered_set {
+    struct ws_value value; //!< @protected base class
+    struct ws_ordered_set* set; //!< @protected ws_ordered_set object
+};
+
+/**
+ * Initialize a value_ordered_set object
+ *
+ * @memberof ws_value_ordered_set
+ *
+ * @return zero on success, else negative error code from errno.h
+ */
+int
+ws_value_ordered_set_init(
+    struct ws_value_ordered_set* self //!< The value_ordered_set object
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Initialize a value_ordered_set object with an existing ordered set
+ *
+ * @memberof ws_value_ordered_set
+ *
+ * The set is shared rather than copied, the value gets one reference on it.
+ */
+void
+ws_value_ordered_set_init_set(
+    struct ws_value_ordered_set* self, //!< The value_ordered_set object
+    struct ws_ordered_set* set //!< The set to store in the value
+)
+__ws_nonnull__(1, 2)
+;
+
+/**
+ * Get a new, initialized value_ordered_set object
+ *
+ * @memberof ws_value_ordered_set
+ *
+ * @return new value_ordered_set object or NULL on failure
+ */
+struct ws_value_ordered_set*
+ws_value_ordered_set_new(void);
+
+/**
+ * Get the ws_ordered_set object stored in the value type
+ *
+ * @memberof ws_value_ordered_set
+ *
+ * @return The set stored in the value (with a reference held), NULL on failure
+ */
+struct ws_ordered_set*
+ws_value_ordered_set_get(
+    struct ws_value_ordered_set* self
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Get the cardinality of a value_ordered_set
+ *
+ * @memberof ws_value_ordered_set
+ *
+ * @return the cardinality of `self`
+ */
+size_t
+ws_value_ordered_set_cardinality(
+    struct ws_value_ordered_set const* self //!< The value_ordered_set object
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Execute a processor function for each element of a value_ordered_set
+ *
+ * @memberof ws_value_ordered_set
+ *
+ * The elements are processed in order.
+ *
+ * @return zero on success, else negative error value from errno.h
+ */
+int
+ws_value_ordered_set_select(
+    struct ws_value_ordered_set const* self, //!< The value_ordered_set object
+    ws_ordered_set_procf proc, //!< Processor function
+    void* proc_etc //!< Additional parameter for the processor function
+)
+__ws_nonnull__(1, 2)
+;
+
+#endif // __WS_VALUES_ORDERED_SET_H__
+
+/**
+ * @}
+ */
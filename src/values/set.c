@@ -47,7 +47,7 @@ ws_value_set_init(
     struct ws_value_set* self
 ) {
     self->set = ws_set_new();
-    if (!self) {
+    if (!self->set) {
         return -ENOMEM;
     }
 
@@ -57,6 +57,17 @@ ws_value_set_init(
     return 0;
 }
 
+void
+ws_value_set_init_set(
+    struct ws_value_set* self,
+    struct ws_set* set
+) {
+    self->set = getref(set);
+
+    self->value.type = WS_VALUE_TYPE_SET;
+    self->value.deinit_callback = value_set_deinit;
+}
+
 struct ws_value_set*
 ws_value_set_new(void) {
     struct ws_value_set* s = calloc(1, sizeof(*s));
@@ -106,7 +117,6 @@ ws_value_set_get_object(
     return  ws_set_get(self->set, cmp);
 }
 
-/*
 int
 ws_value_set_union(
     struct ws_value_set* dest,
@@ -115,9 +125,7 @@ ws_value_set_union(
 ) {
     return ws_set_union(dest->set, src_a->set, src_b->set);
 }
-*/
 
-/*
 int
 ws_value_set_intersection(
     struct ws_value_set* dest,
@@ -126,9 +134,7 @@ ws_value_set_intersection(
 ) {
     return ws_set_intersection(dest->set, src_a->set, src_b->set);
 }
-*/
 
-/*
 int
 ws_value_set_xor(
     struct ws_value_set* dest,
@@ -137,9 +143,7 @@ ws_value_set_xor(
 ) {
     return ws_set_xor(dest->set, src_a->set, src_b->set);
 }
-*/
 
-/*
 bool
 ws_value_set_is_subset(
     struct ws_value_set const* self,
@@ -147,7 +151,6 @@ ws_value_set_is_subset(
 ) {
     return ws_set_is_subset(self->set, other->set);
 }
-*/
 
 bool
 ws_value_set_equal(
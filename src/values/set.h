@@ -72,6 +72,21 @@ ws_value_set_init(
 __ws_nonnull__(1)
 ;
 
+/**
+ * Initialize a value_set object with an existing set
+ *
+ * @memberof ws_value_set
+ *
+ * The set is shared rather than copied, the value gets one reference on it.
+ */
+void
+ws_value_set_init_set(
+    struct ws_value_set* self, //!< The value_set object
+    struct ws_set* set //!< The set to store in the value
+)
+__ws_nonnull__(1, 2)
+;
+
 /**
  * Get a new, initialized value_set object
  *
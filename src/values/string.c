@@ -62,6 +62,19 @@ ws_value_string_init(
     }
 }
 
+void
+ws_value_string_init_str(
+    struct ws_value_string* self,
+    struct ws_string* str
+) {
+    ws_value_init(&self->val);
+
+    self->val.type = WS_VALUE_TYPE_STRING;
+    self->val.deinit_callback = value_string_deinit;
+
+    self->str = getref(str);
+}
+
 struct ws_value_string*
 ws_value_string_new(void)
 {
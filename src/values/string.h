@@ -58,6 +58,22 @@ ws_value_string_init(
 __ws_nonnull__(1)
 ;
 
+/**
+ * Initialize a ws_value_string object referring to an existing ws_string
+ *
+ * @memberof ws_value_string
+ *
+ * The ws_string is shared rather than copied, which makes this cheap. Since
+ * the ws_string may be shared, it must not be modified in place.
+ */
+void
+ws_value_string_init_str(
+    struct ws_value_string* self,
+    struct ws_string* str
+)
+__ws_nonnull__(1, 2)
+;
+
 /**
  * Allocate a new, initialized ws_value_string
  *
@@ -0,0 +1,195 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <errno.h>
+#include <stdlib.h>
+
+#include "values/table.h"
+#include "values/union.h"
+
+/*
+ *
+ * forward declarations
+ *
+ */
+
+static void
+value_table_deinit(
+    struct ws_value* self
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Release the cells of a table
+ */
+static void
+table_clear(
+    struct ws_value_table* self //!< The value_table object
+)
+__ws_nonnull__(1)
+;
+
+/*
+ *
+ * Interface implementation
+ *
+ */
+
+void
+ws_value_table_init(
+    struct ws_value_table* self
+) {
+    ws_value_init(&self->value);
+
+    self->value.type = WS_VALUE_TYPE_TABLE;
+    self->value.deinit_callback = value_table_deinit;
+
+    self->rows = 0;
+    self->cols = 0;
+    self->cells = NULL;
+}
+
+struct ws_value_table*
+ws_value_table_new(void)
+{
+    struct ws_value_table* t = calloc(1, sizeof(*t));
+    if (t) {
+        ws_value_table_init(t);
+    }
+    return t;
+}
+
+int
+ws_value_table_resize(
+    struct ws_value_table* self,
+    size_t rows,
+    size_t cols
+) {
+    table_clear(self);
+
+    size_t num = rows * cols;
+    if (cols && (num / cols != rows)) {
+        return -EOVERFLOW;
+    }
+
+    if (num) {
+        self->cells = calloc(num, sizeof(*self->cells));
+        if (!self->cells) {
+            return -ENOMEM;
+        }
+    }
+
+    size_t i;
+    for (i = 0; i < num; ++i) {
+        ws_value_nil_init(&self->cells[i].nil);
+    }
+
+    self->rows = rows;
+    self->cols = cols;
+    return 0;
+}
+
+size_t
+ws_value_table_rows(
+    struct ws_value_table const* self
+) {
+    return self->rows;
+}
+
+size_t
+ws_value_table_cols(
+    struct ws_value_table const* self
+) {
+    return self->cols;
+}
+
+union ws_value_union*
+ws_value_table_cell(
+    struct ws_value_table* self,
+    size_t row,
+    size_t col
+) {
+    if ((row >= self->rows) || (col >= self->cols)) {
+        return NULL;
+    }
+
+    return self->cells + row * self->cols + col;
+}
+
+int
+ws_value_table_init_copy(
+    struct ws_value_table* self,
+    struct ws_value_table* src
+) {
+    ws_value_table_init(self);
+
+    int res = ws_value_table_resize(self, src->rows, src->cols);
+    if (res < 0) {
+        return res;
+    }
+
+    size_t i;
+    for (i = 0; i < self->rows * self->cols; ++i) {
+        res = ws_value_union_init_from_val(self->cells + i,
+                                           &src->cells[i].value);
+        if (res < 0) {
+            return res;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ *
+ * static function implementations
+ *
+ */
+
+static void
+value_table_deinit(
+    struct ws_value* self
+) {
+    table_clear((struct ws_value_table*) self);
+}
+
+static void
+table_clear(
+    struct ws_value_table* self
+) {
+    size_t i;
+    for (i = 0; i < self->rows * self->cols; ++i) {
+        ws_value_deinit(&self->cells[i].value);
+    }
+
+    free(self->cells);
+    self->cells = NULL;
+    self->rows = 0;
+    self->cols = 0;
+}
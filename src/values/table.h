@@ -0,0 +1,163 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup values "Value types"
+ *
+ * @{
+ */
+
+#ifndef __WS_VALUES_TABLE_H__
+#define __WS_VALUES_TABLE_H__
+
+#include <stddef.h>
+
+#include "values/value.h"
+
+// forward declarations
+union ws_value_union;
+
+/**
+ * ws_value_table type definition
+ *
+ * A table is a two dimensional array of values, e.g. the result of reading
+ * several attributes of several objects at once. Cells are stored row by row.
+ */
+struct ws_value_table {
+    struct ws_value value; //!< @protected base class
+    size_t rows; //!< @protected number of rows
+    size_t cols; //!< @protected number of columns
+    union ws_value_union* cells; //!< @protected the cells, row by row
+};
+
+/**
+ * Initialize a value_table object as an empty table
+ *
+ * @memberof ws_value_table
+ */
+void
+ws_value_table_init(
+    struct ws_value_table* self //!< The value_table object
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Get a new, initialized, empty value_table object
+ *
+ * @memberof ws_value_table
+ *
+ * @return new value_table object or NULL on failure
+ */
+struct ws_value_table*
+ws_value_table_new(void);
+
+/**
+ * Resize a table
+ *
+ * All the cells of the table are discarded. The new cells are `nil`.
+ *
+ * @memberof ws_value_table
+ *
+ * @return zero on success, else negative error code from errno.h
+ */
+int
+ws_value_table_resize(
+    struct ws_value_table* self, //!< The value_table object
+    size_t rows, //!< new number of rows
+    size_t cols //!< new number of columns
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Get the number of rows of a table
+ *
+ * @memberof ws_value_table
+ *
+ * @return number of rows
+ */
+size_t
+ws_value_table_rows(
+    struct ws_value_table const* self //!< The value_table object
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Get the number of columns of a table
+ *
+ * @memberof ws_value_table
+ *
+ * @return number of columns
+ */
+size_t
+ws_value_table_cols(
+    struct ws_value_table const* self //!< The value_table object
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Get a cell of a table
+ *
+ * The cell may be modified in place, e.g. via ws_value_union_reinit().
+ *
+ * @memberof ws_value_table
+ *
+ * @return the cell or NULL, if the position is out of range
+ */
+union ws_value_union*
+ws_value_table_cell(
+    struct ws_value_table* self, //!< The value_table object
+    size_t row, //!< row of the cell
+    size_t col //!< column of the cell
+)
+__ws_nonnull__(1)
+;
+
+/**
+ * Initialize a table as a copy of another one
+ *
+ * @memberof ws_value_table
+ *
+ * @return zero on success, else negative error code from errno.h
+ */
+int
+ws_value_table_init_copy(
+    struct ws_value_table* self, //!< The value_table object to initialize
+    struct ws_value_table* src //!< The table to copy
+)
+__ws_nonnull__(1, 2)
+;
+
+#endif // __WS_VALUES_TABLE_H__
+
+/**
+ * @}
+ */
@@ -32,8 +32,21 @@
 #include "values/set.h"
 #include "values/union.h"
 #include "values/value_type.h"
+#include "util/slab.h"
 #include "util/string.h"
 
+/**
+ * Pool for values allocated via `ws_value_union_alloc()`
+ */
+static struct ws_slab_pool union_pool =
+    WS_SLAB_POOL_INIT("ws_value_union", sizeof(union ws_value_union));
+
+union ws_value_union*
+ws_value_union_alloc(void)
+{
+    return ws_slab_alloc(&union_pool);
+}
+
 int
 ws_value_union_init_from_val(
     union ws_value_union* dest,
@@ -66,12 +79,10 @@ ws_value_union_init_from_val(
         }
 
     case WS_VALUE_TYPE_STRING:
-        ws_value_string_init(&dest->string);
-        {
-            ws_string_set_from_str(dest->string.str,
-                                    ((struct ws_value_string*)src)->str);
-            return 0;
-        }
+        // strings are shared rather than copied
+        ws_value_string_init_str(&dest->string,
+                                 ((struct ws_value_string*)src)->str);
+        return 0;
 
     case WS_VALUE_TYPE_OBJECT_ID:
         ws_value_object_id_init(&dest->object_id);
@@ -87,9 +98,23 @@ ws_value_union_init_from_val(
         }
 
     case WS_VALUE_TYPE_SET:
-        dest->set.set = ws_value_set_get((struct ws_value_set*) src);
+        // sets are shared rather than copied
+        ws_value_set_init_set(&dest->set, ((struct ws_value_set*) src)->set);
         return 0;
 
+    case WS_VALUE_TYPE_TABLE:
+        return ws_value_table_init_copy(&dest->table,
+                                        (struct ws_value_table*) src);
+
+    case WS_VALUE_TYPE_ORDERED_SET:
+        // ordered sets are shared rather than copied, just like sets
+        {
+            struct ws_value_ordered_set* buf;
+            buf = (struct ws_value_ordered_set*) src;
+            ws_value_ordered_set_init_set(&dest->ordered_set, buf->set);
+            return 0;
+        }
+
     }
     return -EINVAL;
 }
@@ -130,6 +155,13 @@ ws_value_union_reinit(
 
     case WS_VALUE_TYPE_SET:
         return ws_value_set_init(&self->set);
+
+    case WS_VALUE_TYPE_TABLE:
+        ws_value_table_init(&self->table);
+        break;
+
+    case WS_VALUE_TYPE_ORDERED_SET:
+        return ws_value_ordered_set_init(&self->ordered_set);
     }
     return 0;
 }
@@ -245,6 +277,38 @@ ws_value_union_tostr(
             }
             break;
 
+    case WS_VALUE_TYPE_TABLE:
+            {
+                size_t rows = ws_value_table_rows(&self->table);
+                size_t cols = ws_value_table_cols(&self->table);
+                char* fmt   = "[ ... ]:%zux%zu";
+                size_t len  = 2 * strlen(STR_OF(SIZE_MAX)) + strlen(fmt);
+
+                res = calloc(1, len + 1);
+                if (!res) {
+                    return NULL;
+                }
+
+                snprintf(res, len, fmt, rows, cols);
+            }
+            break;
+
+    case WS_VALUE_TYPE_ORDERED_SET:
+            {
+                size_t card;
+                card = ws_value_ordered_set_cardinality(&self->ordered_set);
+                char* fmt   = "< ... >:%zu";
+                size_t len  = strlen(STR_OF(SIZE_MAX)) + strlen(fmt);
+
+                res = calloc(1, len + 1);
+                if (!res) {
+                    return NULL;
+                }
+
+                snprintf(res, len, fmt, card);
+            }
+            break;
+
     default:
             break;
     }
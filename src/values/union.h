@@ -39,8 +39,10 @@
 #include "values/int.h"
 #include "values/nil.h"
 #include "values/object_id.h"
+#include "values/ordered_set.h"
 #include "values/set.h"
 #include "values/string.h"
+#include "values/table.h"
 #include "values/value.h"
 
 /**
@@ -54,8 +56,23 @@ union ws_value_union {
     struct ws_value_string      string;         //!< string value
     struct ws_value_object_id   object_id;      //!< object id value
     struct ws_value_set         set;            //!< set value
+    struct ws_value_table       table;          //!< table value
+    struct ws_value_ordered_set ordered_set;    //!< ordered set value
 };
 
+/**
+ * Allocate a value union
+ *
+ * The union is allocated from a pool and may hold a value of any type. It has
+ * to be released using `ws_slab_release()`.
+ *
+ * @memberof ws_value_union
+ *
+ * @return a zero-initialized union or NULL on failure
+ */
+union ws_value_union*
+ws_value_union_alloc(void);
+
 /**
  * Initializes the union by copying another value
  *
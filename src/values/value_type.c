@@ -34,8 +34,10 @@
 #include "values/int.h"
 #include "values/nil.h"
 #include "values/object_id.h"
+#include "values/ordered_set.h"
 #include "values/set.h"
 #include "values/string.h"
+#include "values/table.h"
 #include "values/value_type.h"
 
 const char* WS_VALUE_TYPE_NAMES[] = {
@@ -47,6 +49,8 @@ const char* WS_VALUE_TYPE_NAMES[] = {
     [WS_VALUE_TYPE_STRING]      = "string",
     [WS_VALUE_TYPE_OBJECT_ID]   = "object",
     [WS_VALUE_TYPE_SET]         = "set",
+    [WS_VALUE_TYPE_TABLE]       = "table",
+    [WS_VALUE_TYPE_ORDERED_SET] = "ordered_set",
 };
 
 
@@ -100,6 +104,16 @@ ws_value_type_instance_from_value_name(
         ws_value_set_init((struct ws_value_set*) v);
         break;
 
+    case WS_VALUE_TYPE_TABLE:
+        v = calloc(1, sizeof(struct ws_value_table));
+        ws_value_table_init((struct ws_value_table*) v);
+        break;
+
+    case WS_VALUE_TYPE_ORDERED_SET:
+        v = calloc(1, sizeof(struct ws_value_ordered_set));
+        ws_value_ordered_set_init((struct ws_value_ordered_set*) v);
+        break;
+
     case WS_VALUE_TYPE_NONE:
     case WS_VALUE_TYPE_VALUE:
     default:
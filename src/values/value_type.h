@@ -46,6 +46,8 @@ enum ws_value_type {
     WS_VALUE_TYPE_STRING,
     WS_VALUE_TYPE_OBJECT_ID,
     WS_VALUE_TYPE_SET,
+    WS_VALUE_TYPE_TABLE,
+    WS_VALUE_TYPE_ORDERED_SET,
 };
 
 extern const char* WS_VALUE_TYPE_NAMES[];
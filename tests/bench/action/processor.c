@@ -0,0 +1,154 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @addtogroup bench "Benchmarks"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup bench_processor "Benchmarks: Command processor"
+ *
+ * Compares running a transaction by interpreting its statements to running
+ * its pre-linked bytecode.
+ *
+ * @{
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "action/processor.h"
+#include "action/processor_stack.h"
+#include "bench.h"
+#include "command/command.h"
+#include "command/statement.h"
+#include "objects/message/transaction.h"
+#include "objects/string.h"
+#include "values/int.h"
+
+/**
+ * Number of times the transaction is run
+ */
+#define RUNS 1000000
+
+/**
+ * Number of statements in the transaction
+ */
+#define STATEMENTS 8
+
+static struct ws_value*
+mkint(
+    intmax_t val
+) {
+    struct ws_value_int* v = calloc(1, sizeof(*v));
+    if (!v) {
+        abort();
+    }
+    ws_value_int_init(v);
+    ws_value_int_set(v, val);
+    return &v->value;
+}
+
+/**
+ * Build a transaction summing up some numbers, like a hotkey action would
+ */
+static struct ws_transaction*
+mktransaction(void)
+{
+    struct ws_string* name = ws_string_new();
+    ws_string_set_from_raw(name, "bench");
+    struct ws_transaction* t = ws_transaction_new(0, name, 0, NULL);
+    ws_object_unref(&name->obj);
+
+    struct ws_statement stmt;
+    ws_statement_init(&stmt, "add");
+    ws_statement_append_direct(&stmt, mkint(1));
+    ws_statement_append_direct(&stmt, mkint(2));
+    ws_transaction_push_statement(t, &stmt);
+
+    for (int i = 1; i < STATEMENTS; ++i) {
+        ws_statement_init(&stmt, "add");
+        ws_statement_append_indirect(&stmt, -1);
+        ws_statement_append_direct(&stmt, mkint(i));
+        ws_statement_append_direct(&stmt, mkint(i));
+        ws_transaction_push_statement(t, &stmt);
+    }
+
+    return t;
+}
+
+static void
+run(
+    struct ws_transaction* t,
+    struct ws_processor_stack* stack
+) {
+    for (size_t i = 0; i < RUNS; ++i) {
+        struct ws_processor proc;
+        ws_processor_init(&proc, stack, ws_transaction_commands(t));
+        if (ws_processor_exec(&proc) != 0) {
+            abort();
+        }
+        ws_processor_deinit(&proc);
+    }
+}
+
+int
+main(void)
+{
+    if (ws_command_init() != 0) {
+        return 1;
+    }
+
+    struct ws_processor_stack stack;
+    memset(&stack, 0, sizeof(stack));
+    if (ws_processor_stack_init(&stack) != 0) {
+        return 1;
+    }
+
+    struct ws_transaction* t = mktransaction();
+
+    WS_BENCH("transaction interpreted", RUNS, run(t, &stack));
+
+    if (ws_transaction_compile(t) != 0) {
+        return 1;
+    }
+    WS_BENCH("transaction compiled", RUNS, run(t, &stack));
+
+    ws_object_unref(&t->m.obj);
+    ws_processor_stack_deinit(&stack);
+    return 0;
+}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
@@ -0,0 +1,80 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @addtogroup bench "Benchmarks"
+ *
+ * This module contains helpers for the micro benchmarks.
+ *
+ * @{
+ */
+
+#ifndef __WS_BENCH_BENCH_H__
+#define __WS_BENCH_BENCH_H__
+
+#include <stdio.h>
+#include <time.h>
+
+/**
+ * Get a monotonic timestamp in seconds
+ */
+static inline double
+ws_bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Report the result of a benchmark
+ */
+static inline void
+ws_bench_report(
+    char const* name, //!< name of the benchmark
+    size_t ops, //!< number of operations performed
+    double secs //!< time taken
+) {
+    printf("%-40s %12zu ops %10.3f ms %10.2f ns/op %12.0f ops/s\n", name, ops,
+           secs * 1e3, secs * 1e9 / ops, ops / secs);
+}
+
+/**
+ * Time a statement, which performs `ops` operations, and report the result
+ */
+#define WS_BENCH(name, ops, stmt) do {                      \
+        double ws_bench_start_ = ws_bench_now();            \
+        stmt;                                               \
+        double ws_bench_secs_ = ws_bench_now() - ws_bench_start_; \
+        ws_bench_report((name), (ops), ws_bench_secs_);     \
+    } while (0)
+
+#endif // __WS_BENCH_BENCH_H__
+
+/**
+ * @}
+ */
@@ -0,0 +1,143 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup bench "Benchmarks"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup bench_command "Benchmarks: Command lookup"
+ *
+ * Compares looking up every builtin command by name via the perfect hash to a
+ * binary and a linear search over the command list.
+ *
+ * @{
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "command/command.h"
+#include "command/list.h"
+
+/**
+ * Number of times every command is looked up
+ */
+#define ROUNDS 100000
+
+/**
+ * Sink for lookup results, keeps the compiler from optimizing lookups away
+ */
+static struct ws_command const* volatile sink;
+
+static struct ws_command const*
+binary_search(
+    char const* name
+) {
+    size_t first = 0;
+    size_t alast = ws_command_cnt;
+
+    while (first < alast) {
+        size_t cur = (first + alast) / 2;
+        int cmp = strcmp(name, ws_command_list[cur].name);
+        if (cmp < 0) {
+            alast = cur;
+        } else if (cmp > 0) {
+            first = cur + 1;
+        } else {
+            return ws_command_list + cur;
+        }
+    }
+    return NULL;
+}
+
+static struct ws_command const*
+linear_search(
+    char const* name
+) {
+    for (size_t i = 0; i < ws_command_cnt; ++i) {
+        if (strcmp(name, ws_command_list[i].name) == 0) {
+            return ws_command_list + i;
+        }
+    }
+    return NULL;
+}
+
+static void
+run(
+    char** names,
+    struct ws_command const* (*lookup)(char const*)
+) {
+    for (size_t r = 0; r < ROUNDS; ++r) {
+        for (size_t i = 0; i < ws_command_cnt; ++i) {
+            sink = lookup(names[i]);
+        }
+    }
+}
+
+int
+main(void)
+{
+    if (ws_command_init() != 0) {
+        return 1;
+    }
+
+    // the deserializer passes names it parsed, not the ones from the list
+    char** names = calloc(ws_command_cnt, sizeof(*names));
+    if (!names) {
+        return 1;
+    }
+    for (size_t i = 0; i < ws_command_cnt; ++i) {
+        names[i] = strdup(ws_command_list[i].name);
+        if (!names[i] || ws_command_get(names[i]) != ws_command_list + i) {
+            return 1;
+        }
+    }
+
+    size_t ops = ROUNDS * ws_command_cnt;
+    WS_BENCH("lookup perfect hash", ops, run(names, ws_command_get));
+    WS_BENCH("lookup binary search", ops, run(names, binary_search));
+    WS_BENCH("lookup linear search", ops, run(names, linear_search));
+
+    for (size_t i = 0; i < ws_command_cnt; ++i) {
+        free(names[i]);
+    }
+    free(names);
+    return 0;
+}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
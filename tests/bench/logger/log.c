@@ -0,0 +1,132 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup bench "Benchmarks"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup bench_log "Benchmarks: Logging"
+ *
+ * Measures the cost of a log call for the caller, before the logger is
+ * initialized (messages are written by the caller) and after (messages are
+ * handed to the writer thread). The output is sent to `/dev/null`.
+ *
+ * @{
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <syslog.h>
+
+#include "bench.h"
+#include "logger/module.h"
+
+/**
+ * Number of messages logged by each thread
+ */
+#define MESSAGES 1000000
+
+static struct ws_logger_context log_ctx = { .prefix = "[Bench] " };
+
+/**
+ * Log a bunch of messages
+ */
+static void*
+log_messages(
+    void* arg
+) {
+    int prio = *(int*) arg;
+
+    for (int i = 0; i < MESSAGES; ++i) {
+        ws_log(&log_ctx, prio, "message %d from %s", i, "bench");
+    }
+
+    return NULL;
+}
+
+/**
+ * Log from `threads` threads
+ */
+static void
+run_threaded(
+    size_t threads,
+    int prio
+) {
+    pthread_t thread[threads];
+
+    for (size_t t = 0; t < threads; ++t) {
+        pthread_create(&thread[t], NULL, log_messages, &prio);
+    }
+    for (size_t t = 0; t < threads; ++t) {
+        pthread_join(thread[t], NULL);
+    }
+}
+
+int
+main(void)
+{
+    if (!freopen("/dev/null", "w", stderr)) {
+        return 1;
+    }
+
+    int prio = LOG_ERR;
+    WS_BENCH("log/sync", MESSAGES, log_messages(&prio));
+
+    setenv("WAYSOME_LOG_LEVEL", "7", 1);
+    if (ws_logger_init() != 0) {
+        return 1;
+    }
+
+    prio = LOG_DEBUG + 1;
+    WS_BENCH("log/disabled", MESSAGES, log_messages(&prio));
+
+    char name[64];
+    for (size_t threads = 1; threads <= 4; threads *= 2) {
+        size_t dropped = ws_logger_dropped();
+
+        snprintf(name, sizeof(name), "log/async/%zu", threads);
+        WS_BENCH(name, threads * MESSAGES, run_threaded(threads, LOG_DEBUG));
+        ws_logger_flush();
+
+        printf("%-40s %12zu dropped\n", name, ws_logger_dropped() - dropped);
+    }
+
+    return 0;
+}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
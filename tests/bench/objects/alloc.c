@@ -0,0 +1,135 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @addtogroup bench "Benchmarks"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup bench_alloc "Benchmarks: Object allocation"
+ *
+ * Measures allocating and releasing strings, which are served from a slab
+ * pool, against plain `calloc()`/`free()` of the same size. Objects are
+ * allocated in bursts, like the temporaries created while handling a message.
+ *
+ * @{
+ */
+
+#include <stdlib.h>
+
+#include "bench.h"
+#include "objects/string.h"
+#include "util/slab.h"
+
+/**
+ * Number of objects alive at once
+ */
+#define BURST 64
+
+/**
+ * Number of bursts
+ */
+#define ROUNDS 200000
+
+static void
+run_calloc(void)
+{
+    void* objs[BURST];
+
+    for (size_t r = 0; r < ROUNDS; ++r) {
+        for (size_t i = 0; i < BURST; ++i) {
+            objs[i] = calloc(1, sizeof(struct ws_string));
+        }
+        for (size_t i = 0; i < BURST; ++i) {
+            free(objs[i]);
+        }
+    }
+}
+
+static void
+run_slab(void)
+{
+    static struct ws_slab_pool pool =
+        WS_SLAB_POOL_INIT("bench", sizeof(struct ws_string));
+    void* objs[BURST];
+
+    for (size_t r = 0; r < ROUNDS; ++r) {
+        for (size_t i = 0; i < BURST; ++i) {
+            objs[i] = ws_slab_alloc(&pool);
+        }
+        for (size_t i = 0; i < BURST; ++i) {
+            ws_slab_release(objs[i]);
+        }
+    }
+}
+
+static void
+run_strings(void)
+{
+    struct ws_string* objs[BURST];
+
+    for (size_t r = 0; r < ROUNDS; ++r) {
+        for (size_t i = 0; i < BURST; ++i) {
+            objs[i] = ws_string_new();
+        }
+        for (size_t i = 0; i < BURST; ++i) {
+            ws_object_unref(&objs[i]->obj);
+        }
+    }
+}
+
+static void
+print_stats(
+    struct ws_slab_pool* pool,
+    void* etc
+) {
+    struct ws_slab_stats stats;
+    ws_slab_pool_stats(pool, &stats);
+    printf("%-40s %12zu live %10zu max %10zu slabs\n", pool->name, stats.live,
+           stats.high_water, stats.slabs);
+}
+
+int
+main(void)
+{
+    WS_BENCH("alloc/calloc+free", BURST * ROUNDS, run_calloc());
+    WS_BENCH("alloc/ws_slab_alloc+release", BURST * ROUNDS, run_slab());
+    WS_BENCH("alloc/ws_string_new+unref", BURST * ROUNDS, run_strings());
+
+    ws_slab_foreach_pool(print_stats, NULL);
+    return 0;
+}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
@@ -0,0 +1,185 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @addtogroup bench "Benchmarks"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup bench_queue "Benchmarks: Queue"
+ *
+ * Compares the throughput of the queue flavours, both single threaded and
+ * with producers on other threads.
+ *
+ * @{
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "objects/object.h"
+#include "objects/queue.h"
+
+/**
+ * Number of elements pushed per batch in the single threaded benchmark
+ */
+#define BATCH 1024
+
+/**
+ * Number of batches in the single threaded benchmark
+ */
+#define ROUNDS 1000
+
+/**
+ * Number of elements pushed by each producer in the threaded benchmarks
+ */
+#define ELEMENTS 1000000
+
+struct producer_ctx {
+    struct ws_queue* q;
+    struct ws_object* obj;
+    size_t num;
+};
+
+static void*
+produce(
+    void* arg
+) {
+    struct producer_ctx* ctx = (struct producer_ctx*) arg;
+
+    for (size_t i = 0; i < ctx->num; ++i) {
+        while (ws_queue_push(ctx->q, ctx->obj) == -ENOSPC) {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Push and pop batches of elements on a single thread
+ */
+static void
+run_batches(
+    struct ws_queue* q,
+    struct ws_object* obj
+) {
+    for (size_t round = 0; round < ROUNDS; ++round) {
+        for (size_t i = 0; i < BATCH; ++i) {
+            ws_queue_push(q, obj);
+        }
+        for (size_t i = 0; i < BATCH; ++i) {
+            ws_object_unref(ws_queue_pop(q));
+        }
+    }
+}
+
+/**
+ * Pop everything `producers` threads push
+ */
+static void
+run_threaded(
+    struct ws_queue* q,
+    struct ws_object* obj,
+    size_t producers
+) {
+    pthread_t threads[producers];
+    struct producer_ctx ctx = { .q = q, .obj = obj, .num = ELEMENTS };
+
+    for (size_t p = 0; p < producers; ++p) {
+        pthread_create(&threads[p], NULL, produce, &ctx);
+    }
+
+    size_t popped = 0;
+    while (popped < producers * ELEMENTS) {
+        struct ws_object* o = ws_queue_pop(q);
+        if (!o) {
+            sched_yield();
+            continue;
+        }
+        ws_object_unref(o);
+        ++popped;
+    }
+
+    for (size_t p = 0; p < producers; ++p) {
+        pthread_join(threads[p], NULL);
+    }
+}
+
+int
+main(void)
+{
+    struct ws_object* obj = ws_object_new_raw();
+    if (!obj) {
+        return 1;
+    }
+
+    struct {
+        char const* name;
+        struct ws_queue* q;
+        size_t max_producers;
+    } queues[] = {
+        { "locked", ws_queue_new(),             4 },
+        { "spsc",   ws_queue_new_spsc(BATCH),   1 },
+        { "mpsc",   ws_queue_new_mpsc(),        4 },
+    };
+
+    for (size_t i = 0; i < sizeof(queues) / sizeof(*queues); ++i) {
+        struct ws_queue* q = queues[i].q;
+        if (!q) {
+            return 1;
+        }
+
+        char name[64];
+
+        snprintf(name, sizeof(name), "queue/%s/push+pop", queues[i].name);
+        WS_BENCH(name, ROUNDS * BATCH, run_batches(q, obj));
+
+        for (size_t p = 1; p <= queues[i].max_producers; p *= 4) {
+            snprintf(name, sizeof(name), "queue/%s/%zup1c", queues[i].name, p);
+            WS_BENCH(name, p * ELEMENTS, run_threaded(q, obj, p));
+        }
+
+        ws_object_unref(&q->obj);
+    }
+
+    ws_object_unref(obj);
+    return 0;
+}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
@@ -0,0 +1,117 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @addtogroup bench "Benchmarks"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup bench_refcount "Benchmarks: Reference counting"
+ *
+ * Measures getref/unref pairs on a single object, both uncontended and with
+ * several threads sharing the object.
+ *
+ * @{
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "bench.h"
+#include "objects/object.h"
+
+/**
+ * Number of getref/unref pairs per thread
+ */
+#define PAIRS 10000000
+
+/**
+ * Maximum number of threads sharing the object
+ */
+#define MAX_THREADS 8
+
+static void*
+run_pairs(
+    void* arg
+) {
+    struct ws_object* obj = (struct ws_object*) arg;
+
+    for (size_t i = 0; i < PAIRS; ++i) {
+        ws_object_unref(ws_object_getref(obj));
+    }
+
+    return NULL;
+}
+
+/**
+ * Run `PAIRS` getref/unref pairs on each of `num` threads
+ */
+static void
+run_threaded(
+    struct ws_object* obj,
+    size_t num
+) {
+    pthread_t threads[num];
+
+    for (size_t t = 0; t < num; ++t) {
+        pthread_create(&threads[t], NULL, run_pairs, obj);
+    }
+
+    for (size_t t = 0; t < num; ++t) {
+        pthread_join(threads[t], NULL);
+    }
+}
+
+int
+main(void)
+{
+    struct ws_object* obj = ws_object_new_raw();
+    if (!obj) {
+        return 1;
+    }
+
+    WS_BENCH("refcount/getref+unref", PAIRS, run_pairs(obj));
+
+    for (size_t t = 2; t <= MAX_THREADS; t *= 2) {
+        char name[64];
+        snprintf(name, sizeof(name), "refcount/getref+unref/%zu threads", t);
+        WS_BENCH(name, t * PAIRS, run_threaded(obj, t));
+    }
+
+    ws_object_unref(obj);
+    return 0;
+}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
@@ -0,0 +1,242 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @addtogroup bench "Benchmarks"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup bench_select "Benchmarks: Parallel select"
+ *
+ * Compares `ws_set_select()` with `ws_set_select_parallel()` using different
+ * numbers of threads, for a predicate reading attributes of the elements, as
+ * done when selecting surfaces by their geometry.
+ *
+ * @{
+ */
+
+#include <stddef.h>
+#include <stdio.h>
+
+#include "bench.h"
+#include "objects/object.h"
+#include "objects/set.h"
+#include "util/arithmetical.h"
+#include "util/parallel.h"
+#include "values/int.h"
+
+/**
+ * Number of elements in the set
+ */
+#define ELEMENTS 100000
+
+/**
+ * Number of times each selection is performed
+ */
+#define ROUNDS 10
+
+/*
+ *
+ * Element type
+ *
+ */
+
+struct elem {
+    struct ws_object obj;
+    int32_t x;
+    int32_t y;
+};
+
+static size_t
+elem_hash(
+    struct ws_object* const self
+) {
+    return (size_t) self >> 4;
+}
+
+static int
+elem_cmp(
+    struct ws_object const* o1,
+    struct ws_object const* o2
+) {
+    return (o1 > o2) - (o1 < o2);
+}
+
+static struct ws_object_attribute const ELEM_ATTRS[] = {
+    {
+        .name = "x",
+        .offset_in_struct = offsetof(struct elem, x),
+        .type = WS_OBJ_ATTR_TYPE_INT32,
+        .vtype = WS_VALUE_TYPE_INT,
+    },
+    {
+        .name = "y",
+        .offset_in_struct = offsetof(struct elem, y),
+        .type = WS_OBJ_ATTR_TYPE_INT32,
+        .vtype = WS_VALUE_TYPE_INT,
+    },
+    {
+        .name = NULL,
+    },
+};
+
+static ws_object_type_id ELEM_TYPE = {
+    .supertype  = &WS_OBJECT_TYPE_ID_OBJECT,
+    .typestr    = "bench_select_elem",
+
+    .hash_callback = elem_hash,
+    .cmp_callback = elem_cmp,
+    .attribute_table = ELEM_ATTRS,
+};
+
+/*
+ *
+ * Predicate and processor
+ *
+ */
+
+/**
+ * Select elements within a rectangle, reading their position via attributes
+ */
+static int
+in_rect(
+    void const* obj,
+    void* etc
+) {
+    struct ws_value_int x;
+    struct ws_value_int y;
+    ws_value_int_init(&x);
+    ws_value_int_init(&y);
+
+    struct ws_object* o = (struct ws_object*) obj;
+    if (ws_object_attr_read(o, "x", &x.value) < 0 ||
+            ws_object_attr_read(o, "y", &y.value) < 0) {
+        return 0;
+    }
+
+    intmax_t px = ws_value_int_get(&x);
+    intmax_t py = ws_value_int_get(&y);
+    return px >= 100 && px < 700 && py >= 100 && py < 500;
+}
+
+static int
+count(
+    void* etc,
+    void const* obj
+) {
+    ++*(size_t*) etc;
+    return 0;
+}
+
+/*
+ *
+ * Benchmark drivers
+ *
+ */
+
+static size_t
+run_serial(
+    struct ws_set* set
+) {
+    size_t selected = 0;
+    for (size_t round = 0; round < ROUNDS; ++round) {
+        ws_set_select(set, in_rect, NULL, count, &selected);
+    }
+    return selected;
+}
+
+static size_t
+run_parallel(
+    struct ws_set* set,
+    unsigned int threads
+) {
+    size_t selected = 0;
+    for (size_t round = 0; round < ROUNDS; ++round) {
+        ws_set_select_parallel(set, in_rect, NULL, count, &selected, threads);
+    }
+    return selected;
+}
+
+int
+main(void)
+{
+    static struct elem elems[ELEMENTS];
+
+    struct ws_set* set = ws_set_new();
+    if (!set) {
+        return 1;
+    }
+
+    for (size_t i = 0; i < ELEMENTS; ++i) {
+        ws_object_init(&elems[i].obj);
+        elems[i].obj.id = &ELEM_TYPE;
+        elems[i].x = (i * 7919) % 1000;
+        elems[i].y = (i * 104729) % 800;
+        ws_set_insert(set, &elems[i].obj);
+    }
+
+    size_t ops = ROUNDS * ELEMENTS;
+    size_t expected;
+
+    WS_BENCH("select/serial", ops, expected = run_serial(set));
+
+    // scale from one thread up to the number of CPUs
+    unsigned int max = ws_parallel_threads();
+    for (unsigned int threads = 1; ; threads = MIN(threads * 2, max)) {
+        char name[64];
+        snprintf(name, sizeof(name), "select/parallel/%u", threads);
+
+        size_t selected;
+        WS_BENCH(name, ops, selected = run_parallel(set, threads));
+        if (selected != expected) {
+            fprintf(stderr, "%s: selected %zu instead of %zu elements\n",
+                    name, selected, expected);
+            return 1;
+        }
+
+        if (threads == max) {
+            break;
+        }
+    }
+
+    ws_object_unref(&set->obj);
+    for (size_t i = 0; i < ELEMENTS; ++i) {
+        ws_object_deinit(&elems[i].obj);
+    }
+
+    return 0;
+}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
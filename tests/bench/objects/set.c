@@ -0,0 +1,279 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @addtogroup bench "Benchmarks"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup bench_set "Benchmarks: Set"
+ *
+ * Compares the set operations of ws_set with their emulation via single
+ * element lookups and insertions, as done by scripts before the operations
+ * were available.
+ *
+ * @{
+ */
+
+#include <stdlib.h>
+
+#include "bench.h"
+#include "objects/object.h"
+#include "objects/set.h"
+
+/**
+ * Number of elements in each of the sets
+ */
+#define ELEMENTS 10000
+
+/**
+ * Number of times each operation is performed
+ */
+#define ROUNDS 10
+
+/*
+ *
+ * Element type
+ *
+ * Plain objects can neither be hashed nor ordered, so we need our own type.
+ *
+ */
+
+static size_t
+elem_hash(
+    struct ws_object* const self
+) {
+    return (size_t) self >> 4;
+}
+
+static int
+elem_cmp(
+    struct ws_object const* o1,
+    struct ws_object const* o2
+) {
+    return (o1 > o2) - (o1 < o2);
+}
+
+static ws_object_type_id ELEM_TYPE = {
+    .supertype  = &WS_OBJECT_TYPE_ID_OBJECT,
+    .typestr    = "bench_set_elem",
+
+    .hash_callback = elem_hash,
+    .cmp_callback = elem_cmp,
+};
+
+/*
+ *
+ * Per-element emulation
+ *
+ */
+
+static int
+emu_insert(
+    void* etc,
+    void const* obj
+) {
+    return ws_set_insert((struct ws_set*) etc, (struct ws_object*) obj);
+}
+
+static int
+emu_contained(
+    void const* obj,
+    void* etc
+) {
+    struct ws_object* o = ws_set_get((struct ws_set*) etc, obj);
+    ws_object_unref(o);
+    return o != NULL;
+}
+
+static int
+emu_not_contained(
+    void const* obj,
+    void* etc
+) {
+    return !emu_contained(obj, etc);
+}
+
+static void
+emu_union(
+    struct ws_set* dest,
+    struct ws_set* a,
+    struct ws_set* b
+) {
+    ws_set_select(a, NULL, NULL, emu_insert, dest);
+    ws_set_select(b, emu_not_contained, dest, emu_insert, dest);
+}
+
+static void
+emu_intersection(
+    struct ws_set* dest,
+    struct ws_set* a,
+    struct ws_set* b
+) {
+    ws_set_select(a, emu_contained, b, emu_insert, dest);
+}
+
+static void
+emu_xor(
+    struct ws_set* dest,
+    struct ws_set* a,
+    struct ws_set* b
+) {
+    ws_set_select(a, emu_not_contained, b, emu_insert, dest);
+    ws_set_select(b, emu_not_contained, a, emu_insert, dest);
+}
+
+/*
+ *
+ * Benchmark drivers
+ *
+ */
+
+/**
+ * Run a three-set operation `ROUNDS` times, each time with a fresh destination
+ */
+static void
+run_op(
+    int (*op)(struct ws_set*, struct ws_set const*, struct ws_set const*),
+    struct ws_set* a,
+    struct ws_set* b
+) {
+    for (size_t round = 0; round < ROUNDS; ++round) {
+        struct ws_set* dest = ws_set_new();
+        op(dest, a, b);
+        ws_object_unref(&dest->obj);
+    }
+}
+
+/**
+ * Run an emulated operation `ROUNDS` times, each time with a fresh destination
+ */
+static void
+run_emu(
+    void (*op)(struct ws_set*, struct ws_set*, struct ws_set*),
+    struct ws_set* a,
+    struct ws_set* b
+) {
+    for (size_t round = 0; round < ROUNDS; ++round) {
+        struct ws_set* dest = ws_set_new();
+        op(dest, a, b);
+        ws_object_unref(&dest->obj);
+    }
+}
+
+/**
+ * Run an in-place operation `ROUNDS` times on a copy of `a`
+ *
+ * The copy is built outside of the timed region.
+ */
+static double
+run_inplace(
+    int (*op)(struct ws_set*, struct ws_set const*),
+    struct ws_set* a,
+    struct ws_set* b
+) {
+    double secs = 0;
+
+    for (size_t round = 0; round < ROUNDS; ++round) {
+        struct ws_set* self = ws_set_new();
+        ws_set_union_inplace(self, a);
+
+        double start = ws_bench_now();
+        op(self, b);
+        secs += ws_bench_now() - start;
+
+        ws_object_unref(&self->obj);
+    }
+
+    return secs;
+}
+
+int
+main(void)
+{
+    // the sets overlap by half of their elements
+    static struct ws_object* objs[ELEMENTS + ELEMENTS / 2];
+    size_t num = sizeof(objs) / sizeof(*objs);
+
+    struct ws_set* a = ws_set_new();
+    struct ws_set* b = ws_set_new();
+    if (!a || !b) {
+        return 1;
+    }
+
+    for (size_t i = 0; i < num; ++i) {
+        objs[i] = ws_object_new_raw();
+        if (!objs[i]) {
+            return 1;
+        }
+        objs[i]->id = &ELEM_TYPE;
+
+        if (i < ELEMENTS) {
+            ws_set_insert(a, objs[i]);
+        }
+        if (i >= ELEMENTS / 2) {
+            ws_set_insert(b, objs[i]);
+        }
+    }
+
+    size_t ops = ROUNDS * 2 * ELEMENTS;
+
+    WS_BENCH("set/union",               ops, run_op(ws_set_union, a, b));
+    WS_BENCH("set/union/emulated",      ops, run_emu(emu_union, a, b));
+    ws_bench_report("set/union/inplace", ops,
+                    run_inplace(ws_set_union_inplace, a, b));
+
+    WS_BENCH("set/intersection",          ops,
+             run_op(ws_set_intersection, a, b));
+    WS_BENCH("set/intersection/emulated", ops,
+             run_emu(emu_intersection, a, b));
+    ws_bench_report("set/intersection/inplace", ops,
+                    run_inplace(ws_set_intersection_inplace, a, b));
+
+    WS_BENCH("set/xor",                 ops, run_op(ws_set_xor, a, b));
+    WS_BENCH("set/xor/emulated",        ops, run_emu(emu_xor, a, b));
+    ws_bench_report("set/xor/inplace", ops,
+                    run_inplace(ws_set_xor_inplace, a, b));
+
+    ws_object_unref(&a->obj);
+    ws_object_unref(&b->obj);
+    for (size_t i = 0; i < num; ++i) {
+        ws_object_unref(objs[i]);
+    }
+
+    return 0;
+}
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
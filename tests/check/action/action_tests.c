@@ -38,18 +38,385 @@
  */
 
 #include <check.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
 #include "tests.h"
 
+#include "action/job.h"
+#include "action/memo.h"
+#include "action/processor.h"
+#include "action/processor_stack.h"
+#include "command/command.h"
+#include "command/statement.h"
+#include "objects/message/error_reply.h"
+#include "objects/message/transaction.h"
+#include "objects/message/value_reply.h"
+#include "objects/object.h"
+#include "objects/string.h"
+#include "values/int.h"
+#include "values/table.h"
+#include "values/union.h"
+
+/*
+ *
+ * Setup and teardown functions, including variables
+ *
+ */
+
+static struct ws_transaction* transaction = NULL;
+
+/**
+ * Set up a transaction computing `(1 + 2) + 4`
+ */
+static void
+setup(void)
+{
+    ck_assert(ws_command_init() == 0);
+
+    struct ws_string* name = ws_string_new();
+    ck_assert(name);
+    ck_assert(ws_string_set_from_raw(name, "test") == 0);
+
+    transaction = ws_transaction_new(0, name, 0, NULL);
+    ck_assert(transaction);
+    // the transaction has a copy of its own, ours stays lockable
+    ck_assert(!(ws_object_get_settings(&name->obj) & WS_OBJ_CONST));
+    ws_object_unref(&name->obj);
+
+    struct ws_value_int* one = calloc(1, sizeof(*one));
+    struct ws_value_int* two = calloc(1, sizeof(*two));
+    struct ws_value_int* four = calloc(1, sizeof(*four));
+    ck_assert(one && two && four);
+    ws_value_int_init(one);
+    ws_value_int_set(one, 1);
+    ws_value_int_init(two);
+    ws_value_int_set(two, 2);
+    ws_value_int_init(four);
+    ws_value_int_set(four, 4);
+
+    struct ws_statement stmt;
+    ck_assert(ws_statement_init(&stmt, "add") == 0);
+    ck_assert(ws_statement_append_direct(&stmt, &one->value) == 0);
+    ck_assert(ws_statement_append_direct(&stmt, &two->value) == 0);
+    ck_assert(ws_transaction_push_statement(transaction, &stmt) == 0);
+
+    ck_assert(ws_statement_init(&stmt, "add") == 0);
+    ck_assert(ws_statement_append_indirect(&stmt, -1) == 0);
+    ck_assert(ws_statement_append_direct(&stmt, &four->value) == 0);
+    ck_assert(ws_transaction_push_statement(transaction, &stmt) == 0);
+}
+
+static void
+teardown(void)
+{
+    ws_object_unref(&transaction->m.obj);
+    transaction = NULL;
+}
+
+/**
+ * Run the transaction in slices of `budget` statements and return the topmost
+ * value
+ */
+static intmax_t
+run(
+    size_t budget
+) {
+    struct ws_processor_stack stack;
+    memset(&stack, 0, sizeof(stack));
+    ck_assert(ws_processor_stack_init(&stack) == 0);
+
+    struct ws_processor proc;
+    ck_assert(ws_processor_init(&proc, &stack,
+                                ws_transaction_commands(transaction)) == 0);
+    int res;
+    while ((res = ws_processor_exec_budget(&proc, budget)) == -EINPROGRESS);
+    ck_assert(res == 0);
+
+    union ws_value_union* top;
+    top = (union ws_value_union*) ws_processor_stack_value_at(&stack, -1, NULL);
+    ck_assert(top);
+    ck_assert(ws_value_get_type(&top->value) == WS_VALUE_TYPE_INT);
+    intmax_t retval = ws_value_int_get(&top->int_);
+
+    ws_processor_deinit(&proc);
+    ws_processor_stack_deinit(&stack);
+    return retval;
+}
+
+/**
+ * Test object type for the result cache tests
+ */
+struct memo_object {
+    struct ws_object obj;
+    int32_t val;
+};
+
+static struct ws_object_attribute const MEMO_OBJECT_ATTRS[] = {
+    {
+        .name = "val",
+        .offset_in_struct = offsetof(struct memo_object, val),
+        .type = WS_OBJ_ATTR_TYPE_INT32,
+        .vtype = WS_VALUE_TYPE_INT,
+    },
+    {
+        .name = NULL,
+    },
+};
+
+static ws_object_type_id MEMO_OBJECT_TYPE = {
+    .supertype = &WS_OBJECT_TYPE_ID_OBJECT,
+    .typestr = "memo_object",
+    .attribute_table = MEMO_OBJECT_ATTRS,
+};
+
+/**
+ * Append a statement invoking a command with two integers to a transaction
+ */
+static void
+push_statement(
+    struct ws_transaction* t,
+    char const* cmd,
+    intmax_t a,
+    intmax_t b
+) {
+    struct ws_value_int* va = calloc(1, sizeof(*va));
+    struct ws_value_int* vb = calloc(1, sizeof(*vb));
+    ck_assert(va && vb);
+    ws_value_int_init(va);
+    ws_value_int_set(va, a);
+    ws_value_int_init(vb);
+    ws_value_int_set(vb, b);
+
+    struct ws_statement stmt;
+    ck_assert(ws_statement_init(&stmt, cmd) == 0);
+    ck_assert(ws_statement_append_direct(&stmt, &va->value) == 0);
+    ck_assert(ws_statement_append_direct(&stmt, &vb->value) == 0);
+    ck_assert(ws_transaction_push_statement(t, &stmt) == 0);
+}
+
+/**
+ * Create a transaction invoking a command with two integers
+ */
+static struct ws_transaction*
+mktransaction(
+    char const* cmd,
+    intmax_t a,
+    intmax_t b
+) {
+    struct ws_string* name = ws_string_new();
+    ck_assert(name);
+    ck_assert(ws_string_set_from_raw(name, "memo") == 0);
+
+    struct ws_transaction* t = ws_transaction_new(0, name, 0, NULL);
+    ck_assert(t);
+    ws_object_unref(&name->obj);
+
+    push_statement(t, cmd, a, b);
+    return t;
+}
+
+/*
+ *
+ * Test cases
+ *
+ */
+
+START_TEST (test_stack_reuse) {
+    struct ws_processor_stack stack;
+    ck_assert(ws_processor_stack_acquire(&stack, 0) == 0);
+
+    ck_assert(ws_processor_stack_push(&stack, 20) == 0);
+    ck_assert(ws_processor_stack_pop(&stack, 18) == 0);
+    ck_assert(ws_processor_stack_high_water(&stack) == 20);
+
+    // popping must not shrink the stack
+    union ws_value_union* data = ws_processor_stack_bottom(&stack);
+    ck_assert(ws_processor_stack_push(&stack, 18) == 0);
+    ck_assert(ws_processor_stack_bottom(&stack) == data);
+
+    ws_processor_stack_release(&stack);
+
+    // the next stack acquired on this thread gets the same buffer
+    ck_assert(ws_processor_stack_acquire(&stack, 20) == 0);
+    ck_assert(ws_processor_stack_high_water(&stack) == 0);
+    ck_assert(ws_processor_stack_push(&stack, 20) == 0);
+    ck_assert(ws_processor_stack_bottom(&stack) == data);
+    ws_processor_stack_release(&stack);
+}
+END_TEST
+
+START_TEST (test_memo) {
+    ck_assert(ws_command_init() == 0);
+
+    struct ws_transaction* t1 = mktransaction("add", 1, 2);
+    struct ws_transaction* t2 = mktransaction("add", 1, 2);
+    struct ws_transaction* t3 = mktransaction("add", 1, 3);
+    struct ws_transaction* impure = mktransaction("set_attr", 1, 2);
+    ck_assert(ws_action_memo_cacheable(t1));
+    ck_assert(!ws_action_memo_cacheable(impure));
+
+    struct memo_object* obj;
+    obj = (struct memo_object*) ws_object_new(sizeof(*obj));
+    ck_assert(obj);
+    obj->obj.id = &MEMO_OBJECT_TYPE;
+
+    // pretend the transaction read an attribute of the object
+    struct ws_object_read_log reads;
+    struct ws_value_int val;
+    ws_value_int_init(&val);
+    ws_object_read_log_init(&reads);
+    ws_object_read_log_start(&reads);
+    ck_assert(ws_object_attr_read(&obj->obj, "val", &val.value) == 0);
+    ck_assert(ws_object_attr_read(&obj->obj, "val", &val.value) == 0);
+    ws_object_read_log_stop();
+    ck_assert(reads.num == 1);
+    ck_assert(!reads.incomplete);
+
+    ws_value_int_set(&val, 3);
+    struct ws_reply* reply;
+    reply = (struct ws_reply*) ws_value_reply_new(t1, &val.value);
+    ck_assert(reply);
+    ws_action_memo_store(t1, NULL, reply, &reads);
+    ws_object_unref(&reply->m.obj);
+
+    // an identical transaction hits the cache
+    reply = ws_action_memo_lookup(t2, NULL);
+    ck_assert(reply);
+    ck_assert(reply->m.obj.id == &WS_OBJECT_TYPE_ID_VALUE_REPLY);
+    struct ws_value* res = ws_value_reply_get_value((struct ws_value_reply*)
+                                                    reply);
+    ck_assert(ws_value_get_type(res) == WS_VALUE_TYPE_INT);
+    ck_assert(ws_value_int_get((struct ws_value_int*) res) == 3);
+    ws_object_unref(&reply->m.obj);
+
+    // other arguments or another context don't
+    ck_assert(!ws_action_memo_lookup(t3, NULL));
+    ck_assert(!ws_action_memo_lookup(t2, &obj->obj));
+
+    // changing the object read invalidates the result
+    ws_object_attr_touch(&obj->obj);
+    ck_assert(!ws_action_memo_lookup(t2, NULL));
+
+    // results for a context don't keep it alive, but are dropped with it
+    ws_object_read_log_init(&reads);
+    reply = (struct ws_reply*) ws_value_reply_new(t1, &val.value);
+    ck_assert(reply);
+    ws_action_memo_store(t1, &obj->obj, reply, &reads);
+    ws_object_unref(&reply->m.obj);
+    ck_assert(obj->obj.ref_counting.refcnt == 1);
+
+    reply = ws_action_memo_lookup(t2, &obj->obj);
+    ck_assert(reply);
+    ws_object_unref(&reply->m.obj);
+
+    ws_action_memo_forget(&obj->obj);
+    ck_assert(!ws_action_memo_lookup(t2, &obj->obj));
+
+    ws_action_memo_flush();
+    ws_object_unref(&obj->obj);
+    ws_object_unref(&t1->m.obj);
+    ws_object_unref(&t2->m.obj);
+    ws_object_unref(&t3->m.obj);
+    ws_object_unref(&impure->m.obj);
+}
+END_TEST
+
+START_TEST (test_batch) {
+    ck_assert(ws_command_init() == 0);
+
+    struct ws_transaction* t = mktransaction("add", 1, 2);
+    ck_assert(ws_transaction_start_part(t) == 0);
+    push_statement(t, "mul", 2, 3);
+    ck_assert(ws_transaction_start_part(t) == 0);
+    push_statement(t, "add", 4, 5);
+    ck_assert(ws_transaction_parts_num(t) == 3);
+
+    // run the batch in small slices, the parts share one reply
+    struct ws_action_job job;
+    ws_action_job_init(&job, t, NULL, NULL, NULL);
+    while (!ws_action_job_step(&job, 1));
+    struct ws_reply* reply = ws_action_job_take_reply(&job);
+    ws_action_job_deinit(&job);
+
+    ck_assert(reply);
+    ck_assert(reply->m.obj.id == &WS_OBJECT_TYPE_ID_VALUE_REPLY);
+    struct ws_value* val;
+    val = ws_value_reply_get_value((struct ws_value_reply*) reply);
+    ck_assert(ws_value_get_type(val) == WS_VALUE_TYPE_TABLE);
+
+    struct ws_value_table* table = (struct ws_value_table*) val;
+    ck_assert(ws_value_table_rows(table) == 3);
+    ck_assert(ws_value_table_cols(table) == 1);
+    ck_assert(ws_value_int_get(&ws_value_table_cell(table, 0, 0)->int_) == 3);
+    ck_assert(ws_value_int_get(&ws_value_table_cell(table, 1, 0)->int_) == 6);
+    ck_assert(ws_value_int_get(&ws_value_table_cell(table, 2, 0)->int_) == 9);
+    ws_object_unref(&reply->m.obj);
+
+    // a failing part fails the whole batch
+    ck_assert(ws_transaction_start_part(t) == 0);
+    push_statement(t, "div", 1, 0);
+
+    ws_action_job_init(&job, t, NULL, NULL, NULL);
+    while (!ws_action_job_step(&job, SIZE_MAX));
+    reply = ws_action_job_take_reply(&job);
+    ws_action_job_deinit(&job);
+
+    ck_assert(reply);
+    ck_assert(reply->m.obj.id == &WS_OBJECT_TYPE_ID_ERROR_REPLY);
+    ws_object_unref(&reply->m.obj);
+
+    ws_object_unref(&t->m.obj);
+}
+END_TEST
+
+START_TEST (test_processor_interpreted) {
+    ck_assert(run(SIZE_MAX) == 7);
+}
+END_TEST
+
+START_TEST (test_processor_sliced) {
+    // interrupted runs must resume where they left off
+    ck_assert(run(1) == 7);
+    ck_assert(ws_transaction_compile(transaction) == 0);
+    ck_assert(run(1) == 7);
+}
+END_TEST
+
+START_TEST (test_processor_compiled) {
+    ck_assert(ws_transaction_compile(transaction) == 0);
+    ck_assert(ws_transaction_commands(transaction)->code);
+
+    // the bytecode must be reusable
+    ck_assert(run(SIZE_MAX) == 7);
+    ck_assert(run(SIZE_MAX) == 7);
+}
+END_TEST
+
+/*
+ *
+ * main()
+ *
+ */
+
 static Suite*
 actionmanager_suite(void)
 {
     Suite* s    = suite_create("Actionmanager");
     TCase* tc   = tcase_create("main case");
+    TCase* tcp  = tcase_create("processor case");
 
     suite_add_tcase(s, tc);
-    // tcase_add_checked_fixture(tc, setup, cleanup); // Not used yet
+    suite_add_tcase(s, tcp);
+    tcase_add_checked_fixture(tcp, setup, teardown);
 
-    //tcase_add_tests(tc, ...);
+    tcase_add_test(tc, test_stack_reuse);
+    tcase_add_test(tc, test_memo);
+    tcase_add_test(tc, test_batch);
+    tcase_add_test(tcp, test_processor_interpreted);
+    tcase_add_test(tcp, test_processor_compiled);
+    tcase_add_test(tcp, test_processor_sliced);
 
     return s;
 }
@@ -38,7 +38,302 @@
  */
 
 #include <check.h>
+#include <stddef.h>
+#include <stdlib.h>
+
 #include "tests.h"
+#include "command/command.h"
+#include "objects/object.h"
+#include "objects/ordered_set.h"
+#include "objects/set.h"
+#include "objects/string.h"
+#include "values/bool.h"
+#include "values/int.h"
+#include "values/object_id.h"
+#include "values/ordered_set.h"
+#include "values/set.h"
+#include "values/string.h"
+#include "values/table.h"
+#include "values/union.h"
+
+/*
+ *
+ * Test object type
+ *
+ */
+
+struct test_object {
+    struct ws_object obj;
+    int32_t x;
+    int32_t y;
+};
+
+static struct ws_object_attribute const TEST_OBJECT_ATTRS[] = {
+    {
+        .name = "x",
+        .offset_in_struct = offsetof(struct test_object, x),
+        .type = WS_OBJ_ATTR_TYPE_INT32,
+        .vtype = WS_VALUE_TYPE_INT,
+    },
+    {
+        .name = "y",
+        .offset_in_struct = offsetof(struct test_object, y),
+        .type = WS_OBJ_ATTR_TYPE_INT32,
+        .vtype = WS_VALUE_TYPE_INT,
+    },
+    {
+        .name = NULL,
+    },
+};
+
+static ws_object_type_id TEST_OBJECT_TYPE = {
+    .supertype = &WS_OBJECT_TYPE_ID_OBJECT,
+    .typestr = "test_object",
+    .attribute_table = TEST_OBJECT_ATTRS,
+};
+
+static struct test_object*
+test_object_new(
+    int32_t x,
+    int32_t y
+) {
+    struct test_object* o = (struct test_object*) ws_object_new(sizeof(*o));
+    ck_assert(o != NULL);
+    o->obj.id = &TEST_OBJECT_TYPE;
+    o->x = x;
+    o->y = y;
+    return o;
+}
+
+/**
+ * Run a regular command on a stack
+ */
+static int
+run_cmd(
+    char const* name,
+    union ws_value_union* stack
+) {
+    struct ws_command const* cmd = ws_command_get(name);
+    ck_assert(cmd != NULL);
+    ck_assert(cmd->command_type == regular);
+    return cmd->func.regular(stack);
+}
+
+/**
+ * Resolve an attribute handle via the `attr_handle` command
+ */
+static intmax_t
+resolve(
+    struct test_object* o,
+    char const* attr
+) {
+    union ws_value_union stack[3];
+    memset(stack, 0, sizeof(stack));
+
+    ws_value_object_id_init(&stack[0].object_id);
+    ws_value_object_id_set(&stack[0].object_id, &o->obj);
+    ws_value_string_init(&stack[1].string);
+    ws_string_set_from_raw(stack[1].string.str, attr);
+
+    ck_assert(0 == run_cmd("attr_handle", stack));
+    ck_assert(WS_VALUE_TYPE_INT == ws_value_get_type(&stack[0].value));
+    intmax_t handle = ws_value_int_get(&stack[0].int_);
+
+    ws_value_deinit(&stack[0].value);
+    ws_value_deinit(&stack[1].value);
+    return handle;
+}
+
+/**
+ * Run a set command on two sets, each built from two objects
+ *
+ * @return the cardinality of the resulting set
+ */
+static size_t
+run_set_cmd(
+    char const* name,
+    struct ws_object* a0,
+    struct ws_object* a1,
+    struct ws_object* b0,
+    struct ws_object* b1
+) {
+    union ws_value_union stack[3];
+    memset(stack, 0, sizeof(stack));
+
+    ck_assert(0 == ws_value_set_init(&stack[0].set));
+    ck_assert(0 == ws_value_set_insert(&stack[0].set, a0));
+    ck_assert(0 == ws_value_set_insert(&stack[0].set, a1));
+    ck_assert(0 == ws_value_set_init(&stack[1].set));
+    ck_assert(0 == ws_value_set_insert(&stack[1].set, b0));
+    ck_assert(0 == ws_value_set_insert(&stack[1].set, b1));
+    struct ws_set* first = stack[0].set.set;
+
+    ck_assert(0 == run_cmd(name, stack));
+    ck_assert(WS_VALUE_TYPE_SET == ws_value_get_type(&stack[0].value));
+    // the result is a new set rather than the first argument
+    ck_assert(first != stack[0].set.set);
+    size_t card = ws_value_set_cardinality(&stack[0].set);
+
+    ws_value_deinit(&stack[0].value);
+    ws_value_deinit(&stack[1].value);
+    return card;
+}
+
+/*
+ *
+ * Tests
+ *
+ */
+
+START_TEST (test_cmd_get_attrs) {
+    struct test_object* a = test_object_new(1, 2);
+    struct test_object* b = test_object_new(3, 4);
+
+    intmax_t hx = resolve(a, "x");
+    intmax_t hy = resolve(a, "y");
+    ck_assert(hx > 0);
+    ck_assert(hy > 0);
+    ck_assert(hx != hy);
+
+    // read y and x of both objects in one go
+    union ws_value_union stack[5];
+    memset(stack, 0, sizeof(stack));
+    ws_value_int_init(&stack[0].int_);
+    ws_value_int_set(&stack[0].int_, hy);
+    ws_value_int_init(&stack[1].int_);
+    ws_value_int_set(&stack[1].int_, hx);
+    ws_value_object_id_init(&stack[2].object_id);
+    ws_value_object_id_set(&stack[2].object_id, &a->obj);
+    ws_value_object_id_init(&stack[3].object_id);
+    ws_value_object_id_set(&stack[3].object_id, &b->obj);
+
+    ck_assert(0 == run_cmd("get_attrs", stack));
+    ck_assert(WS_VALUE_TYPE_TABLE == ws_value_get_type(&stack[0].value));
+
+    struct ws_value_table* table = &stack[0].table;
+    ck_assert(2 == ws_value_table_rows(table));
+    ck_assert(3 == ws_value_table_cols(table));
+
+    ck_assert(a == (struct test_object*)
+                   ws_value_table_cell(table, 0, 0)->object_id.obj);
+    ck_assert(2 == ws_value_int_get(&ws_value_table_cell(table, 0, 1)->int_));
+    ck_assert(1 == ws_value_int_get(&ws_value_table_cell(table, 0, 2)->int_));
+    ck_assert(b == (struct test_object*)
+                   ws_value_table_cell(table, 1, 0)->object_id.obj);
+    ck_assert(4 == ws_value_int_get(&ws_value_table_cell(table, 1, 1)->int_));
+    ck_assert(3 == ws_value_int_get(&ws_value_table_cell(table, 1, 2)->int_));
+
+    for (size_t i = 0; i < 4; ++i) {
+        ws_value_deinit(&stack[i].value);
+    }
+    ws_object_unref(&a->obj);
+    ws_object_unref(&b->obj);
+}
+END_TEST
+
+START_TEST (test_cmd_set_ops) {
+    struct test_object* a = test_object_new(1, 2);
+    struct test_object* b = test_object_new(3, 4);
+    struct test_object* c = test_object_new(5, 6);
+
+    ck_assert(3 == run_set_cmd("set_union", &a->obj, &b->obj,
+                                            &b->obj, &c->obj));
+    ck_assert(1 == run_set_cmd("set_intersection", &a->obj, &b->obj,
+                                                   &b->obj, &c->obj));
+    ck_assert(2 == run_set_cmd("set_xor", &a->obj, &b->obj,
+                                          &b->obj, &c->obj));
+
+    // { b } is a subset of { a, b } but not the other way round
+    union ws_value_union stack[3];
+    memset(stack, 0, sizeof(stack));
+    ck_assert(0 == ws_value_set_init(&stack[0].set));
+    ck_assert(0 == ws_value_set_insert(&stack[0].set, &b->obj));
+    ck_assert(0 == ws_value_set_init(&stack[1].set));
+    ck_assert(0 == ws_value_set_insert(&stack[1].set, &a->obj));
+    ck_assert(0 == ws_value_set_insert(&stack[1].set, &b->obj));
+
+    ck_assert(0 == run_cmd("set_is_subset", stack));
+    ck_assert(WS_VALUE_TYPE_BOOL == ws_value_get_type(&stack[0].value));
+    ck_assert(ws_value_bool_get(&stack[0].bool_));
+
+    ws_value_deinit(&stack[0].value);
+    ws_value_deinit(&stack[1].value);
+
+    ws_object_unref(&a->obj);
+    ws_object_unref(&b->obj);
+    ws_object_unref(&c->obj);
+}
+END_TEST
+
+START_TEST (test_cmd_ordered_set) {
+    struct test_object* a = test_object_new(1, 2);
+    struct test_object* b = test_object_new(3, 4);
+    struct test_object* c = test_object_new(5, 6);
+
+    // build an ordered set from an object and a set
+    union ws_value_union stack[4];
+    memset(stack, 0, sizeof(stack));
+    ws_value_object_id_init(&stack[0].object_id);
+    ws_value_object_id_set(&stack[0].object_id, &a->obj);
+    ck_assert(0 == ws_value_set_init(&stack[1].set));
+    ck_assert(0 == ws_value_set_insert(&stack[1].set, &b->obj));
+    ck_assert(0 == ws_value_set_insert(&stack[1].set, &c->obj));
+
+    ck_assert(0 == run_cmd("ordered_set", stack));
+    ck_assert(WS_VALUE_TYPE_ORDERED_SET == ws_value_get_type(&stack[0].value));
+    ck_assert(3 == ws_value_ordered_set_cardinality(&stack[0].ordered_set));
+    ws_value_deinit(&stack[1].value);
+
+    struct ws_ordered_set* set;
+    set = ws_value_ordered_set_get(&stack[0].ordered_set);
+    struct ws_object* max = ws_ordered_set_max(set);
+    ws_value_deinit(&stack[0].value);
+
+    // negative positions count from the end
+    ws_value_ordered_set_init_set(&stack[0].ordered_set, set);
+    ws_value_int_init(&stack[1].int_);
+    ws_value_int_set(&stack[1].int_, -1);
+    ck_assert(0 == run_cmd("ordered_set_at", stack));
+    ck_assert(WS_VALUE_TYPE_OBJECT_ID == ws_value_get_type(&stack[0].value));
+    ck_assert(max == stack[0].object_id.obj);
+    ws_value_deinit(&stack[0].value);
+
+    // positions out of range yield nil
+    ws_value_ordered_set_init_set(&stack[0].ordered_set, set);
+    ws_value_int_set(&stack[1].int_, 3);
+    ck_assert(0 == run_cmd("ordered_set_at", stack));
+    ck_assert(WS_VALUE_TYPE_NIL == ws_value_get_type(&stack[0].value));
+    ws_value_deinit(&stack[0].value);
+    ws_value_deinit(&stack[1].value);
+
+    ws_value_ordered_set_init_set(&stack[0].ordered_set, set);
+    ws_value_object_id_init(&stack[1].object_id);
+    ws_value_object_id_set(&stack[1].object_id, max);
+    ck_assert(0 == run_cmd("ordered_set_rank", stack));
+    ck_assert(WS_VALUE_TYPE_INT == ws_value_get_type(&stack[0].value));
+    ck_assert(2 == ws_value_int_get(&stack[0].int_));
+    ws_value_deinit(&stack[0].value);
+    ws_value_deinit(&stack[1].value);
+
+    // slicing off the first element keeps the greatest one
+    ws_value_ordered_set_init_set(&stack[0].ordered_set, set);
+    ws_value_int_init(&stack[1].int_);
+    ws_value_int_set(&stack[1].int_, 1);
+    ck_assert(0 == run_cmd("ordered_set_slice", stack));
+    ck_assert(WS_VALUE_TYPE_ORDERED_SET == ws_value_get_type(&stack[0].value));
+    ck_assert(set != stack[0].ordered_set.set);
+    ck_assert(2 == ws_value_ordered_set_cardinality(&stack[0].ordered_set));
+    ck_assert(1 == ws_ordered_set_rank(stack[0].ordered_set.set, max));
+    ws_value_deinit(&stack[0].value);
+    ws_value_deinit(&stack[1].value);
+
+    ws_object_unref(max);
+    ws_object_unref(&set->obj);
+    ws_object_unref(&a->obj);
+    ws_object_unref(&b->obj);
+    ws_object_unref(&c->obj);
+}
+END_TEST
 
 static Suite*
 commandprocessor_suite(void)
@@ -49,7 +344,9 @@ commandprocessor_suite(void)
     suite_add_tcase(s, tc);
     // tcase_add_checked_fixture(tc, setup, cleanup); // Not used yet
 
-    //tcase_add_tests(tc, ...);
+    tcase_add_test(tc, test_cmd_get_attrs);
+    tcase_add_test(tc, test_cmd_set_ops);
+    tcase_add_test(tc, test_cmd_ordered_set);
 
     return s;
 }
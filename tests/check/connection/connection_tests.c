@@ -38,18 +38,257 @@
  */
 
 #include <check.h>
+#include <errno.h>
+#include <ev.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
 #include "tests.h"
 
+#include "connection/connector.h"
+#include "connection/event_ring.h"
+#include "connection/processor.h"
+#include "serialize/json/deserializer.h"
+#include "serialize/json/serializer.h"
+
+/*
+ *
+ * Helpers
+ *
+ */
+
+static struct ws_event_ring_header*
+map_ring(
+    int* reader,
+    int* eventfd
+) {
+    int memfd;
+    *reader = ws_event_ring_open(&memfd, eventfd);
+    ck_assert(*reader >= 0);
+
+    struct ws_event_ring_header hdr;
+    ck_assert(read(memfd, &hdr, sizeof(hdr)) == sizeof(hdr));
+    ck_assert(hdr.magic == WS_EVENT_RING_MAGIC);
+    ck_assert(hdr.version == WS_EVENT_RING_VERSION);
+    ck_assert(hdr.record_size == sizeof(struct ws_event_record));
+
+    size_t size = sizeof(hdr) + hdr.capacity * hdr.record_size;
+    void* mem = mmap(NULL, size, PROT_READ, MAP_SHARED, memfd, 0);
+    ck_assert(mem != MAP_FAILED);
+
+    // the descriptor handed out must be read-only
+    ck_assert(mmap(NULL, size, PROT_WRITE, MAP_SHARED, memfd, 0) ==
+              MAP_FAILED);
+
+    close(memfd);
+    return mem;
+}
+
+/*
+ *
+ * Test cases
+ *
+ */
+
+START_TEST (test_event_ring_read) {
+    int reader;
+    int eventfd;
+    struct ws_event_ring_header* ring = map_ring(&reader, &eventfd);
+
+    uint64_t cursor = ring->head;
+    struct ws_event_record rec;
+    ck_assert(ws_event_ring_read(ring, &cursor, &rec) == -EAGAIN);
+
+    for (int i = 0; i < 10; ++i) {
+        struct ws_event_record ev = {
+            .type   = WS_EVENT_RECORD_KEY,
+            .code   = i,
+            .value  = 1,
+        };
+        ws_event_ring_push(&ev);
+    }
+
+    for (int i = 0; i < 10; ++i) {
+        ck_assert(ws_event_ring_read(ring, &cursor, &rec) == 0);
+        ck_assert(rec.type == WS_EVENT_RECORD_KEY);
+        ck_assert(rec.code == (uint32_t) i);
+        ck_assert(rec.flags == 0);
+        ck_assert(rec.seq == cursor);
+    }
+    ck_assert(ws_event_ring_read(ring, &cursor, &rec) == -EAGAIN);
+
+    close(eventfd);
+    ws_event_ring_close(reader);
+}
+END_TEST
+
+START_TEST (test_event_ring_overrun) {
+    int reader;
+    int eventfd;
+    struct ws_event_ring_header* ring = map_ring(&reader, &eventfd);
+
+    uint64_t cursor = ring->head;
+    uint64_t num = ring->capacity + 10;
+    for (uint64_t i = 0; i < num; ++i) {
+        struct ws_event_record ev = {
+            .type   = WS_EVENT_RECORD_POINTER_MOTION,
+            .x      = i,
+        };
+        ws_event_ring_push(&ev);
+    }
+
+    // the oldest records were overwritten, which must be flagged
+    struct ws_event_record rec;
+    ck_assert(ws_event_ring_read(ring, &cursor, &rec) == 0);
+    ck_assert(rec.flags & WS_EVENT_RECORD_FLAG_LOST);
+    ck_assert(rec.x == 10);
+
+    ck_assert(ws_event_ring_read(ring, &cursor, &rec) == 0);
+    ck_assert(rec.flags == 0);
+    ck_assert(rec.x == 11);
+
+    close(eventfd);
+    ws_event_ring_close(reader);
+}
+END_TEST
+
+START_TEST (test_event_ring_wakeup) {
+    int reader[2];
+    int eventfd[2];
+    map_ring(&reader[0], &eventfd[0]);
+    map_ring(&reader[1], &eventfd[1]);
+
+    struct ws_event_record ev = {
+        .type   = WS_EVENT_RECORD_KEY,
+    };
+    ws_event_ring_push(&ev);
+    ev_loop(EV_DEFAULT_ EVLOOP_NONBLOCK);
+
+    // every reader must be woken up, not just the first one reading
+    uint64_t val;
+    ck_assert(read(eventfd[0], &val, sizeof(val)) == sizeof(val));
+    ck_assert(read(eventfd[1], &val, sizeof(val)) == sizeof(val));
+
+    // readers which are gone are not woken up anymore
+    ws_event_ring_close(reader[0]);
+    ws_event_ring_push(&ev);
+    ev_loop(EV_DEFAULT_ EVLOOP_NONBLOCK);
+    ck_assert(read(eventfd[0], &val, sizeof(val)) < 0);
+    ck_assert(read(eventfd[1], &val, sizeof(val)) == sizeof(val));
+
+    close(eventfd[0]);
+    close(eventfd[1]);
+    ws_event_ring_close(reader[1]);
+}
+END_TEST
+
+START_TEST (test_connector_attach_fd) {
+    int sv[2];
+    ck_assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+
+    struct ws_connector conn;
+    ck_assert(ws_connector_init(&conn, sv[0]) == 0);
+
+    int pipefd[2];
+    ck_assert(pipe(pipefd) == 0);
+    ck_assert(ws_connector_attach_fd(&conn, pipefd[1]) == 0);
+
+    char* buf = ws_connbuf_reserve(&conn.outbuf, 1);
+    ck_assert(buf);
+    *buf = 'x';
+    ck_assert(ws_connbuf_append(&conn.outbuf, 1) == 0);
+    ck_assert(ws_connector_flush(&conn) == 0);
+    ck_assert(conn.fds_num == 0);
+
+    // receive the data along with the descriptor
+    char data;
+    char control[CMSG_SPACE(sizeof(int))];
+    struct iovec iov = { .iov_base = &data, .iov_len = 1 };
+    struct msghdr msg = {
+        .msg_iov        = &iov,
+        .msg_iovlen     = 1,
+        .msg_control    = control,
+        .msg_controllen = sizeof(control),
+    };
+    ck_assert(recvmsg(sv[1], &msg, 0) == 1);
+    ck_assert(data == 'x');
+
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    ck_assert(cmsg);
+    ck_assert(cmsg->cmsg_type == SCM_RIGHTS);
+    int fd;
+    memcpy(&fd, CMSG_DATA(cmsg), sizeof(fd));
+
+    // the descriptor received must refer to the pipe
+    ck_assert(write(fd, "y", 1) == 1);
+    ck_assert(read(pipefd[0], &data, 1) == 1);
+    ck_assert(data == 'y');
+
+    close(fd);
+    close(pipefd[0]);
+    close(sv[1]);
+    ws_connector_deinit(&conn);
+}
+END_TEST
+
+START_TEST (test_processor_throttle) {
+    int sv[2];
+    ck_assert(socketpair(AF_UNIX, SOCK_STREAM, 0, sv) == 0);
+
+    struct ws_connection_processor* proc;
+    proc = ws_connection_processor_new(sv[0],
+                                       ws_serializer_json_deserializer_new(),
+                                       ws_serializer_json_serializer_new());
+    ck_assert(proc);
+    ck_assert(ws_connection_processor_start(proc) == 0);
+
+    // pretend lots of messages were handed off, well past the high water mark
+    size_t num = 1024;
+    proc->replies_num = num;
+    ev_loop(EV_DEFAULT_ EVLOOP_NONBLOCK);
+    ck_assert(proc->is_throttled);
+
+    // e.g. registrations and events don't have a reply
+    while (num--) {
+        ck_assert(ws_connection_processor_post_reply(proc, NULL) == 0);
+    }
+    ev_loop(EV_DEFAULT_ EVLOOP_NONBLOCK);
+    ck_assert(!proc->is_throttled);
+    ck_assert(proc->replies_num == 0);
+
+    ws_connection_processor_close(proc);
+    ws_object_unref(&proc->obj);
+    close(sv[1]);
+}
+END_TEST
+
+/*
+ *
+ * main()
+ *
+ */
+
 static Suite*
 connectionmanager_suite(void)
 {
     Suite* s    = suite_create("Connectionmanager");
     TCase* tc   = tcase_create("main case");
+    TCase* tcr  = tcase_create("event ring case");
+    TCase* tcp  = tcase_create("processor case");
 
     suite_add_tcase(s, tc);
+    suite_add_tcase(s, tcr);
+    suite_add_tcase(s, tcp);
     // tcase_add_checked_fixture(tc, setup, cleanup); // Not used yet
 
-    //tcase_add_tests(tc, ...);
+    tcase_add_test(tc, test_connector_attach_fd);
+
+    tcase_add_test(tcr, test_event_ring_read);
+    tcase_add_test(tcr, test_event_ring_overrun);
+    tcase_add_test(tcr, test_event_ring_wakeup);
+
+    tcase_add_test(tcp, test_processor_throttle);
 
     return s;
 }
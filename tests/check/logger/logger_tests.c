@@ -38,7 +38,260 @@
  */
 
 #include <check.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <syslog.h>
+#include <unistd.h>
+
 #include "tests.h"
+#include "logger/module.h"
+
+#define THREADS (4)
+#define THREAD_MESSAGES (2000)
+
+static struct ws_logger_context log_ctx = { .prefix = "[Test] " };
+
+/**
+ * File the log output is redirected to
+ */
+static FILE* log_file = NULL;
+
+static void
+setup(void)
+{
+    setenv("WAYSOME_LOG_LEVEL", "7", 1);
+    ws_logger_init();
+
+    log_file = tmpfile();
+    ck_assert(log_file);
+    ck_assert(dup2(fileno(log_file), STDERR_FILENO) >= 0);
+}
+
+static void
+cleanup(void)
+{
+    fclose(log_file);
+}
+
+/**
+ * Read everything written to the log file so far, without flushing
+ */
+static char*
+read_written(void)
+{
+    long len = lseek(fileno(log_file), 0, SEEK_END);
+    ck_assert(len >= 0);
+
+    char* buf = calloc(len + 1, 1);
+    ck_assert(buf);
+    ck_assert(pread(fileno(log_file), buf, len, 0) == len);
+
+    return buf;
+}
+
+/**
+ * Read everything logged so far
+ */
+static char*
+read_log(void)
+{
+    ws_logger_flush();
+    return read_written();
+}
+
+/*
+ *
+ * Tests
+ *
+ */
+
+START_TEST (test_log_format) {
+    char expected[512];
+    char transient[] = "transient";
+    int i = -42;
+    double d = 3.14159;
+
+    snprintf(expected, sizeof(expected),
+             "[Test] %d|%5.2f|%-4s|%.*s|%zu|%x|%%|%c|%lld|%p|%s\n"
+             "[Test] %*d|%.3s\n"
+             "no prefix\n",
+             i, d, "ab", 3, "abcdef", (size_t) 7, 255u, 'c', -1ll,
+             (void*) &i, transient, 6, 17, "truncated");
+
+    ws_log(&log_ctx, LOG_DEBUG,
+           "%d|%5.2f|%-4s|%.*s|%zu|%x|%%|%c|%lld|%p|%s",
+           i, d, "ab", 3, "abcdef", (size_t) 7, 255u, 'c', -1ll,
+           (void*) &i, transient);
+    ws_log(&log_ctx, LOG_DEBUG, "%*d|%.3s", 6, 17, "truncated");
+    ws_log(NULL, LOG_DEBUG, "no prefix");
+
+    // strings are copied, the buffer may be reused right away
+    strcpy(transient, "overwrite");
+
+    char* log = read_log();
+    ck_assert_str_eq(log, expected);
+    free(log);
+}
+END_TEST
+
+START_TEST (test_log_many_args) {
+    char expected[128];
+
+    // more arguments than a record holds are formatted right away
+    snprintf(expected, sizeof(expected),
+             "[Test] %d %d %d %d %d %d %d %d %d %d %s\n",
+             1, 2, 3, 4, 5, 6, 7, 8, 9, 10, "end");
+    ws_log(&log_ctx, LOG_DEBUG, "%d %d %d %d %d %d %d %d %d %d %s",
+           1, 2, 3, 4, 5, 6, 7, 8, 9, 10, "end");
+
+    char* log = read_log();
+    ck_assert_str_eq(log, expected);
+    free(log);
+}
+END_TEST
+
+START_TEST (test_log_ary) {
+    char* ary[] = { "foo", " ", "bar", NULL };
+
+    ws_log_ary(&log_ctx, LOG_DEBUG, ary);
+    ws_log_ary(NULL, LOG_DEBUG, ary);
+
+    char* log = read_log();
+    ck_assert_str_eq(log, "[Test] foo bar\nfoo bar\n");
+    free(log);
+}
+END_TEST
+
+START_TEST (test_log_level) {
+    ws_log(&log_ctx, LOG_DEBUG, "shown");
+    ws_log(&log_ctx, LOG_DEBUG + 1, "hidden");
+
+    char* log = read_log();
+    ck_assert_str_eq(log, "[Test] shown\n");
+    free(log);
+}
+END_TEST
+
+START_TEST (test_log_serious) {
+    char* ary[] = { "crit", NULL };
+    static char const expected[] = "[Test] err\n[Test] crit\n";
+
+    // fill the ring, some of these may well be dropped
+    for (int i = 0; i < THREAD_MESSAGES; ++i) {
+        ws_log(&log_ctx, LOG_DEBUG, "message %d", i);
+    }
+    ws_log(&log_ctx, LOG_ERR, "err");
+    ws_log_ary(&log_ctx, LOG_CRIT, ary);
+
+    // serious messages are written right away, after those queued before
+    char* log = read_written();
+    size_t len = strlen(log);
+    ck_assert(len >= sizeof(expected) - 1);
+    ck_assert_str_eq(log + len - (sizeof(expected) - 1), expected);
+    free(log);
+}
+END_TEST
+
+START_TEST (test_log_module_levels) {
+    struct ws_logger_context test = { .prefix = "[Test] " };
+    struct ws_logger_context sub = { .prefix = "[Test/Sub] " };
+    struct ws_logger_context testing = { .prefix = "[Testing] " };
+    struct ws_logger_context none = { .prefix = NULL };
+
+    ck_assert(ws_logger_set_levels("err, test:debug,TEST/sub : warn") == 0);
+    ck_assert(ws_logger_level(&test) == LOG_DEBUG);
+    ck_assert(ws_logger_level(&sub) == LOG_WARNING);
+    ck_assert(ws_logger_level(&testing) == LOG_ERR);
+    ck_assert(ws_logger_level(&none) == LOG_ERR);
+    ck_assert(ws_logger_level(NULL) == LOG_ERR);
+
+    ck_assert(ws_log_enabled(&test, LOG_DEBUG));
+    ck_assert(!ws_log_enabled(&sub, LOG_NOTICE));
+    ck_assert(ws_log_enabled(&sub, LOG_WARNING));
+
+    // malformed configurations do not change anything
+    ck_assert(ws_logger_set_levels("test:verbose") == -EINVAL);
+    ck_assert(ws_logger_set_levels(":debug") == -EINVAL);
+    ck_assert(ws_log_enabled(&test, LOG_DEBUG));
+
+    // cached levels are updated
+    ck_assert(ws_logger_set_levels("4,test:off") == 0);
+    ck_assert(!ws_log_enabled(&test, LOG_EMERG));
+    ck_assert(!ws_log_enabled(&sub, LOG_EMERG));
+    ck_assert(ws_log_enabled(&testing, LOG_WARNING));
+    ck_assert(!ws_log_enabled(&testing, LOG_NOTICE));
+
+    // arguments are not evaluated for disabled levels
+    int evaluated = 0;
+    ws_log(&test, LOG_ERR, "%d", ++evaluated);
+    ws_log(&testing, LOG_ERR, "%d", ++evaluated);
+    ck_assert(evaluated == 1);
+
+    ck_assert(ws_logger_set_levels("debug") == 0);
+
+    char* log = read_log();
+    ck_assert_str_eq(log, "[Testing] 1\n");
+    free(log);
+}
+END_TEST
+
+/**
+ * Log a bunch of messages
+ */
+static void*
+log_messages(
+    void* arg
+) {
+    int thread = (intptr_t) arg;
+
+    for (int i = 0; i < THREAD_MESSAGES; ++i) {
+        ws_log(NULL, LOG_DEBUG, "thread %d message %d", thread, i);
+    }
+
+    return NULL;
+}
+
+START_TEST (test_log_threads) {
+    pthread_t threads[THREADS];
+    size_t dropped = ws_logger_dropped();
+
+    for (intptr_t i = 0; i < THREADS; ++i) {
+        ck_assert(pthread_create(threads + i, NULL, log_messages,
+                                 (void*) i) == 0);
+    }
+    for (int i = 0; i < THREADS; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+    char* log = read_log();
+
+    // messages may be dropped, but those written are in order
+    int last[THREADS] = { -1, -1, -1, -1 };
+    size_t lines = 0;
+    char* line = strtok(log, "\n");
+    while (line) {
+        int thread;
+        int message;
+        if (sscanf(line, "thread %d message %d", &thread, &message) == 2) {
+            ck_assert(thread >= 0 && thread < THREADS);
+            ck_assert(message > last[thread]);
+            last[thread] = message;
+            ++lines;
+        } else {
+            ck_assert(strstr(line, "messages dropped"));
+        }
+        line = strtok(NULL, "\n");
+    }
+    free(log);
+
+    dropped = ws_logger_dropped() - dropped;
+    ck_assert(lines + dropped == THREADS * THREAD_MESSAGES);
+}
+END_TEST
 
 static Suite*
 logger_suite(void)
@@ -47,9 +300,15 @@ logger_suite(void)
     TCase* tc   = tcase_create("main case");
 
     suite_add_tcase(s, tc);
-    // tcase_add_checked_fixture(tc, setup, cleanup); // Not used yet
+    tcase_add_checked_fixture(tc, setup, cleanup);
 
-    //tcase_add_tests(tc, ...);
+    tcase_add_test(tc, test_log_format);
+    tcase_add_test(tc, test_log_many_args);
+    tcase_add_test(tc, test_log_ary);
+    tcase_add_test(tc, test_log_level);
+    tcase_add_test(tc, test_log_serious);
+    tcase_add_test(tc, test_log_module_levels);
+    tcase_add_test(tc, test_log_threads);
 
     return s;
 }
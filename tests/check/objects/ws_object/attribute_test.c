@@ -32,6 +32,7 @@
 #include "util/string.h"
 #include "values/int.h"
 #include "values/string.h"
+#include "values/union.h"
 
 #define TEST_INT 1
 #define TEST_CHR 'a'
@@ -76,6 +77,26 @@ struct ws_object_attribute const WS_OBJECT_ATTRS_TEST_OBJ[] = {
     },
 };
 
+static int
+test_func_base(
+    union ws_value_union* stack
+) {
+    return 1;
+}
+
+static int
+test_func_inherited(
+    union ws_value_union* stack
+) {
+    return 2;
+}
+
+struct ws_object_function const WS_OBJECT_FUNCS_TEST_OBJ[] = {
+    { .name = "base",       .func = test_func_base },
+    { .name = "shadowed",   .func = test_func_base },
+    { .name = NULL,         .func = NULL },
+};
+
 ws_object_type_id WS_OBJECT_TYPE_ID_TESTOBJ = {
     .supertype  = &WS_OBJECT_TYPE_ID_OBJECT,
     .typestr    = "ws_test_object",
@@ -84,6 +105,7 @@ ws_object_type_id WS_OBJECT_TYPE_ID_TESTOBJ = {
     .hash_callback      = NULL,
     .cmp_callback       = NULL,
     .attribute_table = WS_OBJECT_ATTRS_TEST_OBJ,
+    .function_table = WS_OBJECT_FUNCS_TEST_OBJ,
 };
 
 struct ws_test_inherited_object {
@@ -129,6 +151,12 @@ struct ws_object_attribute const WS_OBJECT_ATTRS_TEST_INHERIT_OBJ[] = {
     },
 };
 
+struct ws_object_function const WS_OBJECT_FUNCS_TEST_INHERIT_OBJ[] = {
+    { .name = "shadowed",   .func = test_func_inherited },
+    { .name = "inherited",  .func = test_func_inherited },
+    { .name = NULL,         .func = NULL },
+};
+
 ws_object_type_id WS_OBJECT_TYPE_ID_TESTOBJ_INHERIT = {
     .supertype  = &WS_OBJECT_TYPE_ID_TESTOBJ,
     .typestr    = "ws_test_inherited_object",
@@ -137,6 +165,7 @@ ws_object_type_id WS_OBJECT_TYPE_ID_TESTOBJ_INHERIT = {
     .hash_callback      = NULL,
     .cmp_callback       = NULL,
     .attribute_table = WS_OBJECT_ATTRS_TEST_INHERIT_OBJ,
+    .function_table = WS_OBJECT_FUNCS_TEST_INHERIT_OBJ,
 };
 
 static int
@@ -186,6 +215,8 @@ ws_test_inherited_object_new(void)
         return NULL;
     }
 
+    to->obj.obj.id = &WS_OBJECT_TYPE_ID_TESTOBJ_INHERIT;
+
     to->int_attribute = TEST_INT;
     to->char_attribute = TEST_CHR;
     to->string_attribute = TEST_STR;
@@ -366,3 +397,63 @@ START_TEST (test_object_attribute_write_basetype) {
 }
 END_TEST
 
+START_TEST (test_object_function_basetype) {
+    struct ws_test_inherited_object* to = ws_test_inherited_object_new();
+    ck_assert(to);
+
+    union ws_value_union stack;
+
+    ck_assert(ws_object_has_cmd(&to->obj.obj, "base"));
+    ck_assert(ws_object_has_cmd(&to->obj.obj, "inherited"));
+    ck_assert(!ws_object_has_cmd(&to->obj.obj, "nonexistent"));
+
+    // functions of supertypes are found, subtypes shadow them
+    ck_assert(1 == ws_object_call_cmd(&to->obj.obj, "base", &stack));
+    ck_assert(2 == ws_object_call_cmd(&to->obj.obj, "inherited", &stack));
+    ck_assert(2 == ws_object_call_cmd(&to->obj.obj, "shadowed", &stack));
+    ck_assert(-ENOENT == ws_object_call_cmd(&to->obj.obj, "nonexistent",
+                                            &stack));
+
+    // the supertype doesn't see the subtype's functions
+    ck_assert(NULL == ws_object_type_get_function(&WS_OBJECT_TYPE_ID_TESTOBJ,
+                                                  "inherited"));
+    ck_assert(test_func_base == ws_object_type_get_function(
+              &WS_OBJECT_TYPE_ID_TESTOBJ, "shadowed")->func);
+
+    ws_object_unref(&to->obj.obj);
+}
+END_TEST
+
+START_TEST (test_object_attribute_handle) {
+    struct ws_test_inherited_object* to = ws_test_inherited_object_new();
+    ck_assert(to);
+
+    intmax_t h = ws_object_attr_handle(&WS_OBJECT_TYPE_ID_TESTOBJ, "int");
+    ck_assert(h > 0);
+    ck_assert(h == ws_object_attr_handle(&WS_OBJECT_TYPE_ID_TESTOBJ, "int"));
+    ck_assert(-ECANCELED == ws_object_attr_handle(&WS_OBJECT_TYPE_ID_TESTOBJ,
+                                                  "i_int"));
+
+    // handles work on subtypes, the destination is made to fit
+    union ws_value_union v;
+    ws_value_nil_init(&v.nil);
+    ck_assert(0 == ws_object_attr_read_handle(&to->obj.obj, h, &v));
+    ck_assert(WS_VALUE_TYPE_INT == ws_value_get_type(&v.value));
+    ck_assert(TEST_INT == ws_value_int_get(&v.int_));
+
+    ws_value_int_set(&v.int_, TEST_INT + 3);
+    ck_assert(0 == ws_object_attr_write_handle(&to->obj.obj, h, &v.value));
+    ck_assert(to->obj.int_attribute == TEST_INT + 3);
+
+    // but not on other types
+    struct ws_object* o = ws_object_new_raw();
+    ck_assert(-ECANCELED == ws_object_attr_read_handle(o, h, &v));
+    ck_assert(-EINVAL == ws_object_attr_read_handle(&to->obj.obj, 0, &v));
+    ck_assert(-EINVAL == ws_object_attr_read_handle(&to->obj.obj, h + 1000,
+                                                    &v));
+
+    ws_value_deinit(&v.value);
+    ws_object_unref(o);
+    ws_object_unref(&to->obj.obj);
+}
+END_TEST
@@ -39,12 +39,14 @@
 
 #include <errno.h>
 #include <check.h>
+#include <pthread.h>
 #include <stdbool.h>
 
 #include "tests.h"
 #include "objects/ws_object/attribute_test.c"
 
 #include "objects/object.h"
+#include "util/slab.h"
 
 START_TEST (test_object_init) {
     struct ws_object o;
@@ -113,6 +115,71 @@ START_TEST (test_object_unref) {
 }
 END_TEST
 
+/*
+ * Refcount stress test: threads hammer the counter of a shared object, each
+ * dropping one reference handed to it when done
+ */
+
+#define REF_THREADS 8
+#define REF_ROUNDS 100000
+
+static size_t ref_deinit_calls;
+
+static bool
+ref_deinit(
+    struct ws_object* const self
+) {
+    ++ref_deinit_calls;
+    return true;
+}
+
+static ws_object_type_id REF_TYPE = {
+    .supertype = &WS_OBJECT_TYPE_ID_OBJECT,
+    .typestr = "ref_test",
+    .deinit_callback = ref_deinit,
+};
+
+static void*
+ref_hammer(
+    void* arg
+) {
+    struct ws_object* o = arg;
+
+    for (size_t i = 0; i < REF_ROUNDS; ++i) {
+        ck_assert(o == ws_object_getref(o));
+        ws_object_unref(o);
+    }
+
+    // drop the reference handed to us
+    ws_object_unref(o);
+    return NULL;
+}
+
+START_TEST (test_object_refcount_threaded) {
+    struct ws_object* o = ws_object_new(sizeof(*o));
+    ck_assert(o != NULL);
+    o->id = &REF_TYPE;
+    ref_deinit_calls = 0;
+
+    pthread_t threads[REF_THREADS];
+    for (size_t t = 0; t < REF_THREADS; ++t) {
+        ws_object_getref(o);
+        ck_assert(0 == pthread_create(&threads[t], NULL, ref_hammer, o));
+    }
+
+    for (size_t t = 0; t < REF_THREADS; ++t) {
+        ck_assert(0 == pthread_join(threads[t], NULL));
+    }
+
+    // only our own reference is left
+    ck_assert(1 == o->ref_counting.refcnt);
+    ck_assert(0 == ref_deinit_calls);
+
+    ws_object_unref(o);
+    ck_assert(1 == ref_deinit_calls);
+}
+END_TEST
+
 START_TEST (test_object_cb_hash) {
     struct ws_object* o = ws_object_new(sizeof(*o));
     ck_assert(-ENOTSUP == ws_object_hash(o));
@@ -136,6 +203,37 @@ START_TEST (test_object_lock_write) {
 }
 END_TEST
 
+START_TEST (test_object_lock_lazy) {
+    struct ws_object* o = ws_object_new(sizeof(*o));
+    ck_assert(NULL == o->rw_lock);
+
+    // the lock is created on first use
+    ck_assert(true == ws_object_lock_read(o));
+    ck_assert(NULL != o->rw_lock);
+    ck_assert(true == ws_object_unlock(o));
+
+    ws_object_deinit(o);
+    ck_assert(NULL == o->rw_lock);
+    ws_slab_release(o);
+}
+END_TEST
+
+START_TEST (test_object_lock_confined) {
+    struct ws_object os;
+    ws_object_init(&os);
+    os.settings |= WS_OBJECT_CONFINED;
+
+    // confined objects are never locked
+    ck_assert(true == ws_object_lock_write(&os));
+    ck_assert(0 == ws_object_lock_try_write(&os));
+    ck_assert(true == ws_object_unlock(&os));
+    ck_assert(true == ws_object_unlock(&os));
+    ck_assert(NULL == os.rw_lock);
+
+    ws_object_deinit(&os);
+}
+END_TEST
+
 START_TEST (test_object_lock_try_read) {
     struct ws_object* o = ws_object_new(sizeof(*o));
     ck_assert(0 == ws_object_lock_try_read(o));
@@ -201,17 +299,25 @@ objects_suite(void)
     tcase_add_test(tc, test_object_settings_set);
     tcase_add_test(tc, test_object_getref);
     tcase_add_test(tc, test_object_unref);
+    tcase_add_test(tc, test_object_refcount_threaded);
     tcase_add_test(tc, test_object_cb_hash);
     tcase_add_test(tc, test_object_lock_read);
     tcase_add_test(tc, test_object_lock_write);
+    tcase_add_test(tc, test_object_lock_lazy);
+    tcase_add_test(tc, test_object_lock_confined);
     tcase_add_test(tc, test_object_lock_try_read);
     tcase_add_test(tc, test_object_lock_try_write);
     tcase_add_test(tc, test_object_cmp);
     tcase_add_test(tc, test_object_uuid);
 
     tcase_add_test(tca, test_object_attribute_type);
+    tcase_add_test(tca, test_object_attribute_type_basetype);
     tcase_add_test(tca, test_object_attribute_read);
+    tcase_add_test(tca, test_object_attribute_read_basetype);
     tcase_add_test(tca, test_object_attribute_write);
+    tcase_add_test(tca, test_object_attribute_write_basetype);
+    tcase_add_test(tca, test_object_function_basetype);
+    tcase_add_test(tca, test_object_attribute_handle);
 
     return s;
 }
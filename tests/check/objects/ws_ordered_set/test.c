@@ -0,0 +1,331 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * @addtogroup tests "Testing"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup tests_objects_ordered_set "Testing: Ordered set"
+ *
+ * @{
+ */
+
+#include <check.h>
+#include <errno.h>
+#include <stdlib.h>
+
+#include "objects/object.h"
+#include "objects/ordered_set.h"
+#include "tests.h"
+#include "util/arithmetical.h"
+
+/*
+ *
+ * Test objects are ordered by a plain number
+ *
+ */
+
+struct test_obj {
+    struct ws_object obj;
+    int val;
+};
+
+static int
+compare_test_objs(
+    struct ws_object const* o1,
+    struct ws_object const* o2
+) {
+    // ws_object_cmp() semantics: 1 if the second object is the greater one
+    return signum(((struct test_obj*) o2)->val - ((struct test_obj*) o1)->val);
+}
+
+static ws_object_type_id TEST_ID = {
+    .supertype  = &WS_OBJECT_TYPE_ID_OBJECT,
+    .typestr    = "ordered_set_test_obj",
+
+    .deinit_callback = NULL,
+    .hash_callback = NULL,
+    .cmp_callback = compare_test_objs,
+};
+
+#define N_TEST_OBJS 200
+static struct test_obj* TEST_OBJS[N_TEST_OBJS] = { 0 };
+
+static struct ws_ordered_set* set = NULL;
+
+/*
+ *
+ * Helpers
+ *
+ */
+
+/**
+ * Get the value of the element at some position
+ */
+static int
+val_at(
+    size_t rank
+) {
+    struct test_obj* o = (struct test_obj*) ws_ordered_set_at(set, rank, NULL);
+    ck_assert(o != NULL);
+    int val = o->val;
+    ws_object_unref(&o->obj);
+    return val;
+}
+
+/**
+ * Check the ordering and positions of all the elements
+ */
+static void
+check_order(void)
+{
+    size_t card = ws_ordered_set_cardinality(set);
+
+    for (size_t i = 0; i < card; ++i) {
+        if (i > 0) {
+            ck_assert(val_at(i - 1) < val_at(i));
+        }
+        struct ws_object* o = ws_ordered_set_at(set, i, NULL);
+        ck_assert((size_t) ws_ordered_set_rank(set, o) == i);
+        ws_object_unref(o);
+    }
+    ck_assert(NULL == ws_ordered_set_at(set, card, NULL));
+}
+
+/**
+ * Processor collecting the values of the elements into an array
+ */
+static int
+collect(
+    void* etc,
+    void const* obj
+) {
+    int** it = etc;
+    *(*it)++ = ((struct test_obj const*) obj)->val;
+    return 0;
+}
+
+/**
+ * Processor which stops after the third element
+ */
+static int
+count_to_three(
+    void* etc,
+    void const* obj
+) {
+    return ++*(int*) etc >= 3;
+}
+
+/*
+ *
+ * Setup/Teardown functions
+ *
+ */
+
+static void
+test_ordered_set_setup(void)
+{
+    set = ws_ordered_set_new();
+    ck_assert(set != NULL);
+
+    for (int i = 0; i < N_TEST_OBJS; ++i) {
+        TEST_OBJS[i] = (struct test_obj*) ws_object_new(sizeof(**TEST_OBJS));
+        ck_assert(TEST_OBJS[i] != NULL);
+        TEST_OBJS[i]->obj.id = &TEST_ID;
+        TEST_OBJS[i]->val = i;
+    }
+}
+
+static void
+test_ordered_set_teardown(void)
+{
+    ws_object_unref(&set->obj);
+    set = NULL;
+
+    for (int i = 0; i < N_TEST_OBJS; ++i) {
+        ws_object_unref(&TEST_OBJS[i]->obj);
+        TEST_OBJS[i] = NULL;
+    }
+}
+
+/*
+ *
+ * Tests
+ *
+ */
+
+START_TEST (test_ordered_set_init) {
+    struct ws_ordered_set s;
+    ck_assert(0 == ws_ordered_set_init(&s));
+    ck_assert(0 == ws_ordered_set_cardinality(&s));
+    ck_assert(NULL == ws_ordered_set_min(&s));
+    ck_assert(NULL == ws_ordered_set_max(&s));
+    ws_object_deinit(&s.obj);
+}
+END_TEST
+
+START_TEST (test_ordered_set_insert) {
+    // insert in a scrambled order
+    for (int i = 0; i < N_TEST_OBJS; ++i) {
+        int j = (i * 7) % N_TEST_OBJS;
+        ck_assert(0 == ws_ordered_set_insert(set, &TEST_OBJS[j]->obj));
+    }
+    ck_assert(N_TEST_OBJS == ws_ordered_set_cardinality(set));
+
+    // inserting an element a second time doesn't alter the set
+    ck_assert(0 == ws_ordered_set_insert(set, &TEST_OBJS[3]->obj));
+    ck_assert(N_TEST_OBJS == ws_ordered_set_cardinality(set));
+
+    check_order();
+
+    struct ws_object* o = ws_ordered_set_min(set);
+    ck_assert(o == &TEST_OBJS[0]->obj);
+    ws_object_unref(o);
+
+    o = ws_ordered_set_max(set);
+    ck_assert(o == &TEST_OBJS[N_TEST_OBJS - 1]->obj);
+    ws_object_unref(o);
+}
+END_TEST
+
+START_TEST (test_ordered_set_remove) {
+    for (int i = 0; i < N_TEST_OBJS; ++i) {
+        ck_assert(0 == ws_ordered_set_insert(set, &TEST_OBJS[i]->obj));
+    }
+
+    // remove every third element
+    for (int i = 0; i < N_TEST_OBJS; i += 3) {
+        ck_assert(0 == ws_ordered_set_remove(set, &TEST_OBJS[i]->obj));
+    }
+    ck_assert(-ENOENT == ws_ordered_set_remove(set, &TEST_OBJS[0]->obj));
+    ck_assert(-ENOENT == ws_ordered_set_rank(set, &TEST_OBJS[3]->obj));
+    ck_assert(N_TEST_OBJS - (N_TEST_OBJS + 2) / 3 ==
+              ws_ordered_set_cardinality(set));
+
+    check_order();
+
+    for (int i = 0; i < N_TEST_OBJS; ++i) {
+        if (i % 3) {
+            ck_assert(0 == ws_ordered_set_remove(set, &TEST_OBJS[i]->obj));
+        }
+    }
+    ck_assert(0 == ws_ordered_set_cardinality(set));
+}
+END_TEST
+
+START_TEST (test_ordered_set_keyed) {
+    // keys reverse the order of the elements
+    for (int i = 0; i < N_TEST_OBJS; ++i) {
+        ck_assert(0 == ws_ordered_set_insert_keyed(set, &TEST_OBJS[i]->obj,
+                                                   -2 * i));
+    }
+
+    intmax_t key;
+    struct ws_object* o = ws_ordered_set_at(set, 0, &key);
+    ck_assert(o == &TEST_OBJS[N_TEST_OBJS - 1]->obj);
+    ck_assert(key == -2 * (N_TEST_OBJS - 1));
+    ws_object_unref(o);
+
+    ck_assert(N_TEST_OBJS - 1 ==
+              ws_ordered_set_rank_keyed(set, &TEST_OBJS[0]->obj, 0));
+    ck_assert(-ENOENT == ws_ordered_set_rank(set, &TEST_OBJS[1]->obj));
+
+    // elements 0 to 4 have a key of at least -9
+    ck_assert(N_TEST_OBJS - 5 == ws_ordered_set_lower_bound(set, -9));
+    ck_assert(N_TEST_OBJS - 5 == ws_ordered_set_lower_bound(set, -8));
+    ck_assert(N_TEST_OBJS == ws_ordered_set_lower_bound(set, 1));
+
+    // an element may be present with different keys
+    ck_assert(0 == ws_ordered_set_insert_keyed(set, &TEST_OBJS[0]->obj, 1));
+    ck_assert(N_TEST_OBJS + 1 == ws_ordered_set_cardinality(set));
+
+    ck_assert(-ENOENT == ws_ordered_set_remove_keyed(set, &TEST_OBJS[1]->obj,
+                                                     0));
+    ck_assert(0 == ws_ordered_set_remove_keyed(set, &TEST_OBJS[1]->obj, -2));
+    ck_assert(N_TEST_OBJS == ws_ordered_set_cardinality(set));
+}
+END_TEST
+
+START_TEST (test_ordered_set_select_range) {
+    for (int i = N_TEST_OBJS - 1; i >= 0; --i) {
+        ck_assert(0 == ws_ordered_set_insert(set, &TEST_OBJS[i]->obj));
+    }
+
+    int vals[N_TEST_OBJS];
+    int* it = vals;
+    ck_assert(0 == ws_ordered_set_select_range(set, 17, 42, collect, &it));
+    ck_assert(it - vals == 42 - 17);
+    for (int i = 0; i < 42 - 17; ++i) {
+        ck_assert(vals[i] == 17 + i);
+    }
+
+    // the end of the range may exceed the cardinality
+    it = vals;
+    ck_assert(0 == ws_ordered_set_select_range(set, N_TEST_OBJS - 2,
+                                               N_TEST_OBJS * 2, collect, &it));
+    ck_assert(it - vals == 2);
+    ck_assert(vals[1] == N_TEST_OBJS - 1);
+
+    // processors may stop the iteration
+    int count = 0;
+    ck_assert(0 == ws_ordered_set_select_range(set, 0, N_TEST_OBJS,
+                                               count_to_three, &count));
+    ck_assert(count == 3);
+}
+END_TEST
+
+static Suite*
+ordered_set_suite(void)
+{
+    Suite* s    = suite_create("Ordered set");
+    TCase* tc   = tcase_create("main case");
+
+    suite_add_tcase(s, tc);
+    tcase_add_checked_fixture(tc, test_ordered_set_setup,
+                              test_ordered_set_teardown);
+
+    tcase_add_test(tc, test_ordered_set_init);
+    tcase_add_test(tc, test_ordered_set_insert);
+    tcase_add_test(tc, test_ordered_set_remove);
+    tcase_add_test(tc, test_ordered_set_keyed);
+    tcase_add_test(tc, test_ordered_set_select_range);
+
+    return s;
+}
+
+WS_TESTS_CHECK_MAIN(ordered_set_suite);
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
@@ -39,7 +39,10 @@
 
 #include <errno.h>
 #include <check.h>
+#include <pthread.h>
+#include <sched.h>
 #include <stdbool.h>
+#include <stdlib.h>
 
 #include "objects/queue.h"
 #include "tests.h"
@@ -109,6 +112,223 @@ START_TEST (test_queue_pop) {
 }
 END_TEST
 
+/*
+ *
+ * Lock-free flavours
+ *
+ */
+
+/**
+ * Number of producers used for stress testing
+ */
+#define STRESS_PRODUCERS 4
+
+/**
+ * Number of elements pushed by each producer
+ */
+#define STRESS_ELEMENTS 100000
+
+/**
+ * Object tagged with the producer which pushed it
+ */
+struct tagged_obj {
+    struct ws_object obj;
+    size_t producer;
+    size_t seq;
+};
+
+struct producer_ctx {
+    struct ws_queue* q;
+    struct tagged_obj* objs;
+};
+
+static void*
+produce(
+    void* arg
+) {
+    struct producer_ctx* ctx = (struct producer_ctx*) arg;
+
+    for (size_t i = 0; i < STRESS_ELEMENTS; ++i) {
+        // a full ring just means we have to retry
+        while (ws_queue_push(ctx->q, &ctx->objs[i].obj) == -ENOSPC) {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Push from `producers` threads, pop from this one and check ordering
+ */
+static void
+stress_queue(
+    struct ws_queue* q,
+    size_t producers
+) {
+    struct tagged_obj* objs = calloc(producers * STRESS_ELEMENTS,
+                                     sizeof(*objs));
+    ck_assert(objs);
+
+    struct producer_ctx ctx[producers];
+    pthread_t threads[producers];
+    size_t next_seq[producers];
+
+    for (size_t p = 0; p < producers; ++p) {
+        ctx[p].q = q;
+        ctx[p].objs = objs + p * STRESS_ELEMENTS;
+        next_seq[p] = 0;
+
+        for (size_t i = 0; i < STRESS_ELEMENTS; ++i) {
+            ck_assert(ws_object_init(&ctx[p].objs[i].obj));
+            ctx[p].objs[i].producer = p;
+            ctx[p].objs[i].seq = i;
+        }
+    }
+
+    for (size_t p = 0; p < producers; ++p) {
+        ck_assert(0 == pthread_create(&threads[p], NULL, produce, &ctx[p]));
+    }
+
+    size_t popped = 0;
+    while (popped < producers * STRESS_ELEMENTS) {
+        struct tagged_obj* o = (struct tagged_obj*) ws_queue_pop(q);
+        if (!o) {
+            sched_yield();
+            continue;
+        }
+
+        // elements of one producer must arrive in order
+        ck_assert(o->seq == next_seq[o->producer]);
+        ++next_seq[o->producer];
+        ws_object_unref(&o->obj);
+        ++popped;
+    }
+
+    for (size_t p = 0; p < producers; ++p) {
+        ck_assert(0 == pthread_join(threads[p], NULL));
+    }
+
+    ck_assert(ws_queue_empty(q));
+    ck_assert(NULL == ws_queue_pop(q));
+
+    for (size_t i = 0; i < producers * STRESS_ELEMENTS; ++i) {
+        ws_object_deinit(&objs[i].obj);
+    }
+    free(objs);
+}
+
+START_TEST (test_queue_spsc) {
+    struct ws_queue* q = ws_queue_new_spsc(3);
+    ck_assert(q);
+
+    ck_assert(ws_queue_empty(q));
+    ck_assert(NULL == ws_queue_pop(q));
+    ck_assert(0 != ws_queue_push(q, NULL));
+
+    struct ws_object* o[5];
+    for (size_t i = 0; i < 5; ++i) {
+        o[i] = ws_object_new_raw();
+        ck_assert(o[i]);
+    }
+
+    // capacity is rounded up to 4
+    for (size_t i = 0; i < 4; ++i) {
+        ck_assert(0 == ws_queue_push(q, o[i]));
+    }
+    ck_assert(-ENOSPC == ws_queue_push(q, o[4]));
+    ck_assert(!ws_queue_empty(q));
+
+    // wrap around
+    ck_assert(o[0] == ws_queue_pop(q));
+    ws_object_unref(o[0]);
+    ck_assert(0 == ws_queue_push(q, o[4]));
+
+    for (size_t i = 1; i < 5; ++i) {
+        ck_assert(o[i] == ws_queue_pop(q));
+        ws_object_unref(o[i]);
+    }
+    ck_assert(ws_queue_empty(q));
+
+    // elements left in the queue are released on deinit
+    ck_assert(0 == ws_queue_push(q, o[0]));
+
+    for (size_t i = 0; i < 5; ++i) {
+        ws_object_unref(o[i]);
+    }
+    ws_object_unref(&q->obj);
+}
+END_TEST
+
+START_TEST (test_queue_mpsc) {
+    struct ws_queue* q = ws_queue_new_mpsc();
+    ck_assert(q);
+
+    ck_assert(ws_queue_empty(q));
+    ck_assert(NULL == ws_queue_pop(q));
+    ck_assert(0 != ws_queue_push(q, NULL));
+
+    struct ws_object* o1 = ws_object_new_raw();
+    struct ws_object* o2 = ws_object_new_raw();
+    struct ws_object* o3 = ws_object_new_raw();
+
+    // run twice, so the second round uses recycled elements
+    for (int round = 0; round < 2; ++round) {
+        ck_assert(0 == ws_queue_push(q, o1));
+        ck_assert(0 == ws_queue_push(q, o2));
+        ck_assert(0 == ws_queue_push(q, o3));
+        ck_assert(!ws_queue_empty(q));
+
+        ck_assert(o1 == ws_queue_pop(q));
+        ck_assert(o2 == ws_queue_pop(q));
+        ck_assert(o3 == ws_queue_pop(q));
+        ck_assert(ws_queue_empty(q));
+
+        ws_object_unref(o1);
+        ws_object_unref(o2);
+        ws_object_unref(o3);
+    }
+
+    // elements left in the queue are released on deinit
+    ck_assert(0 == ws_queue_push(q, o1));
+
+    ws_object_unref(o1);
+    ws_object_unref(o2);
+    ws_object_unref(o3);
+    ws_object_unref(&q->obj);
+}
+END_TEST
+
+START_TEST (test_queue_spsc_stress) {
+    struct ws_queue* q = ws_queue_new_spsc(64);
+    ck_assert(q);
+
+    stress_queue(q, 1);
+
+    ws_object_unref(&q->obj);
+}
+END_TEST
+
+START_TEST (test_queue_mpsc_stress) {
+    struct ws_queue* q = ws_queue_new_mpsc();
+    ck_assert(q);
+
+    stress_queue(q, STRESS_PRODUCERS);
+
+    ws_object_unref(&q->obj);
+}
+END_TEST
+
+START_TEST (test_queue_locked_stress) {
+    struct ws_queue* q = ws_queue_new();
+    ck_assert(q);
+
+    stress_queue(q, STRESS_PRODUCERS);
+
+    ws_object_unref(&q->obj);
+}
+END_TEST
+
 static Suite*
 queue_suite(void)
 {
@@ -122,6 +342,17 @@ queue_suite(void)
     tcase_add_test(tc, test_queue_push);
     tcase_add_test(tc, test_queue_pop);
 
+    TCase* tc_lf = tcase_create("lock-free case");
+    tcase_set_timeout(tc_lf, 30);
+
+    suite_add_tcase(s, tc_lf);
+
+    tcase_add_test(tc_lf, test_queue_spsc);
+    tcase_add_test(tc_lf, test_queue_mpsc);
+    tcase_add_test(tc_lf, test_queue_spsc_stress);
+    tcase_add_test(tc_lf, test_queue_mpsc_stress);
+    tcase_add_test(tc_lf, test_queue_locked_stress);
+
     return s;
 }
 
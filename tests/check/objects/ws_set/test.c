@@ -118,6 +118,52 @@ processor(
     return 0;
 }
 
+/**
+ * Key comparison helper, using the address of an object as key
+ */
+static int
+cmp_key(
+    struct ws_object const* elem,
+    void const* key
+) {
+    return elem != key;
+}
+
+/**
+ * Predicate for parallel selection: select every third element of an array
+ */
+static int
+every_third(
+    void const* obj,
+    void* etc
+) {
+    struct ws_set_test_obj const* base = etc;
+    return (((struct ws_set_test_obj const*) obj) - base) % 3 == 0;
+}
+
+/**
+ * Processor stopping the iteration right away
+ */
+static int
+get_first(
+    void* etc,
+    void const* obj
+) {
+    return 1;
+}
+
+/**
+ * Processor counting the elements
+ */
+static int
+count(
+    void* etc,
+    void const* obj
+) {
+    ++*(size_t*) etc;
+    return 0;
+}
+
 /*
  *
  * Setup/Teardown functions
@@ -174,8 +220,7 @@ static void
 test_set_teardown(void)
 {
     ck_assert(set != NULL);
-    ws_object_deinit(&set->obj);
-    free(set);
+    ws_object_unref(&set->obj);
     set = NULL;
     ck_assert(set == NULL);
 }
@@ -272,87 +317,167 @@ START_TEST (test_set_insert_get_remove) {
 }
 END_TEST
 
+START_TEST (test_set_get_remove_by_key) {
+    int i;
+    for (i = N_TEST_OBJS - 1; i; --i) {
+        ck_assert(0 == ws_set_insert(set, TEST_OBJS[i]));
+    }
+
+    for (i = N_TEST_OBJS - 1; i; --i) {
+        size_t hash = ws_object_hash(TEST_OBJS[i]);
+        struct ws_object* o = ws_set_get_by_key(set, hash, TEST_OBJS[i],
+                                                cmp_key);
+        ck_assert(TEST_OBJS[i] == o);
+        ws_object_unref(o);
+    }
+
+    // not contained
+    size_t hash = ws_object_hash(TEST_OBJS[1]);
+    ck_assert(NULL == ws_set_get_by_key(set, hash, &hash, cmp_key));
+
+    for (i = N_TEST_OBJS - 1; i; --i) {
+        size_t hash = ws_object_hash(TEST_OBJS[i]);
+        ck_assert(0 == ws_set_remove_by_key(set, hash, TEST_OBJS[i], cmp_key));
+        ck_assert(NULL == ws_set_get(set, TEST_OBJS[i]));
+    }
+
+    ck_assert(0 == ws_set_cardinality(set));
+}
+END_TEST
+
 /*
  *
  * Tests: Set operations
  *
  */
 
-//START_TEST (test_set_union) {
-//    ck_assert(0 == ws_set_union(set, set_a, set_b));
-//
-//    int i;
-//
-//    for (i = N_TEST_OBJS - 1; i; --i) {
-//        ck_assert(TEST_OBJS[i] == ws_set_get(set, TEST_OBJS[i]));
-//    }
-//}
-//END_TEST
-
-//START_TEST (test_set_intersection) {
-//    ck_assert(0 == ws_set_intersection(set, set_a, set_b));
-//    // No intersection by now, as the sets `set_a` and `set_b` do not contain
-//    // equal elements
-//
-//    int i;
-//
-//    for (i = N_TEST_OBJS - 1; i; --i) {
-//        ck_assert(NULL == ws_set_get(set, TEST_OBJS[i]));
-//    }
-//
-//    // Insert the same object into both sets here.
-//    // No assertions here, as some of the objects are already in the sets
-//    for (i = N_TEST_OBJS / 2; i; --i) {
-//        ws_set_insert(set_a, TEST_OBJS[i]);
-//        ws_set_insert(set_b, TEST_OBJS[i]);
-//    }
-//
-//    // Now we create a _real_ intersection, where something actually happens
-//    ck_assert(0 == ws_set_intersection(set, set_a, set_b));
-//
-//    for (i = N_TEST_OBJS / 2; i; --i) {
-//        ck_assert(TEST_OBJS[i] == ws_set_get(set, TEST_OBJS[i]));
-//    }
-//}
-//END_TEST
-
-//START_TEST (test_set_xor) {
-//    ck_assert(0 == ws_set_xor(set, set_a, set_b));
-//
-//    int i;
-//
-//    for (i = N_TEST_OBJS - 1; i; --i) {
-//        ck_assert(NULL == ws_set_get(set, TEST_OBJS[i]));
-//    }
-//
-//    ws_set_insert(set_a, TEST_OBJS[0]);
-//    ws_set_insert(set_b, TEST_OBJS[0]);
-//
-//    ck_assert(0 == ws_set_xor(set, set_a, set_b));
-//
-//    for (i = N_TEST_OBJS - 1; i; --i) {
-//        if (i == 0) {
-//            ck_assert(TEST_OBJS[i] == ws_set_get(set, TEST_OBJS[i]));
-//        } else {
-//            ck_assert(NULL == ws_set_get(set, TEST_OBJS[i]));
-//        }
-//    }
-//}
-//END_TEST
-
-//START_TEST (test_set_subset) {
-//    // "set" is empty
-//    ck_assert(0 == ws_set_is_subset(set, set_a));
-//    ck_assert(0 == ws_set_is_subset(set, set_b));
-//
-//    ck_assert(1 == ws_set_is_subset(set_a, set));
-//    ck_assert(1 == ws_set_is_subset(set_b, set));
-//
-//    // set_a and set_b are different
-//    ck_assert(0 == ws_set_is_subset(set_a, set_b));
-//    ck_assert(0 == ws_set_is_subset(set_b, set_a));
-//}
-//END_TEST
+START_TEST (test_set_union) {
+    ck_assert(0 == ws_set_union(set, set_a, set_b));
+
+    int i;
+
+    for (i = N_TEST_OBJS - 1; i; --i) {
+        ck_assert(TEST_OBJS[i] == ws_set_get(set, TEST_OBJS[i]));
+    }
+}
+END_TEST
+
+START_TEST (test_set_intersection) {
+    ck_assert(0 == ws_set_intersection(set, set_a, set_b));
+    // No intersection by now, as the sets `set_a` and `set_b` do not contain
+    // equal elements
+
+    int i;
+
+    for (i = N_TEST_OBJS - 1; i; --i) {
+        ck_assert(NULL == ws_set_get(set, TEST_OBJS[i]));
+    }
+
+    // Insert the same object into both sets here.
+    // No assertions here, as some of the objects are already in the sets
+    for (i = N_TEST_OBJS / 2; i; --i) {
+        ws_set_insert(set_a, TEST_OBJS[i]);
+        ws_set_insert(set_b, TEST_OBJS[i]);
+    }
+
+    // Now we create a _real_ intersection, where something actually happens
+    ck_assert(0 == ws_set_intersection(set, set_a, set_b));
+
+    for (i = N_TEST_OBJS / 2; i; --i) {
+        ck_assert(TEST_OBJS[i] == ws_set_get(set, TEST_OBJS[i]));
+    }
+    ck_assert(N_TEST_OBJS / 2 == ws_set_cardinality(set));
+}
+END_TEST
+
+START_TEST (test_set_xor) {
+    // `set_a` and `set_b` are disjoint, so their xor is their union
+    ck_assert(0 == ws_set_xor(set, set_a, set_b));
+
+    int i;
+
+    for (i = N_TEST_OBJS - 1; i; --i) {
+        ck_assert(TEST_OBJS[i] == ws_set_get(set, TEST_OBJS[i]));
+    }
+
+    // `TEST_OBJS[1]` is in `set_a` already
+    ws_set_insert(set_b, TEST_OBJS[1]);
+
+    struct ws_set* res = ws_set_new();
+    ck_assert(res != NULL);
+    ck_assert(0 == ws_set_xor(res, set_a, set_b));
+
+    for (i = N_TEST_OBJS - 1; i; --i) {
+        if (i == 1) {
+            ck_assert(NULL == ws_set_get(res, TEST_OBJS[i]));
+        } else {
+            ck_assert(TEST_OBJS[i] == ws_set_get(res, TEST_OBJS[i]));
+        }
+    }
+
+    ws_object_unref(&res->obj);
+}
+END_TEST
+
+START_TEST (test_set_subset) {
+    // "set" is empty
+    ck_assert(0 == ws_set_is_subset(set, set_a));
+    ck_assert(0 == ws_set_is_subset(set, set_b));
+
+    ck_assert(1 == ws_set_is_subset(set_a, set));
+    ck_assert(1 == ws_set_is_subset(set_b, set));
+
+    // set_a and set_b are different
+    ck_assert(0 == ws_set_is_subset(set_a, set_b));
+    ck_assert(0 == ws_set_is_subset(set_b, set_a));
+
+    ck_assert(0 == ws_set_union(set, set_a, set_b));
+    ck_assert(1 == ws_set_is_subset(set, set_a));
+    ck_assert(1 == ws_set_is_subset(set, set_b));
+    ck_assert(1 == ws_set_is_subset(set, set));
+}
+END_TEST
+
+START_TEST (test_set_union_inplace) {
+    ck_assert(0 == ws_set_union_inplace(set_a, set_b));
+
+    ck_assert(N_TEST_OBJS - 1 == ws_set_cardinality(set_a));
+    ck_assert(N_TEST_OBJS / 2 == ws_set_cardinality(set_b));
+    ck_assert(1 == ws_set_is_subset(set_a, set_b));
+
+    ck_assert(0 == ws_set_union_inplace(set_a, set_a));
+    ck_assert(N_TEST_OBJS - 1 == ws_set_cardinality(set_a));
+}
+END_TEST
+
+START_TEST (test_set_intersection_inplace) {
+    ck_assert(0 == ws_set_insert(set_a, TEST_OBJS[2]));
+    ck_assert(0 == ws_set_insert(set_a, TEST_OBJS[4]));
+
+    ck_assert(0 == ws_set_intersection_inplace(set_a, set_b));
+
+    ck_assert(2 == ws_set_cardinality(set_a));
+    ck_assert(TEST_OBJS[2] == ws_set_get(set_a, TEST_OBJS[2]));
+    ck_assert(TEST_OBJS[4] == ws_set_get(set_a, TEST_OBJS[4]));
+
+    ck_assert(0 == ws_set_intersection_inplace(set_a, set));
+    ck_assert(0 == ws_set_cardinality(set_a));
+}
+END_TEST
+
+START_TEST (test_set_xor_inplace) {
+    ck_assert(0 == ws_set_insert(set_a, TEST_OBJS[2]));
+
+    ck_assert(0 == ws_set_xor_inplace(set_a, set_b));
+
+    ck_assert(N_TEST_OBJS - 2 == ws_set_cardinality(set_a));
+    ck_assert(NULL == ws_set_get(set_a, TEST_OBJS[2]));
+    ck_assert(TEST_OBJS[4] == ws_set_get(set_a, TEST_OBJS[4]));
+
+    ck_assert(0 == ws_set_xor_inplace(set_a, set_a));
+    ck_assert(0 == ws_set_cardinality(set_a));
+}
+END_TEST
 
 START_TEST (test_set_cardinality) {
     ck_assert(0 == ws_set_cardinality(set));
@@ -360,9 +485,9 @@ START_TEST (test_set_cardinality) {
     ck_assert(N_TEST_OBJS / 2 == ws_set_cardinality(set_a));
     ck_assert(N_TEST_OBJS / 2 == ws_set_cardinality(set_b));
 
-//    ck_assert(0 == ws_set_union(set, set_a, set_b));
-//
-//    ck_assert(15 == ws_set_cardinality(set));
+    ck_assert(0 == ws_set_union(set, set_a, set_b));
+
+    ck_assert(N_TEST_OBJS - 1 == ws_set_cardinality(set));
 }
 END_TEST
 
@@ -375,6 +500,40 @@ START_TEST (test_set_select) {
 }
 END_TEST
 
+START_TEST (test_set_select_parallel) {
+    size_t num = 1000;
+    struct ws_set* large = ws_set_new();
+    struct ws_set_test_obj* objs = calloc(num, sizeof(*objs));
+    ck_assert(large != NULL);
+    ck_assert(objs != NULL);
+
+    for (size_t i = 0; i < num; ++i) {
+        ws_object_init(&objs[i].obj);
+        objs[i].obj.id = &TEST_ID;
+        ck_assert(0 == ws_set_insert(large, &objs[i].obj));
+    }
+
+    // the result must not depend on the number of threads
+    unsigned int threads[] = { 1, 4, 0 };
+    for (size_t t = 0; t < ARYLEN(threads); ++t) {
+        size_t selected = 0;
+        ck_assert(0 == ws_set_select_parallel(large, every_third, objs, count,
+                                              &selected, threads[t]));
+        ck_assert(selected == (num + 2) / 3);
+    }
+
+    // the processor may stop the iteration
+    ck_assert(1 == ws_set_select_parallel(large, every_third, objs,
+                                          get_first, NULL, 0));
+
+    ws_object_unref(&large->obj);
+    for (size_t i = 0; i < num; ++i) {
+        ws_object_deinit(&objs[i].obj);
+    }
+    free(objs);
+}
+END_TEST
+
 /*
  *
  * Suite
@@ -394,21 +553,26 @@ set_suite(void)
 
     tcase_add_test(tc, test_set_init);
     tcase_add_test(tc, test_set_init_deinit);
+    tcase_add_test(tc, test_set_select_parallel);
 
     suite_add_tcase(s, tce);
     tcase_add_checked_fixture(tce, test_set_setup_objs, test_set_teardown_objs);
     tcase_add_test(tce, test_set_insert);
     tcase_add_test(tce, test_set_insert_remove);
     tcase_add_test(tce, test_set_insert_get_remove);
+    tcase_add_test(tce, test_set_get_remove_by_key);
 
     suite_add_tcase(s, tcso);
     tcase_add_checked_fixture(tcso,
                               test_set_setup_sets,
                               test_set_teardown_sets);
-//    tcase_add_test(tcso, test_set_union);
-//    tcase_add_test(tcso, test_set_intersection);
-//    tcase_add_test(tcso, test_set_xor);
-//    tcase_add_test(tcso, test_set_subset);
+    tcase_add_test(tcso, test_set_union);
+    tcase_add_test(tcso, test_set_intersection);
+    tcase_add_test(tcso, test_set_xor);
+    tcase_add_test(tcso, test_set_subset);
+    tcase_add_test(tcso, test_set_union_inplace);
+    tcase_add_test(tcso, test_set_intersection_inplace);
+    tcase_add_test(tcso, test_set_xor_inplace);
     tcase_add_test(tcso, test_set_cardinality);
     tcase_add_test(tcso, test_set_select);
 
@@ -38,7 +38,9 @@
  */
 
 #include <check.h>
+#include <errno.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "tests.h"
 #include "objects/string.h"
@@ -61,8 +63,7 @@ START_TEST (test_string_init) {
 
     sh = ws_string_new();
     ck_assert(NULL != sh);
-    ws_object_deinit(&sh->obj);
-    free(sh);
+    ws_object_unref(&sh->obj);
 }
 END_TEST
 
@@ -72,8 +73,7 @@ START_TEST (test_string_empty_len) {
     ck_assert(s != NULL);
     ck_assert(0 == ws_string_len(s));
 
-    ws_object_deinit(&s->obj);
-    free(s);
+    ws_object_unref(&s->obj);
 }
 END_TEST
 
@@ -90,10 +90,8 @@ START_TEST (test_string_cat_empty) {
     ck_assert(sa == ws_string_cat(sa, sb));
     ck_assert(0 == ws_string_len(sa));
 
-    ws_object_deinit(&sa->obj);
-    ws_object_deinit(&sb->obj);
-    free(sa);
-    free(sb);
+    ws_object_unref(&sa->obj);
+    ws_object_unref(&sb->obj);
 }
 END_TEST
 
@@ -111,10 +109,8 @@ START_TEST (test_string_empty_dupl) {
     ck_assert(0 == ws_string_len(s));
     ck_assert(0 == ws_string_len(d));
 
-    ws_object_deinit(&s->obj);
-    ws_object_deinit(&d->obj);
-    free(s);
-    free(d);
+    ws_object_unref(&s->obj);
+    ws_object_unref(&d->obj);
 }
 END_TEST
 
@@ -124,10 +120,8 @@ START_TEST (test_string_empty_cmp) {
 
     ck_assert(0 == ws_string_cmp(sa, sb));
 
-    ws_object_deinit(&sa->obj);
-    ws_object_deinit(&sb->obj);
-    free(sa);
-    free(sb);
+    ws_object_unref(&sa->obj);
+    ws_object_unref(&sb->obj);
 }
 END_TEST
 
@@ -136,8 +130,7 @@ START_TEST (test_string_empty_raw) {
 
     ck_assert(NULL == ws_string_raw(s));
 
-    ws_object_deinit(&s->obj);
-    free(s);
+    ws_object_unref(&s->obj);
 }
 END_TEST
 
@@ -155,8 +148,7 @@ START_TEST (test_string_from_raw_literal) {
     size_t len = ws_string_len(s);
     ck_assert(strlen(literal) == len);
 
-    ws_object_deinit(&s->obj);
-    free(s);
+    ws_object_unref(&s->obj);
 }
 END_TEST
 
@@ -176,8 +168,7 @@ START_TEST (test_string_from_raw_heapbuf) {
     size_t len = ws_string_len(s);
     ck_assert(strlen(literal) == len);
 
-    ws_object_deinit(&s->obj);
-    free(s);
+    ws_object_unref(&s->obj);
     free(hbuf);
 }
 END_TEST
@@ -231,6 +222,137 @@ START_TEST (test_string_substr) {
 }
 END_TEST
 
+START_TEST (test_string_dupl_cow) {
+    struct ws_string* d = ws_string_dupl(string_a);
+    ck_assert(d != NULL);
+    ck_assert(0 == ws_string_cmp(string_a, d));
+
+    // modifying the copy must not modify the original
+    ck_assert(d == ws_string_cat(d, string_b));
+    ck_assert(ws_string_len(d) == ws_string_len(string_a) +
+                                  ws_string_len(string_b));
+    ck_assert(0 != ws_string_cmp(string_a, d));
+
+    char* buf = ws_string_raw(string_a);
+    ck_assert(ws_streq(buf, "Hello, World!"));
+    free(buf);
+
+    ws_object_unref(&d->obj);
+}
+END_TEST
+
+START_TEST (test_string_equal) {
+    ck_assert(true == ws_string_equal(string_a, string_a));
+    ck_assert(false == ws_string_equal(string_a, string_b));
+
+    struct ws_string* s = ws_string_new();
+    ws_string_set_from_raw(s, "Hello");
+    ck_assert(true == ws_string_equal(s, string_b));
+    ws_object_unref(&s->obj);
+}
+END_TEST
+
+START_TEST (test_string_intern) {
+    struct ws_string* s = ws_string_new();
+    ws_string_set_from_raw(s, "Hello");
+
+    struct ws_string* is = ws_string_intern(s);
+    struct ws_string* ib = ws_string_intern(string_b);
+    struct ws_string* ia = ws_string_intern(string_a);
+    ck_assert(is && ib && ia);
+
+    // the strings passed are left alone
+    ck_assert(false == ws_string_is_interned(s));
+    ck_assert(false == ws_string_is_interned(string_b));
+    ck_assert(!(ws_object_get_settings(&s->obj) & WS_OBJ_CONST));
+    ck_assert(true == ws_string_is_interned(is));
+    ck_assert(ws_object_get_settings(&is->obj) & WS_OBJ_CONST);
+
+    // equal contents are shared, different contents aren't
+    ck_assert(is->str == ib->str);
+    ck_assert(true == ws_string_equal(is, ib));
+    ck_assert(false == ws_string_equal(is, ia));
+    ck_assert(true == ws_string_equal(is, s));
+
+    // interning an interned string yields the same contents
+    struct ws_string* again = ws_string_intern(is);
+    ck_assert(again && again->str == is->str);
+
+    // the originals stay mutable
+    ck_assert(s == ws_string_cat(s, string_a));
+    ck_assert(5 == ws_string_len(is));
+
+    ws_object_unref(&again->obj);
+    ws_object_unref(&ia->obj);
+    ws_object_unref(&ib->obj);
+    ws_object_unref(&is->obj);
+    ws_object_unref(&s->obj);
+}
+END_TEST
+
+START_TEST (test_string_utf8) {
+    struct ws_string* s = ws_string_new();
+
+    // "Grüße, 世界"
+    char const* raw = "Gr\xc3\xbc\xc3\x9f" "e, \xe4\xb8\x96\xe7\x95\x8c";
+    ck_assert(0 == ws_string_set_from_raw(s, raw));
+    ck_assert(9 == ws_string_len(s));
+    ck_assert(strlen(raw) == ws_string_bytelen(s));
+    ck_assert(ws_streq(ws_string_cstr(s), raw));
+
+    // invalid contents are rejected and leave the string untouched
+    ck_assert(-EINVAL == ws_string_set_from_raw(s, "broken \xc3("));
+    ck_assert(9 == ws_string_len(s));
+
+    // offsets count characters
+    struct ws_string* t = ws_string_new();
+    ck_assert(0 == ws_string_set_from_raw(t, "\xe4\xb8\x96"));
+    ck_assert(0 == ws_string_ncmp(s, t, 7, 1));
+    ck_assert(0 != ws_string_ncmp(s, t, 8, 1));
+
+    ws_object_unref(&t->obj);
+    ws_object_unref(&s->obj);
+}
+END_TEST
+
+START_TEST (test_string_cstr) {
+    struct ws_string* s = ws_string_new();
+    ck_assert(ws_streq("", ws_string_cstr(s)));
+    ws_object_unref(&s->obj);
+
+    // the contents are borrowed, not copied
+    ck_assert(ws_string_cstr(string_a) == ws_string_cstr(string_a));
+    ck_assert(ws_streq("Hello, World!", ws_string_cstr(string_a)));
+}
+END_TEST
+
+START_TEST (test_string_cat_grow) {
+    struct ws_string* s = ws_string_new();
+    struct ws_string* r = ws_string_new();
+    char expected[1024] = "";
+
+    for (size_t i = 0; i < 60; ++i) {
+        ck_assert(s == ws_string_cat(s, string_b));
+        strcat(expected, "Hello");
+        ck_assert(ws_string_len(s) == strlen(expected));
+    }
+    ck_assert(ws_streq(ws_string_cstr(s), expected));
+
+    // the hash is maintained while appending
+    ck_assert(0 == ws_string_set_from_raw(r, expected));
+    ck_assert(ws_string_hash(s) == ws_string_hash(r));
+    ck_assert(ws_object_hash(&s->obj) == ws_object_hash(&r->obj));
+    ck_assert(true == ws_string_equal(s, r));
+
+    // appending a string to itself
+    ck_assert(s == ws_string_cat(s, s));
+    ck_assert(ws_string_len(s) == 2 * strlen(expected));
+
+    ws_object_unref(&r->obj);
+    ws_object_unref(&s->obj);
+}
+END_TEST
+
 static Suite*
 string_suite(void)
 {
@@ -257,6 +379,12 @@ string_suite(void)
     tcase_add_test(tc_m, test_string_cmp);
     tcase_add_test(tc_m, test_string_ncmp);
     tcase_add_test(tc_m, test_string_substr);
+    tcase_add_test(tc_m, test_string_dupl_cow);
+    tcase_add_test(tc_m, test_string_equal);
+    tcase_add_test(tc_m, test_string_intern);
+    tcase_add_test(tc_m, test_string_utf8);
+    tcase_add_test(tc_m, test_string_cstr);
+    tcase_add_test(tc_m, test_string_cat_grow);
 
     return s;
 }
@@ -321,6 +321,48 @@ START_TEST (test_json_deserializer_transaction_commands) {
 }
 END_TEST
 
+START_TEST (test_json_deserializer_batch) {
+    char const* buf =   "{ \"" TYPE "\": \"" TYPE_TRANSACTION "\","
+                        " \"" UID "\": 1337, "
+                        " \"" BATCH "\": ["
+                            "[ { \"add\": [ 1, 2 ] } ],"
+                            "[ ],"
+                            "[ { \"sub\": [ 4, 3 ] }, { \"mul\": [ 2 ] } ]"
+                        "] }";
+
+    ssize_t s = ws_deserialize(d, &messagebuf, buf, strlen(buf));
+
+    ck_assert((unsigned long) s == strlen(buf));
+    ck_assert(messagebuf != NULL);
+    ck_assert(messagebuf->obj.id == &WS_OBJECT_TYPE_ID_TRANSACTION);
+    ck_assert(messagebuf->id == 1337);
+    struct ws_transaction* t = (struct ws_transaction*) messagebuf;
+
+    ck_assert(ws_transaction_parts_num(t) == 3);
+
+    struct ws_transaction_command_list* part;
+    part = ws_transaction_part(t, 0);
+    ck_assert(part != NULL);
+    ck_assert(part->num == 1);
+    ck_assert(ws_streq(part->statements[0].command->name, "add"));
+
+    part = ws_transaction_part(t, 1);
+    ck_assert(part != NULL);
+    ck_assert(part->num == 0);
+
+    part = ws_transaction_part(t, 2);
+    ck_assert(part != NULL);
+    ck_assert(part->num == 2);
+    ck_assert(ws_streq(part->statements[0].command->name, "sub"));
+    ck_assert(ws_streq(part->statements[1].command->name, "mul"));
+
+    ck_assert(ws_transaction_part(t, 3) == NULL);
+    ck_assert(t->cmds == part);
+
+    ws_object_unref(&messagebuf->obj);
+}
+END_TEST
+
 START_TEST (test_json_deserializer_flags) {
     char const* buf =   "{ \"" TYPE "\": \"" TYPE_TRANSACTION "\","
                         " \"" UID "\": 1337, "
@@ -655,6 +697,7 @@ json_deserializer_suite(void)
     tcase_add_test(tcx, test_json_deserializer_transaction_one_command);
     tcase_add_test(tcx, test_json_deserializer_transaction_commands);
     tcase_add_test(tcx, test_json_deserializer_flags);
+    tcase_add_test(tcx, test_json_deserializer_batch);
     tcase_add_test(tcx, test_json_deserializer_events);
     tcase_add_test(tcx, test_json_deserializer_events_with_type);
     tcase_add_test(tcx, test_json_deserializer_events_with_everything);
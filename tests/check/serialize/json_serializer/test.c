@@ -48,6 +48,7 @@
 #include <check.h>
 #include "tests.h"
 
+#include "serialize/serialized.h"
 #include "serialize/serializer.h"
 #include "serialize/json/serializer.h"
 #include "serialize/json/keys.h"
@@ -185,6 +186,46 @@ START_TEST (test_json_serializer_event) {
 }
 END_TEST
 
+START_TEST (test_json_serializer_event_twice) {
+    size_t nbuf = 1000; // 1000 bytes are enough, hopefully
+    char* buf   = calloc(1, sizeof(*buf) * nbuf);
+    ck_assert(buf);
+
+    const char* expected = "{\"event\":{\"context\":1,\"name\":\"teststring\"}}";
+
+    // the serializer must be reusable after a message was written completely
+    for (int i = 0; i < 2; ++i) {
+        struct ws_event* ev = mkevent("teststring");
+        memset(buf, 0, nbuf);
+
+        ssize_t s = ws_serialize(ser, buf, nbuf, (struct ws_message*) ev);
+        ck_assert(s == (ssize_t) strlen(expected));
+        ck_assert(ws_streq(expected, buf));
+        ck_assert(ser->buffer == NULL);
+
+        ws_object_unref((struct ws_object*) ev);
+    }
+
+    free(buf);
+}
+END_TEST
+
+START_TEST (test_json_serializer_serialized_message) {
+    struct ws_event* ev = mkevent("teststring");
+
+    struct ws_serialized_message* sm;
+    sm = ws_serialized_message_new(ser, (struct ws_message*) ev);
+    ck_assert(sm);
+
+    const char* expected = "{\"event\":{\"context\":1,\"name\":\"teststring\"}}";
+    ck_assert(sm->len == strlen(expected));
+    ck_assert(ws_strneq(expected, sm->data, sm->len));
+
+    ws_object_unref(&sm->obj);
+    ws_object_unref((struct ws_object*) ev);
+}
+END_TEST
+
 START_TEST (test_json_serializer_event_smallbuf) {
     struct ws_event* ev = mkevent("teststring");
     ssize_t s; // Number of written bytes
@@ -420,6 +461,8 @@ json_deserializer_suite(void)
 
     tcase_add_test(tcx, test_json_serializer_message);
     tcase_add_test(tcx, test_json_serializer_event);
+    tcase_add_test(tcx, test_json_serializer_event_twice);
+    tcase_add_test(tcx, test_json_serializer_serialized_message);
     tcase_add_test(tcx, test_json_serializer_event_smallbuf);
     tcase_add_test(tcx, test_json_serializer_event_with_objid);
 
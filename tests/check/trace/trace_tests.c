@@ -0,0 +1,247 @@
+/*
+ * waysome - wayland based window manager
+ *
+ * Copyright in alphabetical order:
+ *
+ * Copyright (C) 2014-2015 Julian Ganz
+ * Copyright (C) 2014-2015 Manuel Messner
+ * Copyright (C) 2014-2015 Marcel Müller
+ * Copyright (C) 2014-2015 Matthias Beyer
+ * Copyright (C) 2014-2015 Nadja Sommerfeld
+ *
+ * This file is part of waysome.
+ *
+ * waysome is free software: you can redistribute it and/or modify it under the
+ * terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation, either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * waysome is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ * A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with waysome. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/**
+ * @addtogroup tests "Testing"
+ *
+ * @{
+ */
+
+/**
+ * @addtogroup tests_trace "Testing: Tracing"
+ *
+ * @{
+ */
+
+#include <check.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "tests.h"
+#include "trace/decode.h"
+#include "trace/module.h"
+
+/**
+ * Path of the trace file used by the tests
+ */
+static char trace_path[] = "/tmp/waysome-trace-XXXXXX";
+
+static void
+setup(void)
+{
+    int fd = mkstemp(trace_path);
+    ck_assert(fd >= 0);
+    close(fd);
+}
+
+static void
+cleanup(void)
+{
+    ws_trace_close();
+    unlink(trace_path);
+    strcpy(trace_path, "/tmp/waysome-trace-XXXXXX");
+}
+
+/**
+ * Read the trace file
+ */
+static void*
+read_trace(
+    size_t* len
+) {
+    FILE* file = fopen(trace_path, "r");
+    ck_assert(file);
+
+    fseek(file, 0, SEEK_END);
+    *len = ftell(file);
+    rewind(file);
+
+    void* data = malloc(*len);
+    ck_assert(data);
+    ck_assert(fread(data, 1, *len, file) == *len);
+    fclose(file);
+
+    return data;
+}
+
+/**
+ * Convert the trace file to JSON
+ */
+static char*
+trace_json(void)
+{
+    size_t len;
+    void* data = read_trace(&len);
+
+    char* json;
+    size_t json_len;
+    FILE* out = open_memstream(&json, &json_len);
+    ck_assert(out);
+    ck_assert(ws_trace_to_json(out, data, len) == 0);
+    fclose(out);
+    free(data);
+
+    return json;
+}
+
+/**
+ * Count the occurrences of a string in another one
+ */
+static size_t
+count(
+    char const* haystack,
+    char const* needle
+) {
+    size_t num = 0;
+    while ((haystack = strstr(haystack, needle))) {
+        ++num;
+        ++haystack;
+    }
+    return num;
+}
+
+/*
+ *
+ * Tests
+ *
+ */
+
+START_TEST (test_trace_disabled) {
+    int evaluated = 0;
+
+    ck_assert(!ws_trace_enabled);
+    ws_trace_instant(WS_TRACE_EVENT_INPUT, ++evaluated, 0);
+    ck_assert(evaluated == 0);
+}
+END_TEST
+
+START_TEST (test_trace_records) {
+    ck_assert(ws_trace_open(trace_path, 0) == -EINVAL);
+    ck_assert(ws_trace_open(trace_path, SIZE_MAX) == -EINVAL);
+    ck_assert(ws_trace_open(trace_path, 5) == 0);
+    ck_assert(ws_trace_open(trace_path, 5) == -EBUSY);
+
+    ws_trace_begin(WS_TRACE_EVENT_BLIT, 1, 100);
+    ws_trace_end(WS_TRACE_EVENT_BLIT, 1, 100);
+    ws_trace_instant(WS_TRACE_EVENT_FRAME_DONE, 2, 0);
+    ws_trace_close();
+
+    size_t len;
+    struct ws_trace_header* header = read_trace(&len);
+    ck_assert(!memcmp(header->magic, WS_TRACE_MAGIC, sizeof(WS_TRACE_MAGIC)));
+    ck_assert(header->capacity == 8);
+    ck_assert(header->head == 3);
+    ck_assert(len == sizeof(*header) + 8 * sizeof(struct ws_trace_record));
+
+    struct ws_trace_record* rec = (struct ws_trace_record*) (header + 1);
+    ck_assert(rec[0].seq == 1);
+    ck_assert(rec[0].event == WS_TRACE_EVENT_BLIT);
+    ck_assert(rec[0].phase == WS_TRACE_PHASE_BEGIN);
+    ck_assert(rec[0].id == 1);
+    ck_assert(rec[0].arg == 100);
+    ck_assert(rec[1].phase == WS_TRACE_PHASE_END);
+    ck_assert(rec[1].time >= rec[0].time);
+    ck_assert(rec[2].event == WS_TRACE_EVENT_FRAME_DONE);
+    ck_assert(rec[2].thread == rec[0].thread);
+    ck_assert(rec[3].seq == 0);
+
+    free(header);
+}
+END_TEST
+
+START_TEST (test_trace_json) {
+    ck_assert(ws_trace_open(trace_path, 4) == 0);
+
+    for (int i = 0; i < 10; ++i) {
+        ws_trace_instant(WS_TRACE_EVENT_INPUT, i, 0);
+    }
+    ws_trace_async_begin(WS_TRACE_EVENT_TRANSACTION, 0x42, 7);
+    ws_trace_async_end(WS_TRACE_EVENT_TRANSACTION, 0x42, 7);
+    ws_trace_close();
+
+    char* json = trace_json();
+
+    // only the last four records are left
+    ck_assert(strstr(json, "\"overwritten\":8,\"invalid\":0"));
+    ck_assert(count(json, "\"name\"") == 4);
+    ck_assert(count(json, "\"name\":\"input\"") == 2);
+    ck_assert(strstr(json, "\"args\":{\"id\":8,\"arg\":0}"));
+    ck_assert(strstr(json, "\"ph\":\"b\""));
+    ck_assert(strstr(json, "\"ph\":\"e\""));
+    ck_assert(count(json, "\"id\":\"0x42\"") == 2);
+    ck_assert(strstr(json, "\"ph\":\"i\""));
+
+    // the input events come before the transaction
+    ck_assert(strstr(json, "\"input\"") < strstr(json, "\"transaction\""));
+
+    free(json);
+}
+END_TEST
+
+START_TEST (test_trace_json_invalid) {
+    char garbage[256];
+    memset(garbage, 0x2a, sizeof(garbage));
+
+    FILE* out = fopen("/dev/null", "w");
+    ck_assert(out);
+    ck_assert(ws_trace_to_json(out, garbage, sizeof(garbage)) == -EINVAL);
+    ck_assert(ws_trace_to_json(out, garbage, 4) == -EINVAL);
+    fclose(out);
+}
+END_TEST
+
+static Suite*
+trace_suite(void)
+{
+    Suite* s    = suite_create("Trace");
+    TCase* tc   = tcase_create("main case");
+
+    suite_add_tcase(s, tc);
+    tcase_add_checked_fixture(tc, setup, cleanup);
+
+    tcase_add_test(tc, test_trace_disabled);
+    tcase_add_test(tc, test_trace_records);
+    tcase_add_test(tc, test_trace_json);
+    tcase_add_test(tc, test_trace_json_invalid);
+
+    return s;
+}
+
+WS_TESTS_CHECK_MAIN(trace_suite);
+
+/**
+ * @}
+ */
+
+/**
+ * @}
+ */
@@ -38,8 +38,224 @@
  */
 
 #include <check.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "tests.h"
 
+#include "util/parallel.h"
+#include "util/slab.h"
+
+/**
+ * Number of chunks to allocate at once in the slab tests
+ */
+#define SLAB_TEST_CHUNKS (1000)
+
+/**
+ * Number of threads to use in the slab tests
+ */
+#define SLAB_TEST_THREADS (4)
+
+/*
+ *
+ * Slab allocator
+ *
+ */
+
+START_TEST (test_slab_alloc) {
+    static struct ws_slab_pool pool = WS_SLAB_POOL_INIT("test/alloc", 24);
+    static char* chunks[SLAB_TEST_CHUNKS];
+    struct ws_slab_stats stats;
+
+    for (size_t i = 0; i < SLAB_TEST_CHUNKS; ++i) {
+        chunks[i] = ws_slab_alloc(&pool);
+        ck_assert(chunks[i] != NULL);
+
+        // chunks are zeroed, we dirty them to check that for reused ones
+        for (size_t b = 0; b < pool.size; ++b) {
+            ck_assert(chunks[i][b] == 0);
+        }
+        memset(chunks[i], 0xff, pool.size);
+    }
+
+    // the statistics include chunks in the thread's cache
+    ws_slab_pool_stats(&pool, &stats);
+    ck_assert(stats.live >= SLAB_TEST_CHUNKS);
+    ck_assert(stats.high_water == stats.live);
+    ck_assert(stats.slabs >= 1);
+    size_t high_water = stats.high_water;
+    size_t slabs = stats.slabs;
+
+    for (size_t i = 0; i < SLAB_TEST_CHUNKS; ++i) {
+        ws_slab_release(chunks[i]);
+    }
+
+    ws_slab_pool_stats(&pool, &stats);
+    ck_assert(stats.live < SLAB_TEST_CHUNKS);
+    ck_assert(stats.high_water == high_water);
+
+    // released chunks are reused rather than new slabs being allocated
+    for (size_t i = 0; i < SLAB_TEST_CHUNKS; ++i) {
+        chunks[i] = ws_slab_alloc(&pool);
+        ck_assert(chunks[i] != NULL);
+        for (size_t b = 0; b < pool.size; ++b) {
+            ck_assert(chunks[i][b] == 0);
+        }
+    }
+
+    ws_slab_pool_stats(&pool, &stats);
+    ck_assert(stats.slabs == slabs);
+
+    for (size_t i = 0; i < SLAB_TEST_CHUNKS; ++i) {
+        ws_slab_release(chunks[i]);
+    }
+}
+END_TEST
+
+START_TEST (test_slab_release_malloced) {
+    // memory not allocated from a pool is passed to `free()`
+    ws_slab_release(malloc(16));
+    ws_slab_release(calloc(1, 1 << 20));
+    ws_slab_release(NULL);
+}
+END_TEST
+
+/**
+ * Pool used by `slab_test_thread()`
+ */
+static struct ws_slab_pool thread_pool = WS_SLAB_POOL_INIT("test/threads", 40);
+
+/**
+ * Allocate and release chunks, releasing half of them on another thread
+ */
+static void*
+slab_test_thread(
+    void* arg
+) {
+    void** chunks = arg;
+
+    for (size_t i = 0; i < SLAB_TEST_CHUNKS; ++i) {
+        chunks[i] = ws_slab_alloc(&thread_pool);
+        ck_assert(chunks[i] != NULL);
+    }
+
+    // release the chunks of the other thread
+    for (size_t i = 0; i < SLAB_TEST_CHUNKS / 2; ++i) {
+        ws_slab_release(chunks[i]);
+    }
+
+    return NULL;
+}
+
+START_TEST (test_slab_threads) {
+    static void* chunks[SLAB_TEST_THREADS][SLAB_TEST_CHUNKS];
+    pthread_t threads[SLAB_TEST_THREADS];
+    struct ws_slab_stats stats;
+
+    for (size_t i = 0; i < SLAB_TEST_THREADS; ++i) {
+        ck_assert(0 == pthread_create(threads + i, NULL, slab_test_thread,
+                                      chunks[i]));
+    }
+    for (size_t i = 0; i < SLAB_TEST_THREADS; ++i) {
+        ck_assert(0 == pthread_join(threads[i], NULL));
+    }
+
+    // the threads' caches were flushed when they exited
+    ws_slab_pool_stats(&thread_pool, &stats);
+    ck_assert(stats.live == SLAB_TEST_THREADS * SLAB_TEST_CHUNKS / 2);
+
+    // release the remaining chunks from this thread
+    for (size_t i = 0; i < SLAB_TEST_THREADS; ++i) {
+        for (size_t c = SLAB_TEST_CHUNKS / 2; c < SLAB_TEST_CHUNKS; ++c) {
+            ws_slab_release(chunks[i][c]);
+        }
+    }
+
+    ws_slab_pool_stats(&thread_pool, &stats);
+    ck_assert(stats.live < SLAB_TEST_CHUNKS);
+    ck_assert(stats.high_water >= SLAB_TEST_CHUNKS);
+}
+END_TEST
+
+/**
+ * Flag a pool as found if it's the one passed via `etc`
+ */
+static void
+find_pool(
+    struct ws_slab_pool* pool,
+    void* etc
+) {
+    struct ws_slab_pool** wanted = etc;
+    if (*wanted == pool) {
+        *wanted = NULL;
+    }
+}
+
+START_TEST (test_slab_foreach) {
+    static struct ws_slab_pool pool = WS_SLAB_POOL_INIT("test/foreach", 8);
+    struct ws_slab_pool* wanted = &pool;
+
+    // pools are only registered once used
+    ws_slab_foreach_pool(find_pool, &wanted);
+    ck_assert(wanted == &pool);
+
+    ws_slab_release(ws_slab_alloc(&pool));
+
+    ws_slab_foreach_pool(find_pool, &wanted);
+    ck_assert(wanted == NULL);
+}
+END_TEST
+
+/*
+ *
+ * Parallel loops
+ *
+ */
+
+/**
+ * Loop body summing up the indices
+ */
+static void
+sum_indices(
+    size_t index,
+    void* etc
+) {
+    __atomic_fetch_add((size_t*) etc, index, __ATOMIC_RELAXED);
+}
+
+/**
+ * Loop body starting a nested loop
+ */
+static void
+nested_loop(
+    size_t index,
+    void* etc
+) {
+    // nested loops run on the calling thread only
+    ck_assert(1 == ws_parallel_for(10, 4, sum_indices, etc));
+}
+
+START_TEST (test_parallel_for) {
+    size_t sum = 0;
+    ck_assert(ws_parallel_for(1000, 4, sum_indices, &sum) >= 1);
+    ck_assert(sum == 1000 * 999 / 2);
+
+    // no more threads than iterations
+    sum = 0;
+    ck_assert(1 == ws_parallel_for(1, 4, sum_indices, &sum));
+    ck_assert(sum == 0);
+
+    sum = 0;
+    ws_parallel_for(8, 4, nested_loop, &sum);
+    ck_assert(sum == 8 * 45);
+
+    ck_assert(ws_parallel_threads() >= 1);
+    ck_assert(ws_parallel_threads() <= WS_PARALLEL_MAX_THREADS);
+}
+END_TEST
+
 static Suite*
 util_suite(void)
 {
@@ -49,7 +265,11 @@ util_suite(void)
     suite_add_tcase(s, tc);
     // tcase_add_checked_fixture(tc, setup, cleanup); // Not used yet
 
-    //tcase_add_tests(tc, ...);
+    tcase_add_test(tc, test_slab_alloc);
+    tcase_add_test(tc, test_slab_release_malloced);
+    tcase_add_test(tc, test_slab_threads);
+    tcase_add_test(tc, test_slab_foreach);
+    tcase_add_test(tc, test_parallel_for);
 
     return s;
 }